@@ -0,0 +1,100 @@
+// Microbenchmarks for named property lookups, which are what the property lookup caches of
+// the bytecode interpreter speed up. Run with `js -b property-access-benchmark.js` and compare
+// against `js property-access-benchmark.js` (or an older build) to see the difference.
+
+const iterations = 1_000_000;
+
+function ownPropertyGet() {
+    const point = { x: 1, y: 2 };
+    let sum = 0;
+    for (let i = 0; i < iterations; ++i) sum += point.x + point.y;
+    return sum;
+}
+
+function ownPropertyPut() {
+    const counter = { value: 0, other: 0 };
+    for (let i = 0; i < iterations; ++i) {
+        counter.value = i;
+        counter.other = counter.value;
+    }
+    return counter.other;
+}
+
+function prototypeMethodGet() {
+    class Vector {
+        constructor(x, y) {
+            this.x = x;
+            this.y = y;
+        }
+        length() {
+            return this.x + this.y;
+        }
+    }
+    const vector = new Vector(3, 4);
+    let sum = 0;
+    for (let i = 0; i < iterations; ++i) sum += vector.length();
+    return sum;
+}
+
+function polymorphicGet() {
+    const objects = [{ a: 1 }, { b: 1, a: 2 }, { c: 1, b: 2, a: 3 }, { d: 1, c: 2, b: 3, a: 4 }];
+    let sum = 0;
+    for (let i = 0; i < iterations; ++i) sum += objects[i & 3].a;
+    return sum;
+}
+
+function megamorphicGet() {
+    const objects = [];
+    for (let i = 0; i < 16; ++i) {
+        const object = {};
+        object["p" + i] = i;
+        object.a = i;
+        objects.push(object);
+    }
+    let sum = 0;
+    for (let i = 0; i < iterations; ++i) sum += objects[i & 15].a;
+    return sum;
+}
+
+function templating() {
+    const people = [];
+    for (let i = 0; i < 100; ++i) people.push({ name: "Person " + i, age: 20 + (i % 50), address: { city: "City " + (i % 7) } });
+    let length = 0;
+    for (let round = 0; round < iterations / 1000; ++round) {
+        let output = "";
+        for (const person of people) output += `<li>${person.name} (${person.age}), ${person.address.city}</li>`;
+        length += output.length;
+    }
+    return length;
+}
+
+function jsonMassaging() {
+    const records = JSON.parse(
+        JSON.stringify(Array.from({ length: 100 }, (_, i) => ({ id: i, title: "Item " + i, price: i * 3, tags: { sale: i % 2 === 0 } })))
+    );
+    let total = 0;
+    for (let round = 0; round < iterations / 1000; ++round) {
+        for (const record of records) {
+            const copy = { id: record.id, label: record.title, cost: record.price };
+            if (record.tags.sale) copy.cost = copy.cost / 2;
+            total += copy.cost;
+        }
+    }
+    return total;
+}
+
+const benchmarks = [
+    ownPropertyGet,
+    ownPropertyPut,
+    prototypeMethodGet,
+    polymorphicGet,
+    megamorphicGet,
+    templating,
+    jsonMassaging,
+];
+
+for (const benchmark of benchmarks) {
+    const start = Date.now();
+    benchmark();
+    console.log(`${benchmark.name}: ${Date.now() - start} ms`);
+}
@@ -45,6 +45,8 @@ extern "C" {
 #define F_WRLCK ((short)1)
 #define F_UNLCK ((short)2)
 
+#define FALLOC_FL_KEEP_SIZE 0x01
+
 #define AT_FDCWD -100
 #define AT_SYMLINK_NOFOLLOW 0x100
 #define AT_REMOVEDIR 0x200
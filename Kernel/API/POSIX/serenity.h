@@ -33,6 +33,11 @@ enum {
     PERF_EVENT_SYSCALL = 16384,
     PERF_EVENT_SIGNPOST = 32768,
     PERF_EVENT_READ = 65536,
+    PERF_EVENT_CPU_CYCLES = 131072,
+    PERF_EVENT_INSTRUCTIONS = 262144,
+    PERF_EVENT_CACHE_MISSES = 524288,
+    PERF_EVENT_BRANCH_MISSES = 1048576,
+    PERF_EVENT_OFF_CPU = 2097152,
 };
 
 #define PERF_EVENT_MASK_ALL (~0ull)
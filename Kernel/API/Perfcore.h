@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// The binary format of perfcore files and of /proc/profile and /proc/<pid>/perf_events.
+//
+// A stream starts with a FileHeader, followed by records. Every record starts with a RecordHeader
+// that says how many bytes of payload follow, so readers can skip records they don't know about,
+// and can stop at a partial record at the end of a stream that is still being written.
+//
+// Strings and stacks are interned: each one is sent once in its own record, before the first
+// event that refers to it, and events only carry its id. All integers are little-endian.
+
+namespace Perfcore {
+
+static constexpr u32 magic = 0x46524550; // "PERF"
+static constexpr u16 version = 1;
+
+// Used for string and stack ids that don't refer to anything.
+static constexpr u32 invalid_id = 0xffffffff;
+
+struct [[gnu::packed]] FileHeader {
+    u32 magic;
+    u16 version;
+    u16 reserved;
+};
+
+enum class RecordType : u8 {
+    String = 1,
+    Stack = 2,
+    Event = 3,
+};
+
+struct [[gnu::packed]] RecordHeader {
+    RecordType type;
+    u32 length;
+};
+
+// Followed by `length` bytes of UTF-8, without a null terminator.
+struct [[gnu::packed]] StringRecord {
+    u32 id;
+    u32 length;
+};
+
+// Followed by `frame_count` return addresses, innermost first.
+struct [[gnu::packed]] StackRecord {
+    u32 id;
+    u32 frame_count;
+};
+
+// Followed by the payload for `type`, which is one of the PERF_EVENT_* values.
+struct [[gnu::packed]] EventRecord {
+    u32 type;
+    u32 pid;
+    u32 tid;
+    u64 timestamp;
+    u32 lost_samples;
+    u32 stack_id;
+};
+
+struct [[gnu::packed]] AllocationPayload {
+    u64 ptr;
+    u64 size;
+};
+
+struct [[gnu::packed]] MmapPayload {
+    u64 ptr;
+    u64 size;
+    u32 name_id;
+};
+
+struct [[gnu::packed]] ProcessCreatePayload {
+    i32 parent_pid;
+    u32 executable_id;
+};
+
+struct [[gnu::packed]] ProcessExecPayload {
+    u32 executable_id;
+};
+
+struct [[gnu::packed]] ThreadCreatePayload {
+    i32 parent_tid;
+};
+
+struct [[gnu::packed]] ContextSwitchPayload {
+    i32 next_pid;
+    u32 next_tid;
+};
+
+// `string_id` is only valid if `arg1` was the index of a registered string.
+struct [[gnu::packed]] SignpostPayload {
+    u32 string_id;
+    u64 arg1;
+    u64 arg2;
+};
+
+struct [[gnu::packed]] ReadPayload {
+    i32 fd;
+    u64 size;
+    u32 path_id;
+    u64 start_timestamp;
+    u8 success;
+};
+
+// For the hardware events, each sample stands for `period` occurrences of the event.
+struct [[gnu::packed]] PerformanceCounterPayload {
+    u64 period;
+};
+
+// Sent when a thread stops blocking. The event's stack is where it blocked, and `reason_id` says what it waited for.
+struct [[gnu::packed]] OffCpuPayload {
+    u64 duration_us;
+    u32 reason_id;
+};
+
+}
@@ -64,9 +64,13 @@ enum class NeedsBigProcessLock {
     S(dump_backtrace, NeedsBigProcessLock::No)              \
     S(dup2, NeedsBigProcessLock::No)                        \
     S(emuctl, NeedsBigProcessLock::No)                      \
+    S(epoll_create, NeedsBigProcessLock::No)                \
+    S(epoll_ctl, NeedsBigProcessLock::No)                   \
+    S(epoll_wait, NeedsBigProcessLock::No)                  \
     S(execve, NeedsBigProcessLock::Yes)                     \
     S(exit, NeedsBigProcessLock::Yes)                       \
     S(exit_thread, NeedsBigProcessLock::Yes)                \
+    S(fallocate, NeedsBigProcessLock::No)                   \
     S(fchdir, NeedsBigProcessLock::No)                      \
     S(fchmod, NeedsBigProcessLock::No)                      \
     S(fchown, NeedsBigProcessLock::No)                      \
@@ -88,7 +92,7 @@ enum class NeedsBigProcessLock {
     S(getgroups, NeedsBigProcessLock::No)                   \
     S(gethostname, NeedsBigProcessLock::No)                 \
     S(getkeymap, NeedsBigProcessLock::No)                   \
-    S(getpeername, NeedsBigProcessLock::Yes)                \
+    S(getpeername, NeedsBigProcessLock::No)                 \
     S(getpgid, NeedsBigProcessLock::Yes)                    \
     S(getpgrp, NeedsBigProcessLock::Yes)                    \
     S(getpid, NeedsBigProcessLock::No)                      \
@@ -98,7 +102,7 @@ enum class NeedsBigProcessLock {
     S(getresuid, NeedsBigProcessLock::No)                   \
     S(getrusage, NeedsBigProcessLock::Yes)                  \
     S(getsid, NeedsBigProcessLock::Yes)                     \
-    S(getsockname, NeedsBigProcessLock::Yes)                \
+    S(getsockname, NeedsBigProcessLock::No)                 \
     S(getsockopt, NeedsBigProcessLock::No)                  \
     S(gettid, NeedsBigProcessLock::No)                      \
     S(getuid, NeedsBigProcessLock::No)                      \
@@ -112,45 +116,45 @@ enum class NeedsBigProcessLock {
     S(link, NeedsBigProcessLock::No)                        \
     S(listen, NeedsBigProcessLock::No)                      \
     S(lseek, NeedsBigProcessLock::No)                       \
-    S(madvise, NeedsBigProcessLock::Yes)                    \
+    S(madvise, NeedsBigProcessLock::No)                     \
     S(map_time_page, NeedsBigProcessLock::Yes)              \
     S(mkdir, NeedsBigProcessLock::No)                       \
     S(mknod, NeedsBigProcessLock::No)                       \
-    S(mmap, NeedsBigProcessLock::Yes)                       \
+    S(mmap, NeedsBigProcessLock::No)                        \
     S(mount, NeedsBigProcessLock::Yes)                      \
-    S(mprotect, NeedsBigProcessLock::Yes)                   \
-    S(mremap, NeedsBigProcessLock::Yes)                     \
-    S(msync, NeedsBigProcessLock::Yes)                      \
+    S(mprotect, NeedsBigProcessLock::No)                    \
+    S(mremap, NeedsBigProcessLock::No)                      \
+    S(msync, NeedsBigProcessLock::No)                       \
     S(msyscall, NeedsBigProcessLock::Yes)                   \
-    S(munmap, NeedsBigProcessLock::Yes)                     \
+    S(munmap, NeedsBigProcessLock::No)                      \
     S(open, NeedsBigProcessLock::Yes)                       \
     S(perf_event, NeedsBigProcessLock::Yes)                 \
     S(perf_register_string, NeedsBigProcessLock::Yes)       \
     S(pipe, NeedsBigProcessLock::No)                        \
     S(pledge, NeedsBigProcessLock::Yes)                     \
-    S(poll, NeedsBigProcessLock::Yes)                       \
-    S(posix_fallocate, NeedsBigProcessLock::No)             \
+    S(poll, NeedsBigProcessLock::No)                        \
     S(prctl, NeedsBigProcessLock::Yes)                      \
     S(profiling_disable, NeedsBigProcessLock::Yes)          \
     S(profiling_enable, NeedsBigProcessLock::Yes)           \
     S(profiling_free_buffer, NeedsBigProcessLock::Yes)      \
     S(ptrace, NeedsBigProcessLock::Yes)                     \
     S(purge, NeedsBigProcessLock::Yes)                      \
-    S(read, NeedsBigProcessLock::Yes)                       \
-    S(pread, NeedsBigProcessLock::Yes)                      \
+    S(read, NeedsBigProcessLock::No)                        \
+    S(pread, NeedsBigProcessLock::No)                       \
     S(readlink, NeedsBigProcessLock::No)                    \
-    S(readv, NeedsBigProcessLock::Yes)                      \
+    S(readv, NeedsBigProcessLock::No)                       \
     S(realpath, NeedsBigProcessLock::No)                    \
     S(recvfd, NeedsBigProcessLock::No)                      \
-    S(recvmsg, NeedsBigProcessLock::Yes)                    \
+    S(recvmsg, NeedsBigProcessLock::No)                     \
     S(rename, NeedsBigProcessLock::No)                      \
     S(rmdir, NeedsBigProcessLock::No)                       \
     S(sched_getparam, NeedsBigProcessLock::No)              \
     S(sched_setparam, NeedsBigProcessLock::No)              \
     S(sendfd, NeedsBigProcessLock::No)                      \
-    S(sendmsg, NeedsBigProcessLock::Yes)                    \
+    S(sendfile, NeedsBigProcessLock::No)                    \
+    S(sendmsg, NeedsBigProcessLock::No)                     \
     S(set_coredump_metadata, NeedsBigProcessLock::No)       \
-    S(set_mmap_name, NeedsBigProcessLock::Yes)              \
+    S(set_mmap_name, NeedsBigProcessLock::No)               \
     S(set_process_name, NeedsBigProcessLock::Yes)           \
     S(set_thread_name, NeedsBigProcessLock::Yes)            \
     S(setegid, NeedsBigProcessLock::No)                     \
@@ -190,8 +194,8 @@ enum class NeedsBigProcessLock {
     S(utime, NeedsBigProcessLock::No)                       \
     S(utimensat, NeedsBigProcessLock::No)                   \
     S(waitid, NeedsBigProcessLock::Yes)                     \
-    S(write, NeedsBigProcessLock::Yes)                      \
-    S(writev, NeedsBigProcessLock::Yes)                     \
+    S(write, NeedsBigProcessLock::No)                       \
+    S(writev, NeedsBigProcessLock::No)                      \
     S(yield, NeedsBigProcessLock::No)
 
 namespace Syscall {
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+#include <AK/Platform.h>
+VALIDATE_IS_X86()
+
+namespace Kernel {
+
+struct RegisterState;
+
+// Samples the PERF_EVENT_* hardware events with the architectural performance monitoring counters.
+// Each counter raises a performance monitoring interrupt after a fixed number of events, and the
+// interrupt records a sample of the interrupted thread, weighted by that number.
+class PerformanceCounters {
+public:
+    static void initialize();
+
+    static bool is_supported(int event_type);
+    // Whether event_mask asks for nothing but hardware events, none of which the processor can count.
+    static bool counts_none_of(u64 event_mask);
+
+    // Enabling is reference counted, like the profile timer. Events that the processor can't count are ignored.
+    static void enable(u64 event_mask);
+    static void disable();
+
+    static void handle_overflow(RegisterState const&);
+};
+
+}
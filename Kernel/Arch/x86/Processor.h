@@ -101,6 +101,9 @@ class Processor {
 
     Atomic<ProcessorMessageEntry*> m_message_queue;
 
+    // The page directory this processor has loaded, see load_cr3().
+    Atomic<FlatPtr> m_active_cr3 { 0 };
+
     bool m_invoke_scheduler_async;
     bool m_scheduler_initialized;
     bool m_in_scheduler;
@@ -123,6 +126,7 @@ class Processor {
     bool smp_enqueue_message(ProcessorMessage&);
     static void smp_unicast_message(u32 cpu, ProcessorMessage& msg, bool async);
     static void smp_broadcast_message(ProcessorMessage& msg);
+    static void smp_multicast_message(u64 processor_mask, ProcessorMessage& msg);
     static void smp_broadcast_wait_sync(ProcessorMessage& msg);
     static void smp_broadcast_halt();
 
@@ -190,6 +194,16 @@ public:
     static void flush_tlb_local(VirtualAddress vaddr, size_t page_count);
     static void flush_tlb(Memory::PageDirectory const*, VirtualAddress, size_t);
 
+    // Switches to another page directory. Each processor keeps track of the one it has loaded,
+    // so that TLB shootdowns only have to interrupt the processors that are actually using it.
+    static void load_cr3(FlatPtr cr3)
+    {
+        current().m_active_cr3.store(cr3);
+        write_cr3(cr3);
+    }
+
+    FlatPtr active_cr3() const { return m_active_cr3.load(AK::MemoryOrder::memory_order_relaxed); }
+
     Descriptor& get_gdt_entry(u16 selector);
     void flush_gdt();
     DescriptorTablePointer const& get_gdtr();
@@ -377,6 +391,7 @@ public:
 
     static void smp_unicast(u32 cpu, Function<void()>, bool async);
     static void smp_broadcast_flush_tlb(Memory::PageDirectory const*, VirtualAddress, size_t);
+    static void smp_multicast_flush_tlb(u64 processor_mask, Memory::PageDirectory const*, VirtualAddress, size_t);
     static u32 smp_wake_n_idle_processors(u32 wake_count);
 
     static void deferred_call_queue(Function<void()> callback);
@@ -40,13 +40,13 @@ LockRefPtr<PageDirectory> PageDirectory::find_current()
 
 void activate_kernel_page_directory(PageDirectory const& pgd)
 {
-    write_cr3(pgd.cr3());
+    Processor::load_cr3(pgd.cr3());
 }
 
 void activate_page_directory(PageDirectory const& pgd, Thread* current_thread)
 {
     current_thread->regs().cr3 = pgd.cr3();
-    write_cr3(pgd.cr3());
+    Processor::load_cr3(pgd.cr3());
 }
 
 }
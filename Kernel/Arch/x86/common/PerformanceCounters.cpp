@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Arch/InterruptDisabler.h>
+#include <Kernel/Arch/Processor.h>
+#include <Kernel/Arch/RegisterState.h>
+#include <Kernel/Arch/x86/CPUID.h>
+#include <Kernel/Arch/x86/MSR.h>
+#include <Kernel/Arch/x86/PerformanceCounters.h>
+#include <Kernel/Locking/Spinlock.h>
+#include <Kernel/PerformanceManager.h>
+#include <Kernel/Sections.h>
+
+#define IA32_PMC0 0xc1
+#define IA32_PERFEVTSEL0 0x186
+#define IA32_PERF_GLOBAL_STATUS 0x38e
+#define IA32_PERF_GLOBAL_CTRL 0x38f
+#define IA32_PERF_GLOBAL_OVF_CTRL 0x390
+
+#define PERFEVTSEL_USR (1 << 16)
+#define PERFEVTSEL_OS (1 << 17)
+#define PERFEVTSEL_INT (1 << 20)
+#define PERFEVTSEL_EN (1 << 22)
+
+namespace Kernel {
+
+struct HardwareEvent {
+    int type;
+    u8 event_select;
+    u8 unit_mask;
+    // Bit in CPUID.0AH:EBX that is set if the processor can't count this event.
+    u8 unavailable_bit;
+    // Number of events between two samples.
+    u32 period;
+};
+
+static constexpr HardwareEvent s_hardware_events[] = {
+    { PERF_EVENT_CPU_CYCLES, 0x3c, 0x00, 0, 2'000'000 },
+    { PERF_EVENT_INSTRUCTIONS, 0xc0, 0x00, 1, 2'000'000 },
+    { PERF_EVENT_CACHE_MISSES, 0x2e, 0x41, 4, 10'000 },
+    { PERF_EVENT_BRANCH_MISSES, 0xc5, 0x00, 6, 10'000 },
+};
+
+static constexpr size_t max_counters = array_size(s_hardware_events);
+
+static u8 s_counter_count;
+static u32 s_supported_event_mask;
+
+static Spinlock s_lock { LockRank::None };
+static u32 s_enable_count;
+static u64 s_enabled_event_mask;
+
+// Which event each counter is programmed with, in counter order.
+struct CounterAssignment {
+    HardwareEvent const* events[max_counters] {};
+    u8 count { 0 };
+};
+
+// Every processor keeps a copy of the assignment it has programmed, as an overflow interrupt has to
+// be attributed to the event that its counter was counting, not to the one that is about to replace it.
+static CounterAssignment s_local_assignments[ProcessorContainer {}.size()];
+
+UNMAP_AFTER_INIT void PerformanceCounters::initialize()
+{
+    if (!Processor::current().has_feature(CPUFeature::MSR))
+        return;
+    if (CPUID(0).eax() < 0xa)
+        return;
+
+    CPUID leaf(0xa);
+    auto version = leaf.eax() & 0xff;
+    auto counter_count = (leaf.eax() >> 8) & 0xff;
+    auto unavailable_events = leaf.ebx();
+    // Version 2 added the global control MSRs, which is what we use to start, stop and acknowledge counters.
+    if (version < 2 || counter_count == 0)
+        return;
+
+    s_counter_count = min(counter_count, max_counters);
+    for (auto& event : s_hardware_events) {
+        if (!(unavailable_events & (1 << event.unavailable_bit)))
+            s_supported_event_mask |= event.type;
+    }
+    dmesgln("PerformanceCounters: Version {}, {} counters, supported events: {:#x}", version, counter_count, s_supported_event_mask);
+}
+
+bool PerformanceCounters::is_supported(int event_type)
+{
+    return (s_supported_event_mask & event_type) != 0;
+}
+
+bool PerformanceCounters::counts_none_of(u64 event_mask)
+{
+    u64 hardware_event_mask = 0;
+    for (auto& event : s_hardware_events)
+        hardware_event_mask |= event.type;
+    return (event_mask & hardware_event_mask) != 0 && (event_mask & ~hardware_event_mask) == 0 && (event_mask & s_supported_event_mask) == 0;
+}
+
+static u64 reload_value(HardwareEvent const& event)
+{
+    // Counters interrupt when they wrap around to zero. Writes to IA32_PMCx are sign-extended from 32 bits.
+    return -static_cast<u64>(event.period);
+}
+
+static CounterAssignment assign_counters(u64 event_mask)
+{
+    CounterAssignment assignment;
+    for (auto& event : s_hardware_events) {
+        if (assignment.count < s_counter_count && (event_mask & s_supported_event_mask & event.type))
+            assignment.events[assignment.count++] = &event;
+    }
+    return assignment;
+}
+
+static void program_local_counters(u64 event_mask)
+{
+    auto assignment = assign_counters(event_mask);
+    InterruptDisabler disabler;
+    MSR(IA32_PERF_GLOBAL_CTRL).set(0);
+    for (u8 i = 0; i < s_counter_count; ++i)
+        MSR(IA32_PERFEVTSEL0 + i).set(0);
+
+    s_local_assignments[Processor::current_id()] = assignment;
+    u64 global_ctrl = 0;
+    for (u8 i = 0; i < assignment.count; ++i) {
+        auto const& event = *assignment.events[i];
+        MSR(IA32_PMC0 + i).set(reload_value(event));
+        MSR(IA32_PERFEVTSEL0 + i).set(event.event_select | (event.unit_mask << 8) | PERFEVTSEL_USR | PERFEVTSEL_OS | PERFEVTSEL_INT | PERFEVTSEL_EN);
+        global_ctrl |= 1ull << i;
+    }
+    MSR(IA32_PERF_GLOBAL_OVF_CTRL).set(MSR(IA32_PERF_GLOBAL_STATUS).get());
+    MSR(IA32_PERF_GLOBAL_CTRL).set(global_ctrl);
+}
+
+static void program_all_counters(u64 event_mask)
+{
+    ScopedCritical critical;
+    // Every processor assigns its own counters from the mask it was sent. The callers hold s_lock, and processors
+    // handle their messages in the order in which they were sent, so we don't have to wait for them.
+    auto current_id = Processor::current_id();
+    for (u32 cpu = 0; cpu < Processor::count(); ++cpu) {
+        if (cpu != current_id)
+            Processor::smp_unicast(cpu, [event_mask] { program_local_counters(event_mask); }, true);
+    }
+    program_local_counters(event_mask);
+}
+
+void PerformanceCounters::enable(u64 event_mask)
+{
+    if (s_counter_count == 0)
+        return;
+
+    SpinlockLocker locker(s_lock);
+    ++s_enable_count;
+    // Several profiling sessions can be active at the same time, so count the union of what they asked for.
+    auto new_event_mask = s_enabled_event_mask | (event_mask & s_supported_event_mask);
+    if (new_event_mask == s_enabled_event_mask)
+        return;
+    s_enabled_event_mask = new_event_mask;
+    program_all_counters(new_event_mask);
+}
+
+void PerformanceCounters::disable()
+{
+    if (s_counter_count == 0)
+        return;
+
+    SpinlockLocker locker(s_lock);
+    VERIFY(s_enable_count > 0);
+    if (--s_enable_count > 0)
+        return;
+    s_enabled_event_mask = 0;
+    program_all_counters(0);
+}
+
+void PerformanceCounters::handle_overflow(RegisterState const& regs)
+{
+    auto status = MSR(IA32_PERF_GLOBAL_STATUS).get();
+    auto* current_thread = Thread::current();
+    bool should_sample = current_thread && current_thread != Processor::idle_thread();
+
+    auto const& assignment = s_local_assignments[Processor::current_id()];
+    for (u8 i = 0; i < assignment.count; ++i) {
+        if (!(status & (1ull << i)))
+            continue;
+        auto const& event = *assignment.events[i];
+        MSR(IA32_PMC0 + i).set(reload_value(event));
+        if (should_sample)
+            PerformanceManager::add_performance_counter_event(*current_thread, regs, event.type, event.period);
+    }
+    MSR(IA32_PERF_GLOBAL_OVF_CTRL).set(status);
+}
+
+}
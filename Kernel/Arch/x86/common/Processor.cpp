@@ -619,6 +619,7 @@ UNMAP_AFTER_INIT void Processor::early_initialize(u32 cpu)
     m_in_scheduler = true;
 
     m_message_queue = nullptr;
+    m_active_cr3 = read_cr3();
     m_idle_thread = nullptr;
     m_current_thread = nullptr;
     m_info = nullptr;
@@ -1000,8 +1001,17 @@ void Processor::check_invoke_scheduler()
     }
 }
 
+// Past this many pages, it's cheaper to drop all user translations than to invalidate them one by one.
+static constexpr size_t max_pages_to_invalidate_individually = 32;
+
 void Processor::flush_tlb_local(VirtualAddress vaddr, size_t page_count)
 {
+    // Kernel pages are global and survive a CR3 reload, so those are always invalidated individually.
+    if (page_count > max_pages_to_invalidate_individually && Memory::is_user_address(vaddr)) {
+        flush_entire_tlb_local();
+        return;
+    }
+
     auto ptr = vaddr.as_ptr();
     while (page_count > 0) {
         // clang-format off
@@ -1017,9 +1027,30 @@ void Processor::flush_tlb_local(VirtualAddress vaddr, size_t page_count)
 
 void Processor::flush_tlb(Memory::PageDirectory const* page_directory, VirtualAddress vaddr, size_t page_count)
 {
-    if (s_smp_enabled && (!Memory::is_user_address(vaddr) || Process::current().thread_count() > 1))
+    if (!s_smp_enabled) {
+        flush_tlb_local(vaddr, page_count);
+        return;
+    }
+    if (!Memory::is_user_address(vaddr)) {
         smp_broadcast_flush_tlb(page_directory, vaddr, page_count);
-    else
+        return;
+    }
+
+    // Only processors that have this page directory loaded can have cached its user translations.
+    // The fence makes sure that any processor we don't see loading it yet will see the updated page tables.
+    ScopedCritical critical;
+    AK::atomic_thread_fence(AK::MemoryOrder::memory_order_seq_cst);
+    auto cr3 = page_directory->cr3();
+    auto& current_processor = Processor::current();
+    u64 processor_mask = 0;
+    for_each([&](Processor& processor) {
+        if (&processor != &current_processor && processor.active_cr3() == cr3)
+            processor_mask |= 1ull << processor.id();
+    });
+
+    if (processor_mask != 0)
+        smp_multicast_flush_tlb(processor_mask, page_directory, vaddr, page_count);
+    else if (current_processor.active_cr3() == cr3)
         flush_tlb_local(vaddr, page_count);
 }
 
@@ -1259,6 +1290,25 @@ void Processor::smp_broadcast_message(ProcessorMessage& msg)
         APIC::the().broadcast_ipi();
 }
 
+void Processor::smp_multicast_message(u64 processor_mask, ProcessorMessage& msg)
+{
+    auto& current_processor = Processor::current();
+    VERIFY(!(processor_mask & (1ull << current_processor.id())));
+
+    dbgln_if(SMP_DEBUG, "SMP[{}]: Multicast message {} to cpus: {:b} processor: {}", current_processor.id(), VirtualAddress(&msg), processor_mask, VirtualAddress(&current_processor));
+
+    msg.refs.store(popcount(processor_mask), AK::MemoryOrder::memory_order_release);
+    VERIFY(msg.refs > 0);
+    for_each(
+        [&](Processor& proc) {
+            if (!(processor_mask & (1ull << proc.id())))
+                return;
+            // Processors that already had messages queued have an IPI on the way.
+            if (proc.smp_enqueue_message(msg))
+                APIC::the().send_ipi(proc.id());
+        });
+}
+
 void Processor::smp_broadcast_wait_sync(ProcessorMessage& msg)
 {
     auto& cur_proc = Processor::current();
@@ -1332,6 +1382,20 @@ void Processor::smp_broadcast_flush_tlb(Memory::PageDirectory const* page_direct
     smp_broadcast_wait_sync(msg);
 }
 
+void Processor::smp_multicast_flush_tlb(u64 processor_mask, Memory::PageDirectory const* page_directory, VirtualAddress vaddr, size_t page_count)
+{
+    auto& msg = smp_get_from_pool();
+    msg.async = false;
+    msg.type = ProcessorMessage::FlushTlb;
+    msg.flush_tlb.page_directory = page_directory;
+    msg.flush_tlb.ptr = vaddr.as_ptr();
+    msg.flush_tlb.page_count = page_count;
+    smp_multicast_message(processor_mask, msg);
+    if (Processor::current().active_cr3() == page_directory->cr3())
+        flush_tlb_local(vaddr, page_count);
+    smp_broadcast_wait_sync(msg);
+}
+
 void Processor::smp_broadcast_halt()
 {
     // We don't want to use a message, because this could have been triggered
@@ -1621,7 +1685,7 @@ extern "C" void enter_thread_context(Thread* from_thread, Thread* to_thread)
 #endif
 
     if (from_regs.cr3 != to_regs.cr3)
-        write_cr3(to_regs.cr3);
+        Processor::load_cr3(to_regs.cr3);
 
     to_thread->set_cpu(processor.id());
 
@@ -62,6 +62,17 @@ void Device::process_next_queued_request(Badge<AsyncDeviceRequest>, AsyncDeviceR
 {
     SpinlockLocker lock(m_requests_lock);
     VERIFY(!m_requests.is_empty());
+    if (can_process_requests_concurrently()) {
+        // Every request was started when it was made, so there is nothing to kick off.
+        for (auto it = m_requests.begin(); it != m_requests.end(); ++it) {
+            if (it->ptr() == &completed_request) {
+                m_requests.remove(it);
+                evaluate_block_conditions();
+                return;
+            }
+        }
+        VERIFY_NOT_REACHED();
+    }
     VERIFY(m_requests.first().ptr() == &completed_request);
     m_requests.remove(m_requests.begin());
     if (!m_requests.is_empty()) {
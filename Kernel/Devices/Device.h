@@ -59,13 +59,17 @@ public:
         SpinlockLocker lock(m_requests_lock);
         bool was_empty = m_requests.is_empty();
         m_requests.append(request);
-        if (was_empty)
+        if (was_empty || can_process_requests_concurrently())
             request->do_start(move(lock));
         return request;
     }
 
 protected:
     Device(MajorNumber major, MinorNumber minor);
+
+    // Devices that keep several requests in flight start each one as soon as it's made,
+    // instead of waiting for the previous one to complete.
+    virtual bool can_process_requests_concurrently() const { return false; }
     void set_uid(UserID uid) { m_uid = uid; }
     void set_gid(GroupID gid) { m_gid = gid; }
 
@@ -4,53 +4,137 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
+#include <AK/FixedArray.h>
+#include <AK/HashTable.h>
 #include <AK/IntrusiveList.h>
+#include <AK/QuickSort.h>
+#include <AK/ScopeGuard.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/Memory/MemoryManager.h>
 #include <Kernel/Process.h>
+#include <Kernel/Tasks/WritebackTask.h>
+#include <Kernel/Time/TimeManagement.h>
 
 namespace Kernel {
 
+// The storage layer may split large transfers and complete them partially, so keep going until everything is done.
+static ErrorOr<void> read_from_disk(OpenFileDescription& description, u64 offset, u8* data, size_t size)
+{
+    while (size > 0) {
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(data);
+        auto nread = TRY(description.read(buffer, offset, size));
+        if (nread == 0)
+            return EIO;
+        offset += nread;
+        data += nread;
+        size -= nread;
+    }
+    return {};
+}
+
+static ErrorOr<void> write_to_disk(OpenFileDescription& description, u64 offset, u8 const* data, size_t size)
+{
+    while (size > 0) {
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(const_cast<u8*>(data));
+        auto nwritten = TRY(description.write(offset, buffer, size));
+        if (nwritten == 0)
+            return EIO;
+        offset += nwritten;
+        data += nwritten;
+        size -= nwritten;
+    }
+    return {};
+}
+
 struct CacheEntry {
+    enum class Queue : u8 {
+        Free,
+        Recent,
+        Frequent,
+    };
+
     IntrusiveListNode<CacheEntry> list_node;
     BlockBasedFileSystem::BlockIndex block_index { 0 };
     u8* data { nullptr };
+    Time dirty_since;
+    Queue queue { Queue::Free };
     bool has_data { false };
+    bool is_dirty { false };
+};
+
+// All disk caches together may grow to 1/8 of physical memory. Every cache keeps its first segment regardless.
+static Atomic<size_t> s_disk_cache_byte_limit;
+static Atomic<size_t> s_disk_cache_bytes;
+
+struct DiskCacheSegment {
+    NonnullOwnPtr<KBuffer> block_data;
+    FixedArray<CacheEntry> entries;
 };
 
+// A block cache with 2Q replacement: blocks seen for the first time enter a small FIFO ("recent") queue,
+// and only blocks that are referenced again after falling out of it are promoted to the LRU ("frequent") queue.
+// This keeps large sequential scans from flushing out the working set.
+// The cache starts out small and grows in segments up to a limit (and within the budget shared by all disk caches),
+// and gives segments back under memory pressure.
 class DiskCache {
 public:
-    static constexpr size_t EntryCount = 10000;
-    explicit DiskCache(BlockBasedFileSystem& fs, NonnullOwnPtr<KBuffer> cached_block_data, NonnullOwnPtr<KBuffer> entries_buffer)
-        : m_fs(fs)
-        , m_cached_block_data(move(cached_block_data))
-        , m_entries(move(entries_buffer))
+    static constexpr size_t entries_per_segment = 128;
+    // The recent queue is allowed to hold up to 1/recent_queue_divisor of the cache before it is evicted from first.
+    static constexpr size_t recent_queue_divisor = 4;
+    // We check for memory pressure once every this many cache misses.
+    static constexpr size_t memory_pressure_check_interval = 256;
+    // Upper bound on how many adjacent dirty blocks are gathered into a single write.
+    static constexpr size_t max_coalesced_blocks = 64;
+
+    static ErrorOr<NonnullOwnPtr<DiskCache>> try_create(BlockBasedFileSystem& fs, size_t max_entry_count)
     {
-        for (size_t i = 0; i < EntryCount; ++i) {
-            entries()[i].data = m_cached_block_data->data() + i * m_fs.block_size();
-            m_clean_list.append(entries()[i]);
-        }
+        auto cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(fs, max_entry_count)));
+        // Remember about as many evicted blocks as fit in half of the cache.
+        TRY(cache->m_ghost_ring.try_ensure_capacity(max_entry_count / 2));
+        TRY(cache->try_grow(IgnoreGlobalLimit::Yes));
+        return cache;
     }
 
-    ~DiskCache() = default;
+    ~DiskCache()
+    {
+        s_disk_cache_bytes.fetch_sub(m_segments.size() * segment_size());
+    }
 
     bool is_dirty() const { return !m_dirty_list.is_empty(); }
-    bool entry_is_dirty(CacheEntry const& entry) const { return m_dirty_list.contains(entry); }
+    bool entry_is_dirty(CacheEntry const& entry) const { return entry.is_dirty; }
 
-    void mark_all_clean()
+    void mark_clean(CacheEntry& entry)
     {
-        while (auto* entry = m_dirty_list.first())
-            m_clean_list.prepend(*entry);
+        VERIFY(entry.is_dirty);
+        entry.is_dirty = false;
+        --m_dirty_count;
+        queue_for(entry).prepend(entry);
+        ++m_write_generation;
     }
 
     void mark_dirty(CacheEntry& entry)
     {
+        if (!entry.is_dirty) {
+            entry.is_dirty = true;
+            entry.dirty_since = TimeManagement::the().monotonic_time();
+            ++m_dirty_count;
+        }
         m_dirty_list.prepend(entry);
+        ++m_write_generation;
+
+        if (!m_writeback_requested && exceeds_dirty_ratio()) {
+            m_writeback_requested = true;
+            WritebackTask::wake();
+        }
     }
 
-    void mark_clean(CacheEntry& entry)
+    // The ratio is relative to the current size of the cache, not to how large it may grow,
+    // so that a cache that hasn't grown much yet doesn't pile up dirty blocks without bound.
+    bool exceeds_dirty_ratio() const
     {
-        m_clean_list.prepend(entry);
+        return m_dirty_count * 100 > entry_count() * WritebackTask::dirty_ratio.load(AK::MemoryOrder::memory_order_relaxed);
     }
 
     CacheEntry* get(BlockBasedFileSystem::BlockIndex block_index) const
@@ -65,47 +149,262 @@ public:
 
     ErrorOr<CacheEntry*> ensure(BlockBasedFileSystem::BlockIndex block_index) const
     {
-        if (auto* entry = get(block_index))
+        if (auto* entry = get(block_index)) {
+            // Hits in the recent queue are deliberately ignored, so that a burst of accesses
+            // to a block that is never used again doesn't promote it.
+            if (entry->queue == CacheEntry::Queue::Frequent && !entry->is_dirty)
+                m_frequent_queue.prepend(*entry);
             return entry;
+        }
 
-        if (m_clean_list.is_empty()) {
-            // Not a single clean entry! Flush writes and try again.
-            // NOTE: We want to make sure we only call FileBackedFileSystem flush here,
-            //       not some FileBackedFileSystem subclass flush!
-            m_fs.flush_writes_impl();
-            return ensure(block_index);
+        if ((++m_insertions % memory_pressure_check_interval) == 0 && is_under_memory_pressure())
+            try_shrink();
+
+        auto* new_entry = take_entry();
+        if (auto result = m_hash.try_set(block_index, new_entry); result.is_error()) {
+            m_free_list.prepend(*new_entry);
+            return result.release_error();
         }
 
-        VERIFY(m_clean_list.last());
-        auto& new_entry = *m_clean_list.last();
-        m_clean_list.prepend(new_entry);
+        new_entry->block_index = block_index;
+        new_entry->has_data = false;
+        new_entry->queue = m_ghosts.remove(block_index) ? CacheEntry::Queue::Frequent : CacheEntry::Queue::Recent;
+        queue_for(*new_entry).prepend(*new_entry);
+        ++count_for(new_entry->queue);
+        return new_entry;
+    }
 
-        m_hash.remove(new_entry.block_index);
-        TRY(m_hash.try_set(block_index, &new_entry));
+    // Writes back the dirty entries selected by the filter in block order, so that runs of
+    // adjacent blocks go out as a single write. Returns the number of blocks written.
+    template<typename Filter>
+    size_t flush(Filter filter)
+    {
+        Vector<CacheEntry*> entries;
+        for (auto& entry : m_dirty_list) {
+            if (!filter(entry))
+                continue;
+            // If we can't remember them all, write back what we have and leave the rest for later.
+            if (entries.try_append(&entry).is_error())
+                break;
+        }
+        quick_sort(entries, [](auto* a, auto* b) { return a->block_index < b->block_index; });
+
+        auto block_size = m_fs.block_size();
+        OwnPtr<KBuffer> coalescing_buffer;
+        for (size_t i = 0; i < entries.size();) {
+            auto first_block = entries[i]->block_index.value();
+            size_t run_length = 1;
+            while (i + run_length < entries.size() && run_length < max_coalesced_blocks && entries[i + run_length]->block_index.value() == first_block + run_length)
+                ++run_length;
+
+            u8 const* data = entries[i]->data;
+            if (run_length > 1 && !coalescing_buffer) {
+                auto buffer_or_error = KBuffer::try_create_with_size("BlockBasedFS: Writeback"sv, max_coalesced_blocks * block_size);
+                if (buffer_or_error.is_error())
+                    run_length = 1;
+                else
+                    coalescing_buffer = buffer_or_error.release_value();
+            }
+            if (run_length > 1) {
+                for (size_t j = 0; j < run_length; ++j)
+                    memcpy(coalescing_buffer->data() + j * block_size, entries[i + j]->data, block_size);
+                data = coalescing_buffer->data();
+            }
+
+            if (auto result = write_to_disk(m_fs.file_description(), first_block * block_size, data, run_length * block_size); result.is_error())
+                dbgln("{}: Failed to write back {} blocks at {}: {}", m_fs.class_name(), run_length, first_block, result.error());
+            for (size_t j = 0; j < run_length; ++j)
+                mark_clean(*entries[i + j]);
+            i += run_length;
+        }
 
-        new_entry.block_index = block_index;
-        new_entry.has_data = false;
+        if (!exceeds_dirty_ratio())
+            m_writeback_requested = false;
+        return entries.size();
+    }
 
-        return &new_entry;
+    size_t flush_all()
+    {
+        return flush([](auto&) { return true; });
     }
 
-    CacheEntry const* entries() const { return (CacheEntry const*)m_entries->data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries->data(); }
+    void did_hit() { ++m_hits; }
+    void did_miss() { ++m_misses; }
 
-    template<typename Callback>
-    void for_each_dirty_entry(Callback callback)
+    // Bumped whenever a block is dirtied, written to disk or evicted, so that unlocked readers
+    // can tell whether what they read from the disk may be stale.
+    u64 write_generation() const { return m_write_generation; }
+    void bump_write_generation() { ++m_write_generation; }
+
+    void append_statistics(BlockBasedFileSystem::CacheStatistics& statistics) const
     {
-        for (auto& entry : m_dirty_list)
-            callback(entry);
+        statistics.hits += m_hits;
+        statistics.misses += m_misses;
+        statistics.evictions += m_evictions;
+        statistics.entry_count += m_segments.size() * entries_per_segment;
+        statistics.max_entry_count += m_max_entry_count;
+        statistics.dirty_entry_count += m_dirty_count;
     }
 
 private:
+    using EntryList = IntrusiveList<&CacheEntry::list_node>;
+
+    DiskCache(BlockBasedFileSystem& fs, size_t max_entry_count)
+        : m_fs(fs)
+        , m_max_entry_count(max(max_entry_count, entries_per_segment))
+    {
+    }
+
+    EntryList& queue_for(CacheEntry const& entry) const
+    {
+        VERIFY(entry.queue != CacheEntry::Queue::Free);
+        return entry.queue == CacheEntry::Queue::Recent ? m_recent_queue : m_frequent_queue;
+    }
+
+    size_t& count_for(CacheEntry::Queue queue) const
+    {
+        VERIFY(queue != CacheEntry::Queue::Free);
+        return queue == CacheEntry::Queue::Recent ? m_recent_count : m_frequent_count;
+    }
+
+    size_t entry_count() const { return m_segments.size() * entries_per_segment; }
+
+    static bool is_under_memory_pressure()
+    {
+        auto info = MM.get_system_memory_info();
+        return info.physical_pages_uncommitted < info.physical_pages / 16;
+    }
+
+    size_t segment_size() const { return entries_per_segment * m_fs.block_size(); }
+
+    enum class IgnoreGlobalLimit {
+        No,
+        Yes,
+    };
+
+    ErrorOr<void> try_grow(IgnoreGlobalLimit ignore_global_limit = IgnoreGlobalLimit::No) const
+    {
+        auto new_total = s_disk_cache_bytes.fetch_add(segment_size()) + segment_size();
+        ArmedScopeGuard release_reservation = [&] { s_disk_cache_bytes.fetch_sub(segment_size()); };
+        if (ignore_global_limit == IgnoreGlobalLimit::No && new_total > s_disk_cache_byte_limit.load())
+            return ENOMEM;
+
+        auto block_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache blocks"sv, segment_size()));
+        auto entries = TRY(FixedArray<CacheEntry>::try_create(entries_per_segment));
+        auto segment = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCacheSegment { move(block_data), move(entries) }));
+        for (size_t i = 0; i < entries_per_segment; ++i) {
+            auto& entry = segment->entries[i];
+            entry.data = segment->block_data->data() + i * m_fs.block_size();
+            m_free_list.append(entry);
+        }
+        TRY(m_segments.try_append(move(segment)));
+        release_reservation.disarm();
+        return {};
+    }
+
+    // Gives the most recently added segment back to the system, provided none of its blocks are dirty.
+    void try_shrink() const
+    {
+        if (m_segments.size() <= 1)
+            return;
+        auto& segment = *m_segments.last();
+        for (auto& entry : segment.entries) {
+            if (entry.is_dirty)
+                return;
+        }
+        for (auto& entry : segment.entries) {
+            if (entry.queue != CacheEntry::Queue::Free)
+                evict(entry);
+            m_free_list.remove(entry);
+        }
+        m_segments.remove(m_segments.size() - 1);
+        s_disk_cache_bytes.fetch_sub(segment_size());
+        dbgln_if(BBFS_DEBUG, "{}: Shrunk disk cache to {} entries", m_fs.class_name(), entry_count());
+    }
+
+    void remember_evicted_block(BlockBasedFileSystem::BlockIndex block_index) const
+    {
+        auto ghost_capacity = m_ghost_ring.capacity();
+        if (ghost_capacity == 0)
+            return;
+        if (m_ghost_ring.size() < ghost_capacity) {
+            m_ghost_ring.unchecked_append(block_index);
+        } else {
+            m_ghosts.remove(m_ghost_ring[m_ghost_ring_head]);
+            m_ghost_ring[m_ghost_ring_head] = block_index;
+            m_ghost_ring_head = (m_ghost_ring_head + 1) % ghost_capacity;
+        }
+        // The ghost set is only a hint, so we can live without this entry if we're out of memory.
+        (void)m_ghosts.try_set(block_index);
+    }
+
+    void evict(CacheEntry& entry) const
+    {
+        VERIFY(!entry.is_dirty);
+        --count_for(entry.queue);
+        m_hash.remove(entry.block_index);
+        entry.queue = CacheEntry::Queue::Free;
+        entry.has_data = false;
+        m_free_list.prepend(entry);
+        ++m_evictions;
+        ++m_write_generation;
+    }
+
+    CacheEntry* evict_one() const
+    {
+        // Dirty entries live on the dirty list, so the tail of each queue is always a clean entry.
+        auto& preferred_queue = m_recent_count > entry_count() / recent_queue_divisor ? m_recent_queue : m_frequent_queue;
+        auto* victim = preferred_queue.last();
+        if (!victim)
+            victim = (&preferred_queue == &m_recent_queue ? m_frequent_queue : m_recent_queue).last();
+        if (!victim)
+            return nullptr;
+        if (victim->queue == CacheEntry::Queue::Recent)
+            remember_evicted_block(victim->block_index);
+        evict(*victim);
+        return victim;
+    }
+
+    CacheEntry* take_entry() const
+    {
+        if (m_free_list.is_empty() && entry_count() < m_max_entry_count && !is_under_memory_pressure())
+            (void)try_grow();
+
+        if (m_free_list.is_empty() && !evict_one()) {
+            // Not a single clean entry! Flush writes and try again.
+            const_cast<DiskCache&>(*this).flush_all();
+            VERIFY(evict_one());
+        }
+
+        auto* entry = m_free_list.first();
+        VERIFY(entry);
+        m_free_list.remove(*entry);
+        return entry;
+    }
+
     BlockBasedFileSystem& m_fs;
+    size_t const m_max_entry_count { 0 };
+    mutable Vector<NonnullOwnPtr<DiskCacheSegment>> m_segments;
     mutable HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_hash;
-    mutable IntrusiveList<&CacheEntry::list_node> m_clean_list;
-    mutable IntrusiveList<&CacheEntry::list_node> m_dirty_list;
-    NonnullOwnPtr<KBuffer> m_cached_block_data;
-    NonnullOwnPtr<KBuffer> m_entries;
+    mutable EntryList m_free_list;
+    mutable EntryList m_recent_queue;
+    mutable EntryList m_frequent_queue;
+    mutable EntryList m_dirty_list;
+    mutable size_t m_recent_count { 0 };
+    mutable size_t m_frequent_count { 0 };
+    size_t m_dirty_count { 0 };
+    bool m_writeback_requested { false };
+
+    // Blocks recently evicted from the recent queue. Missing on one of these means the block is in the working set.
+    mutable HashTable<BlockBasedFileSystem::BlockIndex> m_ghosts;
+    mutable Vector<BlockBasedFileSystem::BlockIndex> m_ghost_ring;
+    mutable size_t m_ghost_ring_head { 0 };
+
+    mutable u64 m_insertions { 0 };
+    mutable u64 m_evictions { 0 };
+    u64 m_hits { 0 };
+    u64 m_misses { 0 };
+    mutable u64 m_write_generation { 0 };
 };
 
 BlockBasedFileSystem::BlockBasedFileSystem(OpenFileDescription& file_description)
@@ -119,13 +418,19 @@ BlockBasedFileSystem::~BlockBasedFileSystem() = default;
 ErrorOr<void> BlockBasedFileSystem::initialize()
 {
     VERIFY(block_size() != 0);
-    auto cached_block_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache blocks"sv, DiskCache::EntryCount * block_size()));
-    auto entries_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache entries"sv, DiskCache::EntryCount * sizeof(CacheEntry)));
-    auto disk_cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(*this, move(cached_block_data), move(entries_data))));
 
-    m_cache.with_exclusive([&](auto& cache) {
-        cache = move(disk_cache);
-    });
+    // Let the cache grow to 1/8 of physical memory, but no smaller than the fixed-size cache we used to have.
+    // The global limit below keeps all mounted file systems together within that budget.
+    auto physical_memory_size = MM.get_system_memory_info().physical_pages * PAGE_SIZE;
+    s_disk_cache_byte_limit.store(physical_memory_size / 8);
+    m_max_cache_entry_count = clamp(physical_memory_size / 8 / block_size(), 10000u, 1u * MiB);
+
+    for (auto& shard : m_cache_shards) {
+        auto disk_cache = TRY(DiskCache::try_create(*this, ceil_div(m_max_cache_entry_count, cache_shard_count)));
+        shard.with_exclusive([&](auto& cache) {
+            cache = move(disk_cache);
+        });
+    }
     return {};
 }
 
@@ -142,10 +447,11 @@ ErrorOr<void> BlockBasedFileSystem::write_block(BlockIndex index, UserOrKernelBu
 
     TRY(data.read(buffered_data.bytes()));
 
-    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
+    return cache_shard_for(index).with_exclusive([&](auto& cache) -> ErrorOr<void> {
         if (!allow_cache) {
             flush_specific_block_if_needed(index);
             u64 base_offset = index.value() * block_size() + offset;
+            cache->bump_write_generation();
             auto nwritten = TRY(file_description().write(base_offset, data, count));
             VERIFY(nwritten == count);
             return {};
@@ -177,6 +483,11 @@ ErrorOr<void> BlockBasedFileSystem::raw_write(BlockIndex index, UserOrKernelBuff
     auto base_offset = index.value() * m_logical_block_size;
     auto nwritten = TRY(file_description().write(base_offset, buffer, m_logical_block_size));
     VERIFY(nwritten == m_logical_block_size);
+    // This bypasses the cache, so let read-ahead know that it may have read the old contents.
+    cache_shard_for(BlockIndex { base_offset / block_size() }).with_exclusive([](auto& cache) {
+        if (cache)
+            cache->bump_write_generation();
+    });
     return {};
 }
 
@@ -216,7 +527,7 @@ ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuf
     VERIFY(offset + count <= block_size());
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_block {}", index);
 
-    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
+    return cache_shard_for(index).with_exclusive([&](auto& cache) -> ErrorOr<void> {
         if (!allow_cache) {
             const_cast<BlockBasedFileSystem*>(this)->flush_specific_block_if_needed(index);
             u64 base_offset = index.value() * block_size() + offset;
@@ -226,7 +537,10 @@ ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuf
         }
 
         auto* entry = TRY(cache->ensure(index));
-        if (!entry->has_data) {
+        if (entry->has_data) {
+            cache->did_hit();
+        } else {
+            cache->did_miss();
             auto base_offset = index.value() * block_size();
             auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
             auto nread = TRY(file_description().read(entry_data_buffer, base_offset, block_size()));
@@ -255,9 +569,64 @@ ErrorOr<void> BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count
     return {};
 }
 
+ErrorOr<void> BlockBasedFileSystem::read_ahead_blocks(BlockIndex index, size_t count) const
+{
+    VERIFY(m_logical_block_size);
+    dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_ahead_blocks {}, count={}", index, count);
+
+    auto is_cached = [&](u64 block) {
+        return cache_shard_for(BlockIndex { block }).with_exclusive([&](auto& cache) {
+            auto* entry = cache->get(BlockIndex { block });
+            return entry && entry->has_data;
+        });
+    };
+
+    // Trim blocks that are already cached off both ends of the range, and read the rest with a single request.
+    auto first_block = index.value();
+    auto end_block = index.value() + count;
+    while (first_block < end_block && is_cached(first_block))
+        ++first_block;
+    while (end_block > first_block && is_cached(end_block - 1))
+        --end_block;
+    if (first_block == end_block)
+        return {};
+
+    // Don't let read-ahead push out more than a small fraction of the cache.
+    end_block = min(end_block, first_block + m_max_cache_entry_count / 8);
+    auto block_count = end_block - first_block;
+
+    // The read happens without holding any cache locks, so note the write generation of each shard
+    // beforehand. If a shard sees a write or an eviction in the meantime, what we read for it may already be stale.
+    Array<u64, cache_shard_count> write_generations;
+    for (size_t i = 0; i < cache_shard_count; ++i)
+        write_generations[i] = m_cache_shards[i].with_exclusive([](auto& cache) { return cache->write_generation(); });
+
+    auto read_buffer = TRY(KBuffer::try_create_with_size("BlockBasedFS: Read-ahead"sv, block_count * block_size()));
+    TRY(read_from_disk(file_description(), first_block * block_size(), read_buffer->data(), block_count * block_size()));
+
+    for (size_t i = 0; i < block_count; ++i) {
+        BlockIndex block_index { first_block + i };
+        auto shard_index = block_index.value() % cache_shard_count;
+        TRY(m_cache_shards[shard_index].with_exclusive([&](auto& cache) -> ErrorOr<void> {
+            if (cache->write_generation() != write_generations[shard_index])
+                return {};
+            // Blocks in the middle of the range may be cached (and dirty), so don't clobber them.
+            if (auto* entry = cache->get(block_index); entry && entry->has_data)
+                return {};
+            auto* entry = TRY(cache->ensure(block_index));
+            memcpy(entry->data, read_buffer->data() + i * block_size(), block_size());
+            entry->has_data = true;
+            // Making room for this block may have evicted another one, which we know is fine.
+            write_generations[shard_index] = cache->write_generation();
+            return {};
+        }));
+    }
+    return {};
+}
+
 void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
 {
-    m_cache.with_exclusive([&](auto& cache) {
+    cache_shard_for(index).with_exclusive([&](auto& cache) {
         if (!cache->is_dirty())
             return;
         auto* entry = cache->get(index);
@@ -267,6 +636,7 @@ void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
             return;
         size_t base_offset = entry->block_index.value() * block_size();
         auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
+        cache->bump_write_generation();
         (void)file_description().write(base_offset, entry_data_buffer, block_size());
     });
 }
@@ -274,18 +644,42 @@ void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
 void BlockBasedFileSystem::flush_writes_impl()
 {
     size_t count = 0;
-    m_cache.with_exclusive([&](auto& cache) {
-        if (!cache->is_dirty())
-            return;
-        cache->for_each_dirty_entry([&](CacheEntry& entry) {
-            auto base_offset = entry.block_index.value() * block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-            [[maybe_unused]] auto rc = file_description().write(base_offset, entry_data_buffer, block_size());
-            ++count;
+    for (auto& shard : m_cache_shards) {
+        shard.with_exclusive([&](auto& cache) {
+            if (cache->is_dirty())
+                count += cache->flush_all();
         });
-        cache->mark_all_clean();
+    }
+    if (count)
         dbgln("{}: Flushed {} blocks to disk", class_name(), count);
-    });
+}
+
+void BlockBasedFileSystem::writeback_dirty_blocks()
+{
+    auto expiry_time = TimeManagement::the().monotonic_time() - Time::from_milliseconds(WritebackTask::dirty_expire_ms.load(AK::MemoryOrder::memory_order_relaxed));
+    size_t count = 0;
+    for (auto& shard : m_cache_shards) {
+        shard.with_exclusive([&](auto& cache) {
+            if (!cache->is_dirty())
+                return;
+            if (cache->exceeds_dirty_ratio())
+                count += cache->flush_all();
+            else
+                count += cache->flush([&](auto& entry) { return entry.dirty_since <= expiry_time; });
+        });
+    }
+    dbgln_if(BBFS_DEBUG, "{}: Wrote back {} blocks", class_name(), count);
+}
+
+BlockBasedFileSystem::CacheStatistics BlockBasedFileSystem::cache_statistics() const
+{
+    CacheStatistics statistics;
+    for (auto& shard : m_cache_shards) {
+        shard.with_shared([&](auto& cache) {
+            cache->append_statistics(statistics);
+        });
+    }
+    return statistics;
 }
 
 void BlockBasedFileSystem::flush_writes()
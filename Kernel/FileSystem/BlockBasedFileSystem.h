@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/Locking/MutexProtected.h>
 
@@ -21,13 +22,25 @@ public:
     u64 logical_block_size() const { return m_logical_block_size; };
 
     virtual void flush_writes() override;
+    virtual void writeback_dirty_blocks() override;
     void flush_writes_impl();
 
+    struct CacheStatistics {
+        u64 hits { 0 };
+        u64 misses { 0 };
+        u64 evictions { 0 };
+        size_t entry_count { 0 };
+        size_t max_entry_count { 0 };
+        size_t dirty_entry_count { 0 };
+    };
+    CacheStatistics cache_statistics() const;
+
 protected:
     explicit BlockBasedFileSystem(OpenFileDescription&);
 
     ErrorOr<void> read_block(BlockIndex, UserOrKernelBuffer*, size_t count, u64 offset = 0, bool allow_cache = true) const;
     ErrorOr<void> read_blocks(BlockIndex, unsigned count, UserOrKernelBuffer&, bool allow_cache = true) const;
+    ErrorOr<void> read_ahead_blocks(BlockIndex, size_t count) const;
 
     ErrorOr<void> raw_read(BlockIndex, UserOrKernelBuffer&);
     ErrorOr<void> raw_write(BlockIndex, UserOrKernelBuffer const&);
@@ -41,10 +54,16 @@ protected:
     u64 m_logical_block_size { 512 };
 
 private:
-    DiskCache& cache() const;
+    virtual bool is_block_based() const override { return true; }
+
+    // The cache is split into independently locked shards so that I/O on unrelated blocks doesn't serialize.
+    static constexpr size_t cache_shard_count = 8;
+
+    MutexProtected<OwnPtr<DiskCache>>& cache_shard_for(BlockIndex index) const { return m_cache_shards[index.value() % cache_shard_count]; }
     void flush_specific_block_if_needed(BlockIndex index);
 
-    mutable MutexProtected<OwnPtr<DiskCache>> m_cache;
+    mutable Array<MutexProtected<OwnPtr<DiskCache>>, cache_shard_count> m_cache_shards;
+    size_t m_max_cache_entry_count { 0 };
 };
 
 }
@@ -4,9 +4,11 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/HashFunctions.h>
 #include <AK/RefPtr.h>
 #include <AK/Singleton.h>
 #include <AK/StringBuilder.h>
+#include <AK/StringHash.h>
 #include <AK/StringView.h>
 #include <AK/Vector.h>
 #include <Kernel/FileSystem/Custody.h>
@@ -24,8 +26,9 @@ SpinlockProtected<Custody::AllCustodiesList>& Custody::all_instances()
 ErrorOr<NonnullRefPtr<Custody>> Custody::try_create(Custody* parent, StringView name, Inode& inode, int mount_flags)
 {
     return all_instances().with([&](auto& all_custodies) -> ErrorOr<NonnullRefPtr<Custody>> {
-        for (Custody& custody : all_custodies) {
-            if (custody.parent() == parent
+        auto& bucket = all_custodies.bucket_for(parent, name);
+        for (Custody& custody : bucket) {
+            if (custody.m_parent.ptr() == parent
                 && custody.name() == name
                 && &custody.inode() == &inode
                 && custody.mount_flags() == mount_flags) {
@@ -35,11 +38,17 @@ ErrorOr<NonnullRefPtr<Custody>> Custody::try_create(Custody* parent, StringView
 
         auto name_kstring = TRY(KString::try_create(name));
         auto custody = TRY(adopt_nonnull_ref_or_enomem(new (nothrow) Custody(parent, move(name_kstring), inode, mount_flags)));
-        all_custodies.prepend(*custody);
+        bucket.prepend(*custody);
         return custody;
     });
 }
 
+Custody::List& Custody::AllCustodiesList::bucket_for(Custody const* parent, StringView name)
+{
+    auto hash = string_hash(name.characters_without_null_termination(), name.length(), ptr_hash(parent));
+    return m_buckets[hash % bucket_count];
+}
+
 Custody::Custody(Custody* parent, NonnullOwnPtr<KString> name, Inode& inode, int mount_flags)
     : m_parent(parent)
     , m_name(move(name))
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/Error.h>
 #include <AK/IntrusiveList.h>
 #include <AK/RefPtr.h>
@@ -43,7 +44,19 @@ private:
     mutable IntrusiveListNode<Custody> m_all_custodies_list_node;
 
 public:
-    using AllCustodiesList = IntrusiveList<&Custody::m_all_custodies_list_node>;
+    using List = IntrusiveList<&Custody::m_all_custodies_list_node>;
+
+    // Every step of every path resolution looks for an existing Custody with the same parent and name,
+    // so they are spread over hash buckets instead of living on one long list.
+    class AllCustodiesList {
+    public:
+        List& bucket_for(Custody const* parent, StringView name);
+        void remove(Custody& custody) { custody.m_all_custodies_list_node.remove(); }
+
+    private:
+        static constexpr size_t bucket_count = 1024;
+        Array<List, bucket_count> m_buckets;
+    };
     static SpinlockProtected<Custody::AllCustodiesList>& all_instances();
 };
 
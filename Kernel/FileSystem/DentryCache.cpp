@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Singleton.h>
+#include <AK/StringHash.h>
+#include <Kernel/FileSystem/DentryCache.h>
+#include <Kernel/FileSystem/FileSystem.h>
+#include <Kernel/FileSystem/Inode.h>
+
+namespace Kernel {
+
+static Singleton<DentryCache> s_the;
+
+DentryCache& DentryCache::the()
+{
+    return *s_the;
+}
+
+u32 DentryCache::hash_for(InodeIdentifier directory, StringView name)
+{
+    return string_hash(name.characters_without_null_termination(), name.length(), Traits<InodeIdentifier>::hash(directory));
+}
+
+bool DentryCache::Entry::matches(InodeIdentifier other_directory, u32 other_hash, StringView other_name) const
+{
+    return in_use
+        && hash == other_hash
+        && directory == other_directory
+        && StringView { name, name_length } == other_name;
+}
+
+ErrorOr<NonnullLockRefPtr<Inode>> DentryCache::lookup(Inode& directory, StringView name)
+{
+    if (name.length() > max_name_length)
+        return directory.lookup(name);
+
+    auto identifier = directory.identifier();
+    auto hash = hash_for(identifier, name);
+    auto& bucket = bucket_for(hash);
+
+    u32 generation = 0;
+    {
+        SpinlockLocker locker(bucket.lock);
+        for (auto& entry : bucket.entries) {
+            if (!entry.matches(identifier, hash, name))
+                continue;
+            entry.last_used = ++bucket.clock;
+            if (!entry.inode) {
+                m_negative_hits++;
+                return ENOENT;
+            }
+            m_hits++;
+            return NonnullLockRefPtr<Inode> { *entry.inode };
+        }
+        generation = bucket.generation;
+    }
+
+    m_misses++;
+    auto inode_or_error = directory.lookup(name);
+    if (inode_or_error.is_error() && inode_or_error.error().code() != ENOENT)
+        return inode_or_error;
+
+    // Inodes are only released once the bucket is unlocked, as dropping the last
+    // reference may have to write the inode back to disk.
+    LockRefPtr<Inode> evicted_inode;
+    {
+        SpinlockLocker locker(bucket.lock);
+        if (bucket.generation != generation)
+            return inode_or_error;
+
+        Entry* victim = nullptr;
+        for (auto& entry : bucket.entries) {
+            if (entry.matches(identifier, hash, name)) {
+                victim = &entry;
+                break;
+            }
+            if (!victim || (victim->in_use && (!entry.in_use || entry.last_used < victim->last_used)))
+                victim = &entry;
+        }
+
+        evicted_inode = move(victim->inode);
+        victim->directory = identifier;
+        victim->hash = hash;
+        victim->last_used = ++bucket.clock;
+        victim->name_length = name.length();
+        __builtin_memcpy(victim->name, name.characters_without_null_termination(), name.length());
+        if (!inode_or_error.is_error())
+            victim->inode = inode_or_error.value();
+        victim->in_use = true;
+    }
+    return inode_or_error;
+}
+
+void DentryCache::invalidate(Inode const& directory, StringView name)
+{
+    auto identifier = directory.identifier();
+    auto hash = hash_for(identifier, name);
+    auto& bucket = bucket_for(hash);
+
+    LockRefPtr<Inode> evicted_inode;
+    SpinlockLocker locker(bucket.lock);
+    ++bucket.generation;
+    for (auto& entry : bucket.entries) {
+        if (!entry.matches(identifier, hash, name))
+            continue;
+        evicted_inode = move(entry.inode);
+        entry.in_use = false;
+        m_invalidations++;
+        break;
+    }
+    locker.unlock();
+}
+
+void DentryCache::invalidate_file_system(FileSystemID fsid)
+{
+    for (auto& bucket : m_buckets) {
+        Array<LockRefPtr<Inode>, entries_per_bucket> evicted_inodes;
+        SpinlockLocker locker(bucket.lock);
+        ++bucket.generation;
+        for (size_t i = 0; i < entries_per_bucket; ++i) {
+            auto& entry = bucket.entries[i];
+            if (!entry.in_use || entry.directory.fsid() != fsid)
+                continue;
+            evicted_inodes[i] = move(entry.inode);
+            entry.in_use = false;
+            m_invalidations++;
+        }
+        locker.unlock();
+    }
+}
+
+DentryCache::Statistics DentryCache::statistics() const
+{
+    Statistics statistics;
+    statistics.hits = m_hits.load();
+    statistics.negative_hits = m_negative_hits.load();
+    statistics.misses = m_misses.load();
+    statistics.invalidations = m_invalidations.load();
+    statistics.capacity = bucket_count * entries_per_bucket;
+    for (auto const& bucket : m_buckets) {
+        SpinlockLocker locker(bucket.lock);
+        for (auto const& entry : bucket.entries) {
+            if (!entry.in_use)
+                continue;
+            ++statistics.entries;
+            if (!entry.inode)
+                ++statistics.negative_entries;
+        }
+    }
+    return statistics;
+}
+
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <AK/Error.h>
+#include <AK/StringView.h>
+#include <Kernel/FileSystem/InodeIdentifier.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Library/LockRefPtr.h>
+#include <Kernel/Library/NonnullLockRefPtr.h>
+#include <Kernel/Locking/Spinlock.h>
+
+namespace Kernel {
+
+// Global cache of directory lookups, keyed on (directory inode, name).
+// Names that don't exist are remembered as well, so searching $PATH or the library
+// directories doesn't have to ask the file system about the same missing names again.
+//
+// Only file systems that report every change to a directory through Inode::did_add_child()
+// and Inode::did_remove_child() take part, see FileSystem::supports_dentry_cache().
+// Entries refer to the inode found in the directory itself, before mounts are taken
+// into account, so mounting and unmounting never makes them stale.
+class DentryCache {
+public:
+    static DentryCache& the();
+
+    // Names longer than this always go to the file system.
+    static constexpr size_t max_name_length = 39;
+
+    ErrorOr<NonnullLockRefPtr<Inode>> lookup(Inode& directory, StringView name);
+
+    void invalidate(Inode const& directory, StringView name);
+    void invalidate_file_system(FileSystemID);
+
+    struct Statistics {
+        u64 hits { 0 };
+        u64 negative_hits { 0 };
+        u64 misses { 0 };
+        u64 invalidations { 0 };
+        size_t entries { 0 };
+        size_t negative_entries { 0 };
+        size_t capacity { 0 };
+    };
+    Statistics statistics() const;
+
+private:
+    static constexpr size_t bucket_count = 512;
+    static constexpr size_t entries_per_bucket = 4;
+
+    struct Entry {
+        InodeIdentifier directory;
+        u32 hash { 0 };
+        u32 last_used { 0 };
+        u8 name_length { 0 };
+        bool in_use { false };
+        char name[max_name_length];
+        // Null if the directory has no entry with this name.
+        LockRefPtr<Inode> inode;
+
+        bool matches(InodeIdentifier directory, u32 hash, StringView name) const;
+    };
+
+    struct Bucket {
+        mutable Spinlock lock { LockRank::None };
+        // Bumped by every invalidation, so a lookup that raced with a change to the
+        // directory doesn't insert what it found before the change.
+        u32 generation { 0 };
+        u32 clock { 0 };
+        Array<Entry, entries_per_bucket> entries;
+    };
+
+    static u32 hash_for(InodeIdentifier directory, StringView name);
+    Bucket& bucket_for(u32 hash) { return m_buckets[hash % bucket_count]; }
+
+    Array<Bucket, bucket_count> m_buckets;
+
+    Atomic<u64> m_hits { 0 };
+    Atomic<u64> m_negative_hits { 0 };
+    Atomic<u64> m_misses { 0 };
+    Atomic<u64> m_invalidations { 0 };
+};
+
+}
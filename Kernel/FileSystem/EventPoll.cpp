@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/EventPoll.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/KString.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+ErrorOr<NonnullLockRefPtr<EventPollEntry>> EventPollEntry::try_create(EventPoll& event_poll, OpenFileDescription& description, int fd, u32 events, u64 data)
+{
+    return adopt_nonnull_lock_ref_or_enomem(new (nothrow) EventPollEntry(event_poll, description, fd, events, data));
+}
+
+EventPollEntry::EventPollEntry(EventPoll& event_poll, OpenFileDescription& description, int fd, u32 events, u64 data)
+    : m_event_poll(event_poll)
+    , m_file(description.file())
+    , m_description(&description)
+    , m_fd(fd)
+    , m_events(events)
+    , m_data(data)
+{
+}
+
+ErrorOr<void> FileBlockerSet::add_event_poll_entry(EventPollEntry& entry)
+{
+    SpinlockLocker lock(m_lock);
+    return m_event_poll_entries.try_append(&entry);
+}
+
+void FileBlockerSet::remove_event_poll_entry(EventPollEntry& entry)
+{
+    SpinlockLocker lock(m_lock);
+    m_event_poll_entries.remove_first_matching([&](auto* other) { return other == &entry; });
+}
+
+void FileBlockerSet::detach_event_poll_entries_for(OpenFileDescription const& description)
+{
+    SpinlockLocker lock(m_lock);
+    for (size_t i = 0; i < m_event_poll_entries.size();) {
+        auto* entry = m_event_poll_entries[i];
+        if (entry->m_description != &description) {
+            ++i;
+            continue;
+        }
+        entry->m_description = nullptr;
+        m_event_poll_entries.remove(i);
+        // NOTE: This may drop the last reference to the entry.
+        entry->event_poll().did_detach_entry({}, *entry);
+    }
+}
+
+u32 FileBlockerSet::event_poll_entry_revents(EventPollEntry const& entry) const
+{
+    SpinlockLocker lock(m_lock);
+    return event_poll_entry_revents_locked(entry);
+}
+
+u32 FileBlockerSet::event_poll_entry_revents_locked(EventPollEntry const& entry) const
+{
+    VERIFY(m_lock.is_locked());
+    if (!entry.m_description)
+        return 0;
+
+    auto events = entry.m_events.load();
+    // Like poll(), hangups and errors are always reported, whether they were asked for or not.
+    BlockFlags block_flags = BlockFlags::WriteError | BlockFlags::WriteHangUp;
+    if (events & EPOLLIN)
+        block_flags |= BlockFlags::Read;
+    if (events & EPOLLOUT)
+        block_flags |= BlockFlags::Write;
+
+    auto unblock_flags = entry.m_description->should_unblock(block_flags);
+    u32 revents = 0;
+    if (has_flag(unblock_flags, BlockFlags::Read))
+        revents |= EPOLLIN;
+    if (has_flag(unblock_flags, BlockFlags::Write))
+        revents |= EPOLLOUT;
+    if (has_flag(unblock_flags, BlockFlags::WriteHangUp))
+        revents |= EPOLLHUP;
+    if (has_flag(unblock_flags, BlockFlags::WriteError))
+        revents |= EPOLLERR;
+    return revents;
+}
+
+void FileBlockerSet::notify_event_poll_entries_locked()
+{
+    VERIFY(m_lock.is_locked());
+    for (auto* entry : m_event_poll_entries) {
+        if (entry->m_disabled)
+            continue;
+        if (event_poll_entry_revents_locked(*entry) != 0)
+            entry->event_poll().did_become_ready({}, *entry);
+    }
+}
+
+ErrorOr<NonnullLockRefPtr<EventPoll>> EventPoll::try_create()
+{
+    return adopt_nonnull_lock_ref_or_enomem(new (nothrow) EventPoll);
+}
+
+EventPoll::~EventPoll()
+{
+    for (;;) {
+        LockRefPtr<EventPollEntry> entry;
+        {
+            SpinlockLocker lock(m_lock);
+            if (m_entries.is_empty())
+                break;
+            auto it = m_entries.begin();
+            entry = it->value;
+            m_entries.remove(it);
+            entry->m_registered = false;
+            if (entry->m_ready_list_node.is_in_list())
+                m_ready_list.remove(*entry);
+        }
+        entry->file().blocker_set().remove_event_poll_entry(*entry);
+    }
+}
+
+bool EventPoll::can_read(OpenFileDescription const&, u64) const
+{
+    SpinlockLocker lock(m_lock);
+    return !m_ready_list.is_empty();
+}
+
+ErrorOr<NonnullOwnPtr<KString>> EventPoll::pseudo_path(OpenFileDescription const&) const
+{
+    SpinlockLocker lock(m_lock);
+    return KString::formatted("EventPoll:({})", m_entries.size());
+}
+
+ErrorOr<void> EventPoll::add(OpenFileDescription& description, int fd, epoll_event const& event)
+{
+    // Nesting event polls would allow notification loops.
+    if (description.is_event_poll())
+        return EINVAL;
+
+    MutexLocker locker(m_interest_lock);
+    auto entry = TRY(EventPollEntry::try_create(*this, description, fd, event.events, event.data.u64));
+    {
+        SpinlockLocker lock(m_lock);
+        if (m_entries.contains(fd))
+            return EEXIST;
+        TRY(m_entries.try_set(fd, entry));
+        entry->m_registered = true;
+    }
+
+    auto result = entry->file().blocker_set().add_event_poll_entry(*entry);
+    if (result.is_error()) {
+        SpinlockLocker lock(m_lock);
+        entry->m_registered = false;
+        if (entry->m_ready_list_node.is_in_list())
+            m_ready_list.remove(*entry);
+        m_entries.remove(fd);
+        return result.release_error();
+    }
+
+    enqueue_if_ready(*entry);
+    return {};
+}
+
+ErrorOr<void> EventPoll::modify(int fd, epoll_event const& event)
+{
+    MutexLocker locker(m_interest_lock);
+    LockRefPtr<EventPollEntry> entry;
+    {
+        SpinlockLocker lock(m_lock);
+        auto it = m_entries.find(fd);
+        if (it == m_entries.end())
+            return ENOENT;
+        entry = it->value;
+        entry->m_data = event.data.u64;
+        entry->m_events = event.events;
+        entry->m_disabled = false;
+    }
+    enqueue_if_ready(*entry);
+    return {};
+}
+
+ErrorOr<void> EventPoll::remove(int fd)
+{
+    MutexLocker locker(m_interest_lock);
+    LockRefPtr<EventPollEntry> entry;
+    {
+        SpinlockLocker lock(m_lock);
+        auto it = m_entries.find(fd);
+        if (it == m_entries.end())
+            return ENOENT;
+        entry = it->value;
+        m_entries.remove(it);
+        entry->m_registered = false;
+        if (entry->m_ready_list_node.is_in_list())
+            m_ready_list.remove(*entry);
+    }
+    entry->file().blocker_set().remove_event_poll_entry(*entry);
+    return {};
+}
+
+ErrorOr<size_t> EventPoll::collect_ready_events(Vector<epoll_event>& events, size_t max_events)
+{
+    Vector<NonnullLockRefPtr<EventPollEntry>> candidates;
+    TRY(candidates.try_ensure_capacity(max_events));
+    TRY(events.try_ensure_capacity(events.size() + max_events));
+
+    {
+        SpinlockLocker lock(m_lock);
+        while (candidates.size() < max_events && !m_ready_list.is_empty())
+            candidates.unchecked_append(*m_ready_list.take_first());
+    }
+
+    size_t count = 0;
+    for (auto& entry : candidates) {
+        if (entry->m_disabled)
+            continue;
+
+        // The entry was queued at some point, but it may not be ready anymore.
+        auto revents = entry->file().blocker_set().event_poll_entry_revents(*entry);
+        if (revents == 0)
+            continue;
+
+        auto entry_events = entry->m_events.load();
+        epoll_event event {};
+        event.events = revents;
+        {
+            SpinlockLocker lock(m_lock);
+            if (!entry->m_registered)
+                continue;
+            event.data.u64 = entry->m_data;
+            if (entry_events & EPOLLONESHOT)
+                entry->m_disabled = true;
+            else if (!(entry_events & EPOLLET) && !entry->m_ready_list_node.is_in_list())
+                m_ready_list.append(*entry);
+        }
+        events.unchecked_append(event);
+        ++count;
+    }
+    return count;
+}
+
+void EventPoll::did_become_ready(Badge<FileBlockerSet>, EventPollEntry& entry)
+{
+    enqueue(entry);
+}
+
+void EventPoll::did_detach_entry(Badge<FileBlockerSet>, EventPollEntry& entry)
+{
+    SpinlockLocker lock(m_lock);
+    if (!entry.m_registered)
+        return;
+    entry.m_registered = false;
+    if (entry.m_ready_list_node.is_in_list())
+        m_ready_list.remove(entry);
+    m_entries.remove(entry.fd());
+}
+
+void EventPoll::enqueue_if_ready(EventPollEntry& entry)
+{
+    if (entry.file().blocker_set().event_poll_entry_revents(entry) != 0)
+        enqueue(entry);
+}
+
+void EventPoll::enqueue(EventPollEntry& entry)
+{
+    {
+        SpinlockLocker lock(m_lock);
+        if (!entry.m_registered || entry.m_ready_list_node.is_in_list())
+            return;
+        m_ready_list.append(entry);
+    }
+    evaluate_block_conditions();
+}
+
+}
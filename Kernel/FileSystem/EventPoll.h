@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/AtomicRefCounted.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Library/NonnullLockRefPtr.h>
+#include <Kernel/Locking/Mutex.h>
+#include <Kernel/Locking/Spinlock.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+// One file descriptor in the interest list of an EventPoll.
+// The entry is registered both with the EventPoll (keyed by fd) and with the
+// FileBlockerSet of the watched file, which notifies the EventPoll whenever
+// the file re-evaluates its block conditions.
+class EventPollEntry final : public AtomicRefCounted<EventPollEntry> {
+    friend class EventPoll;
+    friend class FileBlockerSet;
+
+public:
+    static ErrorOr<NonnullLockRefPtr<EventPollEntry>> try_create(EventPoll&, OpenFileDescription&, int fd, u32 events, u64 data);
+
+    EventPoll& event_poll() const { return m_event_poll; }
+    File& file() { return *m_file; }
+    int fd() const { return m_fd; }
+
+private:
+    EventPollEntry(EventPoll&, OpenFileDescription&, int fd, u32 events, u64 data);
+
+    EventPoll& m_event_poll;
+    NonnullLockRefPtr<File> m_file;
+
+    // Protected by the blocker set lock of m_file. Cleared when the description goes away.
+    OpenFileDescription* m_description { nullptr };
+
+    int const m_fd { -1 };
+    Atomic<u32> m_events { 0 };
+    Atomic<bool> m_disabled { false };
+
+    // The following are protected by the EventPoll lock.
+    u64 m_data { 0 };
+    bool m_registered { false };
+    IntrusiveListNode<EventPollEntry> m_ready_list_node;
+};
+
+class EventPoll final : public File {
+public:
+    static ErrorOr<NonnullLockRefPtr<EventPoll>> try_create();
+    virtual ~EventPoll() override;
+
+    virtual bool can_read(OpenFileDescription const&, u64) const override;
+    virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual bool can_write(OpenFileDescription const&, u64) const override { return false; }
+    virtual ErrorOr<size_t> write(OpenFileDescription&, u64, UserOrKernelBuffer const&, size_t) override { return EINVAL; }
+
+    virtual ErrorOr<NonnullOwnPtr<KString>> pseudo_path(OpenFileDescription const&) const override;
+    virtual StringView class_name() const override { return "EventPoll"sv; }
+    virtual bool is_event_poll() const override { return true; }
+
+    ErrorOr<void> add(OpenFileDescription&, int fd, epoll_event const&);
+    ErrorOr<void> modify(int fd, epoll_event const&);
+    ErrorOr<void> remove(int fd);
+
+    // Takes up to max_events entries off the ready list and re-checks their readiness.
+    // Level-triggered entries that are still ready go back to the end of the list.
+    ErrorOr<size_t> collect_ready_events(Vector<epoll_event>&, size_t max_events);
+
+    void did_become_ready(Badge<FileBlockerSet>, EventPollEntry&);
+    void did_detach_entry(Badge<FileBlockerSet>, EventPollEntry&);
+
+private:
+    EventPoll() = default;
+
+    void enqueue_if_ready(EventPollEntry&);
+    void enqueue(EventPollEntry&);
+
+    using ReadyList = IntrusiveList<&EventPollEntry::m_ready_list_node>;
+
+    // Serializes changes to the interest list, so that registration with the
+    // watched file and with m_entries appear atomic to each other.
+    Mutex m_interest_lock { "EventPoll"sv };
+
+    mutable Spinlock m_lock { LockRank::None };
+    HashMap<int, NonnullLockRefPtr<EventPollEntry>> m_entries;
+    ReadyList m_ready_list;
+};
+
+}
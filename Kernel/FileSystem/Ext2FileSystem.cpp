@@ -7,6 +7,7 @@
 
 #include <AK/HashMap.h>
 #include <AK/MemoryStream.h>
+#include <AK/QuickSort.h>
 #include <AK/StdLibExtras.h>
 #include <AK/StringView.h>
 #include <Kernel/API/POSIX/errno.h>
@@ -49,6 +50,176 @@ static u8 to_ext2_file_type(mode_t mode)
     return EXT2_FT_UNKNOWN;
 }
 
+// Directory hashing for the dir_index (htree) feature. This has to produce exactly the same
+// values as Linux (fs/ext4/hash.c), otherwise neither side can find entries the other one added.
+
+static void ext2_tea_transform(u32 buffer[4], u32 const input[4])
+{
+    u32 sum = 0;
+    u32 b0 = buffer[0];
+    u32 b1 = buffer[1];
+    for (int round = 0; round < 16; ++round) {
+        sum += 0x9E3779B9;
+        b0 += ((b1 << 4) + input[0]) ^ (b1 + sum) ^ ((b1 >> 5) + input[1]);
+        b1 += ((b0 << 4) + input[2]) ^ (b0 + sum) ^ ((b0 >> 5) + input[3]);
+    }
+    buffer[0] += b0;
+    buffer[1] += b1;
+}
+
+static void ext2_half_md4_transform(u32 buffer[4], u32 const input[8])
+{
+    constexpr u32 k2 = 013240474631;
+    constexpr u32 k3 = 015666365641;
+    auto f = [](u32 x, u32 y, u32 z) { return z ^ (x & (y ^ z)); };
+    auto g = [](u32 x, u32 y, u32 z) { return (x & y) + ((x ^ y) & z); };
+    auto h = [](u32 x, u32 y, u32 z) { return x ^ y ^ z; };
+    auto round = [](auto function, u32& a, u32 b, u32 c, u32 d, u32 x, int shift) {
+        a += function(b, c, d) + x;
+        a = (a << shift) | (a >> (32 - shift));
+    };
+
+    u32 a = buffer[0];
+    u32 b = buffer[1];
+    u32 c = buffer[2];
+    u32 d = buffer[3];
+
+    round(f, a, b, c, d, input[0], 3);
+    round(f, d, a, b, c, input[1], 7);
+    round(f, c, d, a, b, input[2], 11);
+    round(f, b, c, d, a, input[3], 19);
+    round(f, a, b, c, d, input[4], 3);
+    round(f, d, a, b, c, input[5], 7);
+    round(f, c, d, a, b, input[6], 11);
+    round(f, b, c, d, a, input[7], 19);
+
+    round(g, a, b, c, d, input[1] + k2, 3);
+    round(g, d, a, b, c, input[3] + k2, 5);
+    round(g, c, d, a, b, input[5] + k2, 9);
+    round(g, b, c, d, a, input[7] + k2, 13);
+    round(g, a, b, c, d, input[0] + k2, 3);
+    round(g, d, a, b, c, input[2] + k2, 5);
+    round(g, c, d, a, b, input[4] + k2, 9);
+    round(g, b, c, d, a, input[6] + k2, 13);
+
+    round(h, a, b, c, d, input[3] + k3, 3);
+    round(h, d, a, b, c, input[7] + k3, 9);
+    round(h, c, d, a, b, input[2] + k3, 11);
+    round(h, b, c, d, a, input[6] + k3, 15);
+    round(h, a, b, c, d, input[1] + k3, 3);
+    round(h, d, a, b, c, input[5] + k3, 9);
+    round(h, c, d, a, b, input[0] + k3, 11);
+    round(h, b, c, d, a, input[4] + k3, 15);
+
+    buffer[0] += a;
+    buffer[1] += b;
+    buffer[2] += c;
+    buffer[3] += d;
+}
+
+// Whether name bytes are treated as signed depends on the platform the file system was created on,
+// which is recorded in the super block.
+template<typename CharType>
+static u32 ext2_legacy_hash(StringView name)
+{
+    u32 hash0 = 0x12a3fe2d;
+    u32 hash1 = 0x37abe8f9;
+    for (auto character : name.bytes()) {
+        u32 hash = hash1 + (hash0 ^ (static_cast<int>(static_cast<CharType>(character)) * 7152373));
+        if (hash & 0x80000000)
+            hash -= 0x7fffffff;
+        hash1 = hash0;
+        hash0 = hash;
+    }
+    return hash0 << 1;
+}
+
+template<typename CharType>
+static void ext2_string_to_hash_buffer(ReadonlyBytes characters, u32* buffer, size_t count)
+{
+    u32 padding = static_cast<u32>(characters.size()) | (static_cast<u32>(characters.size()) << 8);
+    padding |= padding << 16;
+
+    u32 value = padding;
+    size_t length = min(characters.size(), count * 4);
+    for (size_t i = 0; i < length; ++i) {
+        value = static_cast<int>(static_cast<CharType>(characters[i])) + (value << 8);
+        if ((i % 4) == 3) {
+            *buffer++ = value;
+            value = padding;
+            --count;
+        }
+    }
+    if (count > 0) {
+        *buffer++ = value;
+        --count;
+    }
+    while (count-- > 0)
+        *buffer++ = padding;
+}
+
+template<typename CharType>
+static u32 ext2_half_md4_hash(ReadonlyBytes characters, u32 buffer[4])
+{
+    u32 input[8];
+    do {
+        ext2_string_to_hash_buffer<CharType>(characters, input, 8);
+        ext2_half_md4_transform(buffer, input);
+        characters = characters.slice(min(characters.size(), static_cast<size_t>(32)));
+    } while (!characters.is_empty());
+    return buffer[1];
+}
+
+template<typename CharType>
+static u32 ext2_tea_hash(ReadonlyBytes characters, u32 buffer[4])
+{
+    u32 input[4];
+    do {
+        ext2_string_to_hash_buffer<CharType>(characters, input, 4);
+        ext2_tea_transform(buffer, input);
+        characters = characters.slice(min(characters.size(), static_cast<size_t>(16)));
+    } while (!characters.is_empty());
+    return buffer[0];
+}
+
+static u32 ext2_directory_hash(StringView name, u8 hash_version, u32 const seed[4])
+{
+    u32 buffer[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+    if (seed[0] || seed[1] || seed[2] || seed[3])
+        __builtin_memcpy(buffer, seed, sizeof(buffer));
+
+    u32 hash = 0;
+    switch (hash_version) {
+    case EXT2_HASH_LEGACY:
+        hash = ext2_legacy_hash<i8>(name);
+        break;
+    case EXT2_HASH_LEGACY_UNSIGNED:
+        hash = ext2_legacy_hash<u8>(name);
+        break;
+    case EXT2_HASH_HALF_MD4:
+        hash = ext2_half_md4_hash<i8>(name.bytes(), buffer);
+        break;
+    case EXT2_HASH_HALF_MD4_UNSIGNED:
+        hash = ext2_half_md4_hash<u8>(name.bytes(), buffer);
+        break;
+    case EXT2_HASH_TEA:
+        hash = ext2_tea_hash<i8>(name.bytes(), buffer);
+        break;
+    case EXT2_HASH_TEA_UNSIGNED:
+        hash = ext2_tea_hash<u8>(name.bytes(), buffer);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    // The lowest bit marks hash collisions that continue into the next leaf block,
+    // and 0xfffffffe is reserved as the end-of-directory marker for readdir().
+    hash &= ~1u;
+    if (hash == 0xfffffffe)
+        hash = 0xfffffffc;
+    return hash;
+}
+
 ErrorOr<NonnullLockRefPtr<FileSystem>> Ext2FS::try_create(OpenFileDescription& file_description)
 {
     return TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) Ext2FS(file_description)));
@@ -651,55 +822,63 @@ void Ext2FS::flush_block_group_descriptor_table()
         dbgln("Ext2FS[{}]::flush_block_group_descriptor_table(): Failed to write blocks: {}", fsid(), result.error());
 }
 
-void Ext2FS::flush_writes()
+void Ext2FS::flush_metadata_to_block_cache()
 {
-    {
-        MutexLocker locker(m_lock);
-        if (m_super_block_dirty) {
-            auto result = flush_super_block();
-            if (result.is_error()) {
-                dbgln("Ext2FS[{}]::flush_writes(): Failed to write superblock: {}", fsid(), result.error());
-                // FIXME: We should handle this error.
-                VERIFY_NOT_REACHED();
-            }
-            m_super_block_dirty = false;
-        }
-        if (m_block_group_descriptors_dirty) {
-            flush_block_group_descriptor_table();
-            m_block_group_descriptors_dirty = false;
+    MutexLocker locker(m_lock);
+    if (m_super_block_dirty) {
+        auto result = flush_super_block();
+        if (result.is_error()) {
+            dbgln("Ext2FS[{}]::flush_metadata_to_block_cache(): Failed to write superblock: {}", fsid(), result.error());
+            // FIXME: We should handle this error.
+            VERIFY_NOT_REACHED();
         }
-        for (auto& cached_bitmap : m_cached_bitmaps) {
-            if (cached_bitmap->dirty) {
-                auto buffer = UserOrKernelBuffer::for_kernel_buffer(cached_bitmap->buffer->data());
-                if (auto result = write_block(cached_bitmap->bitmap_block_index, buffer, block_size()); result.is_error()) {
-                    dbgln("Ext2FS[{}]::flush_writes(): Failed to write blocks: {}", fsid(), result.error());
-                }
-                cached_bitmap->dirty = false;
-                dbgln_if(EXT2_DEBUG, "Ext2FS[{}]::flush_writes(): Flushed bitmap block {}", fsid(), cached_bitmap->bitmap_block_index);
+        m_super_block_dirty = false;
+    }
+    if (m_block_group_descriptors_dirty) {
+        flush_block_group_descriptor_table();
+        m_block_group_descriptors_dirty = false;
+    }
+    for (auto& cached_bitmap : m_cached_bitmaps) {
+        if (cached_bitmap->dirty) {
+            auto buffer = UserOrKernelBuffer::for_kernel_buffer(cached_bitmap->buffer->data());
+            if (auto result = write_block(cached_bitmap->bitmap_block_index, buffer, block_size()); result.is_error()) {
+                dbgln("Ext2FS[{}]::flush_metadata_to_block_cache(): Failed to write blocks: {}", fsid(), result.error());
             }
+            cached_bitmap->dirty = false;
+            dbgln_if(EXT2_DEBUG, "Ext2FS[{}]::flush_metadata_to_block_cache(): Flushed bitmap block {}", fsid(), cached_bitmap->bitmap_block_index);
         }
+    }
 
-        // Uncache Inodes that are only kept alive by the index-to-inode lookup cache.
-        // We don't uncache Inodes that are being watched by at least one InodeWatcher.
+    // Uncache Inodes that are only kept alive by the index-to-inode lookup cache.
+    // We don't uncache Inodes that are being watched by at least one InodeWatcher.
 
-        // FIXME: It would be better to keep a capped number of Inodes around.
-        //        The problem is that they are quite heavy objects, and use a lot of heap memory
-        //        for their (child name lookup) and (block list) caches.
+    // FIXME: It would be better to keep a capped number of Inodes around.
+    //        The problem is that they are quite heavy objects, and use a lot of heap memory
+    //        for their (child name lookup) and (block list) caches.
 
-        m_inode_cache.remove_all_matching([](InodeIndex, LockRefPtr<Ext2FSInode> const& cached_inode) {
-            // NOTE: If we're asked to look up an inode by number (via get_inode) and it turns out
-            //       to not exist, we remember the fact that it doesn't exist by caching a nullptr.
-            //       This seems like a reasonable time to uncache ideas about unknown inodes, so do that.
-            if (cached_inode == nullptr)
-                return true;
+    m_inode_cache.remove_all_matching([](InodeIndex, LockRefPtr<Ext2FSInode> const& cached_inode) {
+        // NOTE: If we're asked to look up an inode by number (via get_inode) and it turns out
+        //       to not exist, we remember the fact that it doesn't exist by caching a nullptr.
+        //       This seems like a reasonable time to uncache ideas about unknown inodes, so do that.
+        if (cached_inode == nullptr)
+            return true;
 
-            return cached_inode->ref_count() == 1 && !cached_inode->has_watchers();
-        });
-    }
+        return cached_inode->ref_count() == 1 && !cached_inode->has_watchers();
+    });
+}
 
+void Ext2FS::flush_writes()
+{
+    flush_metadata_to_block_cache();
     BlockBasedFileSystem::flush_writes();
 }
 
+void Ext2FS::writeback_dirty_blocks()
+{
+    flush_metadata_to_block_cache();
+    BlockBasedFileSystem::writeback_dirty_blocks();
+}
+
 Ext2FSInode::Ext2FSInode(Ext2FS& fs, InodeIndex index)
     : Inode(fs, index)
 {
@@ -707,6 +886,7 @@ Ext2FSInode::Ext2FSInode(Ext2FS& fs, InodeIndex index)
 
 Ext2FSInode::~Ext2FSInode()
 {
+    (void)discard_preallocated_blocks();
     if (m_raw_inode.i_links_count == 0) {
         // Alas, we have nowhere to propagate any errors that occur here.
         (void)fs().free_inode(*this);
@@ -862,6 +1042,122 @@ ErrorOr<size_t> Ext2FSInode::read_bytes(off_t offset, size_t count, UserOrKernel
     return nread;
 }
 
+void Ext2FSInode::read_ahead(u64 offset, size_t count) const
+{
+    MutexLocker inode_locker(m_inode_lock);
+    if (!Kernel::is_regular_file(m_raw_inode.i_mode) || offset >= size())
+        return;
+
+    if (m_block_list.is_empty()) {
+        auto block_list_or_error = compute_block_list();
+        if (block_list_or_error.is_error())
+            return;
+        m_block_list = block_list_or_error.release_value();
+    }
+    if (m_block_list.is_empty())
+        return;
+
+    u64 const block_size = fs().block_size();
+    auto end = min(offset + count, size());
+    auto first_block_logical_index = offset / block_size;
+    auto last_block_logical_index = min((end - 1) / block_size, m_block_list.size() - 1);
+
+    // Read each physically contiguous run of blocks with a single request.
+    // NOTE: Read-ahead is only a hint, so errors are left for the actual read to report.
+    BlockBasedFileSystem::BlockIndex run_start { 0 };
+    size_t run_length = 0;
+    auto read_run = [&] {
+        if (run_length == 0)
+            return;
+        [[maybe_unused]] auto result = fs().read_ahead_blocks(run_start, run_length);
+        dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::read_ahead(): Read {} blocks at {}: {}", identifier(), run_length, run_start, result.is_error() ? "failed"sv : "ok"sv);
+        run_length = 0;
+    };
+    for (auto logical_index = first_block_logical_index; logical_index <= last_block_logical_index; ++logical_index) {
+        auto block_index = m_block_list[logical_index];
+        if (block_index.value() == 0) {
+            // Holes don't need to be read.
+            read_run();
+            continue;
+        }
+        if (run_length != 0 && block_index.value() == run_start.value() + run_length) {
+            ++run_length;
+            continue;
+        }
+        read_run();
+        run_start = block_index;
+        run_length = 1;
+    }
+    read_run();
+}
+
+// Regular files take a few more blocks than they need whenever they grow, so that files written
+// in small pieces still end up in one piece on disk. The window grows with the file.
+static constexpr size_t minimum_preallocation_window = 8;
+static constexpr size_t maximum_preallocation_window = 1024;
+
+ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> Ext2FSInode::allocate_data_blocks(size_t count)
+{
+    VERIFY(m_inode_lock.is_locked());
+
+    Vector<BlockBasedFileSystem::BlockIndex> blocks;
+    TRY(blocks.try_ensure_capacity(count));
+
+    auto preallocated_blocks_to_use = min(count, m_preallocated_block_count);
+    for (size_t i = 0; i < preallocated_blocks_to_use; ++i)
+        blocks.unchecked_append(m_first_preallocated_block.value() + i);
+    m_first_preallocated_block = m_first_preallocated_block.value() + preallocated_blocks_to_use;
+    m_preallocated_block_count -= preallocated_blocks_to_use;
+    if (blocks.size() == count)
+        return blocks;
+
+    BlockBasedFileSystem::BlockIndex goal = 0;
+    if (!blocks.is_empty())
+        goal = blocks.last().value() + 1;
+    else if (!m_block_list.is_empty() && m_block_list.last().value())
+        goal = m_block_list.last().value() + 1;
+
+    auto blocks_needed = count - blocks.size();
+    size_t window = 0;
+    if (Kernel::is_regular_file(m_raw_inode.i_mode)) {
+        auto free_blocks = fs().free_block_count();
+        window = clamp(m_block_list.size() + count, minimum_preallocation_window, maximum_preallocation_window);
+        window = free_blocks > blocks_needed ? min(window, free_blocks - blocks_needed) : 0;
+    }
+
+    auto new_blocks = TRY(fs().allocate_blocks(fs().group_index_from_inode(index()), blocks_needed + window, goal));
+    TRY(blocks.try_append(new_blocks.data(), blocks_needed));
+    TRY(keep_as_preallocated_blocks(new_blocks.span().slice(blocks_needed)));
+    return blocks;
+}
+
+ErrorOr<void> Ext2FSInode::keep_as_preallocated_blocks(Span<BlockBasedFileSystem::BlockIndex const> blocks)
+{
+    // Only blocks that directly follow the file (or the current preallocation) are useful, the rest go back.
+    size_t blocks_to_keep = 0;
+    if (m_preallocated_block_count == 0 && !blocks.is_empty()) {
+        m_first_preallocated_block = blocks[0];
+        blocks_to_keep = 1;
+    }
+    while (blocks_to_keep < blocks.size() && blocks[blocks_to_keep].value() == m_first_preallocated_block.value() + m_preallocated_block_count + blocks_to_keep)
+        ++blocks_to_keep;
+    m_preallocated_block_count += blocks_to_keep;
+
+    for (auto block_index : blocks.slice(blocks_to_keep))
+        TRY(fs().set_block_allocation_state(block_index, false));
+    return {};
+}
+
+ErrorOr<void> Ext2FSInode::discard_preallocated_blocks()
+{
+    while (m_preallocated_block_count) {
+        --m_preallocated_block_count;
+        TRY(fs().set_block_allocation_state(m_first_preallocated_block.value() + m_preallocated_block_count, false));
+    }
+    m_first_preallocated_block = 0;
+    return {};
+}
+
 ErrorOr<void> Ext2FSInode::resize(u64 new_size)
 {
     auto old_size = size();
@@ -882,7 +1178,7 @@ ErrorOr<void> Ext2FSInode::resize(u64 new_size)
 
     if (blocks_needed_after > blocks_needed_before) {
         auto additional_blocks_needed = blocks_needed_after - blocks_needed_before;
-        if (additional_blocks_needed > fs().super_block().s_free_blocks_count)
+        if (additional_blocks_needed > fs().super_block().s_free_blocks_count + m_preallocated_block_count)
             return ENOSPC;
     }
 
@@ -890,9 +1186,10 @@ ErrorOr<void> Ext2FSInode::resize(u64 new_size)
         m_block_list = TRY(compute_block_list());
 
     if (blocks_needed_after > blocks_needed_before) {
-        auto blocks = TRY(fs().allocate_blocks(fs().group_index_from_inode(index()), blocks_needed_after - blocks_needed_before));
+        auto blocks = TRY(allocate_data_blocks(blocks_needed_after - blocks_needed_before));
         TRY(m_block_list.try_extend(move(blocks)));
     } else if (blocks_needed_after < blocks_needed_before) {
+        TRY(discard_preallocated_blocks());
         if constexpr (EXT2_VERY_DEBUG) {
             dbgln("Ext2FSInode[{}]::resize(): Shrinking inode, old block list is {} entries:", identifier(), m_block_list.size());
             for (auto block_index : m_block_list) {
@@ -1029,6 +1326,14 @@ Ext2FS::FeaturesReadOnly Ext2FS::get_features_readonly() const
     return Ext2FS::FeaturesReadOnly::None;
 }
 
+u32 Ext2FS::directory_hash(StringView name, u8 hash_version) const
+{
+    VERIFY(hash_version <= EXT2_HASH_TEA);
+    if (m_super_block.s_flags & EXT2_FLAGS_UNSIGNED_HASH)
+        hash_version += EXT2_HASH_LEGACY_UNSIGNED;
+    return ext2_directory_hash(name, hash_version, m_super_block.s_hash_seed);
+}
+
 ErrorOr<void> Ext2FSInode::traverse_as_directory(Function<ErrorOr<void>(FileSystem::DirectoryEntryView const&)> callback) const
 {
     VERIFY(is_directory());
@@ -1107,6 +1412,8 @@ ErrorOr<void> Ext2FSInode::write_directory(Vector<Ext2FSDirectoryEntry>& entries
     VERIFY(stream.is_end());
 
     TRY(resize(stream.size()));
+    // The directory is linear now, so any index it had is gone.
+    m_raw_inode.i_flags &= ~EXT2_INDEX_FL;
 
     auto buffer = UserOrKernelBuffer::for_kernel_buffer(stream.data());
     auto nwritten = TRY(write_bytes(0, stream.size(), buffer, nullptr));
@@ -1116,6 +1423,546 @@ ErrorOr<void> Ext2FSInode::write_directory(Vector<Ext2FSDirectoryEntry>& entries
     return {};
 }
 
+// Hashed directories (dir_index) keep "." and ".." in the first block, followed by the root of a
+// B-tree of hash ranges whose leaves are ordinary directory blocks. Interior nodes are disguised as
+// a single unused directory entry, so code that walks the directory linearly still sees every entry.
+static constexpr size_t directory_index_root_info_offset = 24;
+static constexpr size_t directory_index_root_entries_offset = directory_index_root_info_offset + sizeof(ext2_dx_root_info);
+static constexpr size_t directory_index_node_entries_offset = 8;
+static constexpr u32 directory_index_block_mask = 0x0fffffff;
+// Without the largedir feature, the root may point at one level of interior nodes at most.
+static constexpr u8 directory_index_max_indirect_levels = 1;
+
+struct Ext2FSDirectoryIndexNode {
+    u32 block { 0 };
+    ByteBuffer data;
+    size_t entries_offset { 0 };
+    size_t position { 0 };
+
+    ext2_dx_countlimit& count_limit() { return *reinterpret_cast<ext2_dx_countlimit*>(data.data() + entries_offset); }
+    ext2_dx_entry* entries() { return reinterpret_cast<ext2_dx_entry*>(data.data() + entries_offset); }
+    u16 count() { return count_limit().count; }
+    u16 limit() { return count_limit().limit; }
+    // The first entry's hash is implicitly 0, as the count and limit are stored in its place.
+    u32 hash_at(size_t index) { return index == 0 ? 0 : entries()[index].hash; }
+    u32 block_at(size_t index) { return entries()[index].block & directory_index_block_mask; }
+
+    void insert(size_t index, u32 hash, u32 child_block)
+    {
+        VERIFY(index > 0 && index <= count() && count() < limit());
+        auto* entry = entries();
+        __builtin_memmove(entry + index + 1, entry + index, (count() - index) * sizeof(ext2_dx_entry));
+        entry[index].hash = hash;
+        entry[index].block = child_block;
+        ++count_limit().count;
+    }
+};
+
+struct Ext2FSDirectoryIndexPath {
+    u8 hash_version { 0 };
+    u32 hash { 0 };
+    // From the root down to the node pointing at the leaf.
+    Vector<Ext2FSDirectoryIndexNode, directory_index_max_indirect_levels + 1> nodes;
+
+    u32 leaf_block() { return nodes.last().block_at(nodes.last().position); }
+};
+
+struct Ext2FSHashedDirectoryEntry {
+    u32 hash { 0 };
+    u32 inode { 0 };
+    u8 file_type { 0 };
+    StringView name;
+};
+
+static u16 directory_index_root_limit(size_t block_size)
+{
+    return (block_size - directory_index_root_entries_offset) / sizeof(ext2_dx_entry);
+}
+
+static u16 directory_index_node_limit(size_t block_size)
+{
+    return (block_size - directory_index_node_entries_offset) / sizeof(ext2_dx_entry);
+}
+
+static bool is_valid_directory_block(ReadonlyBytes block)
+{
+    size_t offset = 0;
+    while (offset < block.size()) {
+        if (block.size() - offset < 8)
+            return false;
+        auto const& entry = *reinterpret_cast<ext2_dir_entry_2 const*>(block.data() + offset);
+        if (entry.rec_len < 8 || (entry.rec_len % EXT2_DIR_PAD) != 0 || entry.rec_len > block.size() - offset)
+            return false;
+        if (entry.inode != 0 && static_cast<size_t>(entry.name_len) + 8 > entry.rec_len)
+            return false;
+        offset += entry.rec_len;
+    }
+    return true;
+}
+
+template<typename Callback>
+static void for_each_directory_entry_in_block(Bytes block, Callback callback)
+{
+    ext2_dir_entry_2* previous = nullptr;
+    for (size_t offset = 0; offset < block.size();) {
+        auto* entry = reinterpret_cast<ext2_dir_entry_2*>(block.data() + offset);
+        offset += entry->rec_len;
+        if (callback(*entry, previous) == IterationDecision::Break)
+            return;
+        previous = entry;
+    }
+}
+
+static void write_directory_entry(Bytes block, size_t offset, u16 record_length, u32 inode, u8 file_type, StringView name)
+{
+    auto& entry = *reinterpret_cast<ext2_dir_entry_2*>(block.data() + offset);
+    entry.inode = inode;
+    entry.rec_len = record_length;
+    entry.name_len = name.length();
+    entry.file_type = file_type;
+    __builtin_memcpy(entry.name, name.characters_without_null_termination(), name.length());
+}
+
+static size_t directory_entries_length(Span<Ext2FSHashedDirectoryEntry const> entries)
+{
+    size_t length = 0;
+    for (auto const& entry : entries)
+        length += EXT2_DIR_REC_LEN(entry.name.length());
+    return length;
+}
+
+// Lays out entries in a block, with the last one taking up the remaining space.
+static void pack_directory_block(Bytes block, Span<Ext2FSHashedDirectoryEntry const> entries)
+{
+    block.fill(0);
+    if (entries.is_empty()) {
+        write_directory_entry(block, 0, block.size(), 0, 0, ""sv);
+        return;
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto const& entry = entries[i];
+        size_t record_length = i + 1 == entries.size() ? block.size() - offset : EXT2_DIR_REC_LEN(entry.name.length());
+        write_directory_entry(block, offset, record_length, entry.inode, entry.file_type, entry.name);
+        offset += record_length;
+    }
+    VERIFY(offset == block.size());
+}
+
+static bool try_add_directory_entry_to_block(Bytes block, u32 inode, u8 file_type, StringView name)
+{
+    size_t record_length = EXT2_DIR_REC_LEN(name.length());
+    size_t offset = 0;
+    while (offset < block.size()) {
+        auto& entry = *reinterpret_cast<ext2_dir_entry_2*>(block.data() + offset);
+        size_t used_length = entry.inode ? EXT2_DIR_REC_LEN(entry.name_len) : 0;
+        if (entry.rec_len - used_length >= record_length) {
+            if (used_length == 0) {
+                write_directory_entry(block, offset, entry.rec_len, inode, file_type, name);
+            } else {
+                write_directory_entry(block, offset + used_length, entry.rec_len - used_length, inode, file_type, name);
+                entry.rec_len = used_length;
+            }
+            return true;
+        }
+        offset += entry.rec_len;
+    }
+    return false;
+}
+
+bool Ext2FSInode::has_directory_index() const
+{
+    return (m_raw_inode.i_flags & EXT2_INDEX_FL) && fs().has_directory_index_feature();
+}
+
+ErrorOr<void> Ext2FSInode::read_directory_block(u32 block, Bytes data) const
+{
+    auto block_size = fs().block_size();
+    VERIFY(data.size() == block_size);
+    if (static_cast<u64>(block + 1) * block_size > size()) {
+        dbgln("Ext2FSInode[{}]::read_directory_block(): Block {} is past the end of the directory", identifier(), block);
+        return EIO;
+    }
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(data.data());
+    auto nread = TRY(read_bytes(static_cast<u64>(block) * block_size, block_size, buffer, nullptr));
+    if (nread != block_size || !is_valid_directory_block(data)) {
+        dbgln("Ext2FSInode[{}]::read_directory_block(): Block {} is corrupt", identifier(), block);
+        return EIO;
+    }
+    return {};
+}
+
+ErrorOr<void> Ext2FSInode::write_directory_block(u32 block, ReadonlyBytes data)
+{
+    VERIFY(data.size() == fs().block_size());
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(const_cast<u8*>(data.data()));
+    auto nwritten = TRY(write_bytes(static_cast<u64>(block) * data.size(), data.size(), buffer, nullptr));
+    if (nwritten != data.size())
+        return EIO;
+    return {};
+}
+
+ErrorOr<Ext2FSDirectoryIndexNode> Ext2FSInode::read_directory_index_node(u32 block) const
+{
+    auto block_size = fs().block_size();
+    Ext2FSDirectoryIndexNode node;
+    node.block = block;
+    node.data = TRY(ByteBuffer::create_uninitialized(block_size));
+    TRY(read_directory_block(block, node.data));
+    node.entries_offset = block == 0 ? directory_index_root_entries_offset : directory_index_node_entries_offset;
+
+    auto expected_limit = block == 0 ? directory_index_root_limit(block_size) : directory_index_node_limit(block_size);
+    if (node.limit() != expected_limit || node.count() == 0 || node.count() > node.limit()) {
+        dbgln("Ext2FSInode[{}]::read_directory_index_node(): Bad count {} or limit {} in block {}", identifier(), node.count(), node.limit(), block);
+        return EIO;
+    }
+    return node;
+}
+
+static size_t find_directory_index_position(Ext2FSDirectoryIndexNode& node, u32 hash)
+{
+    // Find the last entry whose hash isn't greater than the one we're looking for.
+    size_t low = 1;
+    size_t high = node.count();
+    while (low < high) {
+        auto middle = low + (high - low) / 2;
+        if (node.hash_at(middle) > hash)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+    return low - 1;
+}
+
+ErrorOr<Ext2FSDirectoryIndexPath> Ext2FSInode::walk_directory_index(StringView name) const
+{
+    Ext2FSDirectoryIndexPath path;
+    auto root = TRY(read_directory_index_node(0));
+    auto const& info = *reinterpret_cast<ext2_dx_root_info const*>(root.data.data() + directory_index_root_info_offset);
+    if (info.reserved_zero != 0 || info.info_length != sizeof(ext2_dx_root_info) || info.indirect_levels > directory_index_max_indirect_levels || (info.unused_flags & EXT2_HASH_FLAG_INCOMPAT) || info.hash_version > EXT2_HASH_TEA) {
+        dbgln("Ext2FSInode[{}]::walk_directory_index(): Unsupported index root (hash version {}, {} levels)", identifier(), info.hash_version, info.indirect_levels);
+        return EIO;
+    }
+    path.hash_version = info.hash_version;
+    path.hash = fs().directory_hash(name, info.hash_version);
+    auto indirect_levels = info.indirect_levels;
+
+    root.position = find_directory_index_position(root, path.hash);
+    TRY(path.nodes.try_append(move(root)));
+    for (size_t level = 0; level < indirect_levels; ++level) {
+        auto node = TRY(read_directory_index_node(path.nodes.last().block_at(path.nodes.last().position)));
+        node.position = find_directory_index_position(node, path.hash);
+        TRY(path.nodes.try_append(move(node)));
+    }
+    return path;
+}
+
+ErrorOr<bool> Ext2FSInode::advance_directory_index_path(Ext2FSDirectoryIndexPath& path) const
+{
+    // Entries with the same hash can continue into the next leaf, which is marked
+    // by setting the lowest bit of the next index entry's hash.
+    size_t level = path.nodes.size();
+    while (level > 0 && path.nodes[level - 1].position + 1 >= path.nodes[level - 1].count())
+        --level;
+    if (level == 0)
+        return false;
+
+    auto& node = path.nodes[level - 1];
+    ++node.position;
+    if ((node.hash_at(node.position) & ~1u) != path.hash)
+        return false;
+
+    for (; level < path.nodes.size(); ++level) {
+        auto& parent = path.nodes[level - 1];
+        path.nodes[level] = TRY(read_directory_index_node(parent.block_at(parent.position)));
+        path.nodes[level].position = 0;
+    }
+    return true;
+}
+
+ErrorOr<InodeIndex> Ext2FSInode::find_child_in_directory_index(StringView name) const
+{
+    VERIFY(m_inode_lock.is_locked());
+    auto path = TRY(walk_directory_index(name));
+    auto leaf = TRY(ByteBuffer::create_uninitialized(fs().block_size()));
+    do {
+        TRY(read_directory_block(path.leaf_block(), leaf));
+        u32 child = 0;
+        for_each_directory_entry_in_block(leaf, [&](auto& entry, auto*) {
+            if (entry.inode != 0 && StringView { entry.name, entry.name_len } == name) {
+                child = entry.inode;
+                return IterationDecision::Break;
+            }
+            return IterationDecision::Continue;
+        });
+        if (child != 0)
+            return InodeIndex { child };
+    } while (TRY(advance_directory_index_path(path)));
+    return ENOENT;
+}
+
+ErrorOr<InodeIndex> Ext2FSInode::remove_child_from_directory_index(StringView name)
+{
+    VERIFY(m_inode_lock.is_locked());
+    auto path = TRY(walk_directory_index(name));
+    auto leaf = TRY(ByteBuffer::create_uninitialized(fs().block_size()));
+    do {
+        auto leaf_block = path.leaf_block();
+        TRY(read_directory_block(leaf_block, leaf));
+        u32 child = 0;
+        for_each_directory_entry_in_block(leaf, [&](auto& entry, auto* previous) {
+            if (entry.inode == 0 || StringView { entry.name, entry.name_len } != name)
+                return IterationDecision::Continue;
+            child = entry.inode;
+            if (previous)
+                previous->rec_len += entry.rec_len;
+            else
+                entry.inode = 0;
+            return IterationDecision::Break;
+        });
+        if (child != 0) {
+            TRY(write_directory_block(leaf_block, leaf));
+            return InodeIndex { child };
+        }
+    } while (TRY(advance_directory_index_path(path)));
+    return ENOENT;
+}
+
+ErrorOr<void> Ext2FSInode::make_room_in_directory_index(Ext2FSDirectoryIndexPath& path)
+{
+    auto block_size = fs().block_size();
+    if (path.nodes.last().count() < path.nodes.last().limit())
+        return {};
+
+    auto make_node = [&](u32 block) -> ErrorOr<Ext2FSDirectoryIndexNode> {
+        Ext2FSDirectoryIndexNode node;
+        node.block = block;
+        node.data = TRY(ByteBuffer::create_zeroed(block_size));
+        node.entries_offset = directory_index_node_entries_offset;
+        write_directory_entry(node.data, 0, block_size, 0, 0, ""sv);
+        return node;
+    };
+
+    if (path.nodes.size() == 1) {
+        // The root points straight at leaves and is full, so move its entries into a new node below it.
+        auto& root = path.nodes[0];
+        auto& info = *reinterpret_cast<ext2_dx_root_info*>(root.data.data() + directory_index_root_info_offset);
+        auto node = TRY(make_node(size() / block_size));
+        __builtin_memcpy(node.entries(), root.entries(), root.count() * sizeof(ext2_dx_entry));
+        node.count_limit() = { directory_index_node_limit(block_size), root.count() };
+        node.position = root.position;
+
+        root.count_limit().count = 1;
+        root.entries()[0].block = node.block;
+        root.position = 0;
+        info.indirect_levels = 1;
+
+        TRY(write_directory_block(node.block, node.data));
+        TRY(write_directory_block(root.block, root.data));
+        TRY(path.nodes.try_append(move(node)));
+        return {};
+    }
+
+    // The interior node is full, so move the upper half of its entries into a new sibling.
+    auto& root = path.nodes[0];
+    if (root.count() >= root.limit()) {
+        dbgln("Ext2FSInode[{}]::make_room_in_directory_index(): Directory index is full", identifier());
+        return ENOSPC;
+    }
+    auto& node = path.nodes[1];
+    u16 keep_count = node.count() / 2;
+    u16 move_count = node.count() - keep_count;
+    auto sibling_hash = node.hash_at(keep_count);
+
+    auto sibling = TRY(make_node(size() / block_size));
+    __builtin_memcpy(sibling.entries(), node.entries() + keep_count, move_count * sizeof(ext2_dx_entry));
+    sibling.count_limit() = { directory_index_node_limit(block_size), move_count };
+    node.count_limit().count = keep_count;
+    root.insert(root.position + 1, sibling_hash, sibling.block);
+
+    TRY(write_directory_block(sibling.block, sibling.data));
+    TRY(write_directory_block(node.block, node.data));
+    TRY(write_directory_block(root.block, root.data));
+
+    if (node.position >= keep_count) {
+        sibling.position = node.position - keep_count;
+        ++root.position;
+        path.nodes[1] = move(sibling);
+    }
+    return {};
+}
+
+ErrorOr<void> Ext2FSInode::add_child_to_directory_index(InodeIndex child, StringView name, u8 file_type)
+{
+    VERIFY(m_inode_lock.is_locked());
+    auto block_size = fs().block_size();
+    auto path = TRY(walk_directory_index(name));
+    auto leaf_block = path.leaf_block();
+    auto leaf = TRY(ByteBuffer::create_uninitialized(block_size));
+    TRY(read_directory_block(leaf_block, leaf));
+
+    if (try_add_directory_entry_to_block(leaf, static_cast<u32>(child.value()), file_type, name))
+        return write_directory_block(leaf_block, leaf);
+
+    // The leaf is full, so split it in two halves by hash.
+    auto old_leaf = TRY(ByteBuffer::copy(leaf));
+    Vector<Ext2FSHashedDirectoryEntry> entries;
+    size_t total_length = 0;
+    ErrorOr<void> result;
+    for_each_directory_entry_in_block(old_leaf, [&](auto& entry, auto*) {
+        if (entry.inode == 0)
+            return IterationDecision::Continue;
+        StringView entry_name { entry.name, entry.name_len };
+        if (auto append_result = entries.try_append({ fs().directory_hash(entry_name, path.hash_version), entry.inode, entry.file_type, entry_name }); append_result.is_error()) {
+            result = append_result.release_error();
+            return IterationDecision::Break;
+        }
+        total_length += EXT2_DIR_REC_LEN(entry.name_len);
+        return IterationDecision::Continue;
+    });
+    TRY(result);
+    if (entries.size() < 2)
+        return EIO;
+    quick_sort(entries, [](auto& a, auto& b) { return a.hash < b.hash; });
+
+    size_t split = entries.size();
+    size_t moved_length = 0;
+    while (split > 1) {
+        auto length = EXT2_DIR_REC_LEN(entries[split - 1].name.length());
+        if (moved_length + length / 2 > block_size / 2)
+            break;
+        moved_length += length;
+        --split;
+    }
+    if (split == 1 || split == entries.size())
+        split = entries.size() / 2;
+    auto split_hash = entries[split].hash;
+    bool continued = split_hash == entries[split - 1].hash;
+
+    TRY(make_room_in_directory_index(path));
+
+    Vector<Ext2FSHashedDirectoryEntry> lower;
+    Vector<Ext2FSHashedDirectoryEntry> upper;
+    TRY(lower.try_append(entries.data(), split));
+    TRY(upper.try_append(entries.data() + split, entries.size() - split));
+    Ext2FSHashedDirectoryEntry new_entry { path.hash, static_cast<u32>(child.value()), file_type, name };
+    TRY((path.hash >= split_hash ? upper : lower).try_append(new_entry));
+
+    if (directory_entries_length(lower) > block_size || directory_entries_length(upper) > block_size)
+        return EIO;
+
+    auto new_leaf_block = static_cast<u32>(size() / block_size);
+    auto new_leaf = TRY(ByteBuffer::create_zeroed(block_size));
+    pack_directory_block(new_leaf, upper);
+    pack_directory_block(leaf, lower);
+    TRY(write_directory_block(new_leaf_block, new_leaf));
+    TRY(write_directory_block(leaf_block, leaf));
+
+    auto& node = path.nodes.last();
+    node.insert(node.position + 1, split_hash | (continued ? 1 : 0), new_leaf_block);
+    return write_directory_block(node.block, node.data);
+}
+
+ErrorOr<void> Ext2FSInode::write_indexed_directory(Vector<Ext2FSDirectoryEntry>& directory_entries)
+{
+    MutexLocker locker(m_inode_lock);
+    auto block_size = fs().block_size();
+
+    u8 hash_version = fs().super_block().s_def_hash_version;
+    if (hash_version > EXT2_HASH_TEA)
+        hash_version = EXT2_HASH_HALF_MD4;
+
+    Optional<InodeIndex> self;
+    Optional<InodeIndex> parent;
+    Vector<Ext2FSHashedDirectoryEntry> entries;
+    for (auto& entry : directory_entries) {
+        auto name = entry.name->view();
+        if (name == "."sv)
+            self = entry.inode_index;
+        else if (name == ".."sv)
+            parent = entry.inode_index;
+        else
+            TRY(entries.try_append({ fs().directory_hash(name, hash_version), static_cast<u32>(entry.inode_index.value()), entry.file_type, name }));
+    }
+    if (!self.has_value() || !parent.has_value() || entries.is_empty())
+        return write_directory(directory_entries);
+    quick_sort(entries, [](auto& a, auto& b) { return a.hash < b.hash; });
+
+    // Fill leaves to about three quarters, so the next few additions don't have to split them right away.
+    Vector<size_t> leaf_starts;
+    size_t used_length = block_size;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto length = EXT2_DIR_REC_LEN(entries[i].name.length());
+        if (used_length + length > block_size * 3 / 4) {
+            TRY(leaf_starts.try_append(i));
+            used_length = 0;
+        }
+        used_length += length;
+    }
+
+    auto root_limit = directory_index_root_limit(block_size);
+    auto node_limit = directory_index_node_limit(block_size);
+    size_t leaf_count = leaf_starts.size();
+    size_t node_count = leaf_count <= root_limit ? 0 : ceil_div(leaf_count, static_cast<size_t>(node_limit));
+    if (node_count > root_limit)
+        return ENOSPC;
+    size_t first_leaf_block = 1 + node_count;
+
+    auto data = TRY(ByteBuffer::create_zeroed((first_leaf_block + leaf_count) * block_size));
+    auto block_data = [&](size_t block) { return data.bytes().slice(block * block_size, block_size); };
+    auto leaf_hash = [&](size_t leaf) {
+        auto hash = entries[leaf_starts[leaf]].hash;
+        bool continued = leaf > 0 && hash == entries[leaf_starts[leaf] - 1].hash;
+        return hash | (continued ? 1 : 0);
+    };
+
+    auto root = block_data(0);
+    write_directory_entry(root, 0, EXT2_DIR_REC_LEN(1), static_cast<u32>(self->value()), EXT2_FT_DIR, "."sv);
+    write_directory_entry(root, EXT2_DIR_REC_LEN(1), block_size - EXT2_DIR_REC_LEN(1), static_cast<u32>(parent->value()), EXT2_FT_DIR, ".."sv);
+    auto& info = *reinterpret_cast<ext2_dx_root_info*>(root.data() + directory_index_root_info_offset);
+    info.hash_version = hash_version;
+    info.info_length = sizeof(ext2_dx_root_info);
+    info.indirect_levels = node_count > 0 ? 1 : 0;
+
+    auto fill_index = [&](Bytes block, size_t entries_offset, u16 limit, size_t count, auto hash_of, auto block_of) {
+        auto* index_entries = reinterpret_cast<ext2_dx_entry*>(block.data() + entries_offset);
+        for (size_t i = 1; i < count; ++i)
+            index_entries[i] = { hash_of(i), block_of(i) };
+        index_entries[0].block = block_of(0);
+        *reinterpret_cast<ext2_dx_countlimit*>(index_entries) = { limit, static_cast<u16>(count) };
+    };
+
+    if (node_count == 0) {
+        fill_index(root, directory_index_root_entries_offset, root_limit, leaf_count, leaf_hash, [&](size_t leaf) { return static_cast<u32>(first_leaf_block + leaf); });
+    } else {
+        fill_index(
+            root, directory_index_root_entries_offset, root_limit, node_count, [&](size_t node) { return leaf_hash(node * node_limit); }, [&](size_t node) { return static_cast<u32>(1 + node); });
+        for (size_t node = 0; node < node_count; ++node) {
+            auto first_leaf = node * node_limit;
+            auto node_block = block_data(1 + node);
+            write_directory_entry(node_block, 0, block_size, 0, 0, ""sv);
+            fill_index(
+                node_block, directory_index_node_entries_offset, node_limit, min(static_cast<size_t>(node_limit), leaf_count - first_leaf), [&](size_t i) { return leaf_hash(first_leaf + i); }, [&](size_t i) { return static_cast<u32>(first_leaf_block + first_leaf + i); });
+        }
+    }
+
+    for (size_t leaf = 0; leaf < leaf_count; ++leaf) {
+        auto end = leaf + 1 < leaf_count ? leaf_starts[leaf + 1] : entries.size();
+        pack_directory_block(block_data(first_leaf_block + leaf), entries.span().slice(leaf_starts[leaf], end - leaf_starts[leaf]));
+    }
+
+    dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::write_indexed_directory(): {} entries in {} leaves and {} index nodes", identifier(), entries.size(), leaf_count, node_count);
+
+    TRY(resize(data.size()));
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(data.data());
+    auto nwritten = TRY(write_bytes(0, data.size(), buffer, nullptr));
+    m_raw_inode.i_flags |= EXT2_INDEX_FL;
+    set_metadata_dirty(true);
+    if (nwritten != data.size())
+        return EIO;
+    return {};
+}
+
 ErrorOr<NonnullLockRefPtr<Inode>> Ext2FSInode::create_child(StringView name, mode_t mode, dev_t dev, UserID uid, GroupID gid)
 {
     if (::is_directory(mode))
@@ -1133,6 +1980,19 @@ ErrorOr<void> Ext2FSInode::add_child(Inode& child, StringView name, mode_t mode)
 
     dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::add_child(): Adding inode {} with name '{}' and mode {:o} to directory {}", identifier(), child.index(), name, mode, index());
 
+    if (has_directory_index()) {
+        auto existing_child_or_error = find_child_in_directory_index(name);
+        if (!existing_child_or_error.is_error())
+            return EEXIST;
+        if (existing_child_or_error.error().code() != ENOENT)
+            return existing_child_or_error.release_error();
+
+        TRY(child.increment_link_count());
+        TRY(add_child_to_directory_index(child.index(), name, to_ext2_file_type(mode)));
+        did_add_child(child.identifier(), name);
+        return {};
+    }
+
     Vector<Ext2FSDirectoryEntry> entries;
     TRY(traverse_as_directory([&](auto& entry) -> ErrorOr<void> {
         if (name == entry.name)
@@ -1147,6 +2007,18 @@ ErrorOr<void> Ext2FSInode::add_child(Inode& child, StringView name, mode_t mode)
     auto entry_name = TRY(KString::try_create(name));
     TRY(entries.try_empend(move(entry_name), child.index(), to_ext2_file_type(mode)));
 
+    // Once a directory outgrows its first block, switch it over to a hashed index like Linux does,
+    // so it doesn't have to be searched and rewritten in full for every change.
+    size_t directory_length = 0;
+    for (auto& entry : entries)
+        directory_length += EXT2_DIR_REC_LEN(entry.name->length());
+    if (fs().has_directory_index_feature() && directory_length > fs().block_size()) {
+        TRY(write_indexed_directory(entries));
+        m_lookup_cache.clear();
+        did_add_child(child.identifier(), name);
+        return {};
+    }
+
     TRY(write_directory(entries));
     TRY(populate_lookup_cache());
 
@@ -1162,6 +2034,16 @@ ErrorOr<void> Ext2FSInode::remove_child(StringView name)
     dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::remove_child(): Removing '{}'", identifier(), name);
     VERIFY(is_directory());
 
+    // "." and ".." live in the index root, and are only removed right before the directory is,
+    // at which point it is empty and rewriting it as a linear directory is cheap.
+    if (has_directory_index() && name != "."sv && name != ".."sv) {
+        InodeIdentifier child_id { fsid(), TRY(remove_child_from_directory_index(name)) };
+        auto child_inode = TRY(fs().get_inode(child_id));
+        TRY(child_inode->decrement_link_count());
+        did_remove_child(child_id, name);
+        return {};
+    }
+
     TRY(populate_lookup_cache());
 
     auto it = m_lookup_cache.find(name);
@@ -1220,9 +2102,34 @@ ErrorOr<void> Ext2FS::write_ext2_inode(InodeIndex inode, ext2_inode const& e2ino
     return write_block(block_index, buffer, inode_size(), offset);
 }
 
-auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) -> ErrorOr<Vector<BlockIndex>>
+ErrorOr<void> Ext2FS::allocate_block_range(GroupIndex group_index, size_t first_bit, size_t count, Vector<BlockIndex>& blocks)
 {
-    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {})", preferred_group_index, count);
+    VERIFY(m_lock.is_locked());
+    auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index));
+    auto* cached_bitmap = TRY(get_bitmap_block(bgd.bg_block_bitmap));
+    auto block_bitmap = cached_bitmap->bitmap(blocks_per_group());
+    if (block_bitmap.count_in_range(first_bit, count, true) != 0) {
+        dbgln("Ext2FS: Blocks {}-{} in group {} are already in use", first_bit, first_bit + count - 1, group_index);
+        return EIO;
+    }
+    block_bitmap.set_range(first_bit, count, true);
+    cached_bitmap->dirty = true;
+
+    m_super_block.s_free_blocks_count -= count;
+    bgd.bg_free_blocks_count -= count;
+    m_super_block_dirty = true;
+    m_block_group_descriptors_dirty = true;
+
+    BlockIndex first_block_in_group = (group_index.value() - 1) * blocks_per_group() + first_block_index().value();
+    for (size_t i = 0; i < count; ++i)
+        blocks.unchecked_append(first_block_in_group.value() + first_bit + i);
+    dbgln_if(EXT2_DEBUG, "Ext2FS: allocated blocks {}-{} [{}]", first_block_in_group.value() + first_bit, first_block_in_group.value() + first_bit + count - 1, group_index);
+    return {};
+}
+
+auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal) -> ErrorOr<Vector<BlockIndex>>
+{
+    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {}, goal {})", preferred_group_index, count, goal);
     if (count == 0)
         return Vector<BlockIndex> {};
 
@@ -1230,46 +2137,67 @@ auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) ->
     TRY(blocks.try_ensure_capacity(count));
 
     MutexLocker locker(m_lock);
-    auto group_index = preferred_group_index;
+    if (count > m_super_block.s_free_blocks_count)
+        return ENOSPC;
+
+    int blocks_in_group = min(blocks_per_group(), super_block().s_blocks_count);
 
-    if (!group_descriptor(preferred_group_index).bg_free_blocks_count) {
-        group_index = 1;
+    // Start with the blocks right after the goal, so a file that grows a bit at a time still ends up in one piece.
+    if (goal.value() >= first_block_index().value() && goal.value() < super_block().s_blocks_count) {
+        auto group_index = group_index_from_block_index(goal);
+        auto const& bgd = group_descriptor(group_index);
+        if (bgd.bg_free_blocks_count) {
+            auto* cached_bitmap = TRY(get_bitmap_block(bgd.bg_block_bitmap));
+            auto block_bitmap = cached_bitmap->bitmap(blocks_in_group);
+            size_t first_bit = (goal.value() - first_block_index().value()) % blocks_per_group();
+            size_t free_run_length = 0;
+            while (free_run_length < count && first_bit + free_run_length < block_bitmap.size() && !block_bitmap.get(first_bit + free_run_length))
+                ++free_run_length;
+            if (free_run_length)
+                TRY(allocate_block_range(group_index, first_bit, free_run_length, blocks));
+        }
+        preferred_group_index = group_index;
     }
 
+    if (!preferred_group_index.value() || preferred_group_index.value() > m_block_group_count)
+        preferred_group_index = 1;
+
     while (blocks.size() < count) {
-        bool found_a_group = false;
-        if (group_descriptor(group_index).bg_free_blocks_count) {
-            found_a_group = true;
-        } else {
-            if (group_index == preferred_group_index)
-                group_index = 1;
-            for (; group_index <= m_block_group_count; group_index = GroupIndex { group_index.value() + 1 }) {
-                if (group_descriptor(group_index).bg_free_blocks_count) {
-                    found_a_group = true;
+        auto remaining = count - blocks.size();
+
+        // Look for a group with a free range that can hold everything that's left, starting at the
+        // preferred group. Otherwise, take the longest free range there is and try again for the rest.
+        Optional<GroupIndex> best_group_index;
+        size_t best_first_bit = 0;
+        size_t best_range_length = 0;
+        auto group_index = preferred_group_index;
+        for (size_t i = 0; i < m_block_group_count; ++i) {
+            auto const& bgd = group_descriptor(group_index);
+            if (bgd.bg_free_blocks_count > best_range_length) {
+                auto* cached_bitmap = TRY(get_bitmap_block(bgd.bg_block_bitmap));
+                auto block_bitmap = cached_bitmap->bitmap(blocks_in_group);
+                if (auto first_fit = block_bitmap.find_first_fit(remaining); first_fit.has_value()) {
+                    best_group_index = group_index;
+                    best_first_bit = first_fit.value();
+                    best_range_length = remaining;
                     break;
                 }
+                size_t range_length = 0;
+                auto first_bit = block_bitmap.find_longest_range_of_unset_bits(remaining, range_length);
+                if (first_bit.has_value() && range_length > best_range_length) {
+                    best_group_index = group_index;
+                    best_first_bit = first_bit.value();
+                    best_range_length = range_length;
+                }
             }
+            group_index = group_index.value() == m_block_group_count ? 1 : group_index.value() + 1;
         }
 
-        VERIFY(found_a_group);
-        auto const& bgd = group_descriptor(group_index);
-
-        auto* cached_bitmap = TRY(get_bitmap_block(bgd.bg_block_bitmap));
-
-        int blocks_in_group = min(blocks_per_group(), super_block().s_blocks_count);
-        auto block_bitmap = cached_bitmap->bitmap(blocks_in_group);
-
-        BlockIndex first_block_in_group = (group_index.value() - 1) * blocks_per_group() + first_block_index().value();
-        size_t free_region_size = 0;
-        auto first_unset_bit_index = block_bitmap.find_longest_range_of_unset_bits(count - blocks.size(), free_region_size);
-        VERIFY(first_unset_bit_index.has_value());
-        dbgln_if(EXT2_DEBUG, "Ext2FS: allocating free region of size: {} [{}]", free_region_size, group_index);
-        for (size_t i = 0; i < free_region_size; ++i) {
-            BlockIndex block_index = (first_unset_bit_index.value() + i) + first_block_in_group.value();
-            TRY(set_block_allocation_state(block_index, true));
-            blocks.unchecked_append(block_index);
-            dbgln_if(EXT2_DEBUG, "  allocated > {}", block_index);
+        if (!best_group_index.has_value()) {
+            dbgln("Ext2FS: allocate_blocks found no free blocks, despite the superblock claiming there are some");
+            return EIO;
         }
+        TRY(allocate_block_range(best_group_index.value(), best_first_bit, best_range_length, blocks));
     }
 
     VERIFY(blocks.size() == count);
@@ -1521,6 +2449,16 @@ ErrorOr<NonnullLockRefPtr<Inode>> Ext2FSInode::lookup(StringView name)
 {
     VERIFY(is_directory());
     dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]:lookup(): Looking up '{}'", identifier(), name);
+
+    if (has_directory_index()) {
+        InodeIndex inode_index;
+        {
+            MutexLocker locker(m_inode_lock);
+            inode_index = TRY(find_child_in_directory_index(name));
+        }
+        return fs().get_inode({ fsid(), inode_index });
+    }
+
     TRY(populate_lookup_cache());
 
     InodeIndex inode_index;
@@ -1626,6 +2564,32 @@ ErrorOr<void> Ext2FSInode::truncate(u64 size)
     return {};
 }
 
+ErrorOr<void> Ext2FSInode::allocate(u64 offset, u64 length)
+{
+    MutexLocker locker(m_inode_lock);
+    // All missing blocks are allocated in one go, so they are as contiguous as the free space allows.
+    auto end = offset + length;
+    if (end > size())
+        TRY(resize(end));
+    return {};
+}
+
+ErrorOr<void> Ext2FSInode::attach(OpenFileDescription&)
+{
+    MutexLocker locker(m_inode_lock);
+    ++m_attach_count;
+    return {};
+}
+
+void Ext2FSInode::detach(OpenFileDescription&)
+{
+    MutexLocker locker(m_inode_lock);
+    VERIFY(m_attach_count);
+    // Nobody is going to write to the file until it's opened again, so give the spare blocks back.
+    if (--m_attach_count == 0)
+        (void)discard_preallocated_blocks();
+}
+
 ErrorOr<int> Ext2FSInode::get_block_address(int index)
 {
     MutexLocker locker(m_inode_lock);
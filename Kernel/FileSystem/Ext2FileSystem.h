@@ -22,6 +22,8 @@ namespace Kernel {
 
 class Ext2FS;
 struct Ext2FSDirectoryEntry;
+struct Ext2FSDirectoryIndexNode;
+struct Ext2FSDirectoryIndexPath;
 
 class Ext2FSInode final : public Inode {
     friend class Ext2FS;
@@ -36,6 +38,7 @@ public:
 private:
     // ^Inode
     virtual ErrorOr<size_t> read_bytes(off_t, size_t, UserOrKernelBuffer& buffer, OpenFileDescription*) const override;
+    virtual void read_ahead(u64, size_t) const override;
     virtual InodeMetadata metadata() const override;
     virtual ErrorOr<void> traverse_as_directory(Function<ErrorOr<void>(FileSystem::DirectoryEntryView const&)>) const override;
     virtual ErrorOr<NonnullLockRefPtr<Inode>> lookup(StringView name) override;
@@ -50,11 +53,29 @@ private:
     virtual ErrorOr<void> chmod(mode_t) override;
     virtual ErrorOr<void> chown(UserID, GroupID) override;
     virtual ErrorOr<void> truncate(u64) override;
+    virtual ErrorOr<void> allocate(u64 offset, u64 length) override;
     virtual ErrorOr<int> get_block_address(int) override;
+    virtual ErrorOr<void> attach(OpenFileDescription&) override;
+    virtual void detach(OpenFileDescription&) override;
 
     ErrorOr<void> write_directory(Vector<Ext2FSDirectoryEntry>&);
     ErrorOr<void> populate_lookup_cache() const;
+
+    bool has_directory_index() const;
+    ErrorOr<void> read_directory_block(u32 block, Bytes) const;
+    ErrorOr<void> write_directory_block(u32 block, ReadonlyBytes);
+    ErrorOr<Ext2FSDirectoryIndexNode> read_directory_index_node(u32 block) const;
+    ErrorOr<Ext2FSDirectoryIndexPath> walk_directory_index(StringView name) const;
+    ErrorOr<bool> advance_directory_index_path(Ext2FSDirectoryIndexPath&) const;
+    ErrorOr<void> make_room_in_directory_index(Ext2FSDirectoryIndexPath&);
+    ErrorOr<InodeIndex> find_child_in_directory_index(StringView name) const;
+    ErrorOr<void> add_child_to_directory_index(InodeIndex child, StringView name, u8 file_type);
+    ErrorOr<InodeIndex> remove_child_from_directory_index(StringView name);
+    ErrorOr<void> write_indexed_directory(Vector<Ext2FSDirectoryEntry>&);
     ErrorOr<void> resize(u64);
+    ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> allocate_data_blocks(size_t count);
+    ErrorOr<void> keep_as_preallocated_blocks(Span<BlockBasedFileSystem::BlockIndex const>);
+    ErrorOr<void> discard_preallocated_blocks();
     ErrorOr<void> write_indirect_block(BlockBasedFileSystem::BlockIndex, Span<BlockBasedFileSystem::BlockIndex>);
     ErrorOr<void> grow_doubly_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, Span<BlockBasedFileSystem::BlockIndex>, Vector<BlockBasedFileSystem::BlockIndex>&, unsigned&);
     ErrorOr<void> shrink_doubly_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, size_t, unsigned&);
@@ -73,6 +94,12 @@ private:
     mutable Vector<BlockBasedFileSystem::BlockIndex> m_block_list;
     mutable HashMap<NonnullOwnPtr<KString>, InodeIndex> m_lookup_cache;
     ext2_inode m_raw_inode {};
+
+    // A run of blocks that is marked as used on disk but isn't part of the file yet.
+    // It's handed out first when the file grows, and given back once the file is closed.
+    BlockBasedFileSystem::BlockIndex m_first_preallocated_block { 0 };
+    size_t m_preallocated_block_count { 0 };
+    size_t m_attach_count { 0 };
 };
 
 class Ext2FS final : public BlockBasedFileSystem {
@@ -97,11 +124,15 @@ public:
     virtual ErrorOr<void> prepare_to_unmount() override;
 
     virtual bool supports_watchers() const override { return true; }
+    virtual bool supports_dentry_cache() const override { return true; }
 
     virtual u8 internal_file_type_to_directory_entry_type(DirectoryEntryView const& entry) const override;
 
     FeaturesReadOnly get_features_readonly() const;
 
+    bool has_directory_index_feature() const { return m_super_block.s_feature_compat & EXT2_FEATURE_COMPAT_DIR_INDEX; }
+    u32 directory_hash(StringView name, u8 hash_version) const;
+
 private:
     AK_TYPEDEF_DISTINCT_ORDERED_ID(unsigned, GroupIndex);
 
@@ -128,10 +159,13 @@ private:
     ErrorOr<NonnullLockRefPtr<Inode>> create_inode(Ext2FSInode& parent_inode, StringView name, mode_t, dev_t, UserID, GroupID);
     ErrorOr<NonnullLockRefPtr<Inode>> create_directory(Ext2FSInode& parent_inode, StringView name, mode_t, UserID, GroupID);
     virtual void flush_writes() override;
+    virtual void writeback_dirty_blocks() override;
+    void flush_metadata_to_block_cache();
 
     BlockIndex first_block_index() const;
     ErrorOr<InodeIndex> allocate_inode(GroupIndex preferred_group = 0);
-    ErrorOr<Vector<BlockIndex>> allocate_blocks(GroupIndex preferred_group_index, size_t count);
+    ErrorOr<Vector<BlockIndex>> allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal = 0);
+    ErrorOr<void> allocate_block_range(GroupIndex, size_t first_bit, size_t count, Vector<BlockIndex>&);
     GroupIndex group_index_from_inode(InodeIndex) const;
     GroupIndex group_index_from_block_index(BlockIndex) const;
 
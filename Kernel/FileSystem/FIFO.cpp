@@ -107,6 +107,16 @@ bool FIFO::can_write(OpenFileDescription const&, u64) const
     return m_buffer->space_for_writing() || !m_readers;
 }
 
+bool FIFO::has_hung_up(OpenFileDescription const& description) const
+{
+    return description.is_readable() && !m_writers;
+}
+
+bool FIFO::has_error(OpenFileDescription const& description) const
+{
+    return description.is_writable() && !m_readers;
+}
+
 ErrorOr<size_t> FIFO::read(OpenFileDescription& fd, u64, UserOrKernelBuffer& buffer, size_t size)
 {
     if (m_buffer->is_empty()) {
@@ -45,6 +45,8 @@ private:
     virtual ErrorOr<struct stat> stat() const override;
     virtual bool can_read(OpenFileDescription const&, u64) const override;
     virtual bool can_write(OpenFileDescription const&, u64) const override;
+    virtual bool has_hung_up(OpenFileDescription const&) const override;
+    virtual bool has_error(OpenFileDescription const&) const override;
     virtual ErrorOr<NonnullOwnPtr<KString>> pseudo_path(OpenFileDescription const&) const override;
     virtual StringView class_name() const override { return "FIFO"sv; }
     virtual bool is_fifo() const override { return true; }
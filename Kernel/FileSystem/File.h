@@ -10,6 +10,7 @@
 #include <AK/Error.h>
 #include <AK/StringView.h>
 #include <AK/Types.h>
+#include <AK/Vector.h>
 #include <Kernel/Forward.h>
 #include <Kernel/Library/LockWeakable.h>
 #include <Kernel/Library/NonnullLockRefPtr.h>
@@ -40,7 +41,23 @@ public:
             auto& blocker = static_cast<Thread::FileBlocker&>(b);
             return blocker.unblock_if_conditions_are_met(false, data);
         });
+        if (!m_event_poll_entries.is_empty())
+            notify_event_poll_entries_locked();
     }
+
+    // These are implemented in EventPoll.cpp.
+    ErrorOr<void> add_event_poll_entry(EventPollEntry&);
+    void remove_event_poll_entry(EventPollEntry&);
+    void detach_event_poll_entries_for(OpenFileDescription const&);
+    u32 event_poll_entry_revents(EventPollEntry const&) const;
+
+private:
+    void notify_event_poll_entries_locked();
+    u32 event_poll_entry_revents_locked(EventPollEntry const&) const;
+
+    // Interest entries of event polls watching an open description of this file.
+    // Like the blockers, these are protected by m_lock.
+    Vector<EventPollEntry*> m_event_poll_entries;
 };
 
 // File is the base class for anything that can be referenced by a OpenFileDescription.
@@ -83,6 +100,10 @@ public:
 
     virtual bool can_read(OpenFileDescription const&, u64) const = 0;
     virtual bool can_write(OpenFileDescription const&, u64) const = 0;
+    // The other end has gone away (reported as POLLHUP / EPOLLHUP).
+    virtual bool has_hung_up(OpenFileDescription const&) const { return false; }
+    // Writing would fail (reported as POLLERR / EPOLLERR).
+    virtual bool has_error(OpenFileDescription const&) const { return false; }
 
     virtual ErrorOr<void> attach(OpenFileDescription&);
     virtual void detach(OpenFileDescription&);
@@ -114,6 +135,7 @@ public:
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
     virtual bool is_inode_watcher() const { return false; }
+    virtual bool is_event_poll() const { return false; }
 
     virtual FileBlockerSet& blocker_set() { return m_blocker_set; }
 
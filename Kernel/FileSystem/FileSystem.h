@@ -27,12 +27,16 @@ public:
     FileSystemID fsid() const { return m_fsid; }
     static FileSystem* from_fsid(FileSystemID);
     static void sync();
+    static void writeback();
     static void lock_all();
 
     virtual ErrorOr<void> initialize() = 0;
     virtual StringView class_name() const = 0;
     virtual Inode& root_inode() = 0;
     virtual bool supports_watchers() const { return false; }
+    // True if every change to a directory is reported through Inode::did_add_child() and Inode::did_remove_child(),
+    // so that lookups can be cached in the DentryCache.
+    virtual bool supports_dentry_cache() const { return false; }
 
     bool is_readonly() const { return m_readonly; }
 
@@ -52,11 +56,14 @@ public:
     };
 
     virtual void flush_writes() { }
+    // Writes back blocks that have been dirty for long enough. Called periodically by the WritebackTask.
+    virtual void writeback_dirty_blocks() { }
 
     u64 block_size() const { return m_block_size; }
     size_t fragment_size() const { return m_fragment_size; }
 
     virtual bool is_file_backed() const { return false; }
+    virtual bool is_block_based() const { return false; }
 
     // Converts file types that are used internally by the filesystem to DT_* types
     virtual u8 internal_file_type_to_directory_entry_type(DirectoryEntryView const& entry) const { return entry.file_type; }
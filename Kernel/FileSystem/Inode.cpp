@@ -10,6 +10,7 @@
 #include <AK/StringView.h>
 #include <Kernel/API/InodeWatcherEvent.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/DentryCache.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/InodeWatcher.h>
 #include <Kernel/FileSystem/OpenFileDescription.h>
@@ -106,6 +107,14 @@ void Inode::will_be_destroyed()
         (void)flush_metadata();
 }
 
+ErrorOr<void> Inode::allocate(u64 offset, u64 length)
+{
+    // Without a block allocator to reserve space with, all we can do is make the file big enough.
+    if (size() >= offset + length)
+        return {};
+    return truncate(offset + length);
+}
+
 ErrorOr<void> Inode::update_timestamps([[maybe_unused]] Optional<time_t> atime, [[maybe_unused]] Optional<time_t> ctime, [[maybe_unused]] Optional<time_t> mtime)
 {
     return ENOTIMPL;
@@ -204,6 +213,9 @@ void Inode::set_metadata_dirty(bool metadata_dirty)
 
 void Inode::did_add_child(InodeIdentifier, StringView name)
 {
+    if (fs().supports_dentry_cache())
+        DentryCache::the().invalidate(*this, name);
+
     m_watchers.for_each([&](auto& watcher) {
         watcher->notify_inode_event({}, identifier(), InodeWatcherEvent::Type::ChildCreated, name);
     });
@@ -211,6 +223,9 @@ void Inode::did_add_child(InodeIdentifier, StringView name)
 
 void Inode::did_remove_child(InodeIdentifier, StringView name)
 {
+    if (fs().supports_dentry_cache())
+        DentryCache::the().invalidate(*this, name);
+
     if (name == "." || name == "..") {
         // These are just aliases and are not interesting to userspace.
         return;
@@ -9,6 +9,7 @@
 #include <Kernel/API/POSIX/errno.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/EventPoll.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/InodeFile.h>
 #include <Kernel/FileSystem/InodeWatcher.h>
@@ -51,6 +52,7 @@ OpenFileDescription::OpenFileDescription(File& file)
 
 OpenFileDescription::~OpenFileDescription()
 {
+    m_file->blocker_set().detach_event_poll_entries_for(*this);
     m_file->detach(*this);
     if (is_fifo())
         static_cast<FIFO*>(m_file.ptr())->detach(fifo_direction());
@@ -83,7 +85,11 @@ Thread::FileBlocker::BlockFlags OpenFileDescription::should_unblock(Thread::File
         unblock_flags |= BlockFlags::Read;
     if (has_flag(block_flags, BlockFlags::Write) && can_write())
         unblock_flags |= BlockFlags::Write;
-    // TODO: Implement Thread::FileBlocker::BlockFlags::Exception
+    if (has_flag(block_flags, BlockFlags::WriteHangUp) && m_file->has_hung_up(*this))
+        unblock_flags |= BlockFlags::WriteHangUp;
+    if (has_flag(block_flags, BlockFlags::WriteError) && m_file->has_error(*this))
+        unblock_flags |= BlockFlags::WriteError;
+    // TODO: Implement Thread::FileBlocker::BlockFlags::ReadHangUp
 
     if (has_any_flag(block_flags, BlockFlags::SocketFlags)) {
         auto const* sock = socket();
@@ -327,6 +333,25 @@ InodeWatcher* OpenFileDescription::inode_watcher()
     return static_cast<InodeWatcher*>(m_file.ptr());
 }
 
+bool OpenFileDescription::is_event_poll() const
+{
+    return m_file->is_event_poll();
+}
+
+EventPoll const* OpenFileDescription::event_poll() const
+{
+    if (!is_event_poll())
+        return nullptr;
+    return static_cast<EventPoll const*>(m_file.ptr());
+}
+
+EventPoll* OpenFileDescription::event_poll()
+{
+    if (!is_event_poll())
+        return nullptr;
+    return static_cast<EventPoll*>(m_file.ptr());
+}
+
 bool OpenFileDescription::is_master_pty() const
 {
     return m_file->is_master_pty();
@@ -493,6 +518,11 @@ bool OpenFileDescription::is_direct() const
     return m_state.with([](auto& state) { return state.direct; });
 }
 
+Optional<ReadAheadRange> OpenFileDescription::did_read_for_read_ahead(u64 offset, size_t count)
+{
+    return m_state.with([&](auto& state) { return state.read_ahead.did_read(offset, count); });
+}
+
 bool OpenFileDescription::is_directory() const
 {
     return m_state.with([](auto& state) { return state.is_directory; });
@@ -12,6 +12,7 @@
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/InodeMetadata.h>
+#include <Kernel/FileSystem/ReadAheadState.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/VirtualAddress.h>
@@ -64,6 +65,8 @@ public:
 
     bool is_direct() const;
 
+    Optional<ReadAheadRange> did_read_for_read_ahead(u64 offset, size_t count);
+
     bool is_directory() const;
 
     File& file() { return *m_file; }
@@ -81,6 +84,10 @@ public:
     InodeWatcher const* inode_watcher() const;
     InodeWatcher* inode_watcher();
 
+    bool is_event_poll() const;
+    EventPoll const* event_poll() const;
+    EventPoll* event_poll();
+
     bool is_master_pty() const;
     MasterPTY const* master_pty() const;
     MasterPTY* master_pty();
@@ -154,6 +161,7 @@ private:
         bool should_append : 1 { false };
         bool direct : 1 { false };
         FIFO::Direction fifo_direction : 2 { FIFO::Direction::Neither };
+        ReadAheadState read_ahead;
     };
 
     SpinlockProtected<State> m_state { LockRank::None };
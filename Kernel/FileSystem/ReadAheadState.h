@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+struct ReadAheadRange {
+    u64 offset { 0 };
+    size_t size { 0 };
+};
+
+// Detects sequential access to a file and decides how much of it should be read
+// ahead of the reader. The window starts out small and doubles with every
+// sequential access that catches up with it, and collapses on a random access.
+class ReadAheadState {
+public:
+    static constexpr size_t initial_window_size = 16 * KiB;
+    static constexpr size_t maximum_window_size = 256 * KiB;
+
+    Optional<ReadAheadRange> did_read(u64 offset, size_t size)
+    {
+        auto end = offset + size;
+        bool is_sequential = offset == m_next_offset;
+        m_next_offset = end;
+
+        if (!is_sequential) {
+            m_window_size = 0;
+            m_read_ahead_end = 0;
+            return {};
+        }
+
+        // Don't issue more read-ahead while at least half a window is still ahead of the reader.
+        if (m_window_size != 0 && end + m_window_size / 2 <= m_read_ahead_end)
+            return {};
+
+        m_window_size = m_window_size == 0 ? initial_window_size : min(m_window_size * 2, maximum_window_size);
+        auto start = max(end, m_read_ahead_end);
+        m_read_ahead_end = end + m_window_size;
+        if (start >= m_read_ahead_end)
+            return {};
+        return ReadAheadRange { start, static_cast<size_t>(m_read_ahead_end - start) };
+    }
+
+private:
+    u64 m_next_offset { 0 };
+    u64 m_read_ahead_end { 0 };
+    size_t m_window_size { 0 };
+};
+
+}
@@ -21,6 +21,8 @@ StringView StorageDeviceAttributeSysFSComponent::name() const
         return "sector_size"sv;
     case Type::CommandSet:
         return "command_set"sv;
+    case Type::Queues:
+        return "queues"sv;
     default:
         VERIFY_NOT_REACHED();
     }
@@ -63,6 +65,9 @@ ErrorOr<NonnullOwnPtr<KBuffer>> StorageDeviceAttributeSysFSComponent::try_to_gen
     case Type::CommandSet:
         value = TRY(KString::formatted("{}", m_device->command_set_to_string_view()));
         break;
+    case Type::Queues:
+        value = TRY(m_device->queue_statistics());
+        break;
     default:
         VERIFY_NOT_REACHED();
     }
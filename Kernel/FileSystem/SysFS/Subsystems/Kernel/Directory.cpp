@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/SysFS/RootDirectory.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Directory.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/DiskCache.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/KmallocSlabs.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/LockStatistics.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT NonnullLockRefPtr<SysFSKernelDirectory> SysFSKernelDirectory::must_create(SysFSRootDirectory const& parent_directory)
+{
+    auto directory = adopt_lock_ref(*new (nothrow) SysFSKernelDirectory(parent_directory));
+    MUST(directory->m_child_components.with([&](auto& list) -> ErrorOr<void> {
+        list.append(SysFSDiskCache::must_create(*directory));
+        list.append(SysFSKmallocSlabs::must_create(*directory));
+        list.append(SysFSLockStatistics::must_create(*directory));
+        return {};
+    }));
+    return directory;
+}
+
+UNMAP_AFTER_INIT SysFSKernelDirectory::SysFSKernelDirectory(SysFSRootDirectory const& parent_directory)
+    : SysFSDirectory(parent_directory)
+{
+}
+
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/FileSystem/SysFS/Component.h>
+#include <Kernel/Forward.h>
+
+namespace Kernel {
+
+class SysFSKernelDirectory : public SysFSDirectory {
+public:
+    virtual StringView name() const override { return "kernel"sv; }
+    static NonnullLockRefPtr<SysFSKernelDirectory> must_create(SysFSRootDirectory const&);
+
+private:
+    explicit SysFSKernelDirectory(SysFSRootDirectory const&);
+};
+
+}
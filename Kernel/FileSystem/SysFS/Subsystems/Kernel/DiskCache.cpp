@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonArraySerializer.h>
+#include <AK/JsonObjectSerializer.h>
+#include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/DiskCache.h>
+#include <Kernel/FileSystem/VirtualFileSystem.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT NonnullLockRefPtr<SysFSDiskCache> SysFSDiskCache::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_lock_ref_if_nonnull(new (nothrow) SysFSDiskCache(parent_directory)).release_nonnull();
+}
+
+UNMAP_AFTER_INIT SysFSDiskCache::SysFSDiskCache(SysFSDirectory const& parent_directory)
+    : SysFSKernelInformation(parent_directory)
+{
+}
+
+ErrorOr<void> SysFSDiskCache::try_generate(KBufferBuilder& builder) const
+{
+    auto array = TRY(JsonArraySerializer<>::try_create(builder));
+    TRY(VirtualFileSystem::the().for_each_mount([&array](auto& mount) -> ErrorOr<void> {
+        auto& fs = mount.guest_fs();
+        if (!fs.is_block_based())
+            return {};
+        auto cache_statistics = static_cast<BlockBasedFileSystem const&>(fs).cache_statistics();
+        auto fs_object = TRY(array.add_object());
+        auto mount_point = TRY(mount.absolute_path());
+        TRY(fs_object.add("mount_point"sv, mount_point->view()));
+        TRY(fs_object.add("class_name"sv, fs.class_name()));
+        TRY(fs_object.add("hits"sv, cache_statistics.hits));
+        TRY(fs_object.add("misses"sv, cache_statistics.misses));
+        TRY(fs_object.add("evictions"sv, cache_statistics.evictions));
+        TRY(fs_object.add("entry_count"sv, cache_statistics.entry_count));
+        TRY(fs_object.add("max_entry_count"sv, cache_statistics.max_entry_count));
+        TRY(fs_object.add("dirty_entry_count"sv, cache_statistics.dirty_entry_count));
+        TRY(fs_object.finish());
+        return {};
+    }));
+    TRY(array.finish());
+    return {};
+}
+
+}
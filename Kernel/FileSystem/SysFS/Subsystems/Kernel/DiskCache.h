@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Information.h>
+
+namespace Kernel {
+
+// Reading gives the disk cache statistics of every mounted block-based filesystem as JSON.
+class SysFSDiskCache final : public SysFSKernelInformation {
+public:
+    virtual StringView name() const override { return "disk_cache"sv; }
+    static NonnullLockRefPtr<SysFSDiskCache> must_create(SysFSDirectory const&);
+
+private:
+    explicit SysFSDiskCache(SysFSDirectory const&);
+
+    virtual ErrorOr<void> try_generate(KBufferBuilder&) const override;
+};
+
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Information.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT SysFSKernelInformation::SysFSKernelInformation(SysFSDirectory const& parent_directory)
+    : SysFSComponent(parent_directory)
+{
+}
+
+ErrorOr<void> SysFSKernelInformation::refresh_data(OpenFileDescription& description) const
+{
+    MutexLocker locker(m_lock);
+    auto& cached_data = description.data();
+    if (!cached_data)
+        cached_data = TRY(adopt_nonnull_own_or_enomem(new (nothrow) SysFSInodeData));
+    auto builder = TRY(KBufferBuilder::try_create());
+    TRY(try_generate(builder));
+    auto& typed_cached_data = static_cast<SysFSInodeData&>(*cached_data);
+    typed_cached_data.buffer = builder.build();
+    if (!typed_cached_data.buffer)
+        return ENOMEM;
+    return {};
+}
+
+ErrorOr<size_t> SysFSKernelInformation::read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, OpenFileDescription* description) const
+{
+    VERIFY(offset >= 0);
+    if (!description)
+        return EIO;
+
+    MutexLocker locker(m_lock);
+    if (!description->data())
+        return EIO;
+
+    auto& data_buffer = static_cast<SysFSInodeData&>(*description->data()).buffer;
+    if (!data_buffer || static_cast<size_t>(offset) >= data_buffer->size())
+        return 0;
+
+    ssize_t nread = min(static_cast<off_t>(data_buffer->size() - offset), static_cast<off_t>(count));
+    TRY(buffer.write(data_buffer->data() + offset, nread));
+    return nread;
+}
+
+}
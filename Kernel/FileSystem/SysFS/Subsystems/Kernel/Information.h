@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/FileSystem/SysFS/Component.h>
+#include <Kernel/KBufferBuilder.h>
+#include <Kernel/Locking/Mutex.h>
+
+namespace Kernel {
+
+// A node in /sys/kernel whose contents are generated whenever it is opened or seeked back to the start.
+class SysFSKernelInformation : public SysFSComponent {
+public:
+    virtual ErrorOr<size_t> read_bytes(off_t, size_t, UserOrKernelBuffer&, OpenFileDescription*) const override;
+
+protected:
+    explicit SysFSKernelInformation(SysFSDirectory const&);
+
+    virtual ErrorOr<void> try_generate(KBufferBuilder&) const = 0;
+
+private:
+    virtual ErrorOr<void> refresh_data(OpenFileDescription&) const override;
+
+    mutable Mutex m_lock { "SysFSKernelInformation"sv };
+};
+
+}
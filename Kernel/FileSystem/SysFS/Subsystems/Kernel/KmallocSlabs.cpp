@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonArraySerializer.h>
+#include <AK/JsonObjectSerializer.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/KmallocSlabs.h>
+#include <Kernel/Heap/kmalloc.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT NonnullLockRefPtr<SysFSKmallocSlabs> SysFSKmallocSlabs::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_lock_ref_if_nonnull(new (nothrow) SysFSKmallocSlabs(parent_directory)).release_nonnull();
+}
+
+UNMAP_AFTER_INIT SysFSKmallocSlabs::SysFSKmallocSlabs(SysFSDirectory const& parent_directory)
+    : SysFSKernelInformation(parent_directory)
+{
+}
+
+ErrorOr<void> SysFSKmallocSlabs::try_generate(KBufferBuilder& builder) const
+{
+    kmalloc_slab_stats slab_stats[kmalloc_slabheap_count];
+    get_kmalloc_slab_stats(slab_stats);
+
+    auto array = TRY(JsonArraySerializer<>::try_create(builder));
+    for (auto const& stats : slab_stats) {
+        auto obj = TRY(array.add_object());
+        TRY(obj.add("slab_size"sv, stats.slab_size));
+        TRY(obj.add("allocation_cache_hits"sv, stats.allocation_cache_hits));
+        TRY(obj.add("allocation_cache_misses"sv, stats.allocation_cache_misses));
+        TRY(obj.add("free_cache_hits"sv, stats.free_cache_hits));
+        TRY(obj.add("free_cache_flushes"sv, stats.free_cache_flushes));
+        TRY(obj.add("cached_slabs"sv, stats.cached_slabs));
+        TRY(obj.finish());
+    }
+    TRY(array.finish());
+    return {};
+}
+
+}
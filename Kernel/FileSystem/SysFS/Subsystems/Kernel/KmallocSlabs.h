@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Information.h>
+
+namespace Kernel {
+
+// Reading gives the statistics of the per-CPU kmalloc slab caches for every size class as JSON.
+class SysFSKmallocSlabs final : public SysFSKernelInformation {
+public:
+    virtual StringView name() const override { return "kmalloc_slabs"sv; }
+    static NonnullLockRefPtr<SysFSKmallocSlabs> must_create(SysFSDirectory const&);
+
+private:
+    explicit SysFSKmallocSlabs(SysFSDirectory const&);
+
+    virtual ErrorOr<void> try_generate(KBufferBuilder&) const override;
+};
+
+}
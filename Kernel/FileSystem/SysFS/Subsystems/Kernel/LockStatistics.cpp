@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/LockStatistics.h>
+#include <Kernel/Locking/LockStatistics.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT NonnullLockRefPtr<SysFSLockStatistics> SysFSLockStatistics::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_lock_ref_if_nonnull(new (nothrow) SysFSLockStatistics(parent_directory)).release_nonnull();
+}
+
+UNMAP_AFTER_INIT SysFSLockStatistics::SysFSLockStatistics(SysFSDirectory const& parent_directory)
+    : SysFSKernelInformation(parent_directory)
+{
+}
+
+mode_t SysFSLockStatistics::permissions() const
+{
+    return S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+}
+
+ErrorOr<void> SysFSLockStatistics::try_generate(KBufferBuilder& builder) const
+{
+    return LockStatistics::try_generate(builder);
+}
+
+ErrorOr<void> SysFSLockStatistics::truncate(u64 size)
+{
+    // Allow truncating to zero, so that the file can be opened with O_TRUNC to write to it.
+    if (size != 0)
+        return EPERM;
+    return {};
+}
+
+ErrorOr<size_t> SysFSLockStatistics::write_bytes(off_t offset, size_t count, UserOrKernelBuffer const& data, OpenFileDescription*)
+{
+    if (offset != 0 || count == 0)
+        return EINVAL;
+
+    // Ignore anything after the first character, like a trailing newline.
+    char value;
+    TRY(data.read(&value, 1));
+    switch (value) {
+    case '0':
+        LockStatistics::set_enabled(false);
+        return count;
+    case '1':
+        LockStatistics::set_enabled(true);
+        return count;
+    default:
+        return EINVAL;
+    }
+}
+
+}
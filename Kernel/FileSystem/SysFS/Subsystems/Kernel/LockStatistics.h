@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Information.h>
+
+namespace Kernel {
+
+// Reading gives the contention statistics of all Mutexes as JSON.
+// Writing '1' starts recording them from scratch, and writing '0' stops recording.
+class SysFSLockStatistics final : public SysFSKernelInformation {
+public:
+    virtual StringView name() const override { return "lock_statistics"sv; }
+    static NonnullLockRefPtr<SysFSLockStatistics> must_create(SysFSDirectory const&);
+
+    virtual mode_t permissions() const override;
+    virtual ErrorOr<size_t> write_bytes(off_t, size_t, UserOrKernelBuffer const&, OpenFileDescription*) override;
+    virtual ErrorOr<void> truncate(u64) override;
+
+private:
+    explicit SysFSLockStatistics(SysFSDirectory const&);
+
+    virtual ErrorOr<void> try_generate(KBufferBuilder&) const override;
+};
+
+}
@@ -14,6 +14,7 @@
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/Devices/DeviceManagement.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/DentryCache.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/FileSystem/FileSystem.h>
 #include <Kernel/FileSystem/OpenFileDescription.h>
@@ -110,6 +111,9 @@ ErrorOr<void> VirtualFileSystem::unmount(Inode& guest_inode)
 {
     dbgln("VirtualFileSystem: unmount called with inode {}", guest_inode.identifier());
 
+    // The cache holds references to inodes, which would keep the file system busy.
+    DentryCache::the().invalidate_file_system(guest_inode.fsid());
+
     return m_mounts.with([&](auto& mounts) -> ErrorOr<void> {
         for (size_t i = 0; i < mounts.size(); ++i) {
             auto& mount = mounts[i];
@@ -929,7 +933,9 @@ ErrorOr<NonnullRefPtr<Custody>> VirtualFileSystem::resolve_path_without_veil(Cre
         }
 
         // Okay, let's look up this part.
-        auto child_or_error = parent.inode().lookup(part);
+        auto child_or_error = parent.inode().fs().supports_dentry_cache()
+            ? DentryCache::the().lookup(parent.inode(), part)
+            : parent.inode().lookup(part);
         if (child_or_error.is_error()) {
             if (out_parent) {
                 // ENOENT with a non-null parent custody signals to caller that
@@ -24,6 +24,8 @@ class DevTmpFSRootDirectoryInode;
 class Device;
 class DiskCache;
 class DoubleBuffer;
+class EventPoll;
+class EventPollEntry;
 class File;
 class OpenFileDescription;
 class DisplayConnector;
@@ -17,12 +17,14 @@
 #include <Kernel/Devices/DeviceManagement.h>
 #include <Kernel/Devices/HID/HIDManagement.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/DentryCache.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/FileSystem/OpenFileDescription.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/Interrupts/GenericInterruptHandler.h>
 #include <Kernel/KBufferBuilder.h>
 #include <Kernel/Net/LocalSocket.h>
+#include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/NetworkingManagement.h>
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCPSocket.h>
@@ -32,6 +34,7 @@
 #include <Kernel/Scheduler.h>
 #include <Kernel/Sections.h>
 #include <Kernel/TTY/TTY.h>
+#include <Kernel/Tasks/WritebackTask.h>
 
 namespace Kernel {
 
@@ -60,6 +63,7 @@ private:
             TRY(obj.add("bytes_in"sv, adapter.bytes_in()));
             TRY(obj.add("packets_out"sv, adapter.packets_out()));
             TRY(obj.add("bytes_out"sv, adapter.bytes_out()));
+            TRY(obj.add("packets_dropped"sv, adapter.packets_dropped()));
             TRY(obj.add("link_up"sv, adapter.link_up()));
             TRY(obj.add("link_speed"sv, adapter.link_speed()));
             TRY(obj.add("link_full_duplex"sv, adapter.link_full_duplex()));
@@ -150,6 +154,16 @@ private:
             TRY(obj.add("bytes_in"sv, socket.bytes_in()));
             TRY(obj.add("packets_out"sv, socket.packets_out()));
             TRY(obj.add("bytes_out"sv, socket.bytes_out()));
+            TRY(obj.add("congestion_control"sv, socket.congestion_control_name()));
+            TRY(obj.add("congestion_window"sv, socket.congestion_window()));
+            TRY(obj.add("slow_start_threshold"sv, socket.slow_start_threshold()));
+            TRY(obj.add("send_window"sv, socket.send_window_size()));
+            TRY(obj.add("srtt_us"sv, socket.smoothed_round_trip_time().to_microseconds()));
+            TRY(obj.add("rto_ms"sv, socket.retransmit_timeout().to_milliseconds()));
+            TRY(obj.add("retransmits"sv, socket.retransmits()));
+            TRY(obj.add("fast_retransmits"sv, socket.fast_retransmits()));
+            TRY(obj.add("sack_permitted"sv, socket.is_sack_permitted()));
+            TRY(obj.add("window_scaling"sv, socket.is_window_scaling_enabled()));
             auto current_process_credentials = Process::current().credentials();
             if (current_process_credentials->is_superuser() || current_process_credentials->uid() == socket.origin_uid()) {
                 TRY(obj.add("origin_pid"sv, socket.origin_pid().value()));
@@ -352,6 +366,31 @@ private:
     mutable Mutex m_lock;
 };
 
+class ProcFSSystemTunable : public ProcFSSystemUnsigned {
+public:
+    using ChangeCallback = void (*)();
+
+    static NonnullLockRefPtr<ProcFSSystemTunable> must_create(StringView name, Atomic<u32>& variable, u32 min_value, u32 max_value, ChangeCallback = nullptr);
+    virtual u32 value() const override { return m_variable.load(); }
+    virtual ErrorOr<void> set_value(u32 new_value) override
+    {
+        if (new_value < m_min_value || new_value > m_max_value)
+            return EINVAL;
+        m_variable.store(new_value);
+        if (m_on_change)
+            m_on_change();
+        return {};
+    }
+
+private:
+    ProcFSSystemTunable(StringView name, Atomic<u32>& variable, u32 min_value, u32 max_value, ChangeCallback);
+
+    Atomic<u32>& m_variable;
+    u32 m_min_value { 0 };
+    u32 m_max_value { 0 };
+    ChangeCallback m_on_change { nullptr };
+};
+
 UNMAP_AFTER_INIT NonnullLockRefPtr<ProcFSDumpKmallocStacks> ProcFSDumpKmallocStacks::must_create(ProcFSSystemDirectory const&)
 {
     return adopt_lock_ref_if_nonnull(new (nothrow) ProcFSDumpKmallocStacks).release_nonnull();
@@ -365,6 +404,11 @@ UNMAP_AFTER_INIT NonnullLockRefPtr<ProcFSCapsLockRemap> ProcFSCapsLockRemap::mus
     return adopt_lock_ref_if_nonnull(new (nothrow) ProcFSCapsLockRemap).release_nonnull();
 }
 
+UNMAP_AFTER_INIT NonnullLockRefPtr<ProcFSSystemTunable> ProcFSSystemTunable::must_create(StringView name, Atomic<u32>& variable, u32 min_value, u32 max_value, ChangeCallback on_change)
+{
+    return adopt_lock_ref_if_nonnull(new (nothrow) ProcFSSystemTunable(name, variable, min_value, max_value, on_change)).release_nonnull();
+}
+
 UNMAP_AFTER_INIT ProcFSDumpKmallocStacks::ProcFSDumpKmallocStacks()
     : ProcFSSystemBoolean("kmalloc_stacks"sv)
 {
@@ -380,6 +424,15 @@ UNMAP_AFTER_INIT ProcFSCapsLockRemap::ProcFSCapsLockRemap()
 {
 }
 
+UNMAP_AFTER_INIT ProcFSSystemTunable::ProcFSSystemTunable(StringView name, Atomic<u32>& variable, u32 min_value, u32 max_value, ChangeCallback on_change)
+    : ProcFSSystemUnsigned(name)
+    , m_variable(variable)
+    , m_min_value(min_value)
+    , m_max_value(max_value)
+    , m_on_change(on_change)
+{
+}
+
 class ProcFSSelfProcessDirectory final : public ProcFSExposedLink {
 public:
     static NonnullLockRefPtr<ProcFSSelfProcessDirectory> must_create();
@@ -444,6 +497,7 @@ private:
         get_kmalloc_stats(stats);
 
         auto system_memory = MM.get_system_memory_info();
+        auto huge_pages = MM.huge_page_statistics();
 
         auto json = TRY(JsonObjectSerializer<>::try_create(builder));
         TRY(json.add("kmalloc_allocated"sv, stats.bytes_allocated));
@@ -454,6 +508,31 @@ private:
         TRY(json.add("physical_uncommitted"sv, system_memory.physical_pages_uncommitted));
         TRY(json.add("kmalloc_call_count"sv, stats.kmalloc_call_count));
         TRY(json.add("kfree_call_count"sv, stats.kfree_call_count));
+        TRY(json.add("huge_pages_mapped"sv, huge_pages.mapped));
+        TRY(json.add("huge_pages_split"sv, huge_pages.split));
+        TRY(json.add("huge_page_allocation_failures"sv, huge_pages.allocation_failures));
+        TRY(json.finish());
+        return {};
+    }
+};
+
+class ProcFSDentryCache final : public ProcFSGlobalInformation {
+public:
+    static NonnullLockRefPtr<ProcFSDentryCache> must_create();
+
+private:
+    ProcFSDentryCache();
+    virtual ErrorOr<void> try_generate(KBufferBuilder& builder) override
+    {
+        auto statistics = DentryCache::the().statistics();
+        auto json = TRY(JsonObjectSerializer<>::try_create(builder));
+        TRY(json.add("hits"sv, statistics.hits));
+        TRY(json.add("negative_hits"sv, statistics.negative_hits));
+        TRY(json.add("misses"sv, statistics.misses));
+        TRY(json.add("invalidations"sv, statistics.invalidations));
+        TRY(json.add("entries"sv, statistics.entries));
+        TRY(json.add("negative_entries"sv, statistics.negative_entries));
+        TRY(json.add("capacity"sv, statistics.capacity));
         TRY(json.finish());
         return {};
     }
@@ -548,6 +627,7 @@ private:
             size_t amount_shared = 0;
             size_t amount_purgeable_volatile = 0;
             size_t amount_purgeable_nonvolatile = 0;
+            size_t amount_huge = 0;
 
             TRY(process.address_space().with([&](auto& space) -> ErrorOr<void> {
                 amount_virtual = space->amount_virtual();
@@ -557,6 +637,7 @@ private:
                 amount_shared = space->amount_shared();
                 amount_purgeable_volatile = space->amount_purgeable_volatile();
                 amount_purgeable_nonvolatile = space->amount_purgeable_nonvolatile();
+                amount_huge = space->amount_huge();
                 return {};
             }));
 
@@ -567,6 +648,7 @@ private:
             TRY(process_object.add("amount_shared"sv, amount_shared));
             TRY(process_object.add("amount_purgeable_volatile"sv, amount_purgeable_volatile));
             TRY(process_object.add("amount_purgeable_nonvolatile"sv, amount_purgeable_nonvolatile));
+            TRY(process_object.add("amount_huge"sv, amount_huge));
             TRY(process_object.add("dumpable"sv, process.is_dumpable()));
             TRY(process_object.add("kernel"sv, process.is_kernel_process()));
             auto thread_array = TRY(process_object.add_array("threads"sv));
@@ -829,7 +911,7 @@ private:
     {
         if (!g_global_perf_events)
             return ENOENT;
-        TRY(g_global_perf_events->to_json(builder));
+        TRY(g_global_perf_events->serialize(builder));
         return {};
     }
 };
@@ -864,6 +946,10 @@ UNMAP_AFTER_INIT NonnullLockRefPtr<ProcFSMemoryStatus> ProcFSMemoryStatus::must_
 {
     return adopt_lock_ref_if_nonnull(new (nothrow) ProcFSMemoryStatus).release_nonnull();
 }
+UNMAP_AFTER_INIT NonnullLockRefPtr<ProcFSDentryCache> ProcFSDentryCache::must_create()
+{
+    return adopt_lock_ref_if_nonnull(new (nothrow) ProcFSDentryCache).release_nonnull();
+}
 UNMAP_AFTER_INIT NonnullLockRefPtr<ProcFSSystemStatistics> ProcFSSystemStatistics::must_create()
 {
     return adopt_lock_ref_if_nonnull(new (nothrow) ProcFSSystemStatistics).release_nonnull();
@@ -926,6 +1012,10 @@ UNMAP_AFTER_INIT ProcFSMemoryStatus::ProcFSMemoryStatus()
     : ProcFSGlobalInformation("memstat"sv)
 {
 }
+UNMAP_AFTER_INIT ProcFSDentryCache::ProcFSDentryCache()
+    : ProcFSGlobalInformation("dentry_cache"sv)
+{
+}
 UNMAP_AFTER_INIT ProcFSSystemStatistics::ProcFSSystemStatistics()
     : ProcFSGlobalInformation("stat"sv)
 {
@@ -982,6 +1072,13 @@ UNMAP_AFTER_INIT NonnullLockRefPtr<ProcFSSystemDirectory> ProcFSSystemDirectory:
     directory->m_components.append(ProcFSDumpKmallocStacks::must_create(directory));
     directory->m_components.append(ProcFSUBSanDeadly::must_create(directory));
     directory->m_components.append(ProcFSCapsLockRemap::must_create(directory));
+    directory->m_components.append(ProcFSSystemTunable::must_create("writeback_interval_ms"sv, WritebackTask::interval_ms, 1, NumericLimits<u32>::max(), WritebackTask::wake));
+    directory->m_components.append(ProcFSSystemTunable::must_create("dirty_expire_ms"sv, WritebackTask::dirty_expire_ms, 0, NumericLimits<u32>::max(), WritebackTask::wake));
+    directory->m_components.append(ProcFSSystemTunable::must_create("dirty_ratio"sv, WritebackTask::dirty_ratio, 1, 100, WritebackTask::wake));
+    directory->m_components.append(ProcFSSystemTunable::must_create("tcp_congestion_control"sv, TCPCongestionControl::default_algorithm, 0, to_underlying(TCPCongestionControl::Algorithm::Cubic)));
+    directory->m_components.append(ProcFSSystemTunable::must_create("loopback_delay_ms"sv, LoopbackAdapter::delay_ms, 0, 10'000));
+    directory->m_components.append(ProcFSSystemTunable::must_create("loopback_loss_per_mille"sv, LoopbackAdapter::loss_per_mille, 0, 1000));
+    directory->m_components.append(ProcFSSystemTunable::must_create("transparent_huge_pages"sv, Memory::MemoryManager::transparent_huge_pages, 0, 1));
     return directory;
 }
 
@@ -996,6 +1093,7 @@ UNMAP_AFTER_INIT NonnullLockRefPtr<ProcFSRootDirectory> ProcFSRootDirectory::mus
     directory->m_components.append(ProcFSSelfProcessDirectory::must_create());
     directory->m_components.append(ProcFSDiskUsage::must_create());
     directory->m_components.append(ProcFSMemoryStatus::must_create());
+    directory->m_components.append(ProcFSDentryCache::must_create());
     directory->m_components.append(ProcFSSystemStatistics::must_create());
     directory->m_components.append(ProcFSOverallProcesses::must_create());
     directory->m_components.append(ProcFSCPUInformation::must_create());
@@ -5,8 +5,11 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/Atomic.h>
 #include <AK/Types.h>
+#include <Kernel/Arch/InterruptDisabler.h>
 #include <Kernel/Arch/PageDirectory.h>
+#include <Kernel/Arch/Processor.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Heap/Heap.h>
 #include <Kernel/Heap/kmalloc.h>
@@ -125,22 +128,7 @@ public:
 
     void* allocate()
     {
-        if (m_usable_blocks.is_empty()) {
-            // FIXME: This allocation wastes `block_size` bytes due to the implementation of kmalloc_aligned().
-            //        Handle this with a custom VM+page allocator instead of using kmalloc_aligned().
-            auto* slot = kmalloc_aligned(KmallocSlabBlock::block_size, KmallocSlabBlock::block_size);
-            if (!slot) {
-                // FIXME: Dare to return nullptr!
-                PANIC("OOM while growing slabheap ({})", m_slab_size);
-            }
-            auto* block = new (slot) KmallocSlabBlock(m_slab_size);
-            m_usable_blocks.append(*block);
-        }
-        auto* block = m_usable_blocks.first();
-        auto* ptr = block->allocate();
-        if (block->is_full())
-            m_full_blocks.append(*block);
-
+        auto* ptr = allocate_slab();
         memset(ptr, KMALLOC_SCRUB_BYTE, m_slab_size);
         return ptr;
     }
@@ -148,12 +136,20 @@ public:
     void deallocate(void* ptr)
     {
         memset(ptr, KFREE_SCRUB_BYTE, m_slab_size);
+        deallocate_slab(ptr);
+    }
 
-        auto* block = (KmallocSlabBlock*)((FlatPtr)ptr & KmallocSlabBlock::block_mask);
-        bool block_was_full = block->is_full();
-        block->deallocate(ptr);
-        if (block_was_full)
-            m_usable_blocks.append(*block);
+    // NOTE: The batch functions don't scrub the slabs, that's left to the per-processor caches.
+    void allocate_batch(void** slabs, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            slabs[i] = allocate_slab();
+    }
+
+    void deallocate_batch(void* const* slabs, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            deallocate_slab(slabs[i]);
     }
 
     size_t allocated_bytes() const
@@ -198,12 +194,43 @@ public:
     }
 
 private:
+    void* allocate_slab()
+    {
+        if (m_usable_blocks.is_empty()) {
+            // FIXME: This allocation wastes `block_size` bytes due to the implementation of kmalloc_aligned().
+            //        Handle this with a custom VM+page allocator instead of using kmalloc_aligned().
+            auto* slot = kmalloc_aligned(KmallocSlabBlock::block_size, KmallocSlabBlock::block_size);
+            if (!slot) {
+                // FIXME: Dare to return nullptr!
+                PANIC("OOM while growing slabheap ({})", m_slab_size);
+            }
+            auto* block = new (slot) KmallocSlabBlock(m_slab_size);
+            m_usable_blocks.append(*block);
+        }
+        auto* block = m_usable_blocks.first();
+        auto* ptr = block->allocate();
+        if (block->is_full())
+            m_full_blocks.append(*block);
+        return ptr;
+    }
+
+    void deallocate_slab(void* ptr)
+    {
+        auto* block = (KmallocSlabBlock*)((FlatPtr)ptr & KmallocSlabBlock::block_mask);
+        bool block_was_full = block->is_full();
+        block->deallocate(ptr);
+        if (block_was_full)
+            m_usable_blocks.append(*block);
+    }
+
     size_t m_slab_size { 0 };
 
     KmallocSlabBlock::List m_usable_blocks;
     KmallocSlabBlock::List m_full_blocks;
 };
 
+static void reclaim_processor_caches();
+
 struct KmallocGlobalData {
     static constexpr size_t minimum_subheap_size = 1 * MiB;
 
@@ -238,6 +265,7 @@ struct KmallocGlobalData {
         if (size <= KmallocSlabBlock::block_size * 2 + sizeof(ptrdiff_t) + sizeof(size_t)) {
             // FIXME: We should propagate a freed pointer, to find the specific subheap it belonged to
             //        This would save us iterating over them in the next step and remove a recursion
+            reclaim_processor_caches();
             bool did_purge = false;
             for (auto& slabheap : slabheaps) {
                 if (slabheap.try_purge()) {
@@ -392,7 +420,16 @@ struct KmallocGlobalData {
 
     KmallocSubheap::List subheaps;
 
-    KmallocSlabheap slabheaps[6] = { 16, 32, 64, 128, 256, 512 };
+    KmallocSlabheap slabheaps[kmalloc_slabheap_count] = { 16, 32, 64, 128, 256, 512 };
+
+    Optional<size_t> slabheap_index_for_size(size_t size) const
+    {
+        for (size_t i = 0; i < kmalloc_slabheap_count; ++i) {
+            if (size <= slabheaps[i].slab_size())
+                return i;
+        }
+        return {};
+    }
 
     bool expansion_in_progress { false };
 };
@@ -405,6 +442,130 @@ static size_t g_kfree_call_count;
 static size_t g_nested_kfree_calls;
 bool g_dump_kmalloc_stacks;
 
+// A small stack of free slabs of one size class, owned by a single processor.
+// It is refilled from and flushed to the shared slabheap in batches of half its
+// capacity, so alternating kmalloc/kfree calls never bounce off the global lock.
+struct KmallocSlabMagazine {
+    static constexpr size_t capacity = 32;
+    static constexpr size_t batch_size = capacity / 2;
+
+    size_t count { 0 };
+    void* slabs[capacity];
+
+    u64 allocation_hits { 0 };
+    u64 allocation_misses { 0 };
+    u64 deallocation_hits { 0 };
+    u64 deallocation_flushes { 0 };
+};
+
+struct KmallocProcessorCache {
+    static ProcessorSpecificDataID processor_specific_data_id() { return ProcessorSpecificDataID::KmallocCache; }
+
+    KmallocSlabMagazine magazines[kmalloc_slabheap_count];
+
+    size_t kmalloc_call_count { 0 };
+    size_t kfree_call_count { 0 };
+    size_t nested_kfree_calls { 0 };
+
+    // Set by other processors when the heap runs short, so that we give our cached slabs back.
+    Atomic<bool> drain_requested { false };
+
+    IntrusiveListNode<KmallocProcessorCache> list_node;
+    using List = IntrusiveList<&KmallocProcessorCache::list_node>;
+};
+
+// All processor caches, so their statistics can be collected and they can be asked to drain. Protected by s_lock.
+static KmallocProcessorCache::List s_processor_caches;
+
+// NOTE: Callers must have interrupts disabled, as the cache may only be touched by its own processor.
+static KmallocProcessorCache* current_processor_cache()
+{
+    if (!Processor::is_initialized())
+        return nullptr;
+    return Processor::current().get_specific<KmallocProcessorCache>();
+}
+
+static void* allocate_from_processor_cache(KmallocProcessorCache& cache, size_t slabheap_index)
+{
+    auto& magazine = cache.magazines[slabheap_index];
+    auto& slabheap = g_kmalloc_global->slabheaps[slabheap_index];
+
+    if (magazine.count == 0) {
+        ++magazine.allocation_misses;
+        SpinlockLocker lock(s_lock);
+        slabheap.allocate_batch(magazine.slabs, KmallocSlabMagazine::batch_size);
+        magazine.count = KmallocSlabMagazine::batch_size;
+    } else {
+        ++magazine.allocation_hits;
+    }
+
+    auto* ptr = magazine.slabs[--magazine.count];
+    memset(ptr, KMALLOC_SCRUB_BYTE, slabheap.slab_size());
+    return ptr;
+}
+
+static void deallocate_to_processor_cache(KmallocProcessorCache& cache, size_t slabheap_index, void* ptr)
+{
+    auto& magazine = cache.magazines[slabheap_index];
+    auto& slabheap = g_kmalloc_global->slabheaps[slabheap_index];
+
+    memset(ptr, KFREE_SCRUB_BYTE, slabheap.slab_size());
+
+    if (magazine.count == KmallocSlabMagazine::capacity) {
+        ++magazine.deallocation_flushes;
+        // Return the oldest half of the magazine, keeping the most recently freed (and likely cache-hot) slabs.
+        SpinlockLocker lock(s_lock);
+        slabheap.deallocate_batch(magazine.slabs, KmallocSlabMagazine::batch_size);
+        memmove(magazine.slabs, &magazine.slabs[KmallocSlabMagazine::batch_size], (magazine.count - KmallocSlabMagazine::batch_size) * sizeof(void*));
+        magazine.count -= KmallocSlabMagazine::batch_size;
+    } else {
+        ++magazine.deallocation_hits;
+    }
+
+    magazine.slabs[magazine.count++] = ptr;
+}
+
+// Gives every cached slab back to the slabheaps. Must be called on the processor that owns the cache, with s_lock held.
+static void drain_processor_cache(KmallocProcessorCache& cache)
+{
+    VERIFY(s_lock.is_locked_by_current_processor());
+    cache.drain_requested.store(false, AK::MemoryOrder::memory_order_relaxed);
+    for (size_t i = 0; i < kmalloc_slabheap_count; ++i) {
+        auto& magazine = cache.magazines[i];
+        g_kmalloc_global->slabheaps[i].deallocate_batch(magazine.slabs, magazine.count);
+        magazine.count = 0;
+    }
+}
+
+// Called with s_lock held when the heap is about to grow, so that slabs pinned in the processor caches can be purged
+// instead. We can only touch our own cache, so the other processors drain theirs on their next kmalloc/kfree, or when idle.
+static void reclaim_processor_caches()
+{
+    VERIFY(s_lock.is_locked_by_current_processor());
+    auto* current_cache = current_processor_cache();
+    for (auto& cache : s_processor_caches) {
+        if (&cache == current_cache)
+            drain_processor_cache(cache);
+        else
+            cache.drain_requested.store(true, AK::MemoryOrder::memory_order_relaxed);
+    }
+}
+
+static void drain_processor_cache_if_requested(KmallocProcessorCache& cache)
+{
+    if (!cache.drain_requested.load(AK::MemoryOrder::memory_order_relaxed))
+        return;
+    SpinlockLocker lock(s_lock);
+    drain_processor_cache(cache);
+}
+
+void kmalloc_drain_processor_cache_if_requested()
+{
+    InterruptDisabler disabler;
+    if (auto* cache = current_processor_cache())
+        drain_processor_cache_if_requested(*cache);
+}
+
 void kmalloc_enable_expand()
 {
     g_kmalloc_global->enable_expansion();
@@ -427,19 +588,16 @@ UNMAP_AFTER_INIT void kmalloc_init()
     s_lock.initialize();
 }
 
-void* kmalloc(size_t size)
+UNMAP_AFTER_INIT void kmalloc_enable_processor_cache()
 {
-    kmalloc_verify_nospinlock_held();
-    SpinlockLocker lock(s_lock);
-    ++g_kmalloc_call_count;
+    ProcessorSpecific<KmallocProcessorCache>::initialize();
 
-    if (g_dump_kmalloc_stacks && Kernel::g_kernel_symbols_available) {
-        dbgln("kmalloc({})", size);
-        Kernel::dump_backtrace();
-    }
-
-    void* ptr = g_kmalloc_global->allocate(size);
+    SpinlockLocker lock(s_lock);
+    s_processor_caches.append(*Processor::current().get_specific<KmallocProcessorCache>());
+}
 
+static void add_kmalloc_perf_event(size_t size, void* ptr)
+{
     Thread* current_thread = Thread::current();
     if (!current_thread)
         current_thread = Processor::idle_thread();
@@ -449,7 +607,44 @@ void* kmalloc(size_t size)
         VERIFY(current_thread->is_allocation_enabled());
         PerformanceManager::add_kmalloc_perf_event(*current_thread, size, (FlatPtr)ptr);
     }
+}
 
+static void add_kfree_perf_event(void* ptr)
+{
+    Thread* current_thread = Thread::current();
+    if (!current_thread)
+        current_thread = Processor::idle_thread();
+    if (current_thread) {
+        VERIFY(current_thread->is_allocation_enabled());
+        PerformanceManager::add_kfree_perf_event(*current_thread, 0, (FlatPtr)ptr);
+    }
+}
+
+void* kmalloc(size_t size)
+{
+    kmalloc_verify_nospinlock_held();
+
+    if (g_dump_kmalloc_stacks && Kernel::g_kernel_symbols_available) {
+        dbgln("kmalloc({})", size);
+        Kernel::dump_backtrace();
+    }
+
+    if (auto slabheap_index = g_kmalloc_global->slabheap_index_for_size(size); slabheap_index.has_value()) {
+        InterruptDisabler disabler;
+        if (auto* cache = current_processor_cache()) {
+            drain_processor_cache_if_requested(*cache);
+            ++cache->kmalloc_call_count;
+            void* ptr = allocate_from_processor_cache(*cache, slabheap_index.value());
+            add_kmalloc_perf_event(size, ptr);
+            return ptr;
+        }
+    }
+
+    SpinlockLocker lock(s_lock);
+    ++g_kmalloc_call_count;
+
+    void* ptr = g_kmalloc_global->allocate(size);
+    add_kmalloc_perf_event(size, ptr);
     return ptr;
 }
 
@@ -473,19 +668,27 @@ void kfree_sized(void* ptr, size_t size)
     VERIFY(size > 0);
 
     kmalloc_verify_nospinlock_held();
+
+    if (auto slabheap_index = g_kmalloc_global->slabheap_index_for_size(size); slabheap_index.has_value()) {
+        InterruptDisabler disabler;
+        if (auto* cache = current_processor_cache()) {
+            VERIFY(g_kmalloc_global->is_valid_kmalloc_address(VirtualAddress { ptr }));
+            drain_processor_cache_if_requested(*cache);
+            ++cache->kfree_call_count;
+            if (++cache->nested_kfree_calls == 1)
+                add_kfree_perf_event(ptr);
+            deallocate_to_processor_cache(*cache, slabheap_index.value(), ptr);
+            --cache->nested_kfree_calls;
+            return;
+        }
+    }
+
     SpinlockLocker lock(s_lock);
     ++g_kfree_call_count;
     ++g_nested_kfree_calls;
 
-    if (g_nested_kfree_calls == 1) {
-        Thread* current_thread = Thread::current();
-        if (!current_thread)
-            current_thread = Processor::idle_thread();
-        if (current_thread) {
-            VERIFY(current_thread->is_allocation_enabled());
-            PerformanceManager::add_kfree_perf_event(*current_thread, 0, (FlatPtr)ptr);
-        }
-    }
+    if (g_nested_kfree_calls == 1)
+        add_kfree_perf_event(ptr);
 
     g_kmalloc_global->deallocate(ptr, size);
     --g_nested_kfree_calls;
@@ -587,4 +790,35 @@ void get_kmalloc_stats(kmalloc_stats& stats)
     stats.bytes_free = g_kmalloc_global->free_bytes();
     stats.kmalloc_call_count = g_kmalloc_call_count;
     stats.kfree_call_count = g_kfree_call_count;
+
+    // NOTE: The per-processor counters are read without synchronization, so they may be slightly stale.
+    for (auto const& cache : s_processor_caches) {
+        stats.kmalloc_call_count += cache.kmalloc_call_count;
+        stats.kfree_call_count += cache.kfree_call_count;
+        for (size_t i = 0; i < kmalloc_slabheap_count; ++i) {
+            // Slabs sitting in a magazine are allocated as far as the slabheap is concerned.
+            auto cached_bytes = cache.magazines[i].count * g_kmalloc_global->slabheaps[i].slab_size();
+            stats.bytes_allocated -= cached_bytes;
+            stats.bytes_free += cached_bytes;
+        }
+    }
+}
+
+void get_kmalloc_slab_stats(kmalloc_slab_stats (&slab_stats)[kmalloc_slabheap_count])
+{
+    for (size_t i = 0; i < kmalloc_slabheap_count; ++i)
+        slab_stats[i] = { .slab_size = g_kmalloc_global->slabheaps[i].slab_size() };
+
+    // NOTE: The per-processor counters are read without synchronization, so they may be slightly stale.
+    SpinlockLocker lock(s_lock);
+    for (auto const& cache : s_processor_caches) {
+        for (size_t i = 0; i < kmalloc_slabheap_count; ++i) {
+            auto const& magazine = cache.magazines[i];
+            slab_stats[i].allocation_cache_hits += magazine.allocation_hits;
+            slab_stats[i].allocation_cache_misses += magazine.allocation_misses;
+            slab_stats[i].free_cache_hits += magazine.deallocation_hits;
+            slab_stats[i].free_cache_flushes += magazine.deallocation_flushes;
+            slab_stats[i].cached_slabs += magazine.count;
+        }
+    }
 }
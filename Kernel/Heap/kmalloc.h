@@ -50,6 +50,18 @@ struct kmalloc_stats {
 };
 void get_kmalloc_stats(kmalloc_stats&);
 
+constexpr size_t kmalloc_slabheap_count = 6;
+
+struct kmalloc_slab_stats {
+    size_t slab_size { 0 };
+    u64 allocation_cache_hits { 0 };
+    u64 allocation_cache_misses { 0 };
+    u64 free_cache_hits { 0 };
+    u64 free_cache_flushes { 0 };
+    size_t cached_slabs { 0 };
+};
+void get_kmalloc_slab_stats(kmalloc_slab_stats (&)[kmalloc_slabheap_count]);
+
 extern bool g_dump_kmalloc_stacks;
 
 inline void* operator new(size_t, void* p) { return p; }
@@ -86,3 +98,5 @@ inline void kfree_aligned(void* ptr)
 size_t kmalloc_good_size(size_t);
 
 void kmalloc_enable_expand();
+void kmalloc_enable_processor_cache();
+void kmalloc_drain_processor_cache_if_requested();
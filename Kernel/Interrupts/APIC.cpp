@@ -10,6 +10,7 @@
 #include <AK/Types.h>
 #include <Kernel/Arch/x86/IO.h>
 #include <Kernel/Arch/x86/MSR.h>
+#include <Kernel/Arch/x86/PerformanceCounters.h>
 #include <Kernel/Arch/x86/ProcessorInfo.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Firmware/ACPI/Parser.h>
@@ -25,6 +26,7 @@
 #include <Kernel/Thread.h>
 #include <Kernel/Time/APICTimer.h>
 
+#define IRQ_APIC_PERFORMANCE_COUNTER (0xfb - IRQ_VECTOR_BASE)
 #define IRQ_APIC_TIMER (0xfc - IRQ_VECTOR_BASE)
 #define IRQ_APIC_IPI (0xfd - IRQ_VECTOR_BASE)
 #define IRQ_APIC_ERR (0xfe - IRQ_VECTOR_BASE)
@@ -121,6 +123,37 @@ public:
 private:
 };
 
+class APICPerformanceCounterInterruptHandler final : public GenericInterruptHandler {
+public:
+    explicit APICPerformanceCounterInterruptHandler(u8 interrupt_vector)
+        : GenericInterruptHandler(interrupt_vector, true)
+    {
+    }
+    virtual ~APICPerformanceCounterInterruptHandler()
+    {
+    }
+
+    static void initialize(u8 interrupt_number)
+    {
+        auto* handler = new APICPerformanceCounterInterruptHandler(interrupt_number);
+        handler->register_interrupt_handler();
+    }
+
+    virtual bool handle_interrupt(RegisterState const&) override;
+
+    virtual bool eoi() override;
+
+    virtual HandlerType type() const override { return HandlerType::IRQHandler; }
+    virtual StringView purpose() const override { return "Performance Counter Handler"sv; }
+    virtual StringView controller() const override { return {}; }
+
+    virtual size_t sharing_devices_count() const override { return 0; }
+    virtual bool is_shared_handler() const override { return false; }
+    virtual bool is_sharing_with_others() const override { return false; }
+
+private:
+};
+
 bool APIC::initialized()
 {
     return s_apic.is_initialized();
@@ -492,6 +525,8 @@ UNMAP_AFTER_INIT void APIC::enable(u32 cpu)
 
         // register IPI interrupt vector
         APICIPIInterruptHandler::initialize(IRQ_APIC_IPI);
+
+        APICPerformanceCounterInterruptHandler::initialize(IRQ_APIC_PERFORMANCE_COUNTER);
     }
 
     if (!m_is_x2) {
@@ -507,13 +542,19 @@ UNMAP_AFTER_INIT void APIC::enable(u32 cpu)
 
     write_register(APIC_REG_LVT_TIMER, APIC_LVT(0, 0) | APIC_LVT_MASKED);
     write_register(APIC_REG_LVT_THERMAL, APIC_LVT(0, 0) | APIC_LVT_MASKED);
-    write_register(APIC_REG_LVT_PERFORMANCE_COUNTER, APIC_LVT(0, 0) | APIC_LVT_MASKED);
+    enable_performance_counter_interrupt();
     write_register(APIC_REG_LVT_LINT0, APIC_LVT(0, 7) | APIC_LVT_MASKED);
     write_register(APIC_REG_LVT_LINT1, APIC_LVT(0, 0) | APIC_LVT_TRIGGER_LEVEL);
 
     write_register(APIC_REG_TPR, 0);
 }
 
+void APIC::enable_performance_counter_interrupt()
+{
+    // The processor masks this entry whenever it delivers the interrupt, so it has to be unmasked again after each one.
+    write_register(APIC_REG_LVT_PERFORMANCE_COUNTER, APIC_LVT(IRQ_APIC_PERFORMANCE_COUNTER + IRQ_VECTOR_BASE, 0));
+}
+
 Thread* APIC::get_idle_thread(u32 cpu) const
 {
     VERIFY(cpu > 0);
@@ -666,6 +707,19 @@ bool APICErrInterruptHandler::eoi()
     return true;
 }
 
+bool APICPerformanceCounterInterruptHandler::handle_interrupt(RegisterState const& regs)
+{
+    PerformanceCounters::handle_overflow(regs);
+    APIC::the().enable_performance_counter_interrupt();
+    return true;
+}
+
+bool APICPerformanceCounterInterruptHandler::eoi()
+{
+    APIC::the().eoi();
+    return true;
+}
+
 bool HardwareTimer<GenericInterruptHandler>::eoi()
 {
     APIC::the().eoi();
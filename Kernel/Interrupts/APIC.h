@@ -32,6 +32,7 @@ public:
     void init_finished(u32 cpu);
     void broadcast_ipi();
     void send_ipi(u32 cpu);
+    void enable_performance_counter_interrupt();
     static u8 spurious_interrupt_vector();
     Thread* get_idle_thread(u32 cpu) const;
     u32 enabled_processor_count() const { return m_processor_enabled_cnt; }
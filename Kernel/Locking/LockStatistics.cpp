@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BuiltinWrappers.h>
+#include <AK/HashFunctions.h>
+#include <AK/JsonArraySerializer.h>
+#include <AK/JsonObjectSerializer.h>
+#include <AK/QuickSort.h>
+#include <AK/StringHash.h>
+#include <AK/Vector.h>
+#include <Kernel/KBufferBuilder.h>
+#include <Kernel/Locking/LockStatistics.h>
+#include <Kernel/Locking/Spinlock.h>
+
+namespace Kernel {
+
+// Bucket 0 counts waits shorter than a microsecond, bucket N waits of [2^(N-1), 2^N) microseconds,
+// and the last bucket everything from about half a second up.
+static constexpr size_t wait_time_bucket_count = 20;
+static constexpr size_t max_name_length = 32;
+static constexpr size_t max_entries = 256;
+
+struct LockStatisticsEntry {
+    bool in_use { false };
+    u8 name_length { 0 };
+    char name[max_name_length];
+#if LOCK_DEBUG
+    StringView file;
+    u32 line { 0 };
+#endif
+    u64 contended_count { 0 };
+    u64 acquired_by_spinning_count { 0 };
+    u64 total_wait_us { 0 };
+    u64 max_wait_us { 0 };
+    u64 wait_time_histogram[wait_time_bucket_count] {};
+
+    StringView name_view() const { return { name, name_length }; }
+};
+
+Atomic<bool> LockStatistics::s_enabled;
+
+static Spinlock s_lock { LockRank::None };
+static LockStatisticsEntry s_entries[max_entries];
+// Contentions that didn't fit into the table anymore.
+static u64 s_dropped_count;
+
+static size_t wait_time_bucket(u64 wait_us)
+{
+    if (wait_us == 0)
+        return 0;
+    return min<size_t>(sizeof(u64) * 8 - count_leading_zeroes(wait_us), wait_time_bucket_count - 1);
+}
+
+static LockStatisticsEntry* find_or_create_entry(StringView name, [[maybe_unused]] LockLocation const& location)
+{
+    VERIFY(s_lock.is_locked());
+    name = name.substring_view(0, min(name.length(), max_name_length));
+    auto hash = string_hash(name.characters_without_null_termination(), name.length());
+#if LOCK_DEBUG
+    hash = pair_int_hash(hash, pair_int_hash(ptr_hash(location.filename().characters_without_null_termination()), location.line_number()));
+#endif
+
+    for (size_t probe = 0; probe < max_entries; ++probe) {
+        auto& entry = s_entries[(hash + probe) % max_entries];
+        if (!entry.in_use) {
+            entry.in_use = true;
+            entry.name_length = name.length();
+            __builtin_memcpy(entry.name, name.characters_without_null_termination(), name.length());
+#if LOCK_DEBUG
+            entry.file = location.filename();
+            entry.line = location.line_number();
+#endif
+            return &entry;
+        }
+#if LOCK_DEBUG
+        if (entry.line != location.line_number() || entry.file != location.filename())
+            continue;
+#endif
+        if (entry.name_view() == name)
+            return &entry;
+    }
+    return nullptr;
+}
+
+void LockStatistics::set_enabled(bool enabled)
+{
+    SpinlockLocker locker(s_lock);
+    if (enabled) {
+        for (auto& entry : s_entries)
+            entry = {};
+        s_dropped_count = 0;
+    }
+    s_enabled = enabled;
+}
+
+void LockStatistics::record_contention(StringView name, LockLocation const& location, Time wait_time, bool acquired_by_spinning)
+{
+    auto wait_us = static_cast<u64>(max<i64>(wait_time.to_microseconds(), 0));
+
+    SpinlockLocker locker(s_lock);
+    if (!is_enabled())
+        return;
+    auto* entry = find_or_create_entry(name, location);
+    if (!entry) {
+        ++s_dropped_count;
+        return;
+    }
+    ++entry->contended_count;
+    if (acquired_by_spinning)
+        ++entry->acquired_by_spinning_count;
+    entry->total_wait_us += wait_us;
+    entry->max_wait_us = max(entry->max_wait_us, wait_us);
+    ++entry->wait_time_histogram[wait_time_bucket(wait_us)];
+}
+
+ErrorOr<void> LockStatistics::try_generate(KBufferBuilder& builder)
+{
+    // Take a snapshot first, so that we don't allocate while holding the spinlock.
+    Vector<LockStatisticsEntry> entries;
+    TRY(entries.try_ensure_capacity(max_entries));
+    bool enabled;
+    u64 dropped_count;
+    {
+        SpinlockLocker locker(s_lock);
+        enabled = is_enabled();
+        dropped_count = s_dropped_count;
+        for (auto const& entry : s_entries) {
+            if (entry.in_use)
+                entries.unchecked_append(entry);
+        }
+    }
+    quick_sort(entries, [](auto const& a, auto const& b) { return a.total_wait_us > b.total_wait_us; });
+
+    auto json = TRY(JsonObjectSerializer<>::try_create(builder));
+    TRY(json.add("enabled"sv, enabled));
+    TRY(json.add("dropped"sv, dropped_count));
+    auto array = TRY(json.add_array("locks"sv));
+    for (auto const& entry : entries) {
+        auto obj = TRY(array.add_object());
+        TRY(obj.add("name"sv, entry.name_view()));
+#if LOCK_DEBUG
+        TRY(obj.add("file"sv, entry.file));
+        TRY(obj.add("line"sv, entry.line));
+#endif
+        TRY(obj.add("contended"sv, entry.contended_count));
+        TRY(obj.add("acquired_by_spinning"sv, entry.acquired_by_spinning_count));
+        TRY(obj.add("total_wait_us"sv, entry.total_wait_us));
+        TRY(obj.add("max_wait_us"sv, entry.max_wait_us));
+        auto histogram = TRY(obj.add_array("wait_us_histogram"sv));
+        for (auto count : entry.wait_time_histogram)
+            TRY(histogram.add(count));
+        TRY(histogram.finish());
+        TRY(obj.finish());
+    }
+    TRY(array.finish());
+    TRY(json.finish());
+    return {};
+}
+
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Error.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+#include <Kernel/Locking/LockLocation.h>
+
+namespace Kernel {
+
+class KBufferBuilder;
+
+// Counts how often each Mutex had to wait for another thread, and for how long. Locks are
+// told apart by their name, and also by the location they were locked from if LOCK_DEBUG
+// is enabled. Nothing is recorded unless statistics have been enabled via /sys/kernel/lock_statistics.
+class LockStatistics {
+public:
+    static bool is_enabled() { return s_enabled.load(AK::MemoryOrder::memory_order_relaxed); }
+
+    // Enabling also throws away everything that was recorded before.
+    static void set_enabled(bool);
+
+    static void record_contention(StringView name, LockLocation const&, Time wait_time, bool acquired_by_spinning);
+
+    static ErrorOr<void> try_generate(KBufferBuilder&);
+
+private:
+    static Atomic<bool> s_enabled;
+};
+
+}
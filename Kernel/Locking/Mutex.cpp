@@ -5,12 +5,15 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ScopeGuard.h>
 #include <Kernel/Debug.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Locking/LockLocation.h>
+#include <Kernel/Locking/LockStatistics.h>
 #include <Kernel/Locking/Mutex.h>
 #include <Kernel/Locking/Spinlock.h>
 #include <Kernel/Thread.h>
+#include <Kernel/Time/TimeManagement.h>
 
 extern bool g_in_early_boot;
 
@@ -29,8 +32,22 @@ void Mutex::lock(Mode mode, [[maybe_unused]] LockLocation const& location)
     VERIFY(mode != Mode::Unlocked);
     auto* current_thread = Thread::current();
 
-    SpinlockLocker lock(m_lock);
     bool did_block = false;
+    Optional<Time> contention_start;
+    ScopeGuard record_contention = [&] {
+        if (contention_start.has_value())
+            LockStatistics::record_contention(m_name, location, TimeManagement::the().monotonic_time(TimePrecision::Precise) - contention_start.value(), !did_block);
+    };
+
+    SpinlockLocker lock(m_lock);
+    bool is_contended = (m_mode == Mode::Exclusive && m_holder != current_thread) || (m_mode == Mode::Shared && mode == Mode::Exclusive);
+    if (is_contended) {
+        if (LockStatistics::is_enabled())
+            contention_start = TimeManagement::the().monotonic_time(TimePrecision::Precise);
+        if (m_mode == Mode::Exclusive)
+            spin_while_holder_is_running(lock);
+    }
+
     Mode current_mode = m_mode;
     switch (current_mode) {
     case Mode::Unlocked: {
@@ -247,6 +264,37 @@ void Mutex::block(Thread& current_thread, Mode mode, SpinlockLocker<Spinlock>& l
     });
 }
 
+void Mutex::spin_while_holder_is_running(SpinlockLocker<Spinlock>& lock)
+{
+    VERIFY(m_mode == Mode::Exclusive);
+    VERIFY(m_holder);
+
+    // The holder can only release the lock while it is running on another processor, in which case
+    // it is usually about to do so, and waiting a little is a lot cheaper than blocking and being
+    // woken up again. Threads that are already blocked on the lock get it handed over directly
+    // without it ever being unlocked, so we wouldn't get anywhere by spinning behind them.
+    static constexpr size_t max_spin_iterations = 2000;
+
+    if (Processor::count() == 1 || !Thread::current())
+        return;
+    bool has_blocked_threads = m_blocked_thread_lists.with([](auto& lists) {
+        return !lists.exclusive.is_empty() || !lists.shared.is_empty() || !lists.exclusive_big_lock.is_empty();
+    });
+    if (has_blocked_threads)
+        return;
+
+    LockRefPtr<Thread> holder = m_holder;
+    lock.unlock();
+    for (size_t i = 0; i < max_spin_iterations; ++i) {
+        if (AK::atomic_load(&m_mode, AK::MemoryOrder::memory_order_relaxed) == Mode::Unlocked)
+            break;
+        if (AK::atomic_load(&holder->m_state, AK::MemoryOrder::memory_order_relaxed) != Thread::State::Running)
+            break;
+        Processor::wait_check();
+    }
+    lock.lock();
+}
+
 void Mutex::unblock_waiters(Mode previous_mode)
 {
     VERIFY(m_times_locked == 0);
@@ -338,7 +386,19 @@ void Mutex::restore_exclusive_lock(u32 lock_count, [[maybe_unused]] LockLocation
 
     auto* current_thread = Thread::current();
     bool did_block = false;
+    Optional<Time> contention_start;
+    ScopeGuard record_contention = [&] {
+        if (contention_start.has_value())
+            LockStatistics::record_contention(m_name, location, TimeManagement::the().monotonic_time(TimePrecision::Precise) - contention_start.value(), !did_block);
+    };
+
     SpinlockLocker lock(m_lock);
+    if (m_mode == Mode::Exclusive && m_holder != current_thread) {
+        if (LockStatistics::is_enabled())
+            contention_start = TimeManagement::the().monotonic_time(TimePrecision::Precise);
+        spin_while_holder_is_running(lock);
+    }
+
     [[maybe_unused]] auto previous_mode = m_mode;
     if (m_mode == Mode::Exclusive && m_holder != current_thread) {
         block(*current_thread, Mode::Exclusive, lock, lock_count);
@@ -83,6 +83,7 @@ private:
     using BigLockBlockedThreadList = IntrusiveList<&Thread::m_big_lock_blocked_threads_list_node>;
 
     void block(Thread&, Mode, SpinlockLocker<Spinlock>&, u32);
+    void spin_while_holder_is_running(SpinlockLocker<Spinlock>&);
     void unblock_waiters(Mode);
 
     StringView m_name;
@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ScopeGuard.h>
 #include <Kernel/API/MemoryLayout.h>
 #include <Kernel/Arch/CPU.h>
 #include <Kernel/Locking/Spinlock.h>
@@ -73,7 +74,13 @@ ErrorOr<void> AddressSpace::unmap_mmap_range(VirtualAddress addr, size_t size)
         // Remove the old region from our regions tree, since were going to add another region
         // with the exact same start address.
         auto region = take_region(*old_region);
-        region->unmap();
+        region->unmap(ShouldFlushTLB::No);
+
+        // The pages that are still mapped don't change, so a single flush after remapping is enough.
+        // It has to happen before the old region goes away, as other processors may still cache its pages.
+        ScopeGuard flush_tlb_guard = [&] {
+            MemoryManager::flush_tlb(&page_directory(), region->vaddr(), region->page_count());
+        };
 
         auto new_regions = TRY(try_split_region_around_range(*region, range_to_unmap));
 
@@ -81,7 +88,7 @@ ErrorOr<void> AddressSpace::unmap_mmap_range(VirtualAddress addr, size_t size)
         for (auto* new_region : new_regions) {
             // TODO: Ideally we should do this in a way that can be rolled back on failure, as failing here
             // leaves the caller in an undefined state.
-            TRY(new_region->map(page_directory()));
+            TRY(new_region->map(page_directory(), ShouldFlushTLB::No));
         }
 
         PerformanceManager::add_unmap_perf_event(Process::current(), range_to_unmap);
@@ -103,20 +110,35 @@ ErrorOr<void> AddressSpace::unmap_mmap_range(VirtualAddress addr, size_t size)
 
     Vector<Region*, 2> new_regions;
 
+    // Instead of flushing the TLB once per region, all of them are unmapped first and a single
+    // flush covering the whole span is done at the end. The old regions are kept alive until then.
+    Vector<NonnullOwnPtr<Region>, 2> unmapped_regions;
+    TRY(unmapped_regions.try_ensure_capacity(regions.size()));
+    auto flush_range_base = regions.first()->vaddr();
+    auto flush_range_end = regions.last()->range().end();
+    ScopeGuard flush_tlb_guard = [&] {
+        MemoryManager::flush_tlb(&page_directory(), flush_range_base, (flush_range_end.get() - flush_range_base.get()) / PAGE_SIZE);
+    };
+
     for (auto* old_region : regions) {
+        // Remove the old region from our regions tree, since we're either going to get rid of it
+        // or add another region with the exact same start address.
+        auto region = take_region(*old_region);
+
         // If it's a full match we can remove the entire old region.
-        if (old_region->range().intersect(range_to_unmap).size() == old_region->size()) {
-            deallocate_region(*old_region);
+        if (region->range().intersect(range_to_unmap).size() == region->size()) {
+            // "PROT_NONE" regions were never mapped in the first place.
+            if (region->is_readable() || region->is_writable() || region->is_executable())
+                region->unmap(ShouldFlushTLB::No);
+            unmapped_regions.unchecked_append(move(region));
             continue;
         }
 
-        // Remove the old region from our regions tree, since were going to add another region
-        // with the exact same start address.
-        auto region = take_region(*old_region);
-        region->unmap();
+        region->unmap(ShouldFlushTLB::No);
+        unmapped_regions.unchecked_append(move(region));
 
         // Otherwise, split the regions and collect them for future mapping.
-        auto split_regions = TRY(try_split_region_around_range(*region, range_to_unmap));
+        auto split_regions = TRY(try_split_region_around_range(*unmapped_regions.last(), range_to_unmap));
         TRY(new_regions.try_extend(split_regions));
     }
 
@@ -124,7 +146,7 @@ ErrorOr<void> AddressSpace::unmap_mmap_range(VirtualAddress addr, size_t size)
     for (auto* new_region : new_regions) {
         // TODO: Ideally we should do this in a way that can be rolled back on failure, as failing here
         // leaves the caller in an undefined state.
-        TRY(new_region->map(page_directory()));
+        TRY(new_region->map(page_directory(), ShouldFlushTLB::No));
     }
 
     PerformanceManager::add_unmap_perf_event(Process::current(), range_to_unmap);
@@ -417,4 +439,9 @@ size_t AddressSpace::amount_purgeable_nonvolatile() const
     return amount;
 }
 
+size_t AddressSpace::amount_huge() const
+{
+    return m_page_directory->huge_page_count() * HUGE_PAGE_SIZE;
+}
+
 }
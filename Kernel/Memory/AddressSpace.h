@@ -60,6 +60,7 @@ public:
     size_t amount_shared() const;
     size_t amount_purgeable_volatile() const;
     size_t amount_purgeable_nonvolatile() const;
+    size_t amount_huge() const;
 
 private:
     AddressSpace(NonnullLockRefPtr<PageDirectory>, VirtualRange total_range);
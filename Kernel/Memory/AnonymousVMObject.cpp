@@ -276,6 +276,36 @@ NonnullRefPtr<PhysicalPage> AnonymousVMObject::allocate_committed_page(Badge<Reg
     return m_unused_committed_pages->take_one();
 }
 
+bool AnonymousVMObject::is_untouched(size_t first_page_index, size_t page_count) const
+{
+    VERIFY(m_lock.is_locked_by_current_processor());
+    VERIFY(first_page_index + page_count <= this->page_count());
+    for (size_t i = first_page_index; i < first_page_index + page_count; ++i) {
+        auto const& page = physical_pages()[i];
+        if (!page || !(page->is_shared_zero_page() || page->is_lazy_committed_page()))
+            return false;
+    }
+    return true;
+}
+
+bool AnonymousVMObject::try_replace_untouched_pages(Badge<Region>, size_t first_page_index, NonnullRefPtrVector<PhysicalPage>& new_pages)
+{
+    VERIFY(m_lock.is_locked_by_current_processor());
+    if (!is_untouched(first_page_index, new_pages.size()))
+        return false;
+
+    for (size_t i = 0; i < new_pages.size(); ++i) {
+        auto& page_slot = physical_pages()[first_page_index + i];
+        // The new pages didn't come out of our commitment, so we can give back what was set aside for this one.
+        if (page_slot->is_lazy_committed_page())
+            m_unused_committed_pages->uncommit_one();
+        page_slot = new_pages[i];
+    }
+    if (!m_cow_map.is_null())
+        m_cow_map.set_range(first_page_index, new_pages.size(), false);
+    return true;
+}
+
 ErrorOr<void> AnonymousVMObject::ensure_cow_map()
 {
     if (m_cow_map.is_null())
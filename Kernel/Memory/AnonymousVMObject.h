@@ -26,6 +26,8 @@ public:
     virtual ErrorOr<NonnullLockRefPtr<VMObject>> try_clone() override;
 
     [[nodiscard]] NonnullRefPtr<PhysicalPage> allocate_committed_page(Badge<Region>);
+    bool is_untouched(size_t first_page_index, size_t page_count) const;
+    bool try_replace_untouched_pages(Badge<Region>, size_t first_page_index, NonnullRefPtrVector<PhysicalPage>&);
     PageFaultResponse handle_cow_fault(size_t, VirtualAddress);
     size_t cow_pages() const;
     bool should_cow(size_t page_index, bool) const;
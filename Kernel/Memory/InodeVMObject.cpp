@@ -96,4 +96,10 @@ u32 InodeVMObject::writable_mappings() const
     return count;
 }
 
+Optional<ReadAheadRange> InodeVMObject::did_fault_for_read_ahead(size_t page_index)
+{
+    SpinlockLocker locker(m_lock);
+    return m_read_ahead.did_read(page_index * PAGE_SIZE, PAGE_SIZE);
+}
+
 }
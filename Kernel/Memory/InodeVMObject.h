@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Bitmap.h>
+#include <Kernel/FileSystem/ReadAheadState.h>
 #include <Kernel/Memory/VMObject.h>
 #include <Kernel/UnixTypes.h>
 
@@ -27,6 +28,8 @@ public:
 
     u32 writable_mappings() const;
 
+    Optional<ReadAheadRange> did_fault_for_read_ahead(size_t page_index);
+
 protected:
     explicit InodeVMObject(Inode&, FixedArray<RefPtr<PhysicalPage>>&&, Bitmap dirty_pages);
     explicit InodeVMObject(InodeVMObject const&, FixedArray<RefPtr<PhysicalPage>>&&, Bitmap dirty_pages);
@@ -39,6 +42,7 @@ protected:
 
     NonnullLockRefPtr<Inode> m_inode;
     Bitmap m_dirty_pages;
+    ReadAheadState m_read_ahead;
 };
 
 }
@@ -61,6 +61,8 @@ ErrorOr<FlatPtr> page_round_up(FlatPtr x)
 // the memory manager to be initialized twice!
 static MemoryManager* s_the;
 
+Atomic<u32> MemoryManager::transparent_huge_pages { 1 };
+
 MemoryManager& MemoryManager::the()
 {
     return *s_the;
@@ -554,7 +556,7 @@ PageTableEntry* MemoryManager::pte(PageDirectory& page_directory, VirtualAddress
 
     auto* pd = quickmap_pd(const_cast<PageDirectory&>(page_directory), page_directory_table_index);
     PageDirectoryEntry const& pde = pd[page_directory_index];
-    if (!pde.is_present())
+    if (!pde.is_present() || pde.is_huge())
         return nullptr;
 
     return &quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()))[page_table_index];
@@ -570,9 +572,10 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     auto& pde = pd[page_directory_index];
-    if (pde.is_present())
+    if (pde.is_present() && !pde.is_huge())
         return &quickmap_pt(PhysicalAddress(pde.page_table_base()))[page_table_index];
 
+    auto original_pde = pde;
     bool did_purge = false;
     auto page_table_or_error = allocate_physical_page(ShouldZeroFill::Yes, &did_purge);
     if (page_table_or_error.is_error()) {
@@ -587,8 +590,28 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
         pd = quickmap_pd(page_directory, page_directory_table_index);
         VERIFY(&pde == &pd[page_directory_index]); // Sanity check
 
-        VERIFY(!pde.is_present()); // Should have not changed
+        VERIFY(pde.raw() == original_pde.raw()); // Should have not changed
+    }
+
+    if (pde.is_huge()) {
+        // Someone wants to change a single page of a huge page, so split it up.
+        // The new page table maps the same memory as before, so only the page
+        // that the caller is about to change needs to be flushed from the TLB.
+        auto* page_table_entries = quickmap_pt(page_table->paddr());
+        for (size_t i = 0; i < PAGES_PER_HUGE_PAGE; ++i) {
+            auto& entry = page_table_entries[i];
+            entry.set_physical_page_base(pde.page_table_base() + i * PAGE_SIZE);
+            entry.set_present(true);
+            entry.set_writable(pde.is_writable());
+            entry.set_user_allowed(pde.is_user_allowed());
+            entry.set_cache_disabled(pde.is_cache_disabled());
+            entry.set_execute_disabled(pde.is_execute_disabled());
+        }
+        pde.clear();
+        --page_directory.m_huge_page_count;
+        ++m_huge_pages_split;
     }
+
     pde.set_page_table_base(page_table->paddr().get());
     pde.set_user_allowed(true);
     pde.set_present(true);
@@ -601,6 +624,34 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
     return &quickmap_pt(PhysicalAddress(pde.page_table_base()))[page_table_index];
 }
 
+PageDirectoryEntry* MemoryManager::ensure_huge_pde(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(page_directory.get_lock().is_locked_by_current_processor());
+    VERIFY(!(vaddr.get() % HUGE_PAGE_SIZE));
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x1ff;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    auto& pde = pd[page_directory_index];
+    if (pde.is_present() && pde.is_huge())
+        return &pde;
+
+    if (pde.is_present()) {
+        // The page table is replaced wholesale, but other processors may still be walking it or have it in their
+        // paging-structure caches. Like in release_pte(), it's only freed once the next TLB flush of this page
+        // directory (which the caller has to do after mapping the huge page) has reached all of them.
+        auto page_table_page = adopt_ref(get_physical_page_entry(PhysicalAddress { pde.page_table_base() }).allocated.physical_page);
+        pde.clear();
+        if (page_directory.m_page_tables_pending_release.try_append(move(page_table_page)).is_error())
+            flush_tlb(&page_directory, vaddr, PAGES_PER_HUGE_PAGE);
+    }
+    pde.clear();
+    ++page_directory.m_huge_page_count;
+    ++m_huge_pages_mapped;
+    return &pde;
+}
+
 void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress vaddr, IsLastPTERelease is_last_pte_release)
 {
     VERIFY_INTERRUPTS_DISABLED();
@@ -611,6 +662,13 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     PageDirectoryEntry& pde = pd[page_directory_index];
+    if (pde.is_present() && pde.is_huge()) {
+        // Huge pages are only used where the whole 2 MiB lies within one region,
+        // and regions are always unmapped as a whole, so the entire page goes.
+        pde.clear();
+        --page_directory.m_huge_page_count;
+        return;
+    }
     if (pde.is_present()) {
         auto* page_table = quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()));
         auto& pte = page_table[page_table_index];
@@ -627,8 +685,12 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
                 }
             }
             if (all_clear) {
-                get_physical_page_entry(PhysicalAddress { pde.page_table_base() }).allocated.physical_page.unref();
+                // Processors may still have the page table in their paging-structure caches,
+                // so it's only freed once the next TLB flush of this page directory is done.
+                auto page_table_page = adopt_ref(get_physical_page_entry(PhysicalAddress { pde.page_table_base() }).allocated.physical_page);
                 pde.clear();
+                if (page_directory.m_page_tables_pending_release.try_append(move(page_table_page)).is_error())
+                    flush_tlb(&page_directory, VirtualAddress(vaddr.get() & ~(HUGE_PAGE_SIZE - 1)), PAGES_PER_HUGE_PAGE);
             }
         }
     }
@@ -642,6 +704,8 @@ UNMAP_AFTER_INIT void MemoryManager::initialize(u32 cpu)
         new MemoryManager;
         kmalloc_enable_expand();
     }
+
+    kmalloc_enable_processor_cache();
 }
 
 Region* MemoryManager::kernel_region_from_vaddr(VirtualAddress address)
@@ -1018,6 +1082,46 @@ ErrorOr<NonnullRefPtrVector<PhysicalPage>> MemoryManager::allocate_contiguous_ph
     return physical_pages;
 }
 
+ErrorOr<NonnullRefPtrVector<PhysicalPage>> MemoryManager::allocate_huge_physical_page()
+{
+    auto physical_pages_or_error = m_global_data.with([&](auto& global_data) -> ErrorOr<NonnullRefPtrVector<PhysicalPage>> {
+        // We need to make sure we don't touch pages that we have committed to
+        if (global_data.system_memory_info.physical_pages_uncommitted < PAGES_PER_HUGE_PAGE)
+            return ENOMEM;
+
+        for (auto& physical_region : global_data.physical_regions) {
+            auto physical_pages = physical_region.take_aligned_contiguous_free_pages(PAGES_PER_HUGE_PAGE);
+            if (!physical_pages.is_empty()) {
+                global_data.system_memory_info.physical_pages_uncommitted -= PAGES_PER_HUGE_PAGE;
+                global_data.system_memory_info.physical_pages_used += PAGES_PER_HUGE_PAGE;
+                return physical_pages;
+            }
+        }
+        return ENOMEM;
+    });
+    if (physical_pages_or_error.is_error()) {
+        ++m_huge_page_allocation_failures;
+        return physical_pages_or_error.release_error();
+    }
+
+    auto physical_pages = physical_pages_or_error.release_value();
+    for (auto& physical_page : physical_pages) {
+        auto* ptr = quickmap_page(physical_page);
+        memset(ptr, 0, PAGE_SIZE);
+        unquickmap_page();
+    }
+    return physical_pages;
+}
+
+MemoryManager::HugePageStatistics MemoryManager::huge_page_statistics() const
+{
+    HugePageStatistics statistics;
+    statistics.mapped = m_huge_pages_mapped.load();
+    statistics.split = m_huge_pages_split.load();
+    statistics.allocation_failures = m_huge_page_allocation_failures.load();
+    return statistics;
+}
+
 void MemoryManager::enter_process_address_space(Process& process)
 {
     process.address_space().with([](auto& space) {
@@ -1037,9 +1141,13 @@ void MemoryManager::flush_tlb_local(VirtualAddress vaddr, size_t page_count)
     Processor::flush_tlb_local(vaddr, page_count);
 }
 
-void MemoryManager::flush_tlb(PageDirectory const* page_directory, VirtualAddress vaddr, size_t page_count)
+void MemoryManager::flush_tlb(PageDirectory* page_directory, VirtualAddress vaddr, size_t page_count)
 {
     Processor::flush_tlb(page_directory, vaddr, page_count);
+
+    // Any invalidation also drops the paging-structure caches, so released page tables can go now.
+    SpinlockLocker locker(page_directory->get_lock());
+    page_directory->m_page_tables_pending_release.clear_with_capacity();
 }
 
 PageDirectoryEntry* MemoryManager::quickmap_pd(PageDirectory& directory, size_t pdpt_index)
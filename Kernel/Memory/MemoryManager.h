@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/Badge.h>
 #include <AK/Concepts.h>
 #include <AK/HashTable.h>
@@ -37,6 +38,10 @@ constexpr FlatPtr page_round_down(FlatPtr x)
     return ((FlatPtr)(x)) & ~(PAGE_SIZE - 1);
 }
 
+// A huge page is mapped by a single page directory entry instead of a page table.
+constexpr size_t HUGE_PAGE_SIZE = 2 * MiB;
+constexpr size_t PAGES_PER_HUGE_PAGE = HUGE_PAGE_SIZE / PAGE_SIZE;
+
 inline FlatPtr virtual_to_low_physical(FlatPtr virtual_)
 {
     return virtual_ - physical_to_virtual_offset;
@@ -156,6 +161,10 @@ public:
     static void enter_process_address_space(Process&);
     static void enter_address_space(AddressSpace&);
 
+    // Invalidates the given range on every processor that may have cached it. Page tables
+    // that were released since the last flush of this page directory are freed afterwards.
+    static void flush_tlb(PageDirectory*, VirtualAddress, size_t page_count = 1);
+
     bool validate_user_stack(AddressSpace&, VirtualAddress) const;
 
     enum class ShouldZeroFill {
@@ -169,6 +178,7 @@ public:
     NonnullRefPtr<PhysicalPage> allocate_committed_physical_page(Badge<CommittedPhysicalPageSet>, ShouldZeroFill = ShouldZeroFill::Yes);
     ErrorOr<NonnullRefPtr<PhysicalPage>> allocate_physical_page(ShouldZeroFill = ShouldZeroFill::Yes, bool* did_purge = nullptr);
     ErrorOr<NonnullRefPtrVector<PhysicalPage>> allocate_contiguous_physical_pages(size_t size);
+    ErrorOr<NonnullRefPtrVector<PhysicalPage>> allocate_huge_physical_page();
     void deallocate_physical_page(PhysicalAddress);
 
     ErrorOr<NonnullOwnPtr<Region>> allocate_contiguous_kernel_region(size_t, StringView name, Region::Access access, Region::Cacheable = Region::Cacheable::Yes);
@@ -191,6 +201,17 @@ public:
 
     SystemMemoryInfo get_system_memory_info();
 
+    struct HugePageStatistics {
+        u64 mapped { 0 };
+        u64 split { 0 };
+        u64 allocation_failures { 0 };
+    };
+
+    HugePageStatistics huge_page_statistics() const;
+
+    // Set to 0 to stop mapping anonymous memory with huge pages. Existing huge mappings are left alone.
+    static Atomic<u32> transparent_huge_pages;
+
     template<IteratorFunction<VMObject&> Callback>
     static void for_each_vmobject(Callback callback)
     {
@@ -251,7 +272,6 @@ private:
     void protect_kernel_image();
     void parse_memory_map();
     static void flush_tlb_local(VirtualAddress, size_t page_count = 1);
-    static void flush_tlb(PageDirectory const*, VirtualAddress, size_t page_count = 1);
 
     static Region* kernel_region_from_vaddr(VirtualAddress);
 
@@ -271,6 +291,7 @@ private:
 
     PageTableEntry* pte(PageDirectory&, VirtualAddress);
     PageTableEntry* ensure_pte(PageDirectory&, VirtualAddress);
+    PageDirectoryEntry* ensure_huge_pde(PageDirectory&, VirtualAddress);
     enum class IsLastPTERelease {
         Yes,
         No
@@ -305,6 +326,10 @@ private:
     };
 
     SpinlockProtected<GlobalData> m_global_data;
+
+    Atomic<u64> m_huge_pages_mapped { 0 };
+    Atomic<u64> m_huge_pages_split { 0 };
+    Atomic<u64> m_huge_page_allocation_failures { 0 };
 };
 
 inline bool is_user_address(VirtualAddress vaddr)
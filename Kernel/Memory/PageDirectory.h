@@ -6,11 +6,13 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/AtomicRefCounted.h>
 #include <AK/Badge.h>
 #include <AK/HashMap.h>
 #include <AK/IntrusiveRedBlackTree.h>
 #include <AK/RefPtr.h>
+#include <AK/Vector.h>
 #include <Kernel/Forward.h>
 #include <Kernel/Locking/Spinlock.h>
 #include <Kernel/Memory/PhysicalPage.h>
@@ -54,6 +56,8 @@ public:
 
     RecursiveSpinlock& get_lock() { return m_lock; }
 
+    size_t huge_page_count() const { return m_huge_page_count.load(); }
+
     // This has to be public to let the global singleton access the member pointer
     IntrusiveRedBlackTreeNode<FlatPtr, PageDirectory, RawPtr<PageDirectory>> m_tree_node;
 
@@ -73,6 +77,12 @@ private:
     RefPtr<PhysicalPage> m_directory_pages[4];
 #endif
     RecursiveSpinlock m_lock { LockRank::None };
+
+    // Number of huge pages currently mapped, only changed with m_lock held.
+    Atomic<size_t> m_huge_page_count { 0 };
+
+    // Page tables that were unmapped but may still be cached by a processor, see MemoryManager::release_pte().
+    Vector<NonnullRefPtr<PhysicalPage>> m_page_tables_pending_release;
 };
 
 void activate_kernel_page_directory(PageDirectory const& pgd);
@@ -103,6 +103,47 @@ NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(siz
     return physical_pages;
 }
 
+NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_aligned_contiguous_free_pages(size_t count)
+{
+    VERIFY(is_power_of_two(count));
+    auto order = count_trailing_zeroes(count);
+    auto alignment = static_cast<PhysicalPtr>(count) * PAGE_SIZE;
+
+    Optional<PhysicalAddress> page_base;
+    for (auto& zone : m_usable_zones) {
+        // Buddy blocks are only aligned relative to the start of their zone. If the zone itself
+        // isn't aligned, take a block twice the size and give back what's around the aligned part.
+        bool zone_is_aligned = !(zone.base().get() % alignment);
+        auto block_order = zone_is_aligned ? order : order + 1;
+        auto block_base = zone.allocate_block(block_order);
+        if (!block_base.has_value())
+            continue;
+
+        auto block_end = block_base->offset((PhysicalPtr)(1u << block_order) * PAGE_SIZE);
+        page_base = PhysicalAddress(align_up_to(block_base->get(), alignment));
+        for (auto paddr = *block_base; paddr < *page_base; paddr = paddr.offset(PAGE_SIZE))
+            zone.deallocate_block(paddr, 0);
+        for (auto paddr = page_base->offset(alignment); paddr < block_end; paddr = paddr.offset(PAGE_SIZE))
+            zone.deallocate_block(paddr, 0);
+
+        if (zone.is_empty()) {
+            // We've exhausted this zone, move it to the full zones list.
+            m_full_zones.append(zone);
+        }
+        break;
+    }
+
+    if (!page_base.has_value())
+        return {};
+
+    NonnullRefPtrVector<PhysicalPage> physical_pages;
+    physical_pages.ensure_capacity(count);
+
+    for (size_t i = 0; i < count; ++i)
+        physical_pages.append(PhysicalPage::create(page_base.value().offset(i * PAGE_SIZE)));
+    return physical_pages;
+}
+
 RefPtr<PhysicalPage> PhysicalRegion::take_free_page()
 {
     if (m_usable_zones.is_empty())
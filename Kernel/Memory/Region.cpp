@@ -5,6 +5,7 @@
  */
 
 #include <AK/Memory.h>
+#include <AK/NonnullRefPtrVector.h>
 #include <AK/StringView.h>
 #include <Kernel/Arch/InterruptDisabler.h>
 #include <Kernel/Arch/PageDirectory.h>
@@ -249,6 +250,57 @@ bool Region::map_individual_page_impl(size_t page_index)
     return map_individual_page_impl(page_index, page);
 }
 
+bool Region::can_use_huge_pages() const
+{
+    if (!MemoryManager::transparent_huge_pages.load())
+        return false;
+    if (!is_user() || is_shared() || !m_cacheable || is_write_combine())
+        return false;
+    if (!vmobject().is_anonymous())
+        return false;
+    // Purging swaps out individual pages, which would split the huge page right away.
+    return !static_cast<AnonymousVMObject const&>(vmobject()).is_purgeable();
+}
+
+// Maps the 2 MiB starting at page_index with a single huge page, if it's backed by
+// a naturally aligned run of physical pages that can all be mapped the same way.
+bool Region::map_huge_page_impl(size_t page_index)
+{
+    VERIFY(m_page_directory->get_lock().is_locked_by_current_processor());
+
+    auto page_vaddr = vaddr_from_page_index(page_index);
+    if (page_vaddr.get() % HUGE_PAGE_SIZE || page_index + PAGES_PER_HUGE_PAGE > page_count())
+        return false;
+    if (!is_readable() || !can_use_huge_pages())
+        return false;
+
+    PhysicalAddress base;
+    {
+        SpinlockLocker vmobject_locker(vmobject().m_lock);
+        auto const& first_page = physical_page_slot(page_index);
+        if (!first_page || first_page->paddr().get() % HUGE_PAGE_SIZE)
+            return false;
+        base = first_page->paddr();
+        for (size_t i = 0; i < PAGES_PER_HUGE_PAGE; ++i) {
+            auto const& page = physical_page_slot(page_index + i);
+            if (!page || page->paddr() != base.offset(i * PAGE_SIZE))
+                return false;
+            if (page->is_shared_zero_page() || page->is_lazy_committed_page() || should_cow(page_index + i))
+                return false;
+        }
+    }
+
+    auto* pde = MM.ensure_huge_pde(*m_page_directory, page_vaddr);
+    pde->set_page_table_base(base.get());
+    pde->set_huge(true);
+    pde->set_present(true);
+    pde->set_writable(is_writable());
+    pde->set_user_allowed(true);
+    if (Processor::current().has_nx())
+        pde->set_execute_disabled(!is_executable());
+    return true;
+}
+
 bool Region::remap_vmobject_page(size_t page_index, NonnullRefPtr<PhysicalPage> physical_page)
 {
     SpinlockLocker page_lock(m_page_directory->get_lock());
@@ -302,6 +354,10 @@ ErrorOr<void> Region::map(PageDirectory& page_directory, ShouldFlushTLB should_f
     set_page_directory(page_directory);
     size_t page_index = 0;
     while (page_index < page_count()) {
+        if (map_huge_page_impl(page_index)) {
+            page_index += PAGES_PER_HUGE_PAGE;
+            continue;
+        }
         if (!map_individual_page_impl(page_index))
             break;
         ++page_index;
@@ -408,6 +464,9 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region, Physica
     if (current_thread != nullptr)
         current_thread->did_zero_fault();
 
+    if (handle_zero_fault_with_huge_page(page_index_in_region))
+        return PageFaultResponse::Continue;
+
     RefPtr<PhysicalPage> new_physical_page;
 
     if (page_in_slot_at_time_of_fault.is_lazy_committed_page()) {
@@ -446,6 +505,48 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region, Physica
     return PageFaultResponse::Continue;
 }
 
+// If the whole 2 MiB around the faulting page is still untouched, fault it all in at once and map it with a huge page.
+bool Region::handle_zero_fault_with_huge_page(size_t page_index_in_region)
+{
+    if (!is_writable() || !can_use_huge_pages())
+        return false;
+
+    auto window_base = VirtualAddress(vaddr_from_page_index(page_index_in_region).get() & ~(HUGE_PAGE_SIZE - 1));
+    if (!range().contains(window_base, HUGE_PAGE_SIZE))
+        return false;
+    auto first_page_index = page_index_from_address(window_base);
+    auto& anonymous_vmobject = static_cast<AnonymousVMObject&>(vmobject());
+
+    {
+        SpinlockLocker locker(vmobject().m_lock);
+        if (!anonymous_vmobject.is_untouched(translate_to_vmobject_page(first_page_index), PAGES_PER_HUGE_PAGE))
+            return false;
+    }
+
+    auto pages_or_error = MM.allocate_huge_physical_page();
+    if (pages_or_error.is_error())
+        return false;
+    auto pages = pages_or_error.release_value();
+
+    {
+        SpinlockLocker locker(vmobject().m_lock);
+        // Someone else may have faulted in one of the pages while we were allocating.
+        if (!anonymous_vmobject.try_replace_untouched_pages({}, translate_to_vmobject_page(first_page_index), pages))
+            return false;
+    }
+
+    SpinlockLocker page_lock(m_page_directory->get_lock());
+    if (!map_huge_page_impl(first_page_index)) {
+        // Huge pages were switched off in the meantime, the memory is ours either way.
+        for (size_t i = 0; i < PAGES_PER_HUGE_PAGE; ++i) {
+            if (!map_individual_page_impl(first_page_index + i))
+                return false;
+        }
+    }
+    MemoryManager::flush_tlb(m_page_directory, window_base, PAGES_PER_HUGE_PAGE);
+    return true;
+}
+
 PageFaultResponse Region::handle_cow_fault(size_t page_index_in_region)
 {
     auto current_thread = Thread::current();
@@ -506,6 +607,10 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
         memset(page_buffer + nread, 0, PAGE_SIZE - nread);
     }
 
+    // If this mapping is being faulted in sequentially, pull the next pages into the disk cache in one go.
+    if (auto read_ahead = inode_vmobject.did_fault_for_read_ahead(page_index_in_vmobject); read_ahead.has_value())
+        inode.read_ahead(read_ahead->offset, read_ahead->size);
+
     // Allocate a new physical page, and copy the read inode contents into it.
     auto new_physical_page_or_error = MM.allocate_physical_page(MemoryManager::ShouldZeroFill::No);
     if (new_physical_page_or_error.is_error()) {
@@ -225,6 +225,10 @@ private:
     [[nodiscard]] bool map_individual_page_impl(size_t page_index);
     [[nodiscard]] bool map_individual_page_impl(size_t page_index, RefPtr<PhysicalPage>);
 
+    [[nodiscard]] bool can_use_huge_pages() const;
+    [[nodiscard]] bool map_huge_page_impl(size_t page_index);
+    [[nodiscard]] bool handle_zero_fault_with_huge_page(size_t page_index);
+
     LockRefPtr<PageDirectory> m_page_directory;
     VirtualRange m_range;
     size_t m_offset_in_vmobject { 0 };
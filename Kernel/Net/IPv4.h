@@ -121,4 +121,30 @@ inline NetworkOrdered<u16> internet_checksum(void const* ptr, size_t count)
     return ~checksum & 0xffff;
 }
 
+// Copies `count` bytes and returns the one's complement sum of their 16-bit words, like internet_checksum()
+// but without the final complement, so that a checksum can be verified without another pass over the data.
+inline u16 copy_and_sum_for_internet_checksum(u8* destination, u8 const* source, size_t count)
+{
+    // Since 2^16 is 1 modulo 2^16 - 1, we can add up 32-bit words and fold the result afterwards. The sum also
+    // doesn't depend on byte order, so we only have to swap the bytes of the result instead of those of each word.
+    u64 sum = 0;
+    for (; count >= sizeof(u32); count -= sizeof(u32)) {
+        u32 word;
+        __builtin_memcpy(&word, source, sizeof(word));
+        __builtin_memcpy(destination, &word, sizeof(word));
+        sum += word;
+        source += sizeof(word);
+        destination += sizeof(word);
+    }
+    if (count > 0) {
+        u32 word = 0;
+        __builtin_memcpy(&word, source, count);
+        __builtin_memcpy(destination, source, count);
+        sum += word;
+    }
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return AK::convert_between_host_and_network_endian(static_cast<u16>(sum));
+}
+
 }
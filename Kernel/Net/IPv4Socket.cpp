@@ -37,7 +37,7 @@ MutexProtected<IPv4Socket::List>& IPv4Socket::all_sockets()
 
 ErrorOr<NonnullOwnPtr<DoubleBuffer>> IPv4Socket::try_create_receive_buffer()
 {
-    return DoubleBuffer::try_create("IPv4Socket: Receive buffer"sv, 256 * KiB);
+    return DoubleBuffer::try_create("IPv4Socket: Receive buffer"sv, receive_buffer_size);
 }
 
 ErrorOr<NonnullLockRefPtr<Socket>> IPv4Socket::create(int type, int protocol)
@@ -278,8 +278,10 @@ ErrorOr<size_t> IPv4Socket::receive_byte_buffered(OpenFileDescription& descripti
     else
         nreceived_or_error = m_receive_buffer->read(buffer, buffer_length);
 
-    if (!nreceived_or_error.is_error() && nreceived_or_error.value() > 0 && !(flags & MSG_PEEK))
+    if (!nreceived_or_error.is_error() && nreceived_or_error.value() > 0 && !(flags & MSG_PEEK)) {
         Thread::current()->did_ipv4_socket_read(nreceived_or_error.value());
+        protocol_did_read();
+    }
 
     set_can_read(!m_receive_buffer->is_empty());
     return nreceived_or_error;
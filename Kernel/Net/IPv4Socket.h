@@ -72,6 +72,8 @@ public:
     };
     BufferMode buffer_mode() const { return m_buffer_mode; }
 
+    static constexpr size_t receive_buffer_size = 256 * KiB;
+
 protected:
     IPv4Socket(int type, int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, OwnPtr<KBuffer> optional_scratch_buffer);
     virtual StringView class_name() const override { return "IPv4Socket"sv; }
@@ -86,6 +88,7 @@ protected:
     virtual ErrorOr<u16> protocol_allocate_local_port() { return ENOPROTOOPT; }
     virtual ErrorOr<size_t> protocol_size(ReadonlyBytes /* raw_ipv4_packet */) { return ENOTIMPL; }
     virtual bool protocol_is_disconnected() const { return false; }
+    virtual void protocol_did_read() { }
 
     virtual void shut_down_for_reading() override;
 
@@ -94,6 +97,7 @@ protected:
 
     static ErrorOr<NonnullOwnPtr<DoubleBuffer>> try_create_receive_buffer();
     void drop_receive_buffer();
+    size_t receive_buffer_space() const { return m_receive_buffer ? m_receive_buffer->space_for_writing() : 0; }
 
 private:
     virtual bool is_ipv4() const override { return true; }
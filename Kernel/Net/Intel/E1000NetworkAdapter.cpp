@@ -454,20 +454,26 @@ void E1000NetworkAdapter::send_raw(ReadonlyBytes payload)
 void E1000NetworkAdapter::receive()
 {
     auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
-    u32 rx_current;
+    // Register accesses are slow, so we only give the descriptors back to the card once we've handled all of them.
+    u32 rx_tail = in32(REG_RXDESCTAIL) % number_of_rx_descriptors;
+    u32 rx_current = rx_tail;
+    size_t received_count = 0;
     for (;;) {
-        rx_current = in32(REG_RXDESCTAIL) % number_of_rx_descriptors;
         rx_current = (rx_current + 1) % number_of_rx_descriptors;
         if (!(rx_descriptors[rx_current].status & 1))
             break;
         auto* buffer = m_rx_buffers[rx_current];
         u16 length = rx_descriptors[rx_current].length;
         VERIFY(length <= 8192);
-        dbgln_if(E1000_DEBUG, "E1000: Received 1 packet @ {:p} ({} bytes)", buffer, length);
         did_receive({ buffer, length });
         rx_descriptors[rx_current].status = 0;
-        out32(REG_RXDESCTAIL, rx_current);
+        rx_tail = rx_current;
+        ++received_count;
     }
+    if (received_count == 0)
+        return;
+    dbgln_if(E1000_DEBUG, "E1000: Received {} packet(s)", received_count);
+    out32(REG_RXDESCTAIL, rx_tail);
 }
 
 i32 E1000NetworkAdapter::link_speed()
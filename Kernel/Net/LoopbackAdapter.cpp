@@ -4,13 +4,20 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteBuffer.h>
 #include <AK/Singleton.h>
 #include <Kernel/Net/LoopbackAdapter.h>
+#include <Kernel/Random.h>
+#include <Kernel/Time/TimeManagement.h>
+#include <Kernel/TimerQueue.h>
 
 namespace Kernel {
 
 static bool s_loopback_initialized = false;
 
+Atomic<u32> LoopbackAdapter::delay_ms { 0 };
+Atomic<u32> LoopbackAdapter::loss_per_mille { 0 };
+
 LockRefPtr<LoopbackAdapter> LoopbackAdapter::try_create()
 {
     auto interface_name = KString::try_create("loop"sv);
@@ -32,8 +39,31 @@ LoopbackAdapter::~LoopbackAdapter() = default;
 
 void LoopbackAdapter::send_raw(ReadonlyBytes payload)
 {
-    dbgln("LoopbackAdapter: Sending {} byte(s) to myself.", payload.size());
+    auto loss = loss_per_mille.load(AK::MemoryOrder::memory_order_relaxed);
+    if (loss > 0 && get_fast_random<u32>() % 1000 < loss) {
+        dbgln("LoopbackAdapter: Dropping {} byte(s) on purpose.", payload.size());
+        return;
+    }
+
+    auto delay = delay_ms.load(AK::MemoryOrder::memory_order_relaxed);
+    if (delay > 0 && schedule_delayed_receive(payload, Time::from_milliseconds(delay)))
+        return;
+
     did_receive(payload);
 }
 
+bool LoopbackAdapter::schedule_delayed_receive(ReadonlyBytes payload, Time const& delay)
+{
+    auto timer = adopt_lock_ref_if_nonnull(new (nothrow) Timer);
+    if (!timer)
+        return false;
+    auto buffer_or_error = ByteBuffer::copy(payload);
+    if (buffer_or_error.is_error())
+        return false;
+    auto deadline = TimeManagement::the().current_time(CLOCK_MONOTONIC_COARSE) + delay;
+    return TimerQueue::the().add_timer_without_id(timer.release_nonnull(), CLOCK_MONOTONIC_COARSE, deadline, [this, buffer = buffer_or_error.release_value()] {
+        did_receive(buffer.bytes());
+    });
+}
+
 }
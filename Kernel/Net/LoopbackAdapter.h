@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <Kernel/Net/NetworkAdapter.h>
 
 namespace Kernel {
@@ -23,6 +24,15 @@ public:
     virtual bool link_up() override { return true; }
     virtual bool link_full_duplex() override { return true; }
     virtual int link_speed() override { return 1000; }
+    virtual bool needs_checksum_verification() const override { return false; }
+
+    // Emulate a slow or lossy link, for testing how TCP copes with it.
+    // Exposed as /proc/sys/loopback_delay_ms and /proc/sys/loopback_loss_per_mille.
+    static Atomic<u32> delay_ms;
+    static Atomic<u32> loss_per_mille;
+
+private:
+    bool schedule_delayed_receive(ReadonlyBytes, Time const& delay);
 };
 
 }
@@ -69,6 +69,28 @@ void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Addres
     ipv4.set_checksum(ipv4.compute_checksum());
 }
 
+void NetworkAdapter::copy_received_frame(PacketWithTimestamp& packet, ReadonlyBytes frame)
+{
+    auto* destination = packet.buffer->data();
+    packet.ipv4_packet_sum = {};
+
+    if (needs_checksum_verification() && frame.size() >= sizeof(EthernetFrameHeader) + sizeof(IPv4Packet)) {
+        auto const& eth = *reinterpret_cast<EthernetFrameHeader const*>(frame.data());
+        auto const& ipv4 = *static_cast<IPv4Packet const*>(eth.payload());
+        size_t ipv4_length = ipv4.length();
+        if (eth.ether_type() == EtherType::IPv4 && ipv4_length >= sizeof(IPv4Packet) && ipv4_length <= frame.size() - sizeof(EthernetFrameHeader)) {
+            // Sum up the IPv4 packet while we're copying it anyway, but not the padding that may follow it.
+            memcpy(destination, frame.data(), sizeof(EthernetFrameHeader));
+            packet.ipv4_packet_sum = copy_and_sum_for_internet_checksum(destination + sizeof(EthernetFrameHeader), frame.offset(sizeof(EthernetFrameHeader)), ipv4_length);
+            size_t copied_size = sizeof(EthernetFrameHeader) + ipv4_length;
+            memcpy(destination + copied_size, frame.offset(copied_size), frame.size() - copied_size);
+            return;
+        }
+    }
+
+    memcpy(destination, frame.data(), frame.size());
+}
+
 void NetworkAdapter::did_receive(ReadonlyBytes payload)
 {
     InterruptDisabler disabler;
@@ -76,39 +98,57 @@ void NetworkAdapter::did_receive(ReadonlyBytes payload)
     m_bytes_in += payload.size();
 
     if (m_packet_queue_size == max_packet_buffers) {
-        // FIXME: Keep track of the number of dropped packets
+        m_packets_dropped++;
         return;
     }
 
     auto packet = acquire_packet_buffer(payload.size());
     if (!packet) {
         dbgln("Discarding packet because we're out of memory");
+        m_packets_dropped++;
         return;
     }
 
-    memcpy(packet->buffer->data(), payload.data(), payload.size());
+    copy_received_frame(*packet, payload);
 
+    bool was_empty = m_packet_queue.is_empty();
     m_packet_queue.append(*packet);
     m_packet_queue_size++;
 
-    if (on_receive)
+    // Whoever handles our packets takes everything that is queued before waiting again,
+    // so they only have to be notified about the first packet of a batch.
+    if (was_empty && on_receive)
         on_receive();
 }
 
-size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp)
+size_t NetworkAdapter::dequeue_packets(PacketList& packets, size_t max_count)
 {
     InterruptDisabler disabler;
-    if (m_packet_queue.is_empty())
-        return 0;
-    auto packet_with_timestamp = m_packet_queue.take_first();
-    m_packet_queue_size--;
-    packet_timestamp = packet_with_timestamp->timestamp;
-    auto& packet_buffer = packet_with_timestamp->buffer;
-    size_t packet_size = packet_buffer->size();
-    VERIFY(packet_size <= buffer_size);
-    memcpy(buffer, packet_buffer->data(), packet_size);
-    release_packet_buffer(*packet_with_timestamp);
-    return packet_size;
+    size_t count = 0;
+    for (; count < max_count && !m_packet_queue.is_empty(); ++count)
+        packets.append(*m_packet_queue.take_first());
+    m_packet_queue_size -= count;
+    return count;
+}
+
+static ErrorOr<NonnullLockRefPtr<PacketWithTimestamp>> create_packet_buffer(size_t capacity)
+{
+    auto buffer = TRY(KBuffer::try_create_with_size("NetworkAdapter: Packet buffer"sv, capacity, Memory::Region::Access::ReadWrite, AllocationStrategy::AllocateNow));
+    return adopt_nonnull_lock_ref_or_enomem(new (nothrow) PacketWithTimestamp { move(buffer), kgettimeofday() });
+}
+
+ErrorOr<void> NetworkAdapter::initialize_packet_buffer_pool()
+{
+    auto buffer_size = TRY(Memory::page_round_up(max_frame_size()));
+    auto buffer_count = max(packet_buffer_pool_budget / buffer_size, min_pooled_packet_buffers);
+
+    PacketList packets;
+    for (size_t i = 0; i < buffer_count; ++i) {
+        auto packet = TRY(create_packet_buffer(buffer_size));
+        packets.append(*packet);
+    }
+    release_packet_buffers(packets);
+    return {};
 }
 
 LockRefPtr<PacketWithTimestamp> NetworkAdapter::acquire_packet_buffer(size_t size)
@@ -126,18 +166,16 @@ LockRefPtr<PacketWithTimestamp> NetworkAdapter::acquire_packet_buffer(size_t siz
         return nullptr;
     });
 
-    if (packet) {
-        packet->timestamp = kgettimeofday();
-        packet->buffer->set_size(size);
-        return packet;
+    if (!packet) {
+        // Make the new buffer large enough for any frame, so that it can be reused for everything once it's released.
+        auto packet_or_error = create_packet_buffer(max(size, max_frame_size()));
+        if (packet_or_error.is_error())
+            return {};
+        packet = packet_or_error.release_value();
     }
 
-    auto buffer_or_error = KBuffer::try_create_with_size("NetworkAdapter: Packet buffer"sv, size, Memory::Region::Access::ReadWrite, AllocationStrategy::AllocateNow);
-    if (buffer_or_error.is_error())
-        return {};
-    packet = adopt_lock_ref_if_nonnull(new (nothrow) PacketWithTimestamp { buffer_or_error.release_value(), kgettimeofday() });
-    if (!packet)
-        return {};
+    packet->timestamp = kgettimeofday();
+    packet->ipv4_packet_sum = {};
     packet->buffer->set_size(size);
     return packet;
 }
@@ -149,6 +187,14 @@ void NetworkAdapter::release_packet_buffer(PacketWithTimestamp& packet)
     });
 }
 
+void NetworkAdapter::release_packet_buffers(PacketList& packets)
+{
+    m_unused_packets.with([&packets](auto& unused_packets) {
+        while (!packets.is_empty())
+            unused_packets.append(*packets.take_first());
+    });
+}
+
 void NetworkAdapter::set_ipv4_address(IPv4Address const& address)
 {
     m_ipv4_address = address;
@@ -39,6 +39,9 @@ struct PacketWithTimestamp final : public AtomicRefCounted<PacketWithTimestamp>
 
     NonnullOwnPtr<KBuffer> buffer;
     Time timestamp;
+    // For received IPv4 frames, the one's complement sum over the IPv4 packet, which was computed while copying
+    // the frame in. Empty if the adapter doesn't need us to verify checksums.
+    Optional<u16> ipv4_packet_sum;
     IntrusiveListNode<PacketWithTimestamp, LockRefPtr<PacketWithTimestamp>> packet_node;
 };
 
@@ -71,7 +74,11 @@ public:
     void send(MACAddress const&, ARPPacket const&);
     void fill_in_ipv4_header(PacketWithTimestamp&, IPv4Address const&, MACAddress const&, IPv4Address const&, IPv4Protocol, size_t, u8 type_of_service, u8 ttl);
 
-    size_t dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp);
+    using PacketList = IntrusiveList<&PacketWithTimestamp::packet_node>;
+
+    // Moves up to `max_count` received packets to the end of `packets`, and returns how many were moved.
+    // The packets have to be given back with release_packet_buffers() once they have been handled.
+    size_t dequeue_packets(PacketList& packets, size_t max_count);
 
     bool has_queued_packets() const { return !m_packet_queue.is_empty(); }
 
@@ -82,9 +89,14 @@ public:
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
+    u32 packets_dropped() const { return m_packets_dropped; }
+
+    // Allocates the buffers that received and sent packets are copied into up front, so that we don't have to allocate memory for each frame.
+    ErrorOr<void> initialize_packet_buffer_pool();
 
     LockRefPtr<PacketWithTimestamp> acquire_packet_buffer(size_t);
     void release_packet_buffer(PacketWithTimestamp&);
+    void release_packet_buffers(PacketList&);
 
     constexpr size_t layer3_payload_offset() const { return sizeof(EthernetFrameHeader); }
     constexpr size_t ipv4_payload_offset() const { return layer3_payload_offset() + sizeof(IPv4Packet); }
@@ -99,6 +111,9 @@ protected:
     void did_receive(ReadonlyBytes);
     virtual void send_raw(ReadonlyBytes) = 0;
 
+    // Frames from adapters that can't corrupt them in transit don't need their checksums verified.
+    virtual bool needs_checksum_verification() const { return true; }
+
 private:
     MACAddress m_mac_address;
     IPv4Address m_ipv4_address;
@@ -106,8 +121,12 @@ private:
 
     // FIXME: Make this configurable
     static constexpr size_t max_packet_buffers = 1024;
+    // How much memory the packet buffer pool starts out with, unless that's too few buffers for a large MTU.
+    static constexpr size_t packet_buffer_pool_budget = 1 * MiB;
+    static constexpr size_t min_pooled_packet_buffers = 16;
 
-    using PacketList = IntrusiveList<&PacketWithTimestamp::packet_node>;
+    size_t max_frame_size() const { return sizeof(EthernetFrameHeader) + m_mtu; }
+    void copy_received_frame(PacketWithTimestamp&, ReadonlyBytes);
 
     PacketList m_packet_queue;
     size_t m_packet_queue_size { 0 };
@@ -117,6 +136,7 @@ private:
     u32 m_bytes_in { 0 };
     u32 m_packets_out { 0 };
     u32 m_bytes_out { 0 };
+    u32 m_packets_dropped { 0 };
     u32 m_mtu { 1500 };
 };
 
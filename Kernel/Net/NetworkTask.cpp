@@ -26,7 +26,7 @@
 namespace Kernel {
 
 static void handle_arp(EthernetFrameHeader const&, size_t frame_size);
-static void handle_ipv4(EthernetFrameHeader const&, size_t frame_size, Time const& packet_timestamp);
+static void handle_ipv4(EthernetFrameHeader const&, size_t frame_size, Time const& packet_timestamp, Optional<u16> ipv4_packet_sum);
 static void handle_icmp(EthernetFrameHeader const&, IPv4Packet const&, Time const& packet_timestamp);
 static void handle_udp(IPv4Packet const&, Time const& packet_timestamp);
 static void handle_tcp(IPv4Packet const&, Time const& packet_timestamp);
@@ -35,6 +35,11 @@ static void send_tcp_rst(IPv4Packet const& ipv4_packet, TCPPacket const& tcp_pac
 static void flush_delayed_tcp_acks();
 static void retransmit_tcp_packets();
 
+static void handle_packet(PacketWithTimestamp&);
+
+// How many packets we take from an adapter at once.
+static constexpr size_t receive_batch_size = 64;
+
 static Thread* network_task = nullptr;
 static HashTable<LockRefPtr<TCPSocket>>* delayed_ack_sockets;
 
@@ -60,7 +65,6 @@ void NetworkTask_main(void*)
     delayed_ack_sockets = new HashTable<LockRefPtr<TCPSocket>>;
 
     WaitQueue packet_wait_queue;
-    int pending_packets = 0;
     NetworkingManagement::the().for_each([&](auto& adapter) {
         dmesgln("NetworkTask: {} network adapter found: hw={}", adapter.class_name(), adapter.mac_address().to_string());
 
@@ -70,66 +74,61 @@ void NetworkTask_main(void*)
         }
 
         adapter.on_receive = [&]() {
-            pending_packets++;
             packet_wait_queue.wake_all();
         };
     });
 
-    auto dequeue_packet = [&pending_packets](u8* buffer, size_t buffer_size, Time& packet_timestamp) -> size_t {
-        if (pending_packets == 0)
-            return 0;
-        size_t packet_size = 0;
+    for (;;) {
+        flush_delayed_tcp_acks();
+        retransmit_tcp_packets();
+
+        // Take a batch of packets from each adapter in turn, so that a busy adapter can't starve the others.
+        size_t packet_count = 0;
         NetworkingManagement::the().for_each([&](auto& adapter) {
-            if (packet_size || !adapter.has_queued_packets())
+            NetworkAdapter::PacketList packets;
+            auto count = adapter.dequeue_packets(packets, receive_batch_size);
+            if (count == 0)
                 return;
-            packet_size = adapter.dequeue_packet(buffer, buffer_size, packet_timestamp);
-            pending_packets--;
-            dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} ({} bytes)", adapter.name(), packet_size);
+            dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued {} packet(s) from {}", count, adapter.name());
+            packet_count += count;
+            for (auto& packet : packets)
+                handle_packet(packet);
+            adapter.release_packet_buffers(packets);
         });
-        return packet_size;
-    };
-
-    size_t buffer_size = 64 * KiB;
-    auto region_or_error = MM.allocate_kernel_region(buffer_size, "Kernel Packet Buffer"sv, Memory::Region::Access::ReadWrite);
-    if (region_or_error.is_error())
-        TODO();
-    auto buffer_region = region_or_error.release_value();
-    auto buffer = (u8*)buffer_region->vaddr().get();
-    Time packet_timestamp;
 
-    for (;;) {
-        flush_delayed_tcp_acks();
-        retransmit_tcp_packets();
-        size_t packet_size = dequeue_packet(buffer, buffer_size, packet_timestamp);
-        if (!packet_size) {
+        if (packet_count == 0) {
             auto timeout_time = Time::from_milliseconds(500);
             auto timeout = Thread::BlockTimeout { false, &timeout_time };
             [[maybe_unused]] auto result = packet_wait_queue.wait_on(timeout, "NetworkTask"sv);
-            continue;
-        }
-        if (packet_size < sizeof(EthernetFrameHeader)) {
-            dbgln("NetworkTask: Packet is too small to be an Ethernet packet! ({})", packet_size);
-            continue;
-        }
-        auto& eth = *(EthernetFrameHeader const*)buffer;
-        dbgln_if(ETHERNET_DEBUG, "NetworkTask: From {} to {}, ether_type={:#04x}, packet_size={}", eth.source().to_string(), eth.destination().to_string(), eth.ether_type(), packet_size);
-
-        switch (eth.ether_type()) {
-        case EtherType::ARP:
-            handle_arp(eth, packet_size);
-            break;
-        case EtherType::IPv4:
-            handle_ipv4(eth, packet_size, packet_timestamp);
-            break;
-        case EtherType::IPv6:
-            // ignore
-            break;
-        default:
-            dbgln_if(ETHERNET_DEBUG, "NetworkTask: Unknown ethernet type {:#04x}", eth.ether_type());
         }
     }
 }
 
+void handle_packet(PacketWithTimestamp& packet)
+{
+    auto frame = packet.bytes();
+    if (frame.size() < sizeof(EthernetFrameHeader)) {
+        dbgln("NetworkTask: Packet is too small to be an Ethernet packet! ({})", frame.size());
+        return;
+    }
+    auto& eth = *(EthernetFrameHeader const*)frame.data();
+    dbgln_if(ETHERNET_DEBUG, "NetworkTask: From {} to {}, ether_type={:#04x}, packet_size={}", eth.source().to_string(), eth.destination().to_string(), eth.ether_type(), frame.size());
+
+    switch (eth.ether_type()) {
+    case EtherType::ARP:
+        handle_arp(eth, frame.size());
+        break;
+    case EtherType::IPv4:
+        handle_ipv4(eth, frame.size(), packet.timestamp, packet.ipv4_packet_sum);
+        break;
+    case EtherType::IPv6:
+        // ignore
+        break;
+    default:
+        dbgln_if(ETHERNET_DEBUG, "NetworkTask: Unknown ethernet type {:#04x}", eth.ether_type());
+    }
+}
+
 void handle_arp(EthernetFrameHeader const& eth, size_t frame_size)
 {
     constexpr size_t minimum_arp_frame_size = sizeof(EthernetFrameHeader) + sizeof(ARPPacket);
@@ -178,7 +177,47 @@ void handle_arp(EthernetFrameHeader const& eth, size_t frame_size)
     }
 }
 
-void handle_ipv4(EthernetFrameHeader const& eth, size_t frame_size, Time const& packet_timestamp)
+static bool has_valid_checksums(IPv4Packet const& packet, u16 packet_sum)
+{
+    // The header checksum covers the options too.
+    size_t header_length = packet.internet_header_length() * 4;
+    if (header_length < sizeof(IPv4Packet) || header_length > packet.length())
+        return false;
+    if (internet_checksum(&packet, header_length) != 0)
+        return false;
+
+    // The transport checksum covers the whole datagram, so it can't be checked on a single fragment.
+    if (packet.is_a_fragment())
+        return true;
+
+    auto const* payload = reinterpret_cast<u8 const*>(&packet) + header_length;
+    u16 payload_size = packet.length() - header_length;
+    auto protocol = static_cast<IPv4Protocol>(packet.protocol());
+    if (protocol == IPv4Protocol::UDP) {
+        // A zero UDP checksum means that the sender didn't compute one.
+        if (payload_size < sizeof(UDPPacket) || reinterpret_cast<UDPPacket const*>(payload)->checksum() == 0)
+            return true;
+    } else if (protocol != IPv4Protocol::TCP) {
+        return true;
+    }
+
+    struct [[gnu::packed]] PseudoHeader {
+        IPv4Address source;
+        IPv4Address destination;
+        u8 zero;
+        u8 protocol;
+        NetworkOrdered<u16> payload_size;
+    };
+    PseudoHeader pseudo_header { packet.source(), packet.destination(), 0, packet.protocol(), payload_size };
+
+    // A valid IPv4 header sums up to 0xffff, which doesn't change a one's complement sum,
+    // so the sum over the whole packet is the sum over its payload.
+    u32 sum = packet_sum + static_cast<u16>(~internet_checksum(&pseudo_header, sizeof(pseudo_header)));
+    sum = (sum & 0xffff) + (sum >> 16);
+    return sum == 0xffff;
+}
+
+void handle_ipv4(EthernetFrameHeader const& eth, size_t frame_size, Time const& packet_timestamp, Optional<u16> ipv4_packet_sum)
 {
     constexpr size_t minimum_ipv4_frame_size = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet);
     if (frame_size < minimum_ipv4_frame_size) {
@@ -198,6 +237,11 @@ void handle_ipv4(EthernetFrameHeader const& eth, size_t frame_size, Time const&
         return;
     }
 
+    if (ipv4_packet_sum.has_value() && !has_valid_checksums(packet, ipv4_packet_sum.value())) {
+        dbgln_if(IPV4_DEBUG, "handle_ipv4: Dropping packet from {} with invalid checksum", packet.source());
+        return;
+    }
+
     dbgln_if(IPV4_DEBUG, "handle_ipv4: source={}, destination={}", packet.source(), packet.destination());
 
     NetworkingManagement::the().for_each([&](auto& adapter) {
@@ -459,6 +503,7 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
             dbgln_if(TCP_DEBUG, "handle_tcp: created new client socket with tuple {}", client->tuple().to_string());
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            client->receive_syn_options(tcp_packet);
             [[maybe_unused]] auto rc2 = client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
             client->set_state(TCPSocket::State::SynReceived);
             return;
@@ -620,6 +665,13 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
         }
 
         if (tcp_packet.sequence_number() != socket->ack_number()) {
+            if (payload_size > 0 && !tcp_packet.has_fin()
+                && socket->queue_out_of_order_segment(tcp_packet.sequence_number(), payload_size, { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() }, packet_timestamp)) {
+                dbgln_if(TCP_DEBUG, "Queued out of order packet: seq {} vs. ack {}", tcp_packet.sequence_number(), socket->ack_number());
+                // Every segment past a hole gets a duplicate ACK, so the peer can detect the loss quickly.
+                [[maybe_unused]] auto result = socket->send_ack(true);
+                return;
+            }
             dbgln_if(TCP_DEBUG, "Discarding out of order packet: seq {} vs. ack {}", tcp_packet.sequence_number(), socket->ack_number());
             if (socket->duplicate_acks() < TCPSocket::maximum_duplicate_acks) {
                 dbgln_if(TCP_DEBUG, "Sending ACK with same ack number to trigger fast retransmission");
@@ -647,7 +699,11 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
                 socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
                 dbgln_if(TCP_DEBUG, "Got packet with ack_no={}, seq_no={}, payload_size={}, acking it with new ack_no={}, seq_no={}",
                     tcp_packet.ack_number(), tcp_packet.sequence_number(), payload_size, socket->ack_number(), socket->sequence_number());
-                send_delayed_tcp_ack(socket);
+                // If this filled a hole, acknowledge everything right away (RFC 5681 section 4.2).
+                if (socket->deliver_out_of_order_segments(ipv4_packet.source(), tcp_packet.source_port()))
+                    (void)socket->send_ack();
+                else
+                    send_delayed_tcp_ack(socket);
             }
         }
     }
@@ -124,6 +124,11 @@ bool NetworkingManagement::initialize()
     VERIFY(loopback);
     m_adapters.with([&](auto& adapters) { adapters.append(*loopback); });
     m_loopback_adapter = loopback;
+
+    for_each([](auto& adapter) {
+        if (auto result = adapter.initialize_packet_buffer_pool(); result.is_error())
+            dmesgln("NetworkingManagement: Couldn't allocate packet buffers for {}: {}", adapter.name(), result.error());
+    });
     return true;
 }
 }
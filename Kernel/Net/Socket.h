@@ -82,6 +82,10 @@ public:
     virtual ErrorOr<size_t> sendto(OpenFileDescription&, UserOrKernelBuffer const&, size_t, int flags, Userspace<sockaddr const*>, socklen_t) = 0;
     virtual ErrorOr<size_t> recvfrom(OpenFileDescription&, UserOrKernelBuffer&, size_t, int flags, Userspace<sockaddr*>, Userspace<socklen_t*>, Time&, bool blocking) = 0;
 
+    // Sends up to size bytes of the regular file behind source, starting at offset.
+    // Sockets that can read file contents straight into their outgoing packets override this.
+    virtual ErrorOr<size_t> sendfile(OpenFileDescription&, off_t, size_t) { return ENOTSUP; }
+
     virtual ErrorOr<void> setsockopt(int level, int option, Userspace<void const*>, socklen_t);
     virtual ErrorOr<void> getsockopt(OpenFileDescription&, int level, int option, Userspace<void*>, Userspace<socklen_t*>);
 
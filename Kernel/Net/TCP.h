@@ -22,6 +22,21 @@ struct TCPFlags {
     };
 };
 
+enum class TCPOptionKind : u8 {
+    End = 0,
+    NoOperation = 1,
+    MSS = 2,
+    WindowScale = 3,
+    SACKPermitted = 4,
+    SACK = 5,
+};
+
+// RFC 7323 caps the window scale shift at 14.
+static constexpr u8 maximum_tcp_window_scale = 14;
+
+// At most this many SACK blocks fit into the option space next to other options.
+static constexpr size_t maximum_tcp_sack_blocks = 3;
+
 class [[gnu::packed]] TCPOptionMSS {
 public:
     TCPOptionMSS(u16 value)
@@ -39,6 +54,40 @@ private:
 
 static_assert(AssertSize<TCPOptionMSS, 4>());
 
+class [[gnu::packed]] TCPOptionWindowScale {
+public:
+    TCPOptionWindowScale(u8 shift_count)
+        : m_shift_count(shift_count)
+    {
+    }
+
+    u8 shift_count() const { return m_shift_count; }
+
+private:
+    u8 m_padding { to_underlying(TCPOptionKind::NoOperation) };
+    u8 m_option_kind { to_underlying(TCPOptionKind::WindowScale) };
+    u8 m_option_length { 3 };
+    u8 m_shift_count { 0 };
+};
+
+static_assert(AssertSize<TCPOptionWindowScale, 4>());
+
+class [[gnu::packed]] TCPOptionSACKPermitted {
+private:
+    u8 m_padding[2] { to_underlying(TCPOptionKind::NoOperation), to_underlying(TCPOptionKind::NoOperation) };
+    u8 m_option_kind { to_underlying(TCPOptionKind::SACKPermitted) };
+    u8 m_option_length { 2 };
+};
+
+static_assert(AssertSize<TCPOptionSACKPermitted, 4>());
+
+struct [[gnu::packed]] TCPSACKBlock {
+    NetworkOrdered<u32> left_edge;
+    NetworkOrdered<u32> right_edge;
+};
+
+static_assert(AssertSize<TCPSACKBlock, 8>());
+
 class [[gnu::packed]] TCPPacket {
 public:
     TCPPacket() = default;
@@ -78,6 +127,8 @@ public:
     u16 urgent() const { return m_urgent; }
     void set_urgent(u16 urgent) { m_urgent = urgent; }
 
+    ReadonlyBytes options() const { return { ((u8 const*)this) + sizeof(TCPPacket), header_size() - sizeof(TCPPacket) }; }
+
     void const* payload() const { return ((u8 const*)this) + header_size(); }
     void* payload() { return ((u8*)this) + header_size(); }
 
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Net/TCPCongestionControl.h>
+
+namespace Kernel {
+
+Atomic<u32> TCPCongestionControl::default_algorithm { to_underlying(TCPCongestionControl::Algorithm::Cubic) };
+
+ErrorOr<NonnullOwnPtr<TCPCongestionControl>> TCPCongestionControl::try_create(Algorithm algorithm, size_t mss)
+{
+    switch (algorithm) {
+    case Algorithm::NewReno:
+        return TRY(try_make<TCPNewReno>(mss));
+    case Algorithm::Cubic:
+        return TRY(try_make<TCPCubic>(mss));
+    }
+    return EINVAL;
+}
+
+TCPCongestionControl::TCPCongestionControl(size_t mss)
+    : m_mss(mss)
+{
+    // RFC 6928 initial window.
+    m_congestion_window = min(10 * mss, max(2 * mss, static_cast<size_t>(14600)));
+}
+
+void TCPCongestionControl::slow_start(size_t bytes_acked)
+{
+    // RFC 3465 appropriate byte counting, with a limit of two segments per acknowledgement.
+    m_congestion_window += min(bytes_acked, 2 * m_mss);
+}
+
+size_t TCPCongestionControl::reduced_slow_start_threshold(size_t bytes_in_flight) const
+{
+    return max(bytes_in_flight / 2, 2 * m_mss);
+}
+
+void TCPCongestionControl::on_retransmit_timeout(size_t bytes_in_flight)
+{
+    m_slow_start_threshold = reduced_slow_start_threshold(bytes_in_flight);
+    m_congestion_window = m_mss;
+}
+
+void TCPNewReno::on_ack(size_t bytes_acked, Time const&, Time const&)
+{
+    if (is_in_slow_start()) {
+        slow_start(bytes_acked);
+        return;
+    }
+
+    m_bytes_acked_in_round += bytes_acked;
+    if (m_bytes_acked_in_round >= m_congestion_window) {
+        m_bytes_acked_in_round -= m_congestion_window;
+        m_congestion_window += m_mss;
+    }
+}
+
+void TCPNewReno::on_fast_retransmit(size_t bytes_in_flight, Time const&)
+{
+    m_slow_start_threshold = reduced_slow_start_threshold(bytes_in_flight);
+    m_congestion_window = m_slow_start_threshold;
+    m_bytes_acked_in_round = 0;
+}
+
+// The kernel can't use floating point, so the cubic function is evaluated with the
+// window in thousandths of a segment and the time in milliseconds.
+static constexpr u64 cubic_beta_numerator = 7;
+static constexpr u64 cubic_beta_denominator = 10;
+static constexpr i64 cubic_maximum_time_offset_ms = 100'000;
+
+static u64 integer_cube_root(u64 value)
+{
+    u64 low = 0;
+    u64 high = 2'642'245; // Cube root of 2^64, rounded down.
+    while (low < high) {
+        auto middle = (low + high + 1) / 2;
+        if (middle * middle * middle <= value)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
+
+void TCPCubic::reduce_window_max()
+{
+    // Fast convergence: If the window didn't get back to where it was before the previous loss,
+    // another flow is probably competing for the link, so release some bandwidth to it.
+    if (m_congestion_window < m_previous_window_max)
+        m_window_max = m_congestion_window * (cubic_beta_denominator + cubic_beta_numerator) / (2 * cubic_beta_denominator);
+    else
+        m_window_max = m_congestion_window;
+    m_previous_window_max = m_congestion_window;
+    m_epoch_start.clear();
+}
+
+void TCPCubic::on_fast_retransmit(size_t, Time const&)
+{
+    reduce_window_max();
+    m_slow_start_threshold = max(m_congestion_window * cubic_beta_numerator / cubic_beta_denominator, 2 * m_mss);
+    m_congestion_window = m_slow_start_threshold;
+}
+
+void TCPCubic::on_retransmit_timeout(size_t bytes_in_flight)
+{
+    reduce_window_max();
+    TCPCongestionControl::on_retransmit_timeout(bytes_in_flight);
+}
+
+void TCPCubic::on_ack(size_t bytes_acked, Time const& now, Time const& smoothed_rtt)
+{
+    if (is_in_slow_start()) {
+        slow_start(bytes_acked);
+        return;
+    }
+
+    if (!m_epoch_start.has_value()) {
+        m_epoch_start = now;
+        m_reno_window = m_congestion_window;
+        if (m_congestion_window < m_window_max) {
+            // K = cbrt((W_max - cwnd) / C) seconds, with C = 0.4.
+            u64 missing_millisegments = (m_window_max - m_congestion_window) * 1000 / m_mss;
+            m_time_to_window_max_ms = integer_cube_root(missing_millisegments * 2'500'000);
+        } else {
+            m_window_max = m_congestion_window;
+            m_time_to_window_max_ms = 0;
+        }
+    }
+
+    // Aim for the window the cubic function reaches one round trip from now.
+    i64 elapsed_ms = (now - *m_epoch_start + smoothed_rtt).to_milliseconds();
+    i64 offset_ms = clamp(elapsed_ms - static_cast<i64>(m_time_to_window_max_ms), -cubic_maximum_time_offset_ms, cubic_maximum_time_offset_ms);
+    // W_cubic(t) = C * (t - K)^3 + W_max, with C = 0.4 segments per second cubed.
+    i64 offset_millisegments = 4 * offset_ms * offset_ms * offset_ms / 10'000'000;
+    i64 target = static_cast<i64>(m_window_max) + offset_millisegments * static_cast<i64>(m_mss) / 1000;
+
+    // Don't grow slower than standard TCP would (RFC 8312 section 4.2).
+    m_reno_window += m_mss * bytes_acked * 3 * (cubic_beta_denominator - cubic_beta_numerator) / ((cubic_beta_denominator + cubic_beta_numerator) * m_congestion_window);
+    target = max(target, static_cast<i64>(m_reno_window));
+
+    // Grow by at most half the window per round trip (RFC 8312 section 4.1).
+    target = min(target, static_cast<i64>(m_congestion_window * 3 / 2));
+    if (target > static_cast<i64>(m_congestion_window))
+        m_congestion_window += max<size_t>((static_cast<size_t>(target) - m_congestion_window) * bytes_acked / m_congestion_window, 1);
+}
+
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Error.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+
+namespace Kernel {
+
+// Decides how much unacknowledged data a TCPSocket may have in flight.
+// The socket reports acknowledgements and losses, and limits itself to congestion_window().
+class TCPCongestionControl {
+public:
+    enum class Algorithm : u32 {
+        NewReno = 0,
+        Cubic = 1,
+    };
+
+    // Algorithm used by newly created sockets, exposed as /proc/sys/tcp_congestion_control.
+    static Atomic<u32> default_algorithm;
+
+    static ErrorOr<NonnullOwnPtr<TCPCongestionControl>> try_create(Algorithm, size_t mss);
+    virtual ~TCPCongestionControl() = default;
+
+    virtual StringView name() const = 0;
+
+    size_t congestion_window() const { return m_congestion_window; }
+    size_t slow_start_threshold() const { return m_slow_start_threshold; }
+    bool is_in_slow_start() const { return m_congestion_window < m_slow_start_threshold; }
+
+    // New data was acknowledged outside of loss recovery.
+    virtual void on_ack(size_t bytes_acked, Time const& now, Time const& smoothed_rtt) = 0;
+
+    // Loss was detected through duplicate acknowledgements, and recovery begins.
+    virtual void on_fast_retransmit(size_t bytes_in_flight, Time const& now) = 0;
+
+    // Everything up to the recovery point was acknowledged.
+    void on_recovery_complete() { m_congestion_window = m_slow_start_threshold; }
+
+    // The retransmission timer expired, so the network has probably lost everything in flight.
+    virtual void on_retransmit_timeout(size_t bytes_in_flight);
+
+protected:
+    explicit TCPCongestionControl(size_t mss);
+
+    void slow_start(size_t bytes_acked);
+    size_t reduced_slow_start_threshold(size_t bytes_in_flight) const;
+
+    size_t m_mss { 0 };
+    size_t m_congestion_window { 0 };
+    size_t m_slow_start_threshold { NumericLimits<size_t>::max() };
+};
+
+// RFC 5681 / RFC 6582: Additive increase of one segment per round trip, halve on loss.
+class TCPNewReno final : public TCPCongestionControl {
+public:
+    explicit TCPNewReno(size_t mss)
+        : TCPCongestionControl(mss)
+    {
+    }
+
+    virtual StringView name() const override { return "newreno"sv; }
+    virtual void on_ack(size_t bytes_acked, Time const& now, Time const& smoothed_rtt) override;
+    virtual void on_fast_retransmit(size_t bytes_in_flight, Time const& now) override;
+
+private:
+    size_t m_bytes_acked_in_round { 0 };
+};
+
+// RFC 8312: Grows the window as a cubic function of the time since the last loss,
+// which recovers much faster than NewReno on paths with a large bandwidth-delay product.
+class TCPCubic final : public TCPCongestionControl {
+public:
+    explicit TCPCubic(size_t mss)
+        : TCPCongestionControl(mss)
+    {
+    }
+
+    virtual StringView name() const override { return "cubic"sv; }
+    virtual void on_ack(size_t bytes_acked, Time const& now, Time const& smoothed_rtt) override;
+    virtual void on_fast_retransmit(size_t bytes_in_flight, Time const& now) override;
+    virtual void on_retransmit_timeout(size_t bytes_in_flight) override;
+
+private:
+    void reduce_window_max();
+
+    // Window sizes before the last reduction, in bytes.
+    size_t m_window_max { 0 };
+    size_t m_previous_window_max { 0 };
+    // Time it takes the cubic function to grow back to m_window_max, in milliseconds.
+    u64 m_time_to_window_max_ms { 0 };
+    Optional<Time> m_epoch_start;
+    // Window that standard TCP would have reached in the same time, in bytes.
+    size_t m_reno_window { 0 };
+};
+
+}
@@ -8,6 +8,7 @@
 #include <AK/Time.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Devices/RandomDevice.h>
+#include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/OpenFileDescription.h>
 #include <Kernel/Locking/MutexProtected.h>
 #include <Kernel/Net/EthernetFrameHeader.h>
@@ -22,6 +23,39 @@
 
 namespace Kernel {
 
+// Smallest shift that lets us advertise the whole receive buffer.
+static constexpr u8 receive_window_scale = [] {
+    u8 shift = 0;
+    while ((IPv4Socket::receive_buffer_size >> shift) > NumericLimits<u16>::max())
+        ++shift;
+    return shift;
+}();
+
+// Leave room for the headers, since the receive buffer has to fit whole packets.
+static constexpr size_t receive_window_headroom = sizeof(IPv4Packet) + 60;
+
+template<typename Callback>
+static void for_each_tcp_option(TCPPacket const& packet, Callback callback)
+{
+    auto options = packet.options();
+    for (size_t i = 0; i < options.size();) {
+        auto kind = static_cast<TCPOptionKind>(options[i]);
+        if (kind == TCPOptionKind::End)
+            return;
+        if (kind == TCPOptionKind::NoOperation) {
+            ++i;
+            continue;
+        }
+        if (i + 1 >= options.size())
+            return;
+        size_t length = options[i + 1];
+        if (length < 2 || i + length > options.size())
+            return;
+        callback(kind, options.slice(i + 2, length - 2));
+        i += length;
+    }
+}
+
 void TCPSocket::for_each(Function<void(TCPSocket const&)> callback)
 {
     sockets_by_tuple().for_each_shared([&](auto const& it) {
@@ -68,6 +102,11 @@ void TCPSocket::set_state(State new_state)
         clear_so_error();
     }
 
+    if (new_state == State::TimeWait || new_state == State::Closed) {
+        m_out_of_order_segments.clear();
+        m_out_of_order_bytes = 0;
+    }
+
     if (new_state == State::TimeWait) {
         // Once we hit TimeWait, we are only holding the socket in case there
         // are packets on the way which we wouldn't want a new socket to get hit
@@ -200,17 +239,59 @@ ErrorOr<size_t> TCPSocket::protocol_receive(ReadonlyBytes raw_ipv4_packet, UserO
     return payload_size;
 }
 
+size_t TCPSocket::maximum_segment_size(RoutingDecision const& routing_decision) const
+{
+    size_t mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
+    if (m_peer_mss)
+        mss = min(mss, m_peer_mss);
+    return mss;
+}
+
 ErrorOr<size_t> TCPSocket::protocol_send(UserOrKernelBuffer const& data, size_t data_length)
 {
     RoutingDecision routing_decision = route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
         return set_so_error(EHOSTUNREACH);
-    size_t mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-    data_length = min(data_length, mss);
+    data_length = min(data_length, maximum_segment_size(routing_decision));
     TRY(send_tcp_packet(TCPFlags::PSH | TCPFlags::ACK, &data, data_length, &routing_decision));
     return data_length;
 }
 
+ErrorOr<size_t> TCPSocket::sendfile(OpenFileDescription& source, off_t offset, size_t size)
+{
+    MutexLocker locker(mutex());
+    if (is_shut_down_for_writing() || !is_connected())
+        return set_so_error(EPIPE);
+
+    auto* inode = source.inode();
+    VERIFY(inode);
+
+    RoutingDecision routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return set_so_error(EHOSTUNREACH);
+    size = min(size, maximum_segment_size(routing_decision));
+    if (m_congestion_control) {
+        // can_write() only tells us that there's some room in the congestion window, so don't send more than that.
+        auto bytes_in_flight = m_unacked_packets.with_shared([&](auto& unacked_packets) { return unacked_packets.size - unacked_packets.sacked_size; });
+        auto congestion_window = m_congestion_control->congestion_window();
+        if (bytes_in_flight >= congestion_window)
+            return EAGAIN;
+        size = min(size, congestion_window - bytes_in_flight);
+    }
+
+    // Read the file contents straight into the packet, instead of staging them in a buffer first.
+    TRY(send_tcp_packet_impl(TCPFlags::PSH | TCPFlags::ACK, size, &routing_decision, [&](Bytes packet_payload) -> ErrorOr<void> {
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(packet_payload.data());
+        auto nread = TRY(inode->read_bytes(offset, packet_payload.size(), buffer, &source));
+        // The file got shorter under us, don't send garbage.
+        if (nread != packet_payload.size())
+            return EIO;
+        return {};
+    }));
+    Thread::current()->did_ipv4_socket_write(size);
+    return size;
+}
+
 ErrorOr<void> TCPSocket::send_ack(bool allow_duplicate)
 {
     if (!allow_duplicate && m_last_ack_number_sent == m_ack_number)
@@ -219,6 +300,16 @@ ErrorOr<void> TCPSocket::send_ack(bool allow_duplicate)
 }
 
 ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* payload, size_t payload_size, RoutingDecision* user_routing_decision)
+{
+    return send_tcp_packet_impl(flags, payload_size, user_routing_decision, [&](Bytes packet_payload) -> ErrorOr<void> {
+        if (!payload)
+            return {};
+        return payload->read(packet_payload.data(), packet_payload.size());
+    });
+}
+
+template<typename FillPayload>
+ErrorOr<void> TCPSocket::send_tcp_packet_impl(u16 flags, size_t payload_size, RoutingDecision* user_routing_decision, FillPayload fill_payload)
 {
     RoutingDecision routing_decision = user_routing_decision ? *user_routing_decision : route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
@@ -226,8 +317,25 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
 
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
 
-    bool const has_mss_option = flags == TCPFlags::SYN;
-    const size_t options_size = has_mss_option ? sizeof(TCPOptionMSS) : 0;
+    bool const is_syn = flags & TCPFlags::SYN;
+    // We offer window scaling and SACK in our own SYN, but only agree to them in a SYN-ACK if the peer offered them.
+    bool const is_syn_ack = is_syn && (flags & TCPFlags::ACK);
+    bool const has_window_scale_option = is_syn && (!is_syn_ack || m_window_scaling_enabled);
+    bool const has_sack_permitted_option = is_syn && (!is_syn_ack || m_sack_permitted);
+    Array<TCPSACKBlock, maximum_tcp_sack_blocks> sack_blocks;
+    size_t sack_block_count = 0;
+    if (!is_syn && (flags & TCPFlags::ACK) && m_sack_permitted)
+        sack_block_count = build_sack_blocks(sack_blocks.span());
+
+    size_t options_size = 0;
+    if (is_syn)
+        options_size += sizeof(TCPOptionMSS);
+    if (has_window_scale_option)
+        options_size += sizeof(TCPOptionWindowScale);
+    if (has_sack_permitted_option)
+        options_size += sizeof(TCPOptionSACKPermitted);
+    if (sack_block_count > 0)
+        options_size += 4 + sack_block_count * sizeof(TCPSACKBlock);
     const size_t tcp_header_size = sizeof(TCPPacket) + options_size;
     const size_t buffer_size = ipv4_payload_offset + tcp_header_size + payload_size;
     auto packet = routing_decision.adapter->acquire_packet_buffer(buffer_size);
@@ -241,35 +349,60 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(NumericLimits<u16>::max());
+    // The window in a SYN is never scaled.
+    u8 window_shift = (!is_syn && m_window_scaling_enabled) ? receive_window_scale : 0;
+    u16 window = min(receive_window() >> window_shift, NumericLimits<u16>::max());
+    tcp_packet.set_window_size(window);
     tcp_packet.set_sequence_number(m_sequence_number);
     tcp_packet.set_data_offset(tcp_header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
 
-    if (payload) {
-        if (auto result = payload->read(tcp_packet.payload(), payload_size); result.is_error()) {
+    if (payload_size > 0) {
+        if (auto result = fill_payload(Bytes { tcp_packet.payload(), payload_size }); result.is_error()) {
             routing_decision.adapter->release_packet_buffer(*packet);
             return set_so_error(result.release_error());
         }
     }
 
     if (flags & TCPFlags::ACK) {
+        m_last_advertised_window = static_cast<u32>(window) << window_shift;
         m_last_ack_number_sent = m_ack_number;
         m_last_ack_sent_time = kgettimeofday();
         tcp_packet.set_ack_number(m_ack_number);
     }
 
+    auto sequence_number = m_sequence_number;
     if (flags & TCPFlags::SYN) {
         ++m_sequence_number;
     } else {
         m_sequence_number += payload_size;
     }
 
-    if (has_mss_option) {
+    VERIFY(packet->buffer->size() >= ipv4_payload_offset + tcp_header_size);
+    auto* options = packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket);
+    if (is_syn) {
         u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
         TCPOptionMSS mss_option { mss };
-        VERIFY(packet->buffer->size() >= ipv4_payload_offset + sizeof(TCPPacket) + sizeof(mss_option));
-        memcpy(packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket), &mss_option, sizeof(mss_option));
+        memcpy(options, &mss_option, sizeof(mss_option));
+        options += sizeof(mss_option);
+        TRY(ensure_congestion_control(maximum_segment_size(routing_decision)));
+    }
+    if (has_window_scale_option) {
+        TCPOptionWindowScale window_scale_option { receive_window_scale };
+        memcpy(options, &window_scale_option, sizeof(window_scale_option));
+        options += sizeof(window_scale_option);
+    }
+    if (has_sack_permitted_option) {
+        TCPOptionSACKPermitted sack_permitted_option;
+        memcpy(options, &sack_permitted_option, sizeof(sack_permitted_option));
+        options += sizeof(sack_permitted_option);
+    }
+    if (sack_block_count > 0) {
+        options[0] = to_underlying(TCPOptionKind::NoOperation);
+        options[1] = to_underlying(TCPOptionKind::NoOperation);
+        options[2] = to_underlying(TCPOptionKind::SACK);
+        options[3] = 2 + sack_block_count * sizeof(TCPSACKBlock);
+        memcpy(options + 4, sack_blocks.data(), sack_block_count * sizeof(TCPSACKBlock));
     }
 
     tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
@@ -280,7 +413,11 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
     m_bytes_out += buffer_size;
     if (tcp_packet.has_syn() || payload_size > 0) {
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-            unacked_packets.packets.append({ m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter });
+            auto now = kgettimeofday();
+            // RFC 6298 (5.1): Start the retransmission timer when the first packet goes out.
+            if (unacked_packets.packets.is_empty())
+                m_last_retransmit_time = now;
+            unacked_packets.packets.append({ m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter, 0, sequence_number, payload_size, now });
             unacked_packets.size += payload_size;
             enqueue_for_retransmit();
         });
@@ -291,28 +428,210 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
     return {};
 }
 
+void TCPSocket::receive_syn_options(TCPPacket const& packet)
+{
+    bool peer_offered_window_scale = false;
+    bool peer_offered_sack = false;
+    for_each_tcp_option(packet, [&](TCPOptionKind kind, ReadonlyBytes data) {
+        switch (kind) {
+        case TCPOptionKind::MSS:
+            if (data.size() == sizeof(u16))
+                m_peer_mss = (data[0] << 8) | data[1];
+            break;
+        case TCPOptionKind::WindowScale:
+            if (data.size() == sizeof(u8)) {
+                peer_offered_window_scale = true;
+                m_send_window_scale = min(data[0], maximum_tcp_window_scale);
+            }
+            break;
+        case TCPOptionKind::SACKPermitted:
+            peer_offered_sack = true;
+            break;
+        default:
+            break;
+        }
+    });
+
+    // Both options only take effect if both sides sent them. We always offer them in our own SYN.
+    m_window_scaling_enabled = peer_offered_window_scale;
+    if (!m_window_scaling_enabled)
+        m_send_window_scale = 0;
+    m_sack_permitted = peer_offered_sack;
+    m_send_window_size = packet.window_size();
+}
+
+void TCPSocket::receive_sack_blocks(TCPPacket const& packet)
+{
+    for_each_tcp_option(packet, [&](TCPOptionKind kind, ReadonlyBytes data) {
+        if (kind != TCPOptionKind::SACK || data.size() % sizeof(TCPSACKBlock) != 0)
+            return;
+        for (size_t i = 0; i < data.size(); i += sizeof(TCPSACKBlock)) {
+            TCPSACKBlock block;
+            memcpy(&block, data.offset(i), sizeof(block));
+            u32 left_edge = block.left_edge;
+            u32 right_edge = block.right_edge;
+            if (!sequence_before(left_edge, right_edge))
+                continue;
+            m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+                for (auto& outgoing_packet : unacked_packets.packets) {
+                    if (sequence_before(right_edge, outgoing_packet.ack_number))
+                        break;
+                    if (outgoing_packet.sacked || outgoing_packet.payload_size == 0 || sequence_before(outgoing_packet.sequence_number, left_edge))
+                        continue;
+                    outgoing_packet.sacked = true;
+                    unacked_packets.sacked_size += outgoing_packet.payload_size;
+                    if (sequence_before(m_highest_sacked, outgoing_packet.ack_number))
+                        m_highest_sacked = outgoing_packet.ack_number;
+                }
+            });
+        }
+    });
+}
+
+size_t TCPSocket::build_sack_blocks(Span<TCPSACKBlock> blocks) const
+{
+    if (m_out_of_order_segments.is_empty() || blocks.is_empty())
+        return 0;
+
+    // Calls back with each contiguous range of queued data.
+    auto for_each_range = [&](auto callback) {
+        u32 left_edge = m_out_of_order_segments.first().sequence_number;
+        u32 right_edge = left_edge + m_out_of_order_segments.first().payload_size;
+        for (size_t i = 1; i < m_out_of_order_segments.size(); ++i) {
+            auto& segment = m_out_of_order_segments[i];
+            u32 segment_end = segment.sequence_number + segment.payload_size;
+            if (sequence_before(right_edge, segment.sequence_number)) {
+                callback(left_edge, right_edge);
+                left_edge = segment.sequence_number;
+                right_edge = segment_end;
+            } else if (sequence_before(right_edge, segment_end)) {
+                right_edge = segment_end;
+            }
+        }
+        callback(left_edge, right_edge);
+    };
+
+    // RFC 2018: The first block has to report the most recently received segment.
+    size_t count = 0;
+    Optional<u32> most_recent_left_edge;
+    for_each_range([&](u32 left_edge, u32 right_edge) {
+        if (count > 0 || sequence_before(m_last_out_of_order_sequence_number, left_edge) || !sequence_before(m_last_out_of_order_sequence_number, right_edge))
+            return;
+        blocks[count].left_edge = left_edge;
+        blocks[count].right_edge = right_edge;
+        ++count;
+        most_recent_left_edge = left_edge;
+    });
+    for_each_range([&](u32 left_edge, u32 right_edge) {
+        if (count >= blocks.size() || most_recent_left_edge == left_edge)
+            return;
+        blocks[count].left_edge = left_edge;
+        blocks[count].right_edge = right_edge;
+        ++count;
+    });
+    return count;
+}
+
+ErrorOr<void> TCPSocket::ensure_congestion_control(size_t mss)
+{
+    if (m_congestion_control)
+        return {};
+    auto algorithm = static_cast<TCPCongestionControl::Algorithm>(TCPCongestionControl::default_algorithm.load());
+    m_congestion_control = TRY(TCPCongestionControl::try_create(algorithm, mss));
+    return {};
+}
+
+u32 TCPSocket::receive_window() const
+{
+    // Only advertise what we can actually buffer, so the peer doesn't send packets we'd have to drop.
+    auto space = receive_buffer_space();
+    auto reserved = m_out_of_order_bytes + receive_window_headroom;
+    return space > reserved ? space - reserved : 0;
+}
+
+void TCPSocket::update_round_trip_time(Time const& sample)
+{
+    // RFC 6298 (2.2) and (2.3), with alpha = 1/8 and beta = 1/4.
+    if (!m_has_rtt_sample) {
+        m_has_rtt_sample = true;
+        m_smoothed_rtt = sample;
+        m_rtt_variance = Time::from_nanoseconds(sample.to_nanoseconds() / 2);
+    } else {
+        auto difference = m_smoothed_rtt < sample ? sample - m_smoothed_rtt : m_smoothed_rtt - sample;
+        m_rtt_variance = Time::from_nanoseconds((3 * m_rtt_variance.to_nanoseconds() + difference.to_nanoseconds()) / 4);
+        m_smoothed_rtt = Time::from_nanoseconds((7 * m_smoothed_rtt.to_nanoseconds() + sample.to_nanoseconds()) / 8);
+    }
+    auto timeout = m_smoothed_rtt + Time::from_nanoseconds(4 * m_rtt_variance.to_nanoseconds());
+    m_retransmit_timeout = clamp(timeout, minimum_retransmit_timeout, maximum_retransmit_timeout);
+}
+
+void TCPSocket::enter_loss_recovery(bool after_timeout)
+{
+    m_in_recovery = true;
+    m_recovering_from_timeout = after_timeout;
+    m_recovery_point = m_sequence_number;
+    m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+        for (auto& outgoing_packet : unacked_packets.packets)
+            outgoing_packet.retransmitted_in_recovery = false;
+    });
+}
+
+void TCPSocket::retransmit_next_hole(bool partial_ack)
+{
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return;
+
+    m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+        for (auto& outgoing_packet : unacked_packets.packets) {
+            if (outgoing_packet.sacked || outgoing_packet.retransmitted_in_recovery)
+                continue;
+            // Without SACK information, only the first unacknowledged packet is known to be lost.
+            // With it, everything below the highest SACKed packet that wasn't SACKed itself is.
+            if (!partial_ack && &outgoing_packet != &unacked_packets.packets.first() && !sequence_before(outgoing_packet.sequence_number, m_highest_sacked))
+                return;
+            outgoing_packet.retransmitted_in_recovery = true;
+            retransmit_packet(outgoing_packet, routing_decision);
+            return;
+        }
+    });
+}
+
 void TCPSocket::receive_tcp_packet(TCPPacket const& packet, u16 size)
 {
     if (packet.has_ack()) {
         u32 ack_number = packet.ack_number();
+        auto now = kgettimeofday();
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
 
+        if (packet.has_syn() && m_state == State::SynSent)
+            receive_syn_options(packet);
+
+        u32 send_window_size = packet.has_syn() ? packet.window_size() : static_cast<u32>(packet.window_size()) << m_send_window_scale;
+        bool send_window_grew = send_window_size > m_send_window_size;
+        m_send_window_size = send_window_size;
+
         int removed = 0;
+        size_t bytes_acked = 0;
+        Optional<Time> rtt_sample;
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
             while (!unacked_packets.packets.is_empty()) {
                 auto& packet = unacked_packets.packets.first();
 
                 dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
 
-                if (packet.ack_number <= ack_number) {
+                if (!sequence_before(ack_number, packet.ack_number)) {
                     auto old_adapter = packet.adapter.strong_ref();
                     if (old_adapter)
                         old_adapter->release_packet_buffer(*packet.buffer);
-                    TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                    auto payload_size = packet.buffer->buffer->data() + packet.buffer->buffer->size() - (u8*)tcp_packet.payload();
-                    unacked_packets.size -= payload_size;
-                    evaluate_block_conditions();
+                    unacked_packets.size -= packet.payload_size;
+                    if (packet.sacked)
+                        unacked_packets.sacked_size -= packet.payload_size;
+                    bytes_acked += packet.payload_size;
+                    // Karn's algorithm: Acknowledgements for retransmitted packets are ambiguous, so don't sample those.
+                    if (packet.tx_counter == 0)
+                        rtt_sample = now - packet.sent_time;
                     unacked_packets.packets.take_first();
                     removed++;
                 } else {
@@ -327,6 +646,55 @@ void TCPSocket::receive_tcp_packet(TCPPacket const& packet, u16 size)
 
             dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
         });
+
+        if (rtt_sample.has_value())
+            update_round_trip_time(*rtt_sample);
+
+        bool has_sacked_packets = m_unacked_packets.with_shared([&](auto& unacked_packets) { return unacked_packets.sacked_size > 0; });
+        if (!has_sacked_packets || sequence_before(m_highest_sacked, ack_number))
+            m_highest_sacked = ack_number;
+        if (m_sack_permitted)
+            receive_sack_blocks(packet);
+
+        if (removed > 0) {
+            m_last_ack_received = ack_number;
+            m_peer_duplicate_acks = 0;
+            m_retransmit_attempts = 0;
+            m_last_retransmit_time = now;
+            if (m_in_recovery) {
+                // After a timeout, the window starts over from a single segment and grows in slow start.
+                if (m_recovering_from_timeout && m_congestion_control)
+                    m_congestion_control->on_ack(bytes_acked, now, m_smoothed_rtt);
+                if (!sequence_before(ack_number, m_recovery_point)) {
+                    m_in_recovery = false;
+                    if (!m_recovering_from_timeout && m_congestion_control)
+                        m_congestion_control->on_recovery_complete();
+                } else {
+                    // RFC 6582: A partial acknowledgement means the next hole was lost as well.
+                    retransmit_next_hole(true);
+                }
+            } else if (m_congestion_control) {
+                m_congestion_control->on_ack(bytes_acked, now, m_smoothed_rtt);
+            }
+        } else if (ack_number == m_last_ack_received && size == packet.header_size() && !packet.has_syn() && !packet.has_fin() && !send_window_grew) {
+            auto bytes_in_flight = m_unacked_packets.with_shared([&](auto& unacked_packets) { return unacked_packets.packets.is_empty() ? 0 : unacked_packets.size - unacked_packets.sacked_size; });
+            if (bytes_in_flight > 0) {
+                ++m_peer_duplicate_acks;
+                if (!m_in_recovery && m_peer_duplicate_acks == fast_retransmit_threshold) {
+                    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) fast retransmit at {}", this, ack_number);
+                    if (m_congestion_control)
+                        m_congestion_control->on_fast_retransmit(bytes_in_flight, now);
+                    enter_loss_recovery(false);
+                    ++m_fast_retransmits;
+                    retransmit_next_hole(true);
+                } else if (m_in_recovery && m_sack_permitted) {
+                    retransmit_next_hole(false);
+                }
+            }
+        }
+
+        if (removed > 0 || send_window_grew)
+            evaluate_block_conditions();
     }
 
     m_packets_in++;
@@ -560,13 +928,13 @@ void TCPSocket::retransmit_packets()
 {
     auto now = kgettimeofday();
 
-    // RFC6298 says we should have at least one second between retransmits. According to
-    // RFC1122 we must do exponential backoff - even for SYN packets.
-    i64 retransmit_interval = 1;
-    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts; i++)
-        retransmit_interval *= 2;
+    // RFC 6298 (5.5): Back off exponentially on every expiry of the timer - even for SYN packets.
+    auto retransmit_interval = m_retransmit_timeout;
+    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts && retransmit_interval < maximum_retransmit_timeout; i++)
+        retransmit_interval = retransmit_interval + retransmit_interval;
+    retransmit_interval = min(retransmit_interval, maximum_retransmit_timeout);
 
-    if (m_last_retransmit_time > now - Time::from_seconds(retransmit_interval))
+    if (m_last_retransmit_time > now - retransmit_interval)
         return;
 
     dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) handling retransmit", this);
@@ -585,42 +953,59 @@ void TCPSocket::retransmit_packets()
     if (routing_decision.is_zero())
         return;
 
+    // Everything in flight is presumed lost, so start over from one segment and resend the oldest packet.
+    // The rest follows as the acknowledgements come in (RFC 5681 section 3.1).
+    auto bytes_in_flight = m_unacked_packets.with_shared([&](auto& unacked_packets) { return unacked_packets.size - unacked_packets.sacked_size; });
+    if (m_congestion_control)
+        m_congestion_control->on_retransmit_timeout(bytes_in_flight);
+    enter_loss_recovery(true);
+
     m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
         for (auto& packet : unacked_packets.packets) {
-            packet.tx_counter++;
-
-            if constexpr (TCP_SOCKET_DEBUG) {
-                auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                    local_address(), local_port(),
-                    peer_address(), peer_port(),
-                    (tcp_packet.has_syn() ? "SYN " : ""),
-                    (tcp_packet.has_ack() ? "ACK " : ""),
-                    (tcp_packet.has_fin() ? "FIN " : ""),
-                    (tcp_packet.has_rst() ? "RST " : ""),
-                    tcp_packet.sequence_number(),
-                    tcp_packet.ack_number(),
-                    packet.tx_counter);
-            }
+            if (packet.sacked)
+                continue;
+            packet.retransmitted_in_recovery = true;
+            retransmit_packet(packet, routing_decision);
+            break;
+        }
+    });
+}
 
-            size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
-            if (ipv4_payload_offset != packet.ipv4_payload_offset) {
-                // FIXME: Add support for this. This can happen if after a route change
-                // we ended up on another adapter which doesn't have the same layer 2 type
-                // like the previous adapter.
-                VERIFY_NOT_REACHED();
-            }
+void TCPSocket::retransmit_packet(OutgoingPacket& packet, RoutingDecision& routing_decision)
+{
+    packet.tx_counter++;
+    m_retransmits++;
+
+    if constexpr (TCP_SOCKET_DEBUG) {
+        auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
+        dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            local_address(), local_port(),
+            peer_address(), peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
+    }
+
+    size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
+    if (ipv4_payload_offset != packet.ipv4_payload_offset) {
+        // FIXME: Add support for this. This can happen if after a route change
+        // we ended up on another adapter which doesn't have the same layer 2 type
+        // like the previous adapter.
+        VERIFY_NOT_REACHED();
+    }
 
-            auto packet_buffer = packet.buffer->bytes();
+    auto packet_buffer = packet.buffer->bytes();
 
-            routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
-                local_address(), routing_decision.next_hop, peer_address(),
-                IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
-            routing_decision.adapter->send_packet(packet_buffer);
-            m_packets_out++;
-            m_bytes_out += packet_buffer.size();
-        }
-    });
+    routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
+        local_address(), routing_decision.next_hop, peer_address(),
+        IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
+    routing_decision.adapter->send_packet(packet_buffer);
+    m_packets_out++;
+    m_bytes_out += packet_buffer.size();
 }
 
 bool TCPSocket::can_write(OpenFileDescription const& file_description, u64 size) const
@@ -635,7 +1020,76 @@ bool TCPSocket::can_write(OpenFileDescription const& file_description, u64 size)
         return true;
 
     return m_unacked_packets.with_shared([&](auto& unacked_packets) {
-        return unacked_packets.size + size <= m_send_window_size;
+        if (unacked_packets.size + size > m_send_window_size)
+            return false;
+        // Packets the peer has SACKed have left the network, so they don't count against the congestion window.
+        // There has to be room for at least one byte, otherwise sendfile() would have nothing to send.
+        if (m_congestion_control && unacked_packets.size - unacked_packets.sacked_size + max<u64>(size, 1) > m_congestion_control->congestion_window())
+            return false;
+        return true;
     });
 }
+
+void TCPSocket::protocol_did_read()
+{
+    if (m_state != State::Established && m_state != State::FinWait1 && m_state != State::FinWait2)
+        return;
+
+    // Let the peer know about the freed up space once it's worth a packet, so it doesn't sit on a closed window
+    // until our next acknowledgement (RFC 1122 4.2.3.3).
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return;
+    auto threshold = min(receive_buffer_size / 2, maximum_segment_size(routing_decision));
+    if (receive_window() >= m_last_advertised_window + threshold)
+        (void)send_ack(true);
+}
+
+bool TCPSocket::queue_out_of_order_segment(u32 sequence_number, size_t payload_size, ReadonlyBytes raw_ipv4_packet, Time const& packet_timestamp)
+{
+    if (payload_size == 0 || !sequence_before(m_ack_number, sequence_number))
+        return false;
+    if (m_out_of_order_segments.size() >= maximum_out_of_order_segments || m_out_of_order_bytes + payload_size > receive_window())
+        return false;
+
+    size_t index = 0;
+    for (; index < m_out_of_order_segments.size(); ++index) {
+        auto& segment = m_out_of_order_segments[index];
+        if (segment.sequence_number == sequence_number) {
+            m_last_out_of_order_sequence_number = sequence_number;
+            return true;
+        }
+        if (sequence_before(sequence_number, segment.sequence_number))
+            break;
+    }
+
+    auto buffer_or_error = KBuffer::try_create_with_bytes("TCPSocket: Out of order segment"sv, raw_ipv4_packet);
+    if (buffer_or_error.is_error())
+        return false;
+    if (m_out_of_order_segments.try_insert(index, { sequence_number, payload_size, packet_timestamp, buffer_or_error.release_value() }).is_error())
+        return false;
+    m_out_of_order_bytes += payload_size;
+    m_last_out_of_order_sequence_number = sequence_number;
+    return true;
+}
+
+bool TCPSocket::deliver_out_of_order_segments(IPv4Address const& source_address, u16 source_port)
+{
+    bool did_deliver = false;
+    while (!m_out_of_order_segments.is_empty()) {
+        auto& segment = m_out_of_order_segments.first();
+        if (sequence_before(m_ack_number, segment.sequence_number))
+            break;
+        // Drop segments that overlap data we already have. The peer resends whatever is still missing.
+        if (segment.sequence_number == m_ack_number) {
+            if (!did_receive(source_address, source_port, segment.raw_ipv4_packet->bytes(), segment.timestamp))
+                break;
+            m_ack_number += segment.payload_size;
+            did_deliver = true;
+        }
+        m_out_of_order_bytes -= segment.payload_size;
+        m_out_of_order_segments.take_first();
+    }
+    return did_deliver;
+}
 }
@@ -13,6 +13,8 @@
 #include <Kernel/Library/LockWeakPtr.h>
 #include <Kernel/Locking/MutexProtected.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/TCP.h>
+#include <Kernel/Net/TCPCongestionControl.h>
 
 namespace Kernel {
 
@@ -139,6 +141,28 @@ public:
     void set_duplicate_acks(u32 acks) { m_duplicate_acks = acks; }
     u32 duplicate_acks() const { return m_duplicate_acks; }
 
+    // RFC 5681 says loss should be assumed after this many duplicate acknowledgements from the peer.
+    static constexpr u32 fast_retransmit_threshold = 3;
+
+    StringView congestion_control_name() const { return m_congestion_control ? m_congestion_control->name() : "none"sv; }
+    size_t congestion_window() const { return m_congestion_control ? m_congestion_control->congestion_window() : 0; }
+    size_t slow_start_threshold() const { return m_congestion_control ? m_congestion_control->slow_start_threshold() : 0; }
+    u32 send_window_size() const { return m_send_window_size; }
+    Time smoothed_round_trip_time() const { return m_smoothed_rtt; }
+    Time retransmit_timeout() const { return m_retransmit_timeout; }
+    u32 retransmits() const { return m_retransmits; }
+    u32 fast_retransmits() const { return m_fast_retransmits; }
+    bool is_sack_permitted() const { return m_sack_permitted; }
+    bool is_window_scaling_enabled() const { return m_window_scaling_enabled; }
+
+    // Picks up the MSS, window scale and SACK-permitted options of the peer's SYN.
+    void receive_syn_options(TCPPacket const&);
+
+    // Holds on to a segment that arrived ahead of a gap, so the peer only has to resend what was lost.
+    bool queue_out_of_order_segment(u32 sequence_number, size_t payload_size, ReadonlyBytes raw_ipv4_packet, Time const& packet_timestamp);
+    // Delivers queued segments that are now in order. Returns whether any were delivered.
+    bool deliver_out_of_order_segments(IPv4Address const& source_address, u16 source_port);
+
     ErrorOr<void> send_ack(bool allow_duplicate = false);
     ErrorOr<void> send_tcp_packet(u16 flags, UserOrKernelBuffer const* = nullptr, size_t = 0, RoutingDecision* = nullptr);
     void receive_tcp_packet(TCPPacket const&, u16 size);
@@ -161,6 +185,7 @@ public:
     virtual ErrorOr<void> close() override;
 
     virtual bool can_write(OpenFileDescription const&, u64) const override;
+    virtual ErrorOr<size_t> sendfile(OpenFileDescription& source, off_t offset, size_t) override;
 
     static NetworkOrdered<u16> compute_tcp_checksum(IPv4Address const& source, IPv4Address const& destination, TCPPacket const&, u16 payload_size);
 
@@ -175,6 +200,10 @@ private:
 
     virtual ErrorOr<size_t> protocol_receive(ReadonlyBytes raw_ipv4_packet, UserOrKernelBuffer& buffer, size_t buffer_size, int flags) override;
     virtual ErrorOr<size_t> protocol_send(UserOrKernelBuffer const&, size_t) override;
+    virtual void protocol_did_read() override;
+
+    template<typename FillPayload>
+    ErrorOr<void> send_tcp_packet_impl(u16 flags, size_t payload_size, RoutingDecision*, FillPayload);
     virtual ErrorOr<void> protocol_connect(OpenFileDescription&) override;
     virtual ErrorOr<u16> protocol_allocate_local_port() override;
     virtual ErrorOr<size_t> protocol_size(ReadonlyBytes raw_ipv4_packet) override;
@@ -185,6 +214,17 @@ private:
     void enqueue_for_retransmit();
     void dequeue_for_retransmit();
 
+    static bool sequence_before(u32 a, u32 b) { return static_cast<i32>(a - b) < 0; }
+
+    size_t maximum_segment_size(RoutingDecision const&) const;
+    ErrorOr<void> ensure_congestion_control(size_t mss);
+    u32 receive_window() const;
+    void update_round_trip_time(Time const& sample);
+    void receive_sack_blocks(TCPPacket const&);
+    size_t build_sack_blocks(Span<TCPSACKBlock>) const;
+    void enter_loss_recovery(bool after_timeout);
+    void retransmit_next_hole(bool partial_ack);
+
     LockWeakPtr<TCPSocket> m_originator;
     HashMap<IPv4SocketTuple, NonnullLockRefPtr<TCPSocket>> m_pending_release_for_accept;
     Direction m_direction { Direction::Unspecified };
@@ -204,13 +244,22 @@ private:
         size_t ipv4_payload_offset;
         LockWeakPtr<NetworkAdapter> adapter;
         int tx_counter { 0 };
+        u32 sequence_number { 0 };
+        size_t payload_size { 0 };
+        Time sent_time;
+        // The peer reported having received this packet out of order.
+        bool sacked { false };
+        bool retransmitted_in_recovery { false };
     };
 
     struct UnackedPackets {
         SinglyLinkedList<OutgoingPacket> packets;
         size_t size { 0 };
+        size_t sacked_size { 0 };
     };
 
+    void retransmit_packet(OutgoingPacket&, RoutingDecision&);
+
     MutexProtected<UnackedPackets> m_unacked_packets;
 
     u32 m_duplicate_acks { 0 };
@@ -219,12 +268,48 @@ private:
     Time m_last_ack_sent_time;
 
     // FIXME: Make this configurable (sysctl)
-    static constexpr u32 maximum_retransmits = 5;
+    static constexpr u32 maximum_retransmits = 8;
     Time m_last_retransmit_time;
     u32 m_retransmit_attempts { 0 };
-
-    // FIXME: Parse window size TCP option from the peer
+    u32 m_retransmits { 0 };
+    u32 m_fast_retransmits { 0 };
+
+    // RFC 6298 round-trip time estimation. The timeout starts at one second until we have a sample.
+    static constexpr Time minimum_retransmit_timeout = Time::from_milliseconds(200);
+    static constexpr Time maximum_retransmit_timeout = Time::from_seconds(60);
+    bool m_has_rtt_sample { false };
+    Time m_smoothed_rtt;
+    Time m_rtt_variance;
+    Time m_retransmit_timeout { Time::from_seconds(1) };
+
+    // Loss recovery (RFC 6582, with SACK information as in RFC 6675).
+    OwnPtr<TCPCongestionControl> m_congestion_control;
+    u32 m_last_ack_received { 0 };
+    u32 m_peer_duplicate_acks { 0 };
+    bool m_in_recovery { false };
+    bool m_recovering_from_timeout { false };
+    u32 m_recovery_point { 0 };
+    u32 m_highest_sacked { 0 };
+
+    // Peer's receive window, already scaled. Until we hear from the peer, assume the unscaled maximum.
     u32 m_send_window_size { 64 * KiB };
+    u16 m_peer_mss { 0 };
+    bool m_window_scaling_enabled { false };
+    u8 m_send_window_scale { 0 };
+    bool m_sack_permitted { false };
+    u32 m_last_advertised_window { 0 };
+
+    struct OutOfOrderSegment {
+        u32 sequence_number { 0 };
+        size_t payload_size { 0 };
+        Time timestamp;
+        NonnullOwnPtr<KBuffer> raw_ipv4_packet;
+    };
+
+    static constexpr size_t maximum_out_of_order_segments = 64;
+    Vector<OutOfOrderSegment> m_out_of_order_segments;
+    size_t m_out_of_order_bytes { 0 };
+    u32 m_last_out_of_order_sequence_number { 0 };
 
     IntrusiveListNode<TCPSocket> m_retransmit_list_node;
 
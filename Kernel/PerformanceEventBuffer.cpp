@@ -4,9 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/JsonArraySerializer.h>
-#include <AK/JsonObjectSerializer.h>
+#include <AK/HashFunctions.h>
 #include <AK/ScopeGuard.h>
+#include <Kernel/API/Perfcore.h>
 #include <Kernel/Arch/RegisterState.h>
 #include <Kernel/Arch/SafeMem.h>
 #include <Kernel/Arch/SmapDisabler.h>
@@ -165,6 +165,18 @@ ErrorOr<void> PerformanceEventBuffer::append_with_ip_and_bp(ProcessID pid, Threa
         event.data.read.start_timestamp = arg5;
         event.data.read.success = !arg6.is_error();
         break;
+    case PERF_EVENT_CPU_CYCLES:
+    case PERF_EVENT_INSTRUCTIONS:
+    case PERF_EVENT_CACHE_MISSES:
+    case PERF_EVENT_BRANCH_MISSES:
+        event.data.performance_counter.period = arg5;
+        break;
+    case PERF_EVENT_OFF_CPU:
+        event.data.off_cpu.duration_us = arg1;
+        memset(event.data.off_cpu.reason, 0, sizeof(event.data.off_cpu.reason));
+        if (!arg3.is_empty())
+            memcpy(event.data.off_cpu.reason, arg3.characters_without_null_termination(), min(arg3.length(), sizeof(event.data.off_cpu.reason) - 1));
+        break;
     default:
         return EINVAL;
     }
@@ -176,6 +188,10 @@ ErrorOr<void> PerformanceEventBuffer::append_with_ip_and_bp(ProcessID pid, Threa
     event.pid = pid.value();
     event.tid = tid.value();
     event.timestamp = TimeManagement::the().uptime_ms();
+
+    SpinlockLocker locker(m_lock);
+    if (m_count >= capacity())
+        return ENOBUFS;
     at(m_count++) = event;
     return {};
 }
@@ -187,30 +203,102 @@ PerformanceEvent& PerformanceEventBuffer::at(size_t index)
     return events[index];
 }
 
-template<typename Serializer>
-ErrorOr<void> PerformanceEventBuffer::to_json_impl(Serializer& object) const
+static u32 hash_stack(PerformanceEvent const& event)
 {
-    {
-        auto strings = TRY(object.add_array("strings"sv));
-        Vector<KString*> strings_sorted_by_index;
-        TRY(strings_sorted_by_index.try_resize(m_strings.size()));
+    u32 hash = event.stack_size;
+    for (size_t i = 0; i < event.stack_size; ++i)
+        hash = pair_int_hash(hash, ptr_hash(event.stack[i]));
+    return hash;
+}
 
-        for (auto& entry : m_strings) {
-            strings_sorted_by_index[entry.value] = const_cast<Kernel::KString*>(entry.key.ptr());
-        }
+static StringView fixed_string_view(char const* characters, size_t capacity)
+{
+    return { characters, strnlen(characters, capacity) };
+}
 
-        for (size_t i = 0; i < m_strings.size(); i++) {
-            TRY(strings.add(strings_sorted_by_index[i]->view()));
-        }
+ErrorOr<void> PerformanceEventBuffer::serialize(KBufferBuilder& builder) const
+{
+    // Other threads may keep appending events and registering strings while we're serializing.
+    // Events before the current count aren't modified until the buffer is cleared, and registered strings are never
+    // removed, so a snapshot of both stays valid.
+    size_t event_count;
+    {
+        SpinlockLocker locker(m_lock);
+        event_count = m_count;
+    }
 
-        TRY(strings.finish());
+    Vector<KString const*> registered_strings;
+    {
+        MutexLocker locker(m_strings_lock);
+        TRY(registered_strings.try_resize(m_strings.size()));
+        for (auto& entry : m_strings)
+            registered_strings[entry.value] = entry.key.ptr();
     }
 
+    Perfcore::FileHeader file_header { Perfcore::magic, Perfcore::version, 0 };
+    TRY(builder.append_bytes({ &file_header, sizeof(file_header) }));
+
+    auto append_record = [&](Perfcore::RecordType type, ReadonlyBytes header, ReadonlyBytes payload) -> ErrorOr<void> {
+        Perfcore::RecordHeader record_header { type, static_cast<u32>(header.size() + payload.size()) };
+        TRY(builder.append_bytes({ &record_header, sizeof(record_header) }));
+        TRY(builder.append_bytes(header));
+        if (!payload.is_empty())
+            TRY(builder.append_bytes(payload));
+        return {};
+    };
+
+    // The strings are either owned by m_strings or live inside the events, so they outlive this function.
+    HashMap<StringView, u32> string_ids;
+    auto intern_string = [&](StringView string) -> ErrorOr<u32> {
+        if (auto id = string_ids.get(string); id.has_value())
+            return id.value();
+        u32 id = string_ids.size();
+        TRY(string_ids.try_set(string, id));
+        Perfcore::StringRecord record { id, static_cast<u32>(string.length()) };
+        TRY(append_record(Perfcore::RecordType::String, { &record, sizeof(record) }, string.bytes()));
+        return id;
+    };
+    auto intern_registered_string = [&](FlatPtr index) -> ErrorOr<u32> {
+        if (index >= registered_strings.size())
+            return Perfcore::invalid_id;
+        return intern_string(registered_strings[index]->view());
+    };
+
     auto current_process_credentials = Process::current().credentials();
     bool show_kernel_addresses = current_process_credentials->is_superuser();
-    auto array = TRY(object.add_array("events"sv));
+
+    // Consecutive samples tend to have the same stack, so each distinct one is only sent once.
+    // On a hash collision, the stack is simply sent again under a new id.
+    HashMap<u32, u32> stack_ids_by_hash;
+    Vector<size_t> first_event_index_by_stack_id;
+    auto intern_stack = [&](size_t event_index) -> ErrorOr<u32> {
+        auto const& event = at(event_index);
+        if (event.stack_size == 0)
+            return Perfcore::invalid_id;
+        auto hash = hash_stack(event);
+        if (auto id = stack_ids_by_hash.get(hash); id.has_value()) {
+            auto const& other = at(first_event_index_by_stack_id[id.value()]);
+            if (other.stack_size == event.stack_size && !memcmp(other.stack, event.stack, event.stack_size * sizeof(FlatPtr)))
+                return id.value();
+        }
+        u32 id = first_event_index_by_stack_id.size();
+        TRY(first_event_index_by_stack_id.try_append(event_index));
+        TRY(stack_ids_by_hash.try_set(hash, id));
+
+        u64 frames[PerformanceEvent::max_stack_frame_count];
+        for (size_t i = 0; i < event.stack_size; ++i) {
+            auto address = event.stack[i];
+            if (!show_kernel_addresses && !Memory::is_user_address(VirtualAddress { address }))
+                address = 0xdeadc0de;
+            frames[i] = address;
+        }
+        Perfcore::StackRecord record { id, event.stack_size };
+        TRY(append_record(Perfcore::RecordType::Stack, { &record, sizeof(record) }, { frames, event.stack_size * sizeof(u64) }));
+        return id;
+    };
+
     bool seen_first_sample = false;
-    for (size_t i = 0; i < m_count; ++i) {
+    for (size_t i = 0; i < event_count; ++i) {
         auto const& event = at(i);
 
         if (!show_kernel_addresses) {
@@ -218,112 +306,106 @@ ErrorOr<void> PerformanceEventBuffer::to_json_impl(Serializer& object) const
                 continue;
         }
 
-        auto event_object = TRY(array.add_object());
+        // Each case fills in the payload, and interns the strings it refers to before the event record is written.
+        union {
+            Perfcore::AllocationPayload allocation;
+            Perfcore::MmapPayload mmap;
+            Perfcore::ProcessCreatePayload process_create;
+            Perfcore::ProcessExecPayload process_exec;
+            Perfcore::ThreadCreatePayload thread_create;
+            Perfcore::ContextSwitchPayload context_switch;
+            Perfcore::SignpostPayload signpost;
+            Perfcore::ReadPayload read;
+            Perfcore::PerformanceCounterPayload performance_counter;
+            Perfcore::OffCpuPayload off_cpu;
+        } payload;
+        size_t payload_size = 0;
+
         switch (event.type) {
-        case PERF_EVENT_SAMPLE:
-            TRY(event_object.add("type"sv, "sample"));
-            break;
         case PERF_EVENT_MALLOC:
-            TRY(event_object.add("type"sv, "malloc"));
-            TRY(event_object.add("ptr"sv, static_cast<u64>(event.data.malloc.ptr)));
-            TRY(event_object.add("size"sv, static_cast<u64>(event.data.malloc.size)));
+            payload.allocation = { event.data.malloc.ptr, event.data.malloc.size };
+            payload_size = sizeof(payload.allocation);
             break;
         case PERF_EVENT_FREE:
-            TRY(event_object.add("type"sv, "free"));
-            TRY(event_object.add("ptr"sv, static_cast<u64>(event.data.free.ptr)));
+            payload.allocation = { event.data.free.ptr, 0 };
+            payload_size = sizeof(payload.allocation);
             break;
         case PERF_EVENT_MMAP:
-            TRY(event_object.add("type"sv, "mmap"));
-            TRY(event_object.add("ptr"sv, static_cast<u64>(event.data.mmap.ptr)));
-            TRY(event_object.add("size"sv, static_cast<u64>(event.data.mmap.size)));
-            TRY(event_object.add("name"sv, event.data.mmap.name));
+            payload.mmap = { event.data.mmap.ptr, event.data.mmap.size, TRY(intern_string(fixed_string_view(event.data.mmap.name, sizeof(event.data.mmap.name)))) };
+            payload_size = sizeof(payload.mmap);
             break;
         case PERF_EVENT_MUNMAP:
-            TRY(event_object.add("type"sv, "munmap"));
-            TRY(event_object.add("ptr"sv, static_cast<u64>(event.data.munmap.ptr)));
-            TRY(event_object.add("size"sv, static_cast<u64>(event.data.munmap.size)));
+            payload.allocation = { event.data.munmap.ptr, event.data.munmap.size };
+            payload_size = sizeof(payload.allocation);
             break;
         case PERF_EVENT_PROCESS_CREATE:
-            TRY(event_object.add("type"sv, "process_create"));
-            TRY(event_object.add("parent_pid"sv, static_cast<u64>(event.data.process_create.parent_pid)));
-            TRY(event_object.add("executable"sv, event.data.process_create.executable));
+            payload.process_create = { event.data.process_create.parent_pid, TRY(intern_string(fixed_string_view(event.data.process_create.executable, sizeof(event.data.process_create.executable)))) };
+            payload_size = sizeof(payload.process_create);
             break;
         case PERF_EVENT_PROCESS_EXEC:
-            TRY(event_object.add("type"sv, "process_exec"));
-            TRY(event_object.add("executable"sv, event.data.process_exec.executable));
-            break;
-        case PERF_EVENT_PROCESS_EXIT:
-            TRY(event_object.add("type"sv, "process_exit"));
+            payload.process_exec = { TRY(intern_string(fixed_string_view(event.data.process_exec.executable, sizeof(event.data.process_exec.executable)))) };
+            payload_size = sizeof(payload.process_exec);
             break;
         case PERF_EVENT_THREAD_CREATE:
-            TRY(event_object.add("type"sv, "thread_create"));
-            TRY(event_object.add("parent_tid"sv, static_cast<u64>(event.data.thread_create.parent_tid)));
-            break;
-        case PERF_EVENT_THREAD_EXIT:
-            TRY(event_object.add("type"sv, "thread_exit"));
+            payload.thread_create = { event.data.thread_create.parent_tid };
+            payload_size = sizeof(payload.thread_create);
             break;
         case PERF_EVENT_CONTEXT_SWITCH:
-            TRY(event_object.add("type"sv, "context_switch"));
-            TRY(event_object.add("next_pid"sv, static_cast<u64>(event.data.context_switch.next_pid)));
-            TRY(event_object.add("next_tid"sv, static_cast<u64>(event.data.context_switch.next_tid)));
+            payload.context_switch = { event.data.context_switch.next_pid, event.data.context_switch.next_tid };
+            payload_size = sizeof(payload.context_switch);
             break;
         case PERF_EVENT_KMALLOC:
-            TRY(event_object.add("type"sv, "kmalloc"));
-            TRY(event_object.add("ptr"sv, static_cast<u64>(event.data.kmalloc.ptr)));
-            TRY(event_object.add("size"sv, static_cast<u64>(event.data.kmalloc.size)));
+            payload.allocation = { event.data.kmalloc.ptr, event.data.kmalloc.size };
+            payload_size = sizeof(payload.allocation);
             break;
         case PERF_EVENT_KFREE:
-            TRY(event_object.add("type"sv, "kfree"));
-            TRY(event_object.add("ptr"sv, static_cast<u64>(event.data.kfree.ptr)));
-            TRY(event_object.add("size"sv, static_cast<u64>(event.data.kfree.size)));
-            break;
-        case PERF_EVENT_PAGE_FAULT:
-            TRY(event_object.add("type"sv, "page_fault"));
-            break;
-        case PERF_EVENT_SYSCALL:
-            TRY(event_object.add("type"sv, "syscall"));
+            payload.allocation = { event.data.kfree.ptr, event.data.kfree.size };
+            payload_size = sizeof(payload.allocation);
             break;
         case PERF_EVENT_SIGNPOST:
-            TRY(event_object.add("type"sv, "signpost"sv));
-            TRY(event_object.add("arg1"sv, event.data.signpost.arg1));
-            TRY(event_object.add("arg2"sv, event.data.signpost.arg2));
+            payload.signpost = { TRY(intern_registered_string(event.data.signpost.arg1)), event.data.signpost.arg1, event.data.signpost.arg2 };
+            payload_size = sizeof(payload.signpost);
             break;
         case PERF_EVENT_READ:
-            TRY(event_object.add("type"sv, "read"));
-            TRY(event_object.add("fd"sv, event.data.read.fd));
-            TRY(event_object.add("size"sv, event.data.read.size));
-            TRY(event_object.add("filename_index"sv, event.data.read.filename_index));
-            TRY(event_object.add("start_timestamp"sv, event.data.read.start_timestamp));
-            TRY(event_object.add("success"sv, event.data.read.success));
+            payload.read = {
+                event.data.read.fd,
+                event.data.read.size,
+                TRY(intern_registered_string(event.data.read.filename_index)),
+                event.data.read.start_timestamp,
+                event.data.read.success,
+            };
+            payload_size = sizeof(payload.read);
+            break;
+        case PERF_EVENT_CPU_CYCLES:
+        case PERF_EVENT_INSTRUCTIONS:
+        case PERF_EVENT_CACHE_MISSES:
+        case PERF_EVENT_BRANCH_MISSES:
+            payload.performance_counter = { event.data.performance_counter.period };
+            payload_size = sizeof(payload.performance_counter);
+            break;
+        case PERF_EVENT_OFF_CPU:
+            payload.off_cpu = { event.data.off_cpu.duration_us, TRY(intern_string(fixed_string_view(event.data.off_cpu.reason, sizeof(event.data.off_cpu.reason)))) };
+            payload_size = sizeof(payload.off_cpu);
+            break;
+        default:
             break;
         }
-        TRY(event_object.add("pid"sv, event.pid));
-        TRY(event_object.add("tid"sv, event.tid));
-        TRY(event_object.add("timestamp"sv, event.timestamp));
-        TRY(event_object.add("lost_samples"sv, seen_first_sample ? event.lost_samples : 0));
+
+        Perfcore::EventRecord record {
+            .type = event.type,
+            .pid = event.pid,
+            .tid = event.tid,
+            .timestamp = event.timestamp,
+            .lost_samples = seen_first_sample ? event.lost_samples : 0,
+            .stack_id = TRY(intern_stack(i)),
+        };
         if (event.type == PERF_EVENT_SAMPLE)
             seen_first_sample = true;
-        auto stack_array = TRY(event_object.add_array("stack"sv));
-        for (size_t j = 0; j < event.stack_size; ++j) {
-            auto address = event.stack[j];
-            if (!show_kernel_addresses && !Memory::is_user_address(VirtualAddress { address }))
-                address = 0xdeadc0de;
-            TRY(stack_array.add(address));
-        }
-        TRY(stack_array.finish());
-        TRY(event_object.finish());
+        TRY(append_record(Perfcore::RecordType::Event, { &record, sizeof(record) }, { &payload, payload_size }));
     }
-    TRY(array.finish());
-    TRY(object.finish());
     return {};
 }
 
-ErrorOr<void> PerformanceEventBuffer::to_json(KBufferBuilder& builder) const
-{
-    auto object = TRY(JsonObjectSerializer<>::try_create(builder));
-    return to_json_impl(object);
-}
-
 OwnPtr<PerformanceEventBuffer> PerformanceEventBuffer::try_create_with_size(size_t buffer_size)
 {
     auto buffer_or_error = KBuffer::try_create_with_size("Performance events"sv, buffer_size, Memory::Region::Access::ReadWrite, AllocationStrategy::AllocateNow);
@@ -363,6 +445,7 @@ ErrorOr<void> PerformanceEventBuffer::add_process(Process const& process, Proces
 
 ErrorOr<FlatPtr> PerformanceEventBuffer::register_string(NonnullOwnPtr<KString> string)
 {
+    MutexLocker locker(m_strings_lock);
     auto it = m_strings.find(string);
     if (it != m_strings.end()) {
         return it->value;
@@ -8,6 +8,8 @@
 
 #include <AK/Error.h>
 #include <Kernel/KBuffer.h>
+#include <Kernel/Locking/Mutex.h>
+#include <Kernel/Locking/Spinlock.h>
 
 namespace Kernel {
 
@@ -76,6 +78,15 @@ struct [[gnu::packed]] ReadPerformanceEvent {
     bool success;
 };
 
+struct [[gnu::packed]] PerformanceCounterPerformanceEvent {
+    u64 period;
+};
+
+struct [[gnu::packed]] OffCpuPerformanceEvent {
+    u64 duration_us;
+    char reason[32];
+};
+
 struct [[gnu::packed]] PerformanceEvent {
     u32 type { 0 };
     u8 stack_size { 0 };
@@ -96,6 +107,8 @@ struct [[gnu::packed]] PerformanceEvent {
         KFreePerformanceEvent kfree;
         SignpostPerformanceEvent signpost;
         ReadPerformanceEvent read;
+        PerformanceCounterPerformanceEvent performance_counter;
+        OffCpuPerformanceEvent off_cpu;
     } data;
     static constexpr size_t max_stack_frame_count = 64;
     FlatPtr stack[max_stack_frame_count];
@@ -118,6 +131,7 @@ public:
 
     void clear()
     {
+        SpinlockLocker locker(m_lock);
         m_count = 0;
     }
 
@@ -128,7 +142,8 @@ public:
         return const_cast<PerformanceEventBuffer&>(*this).at(index);
     }
 
-    ErrorOr<void> to_json(KBufferBuilder&) const;
+    // Writes the events in the binary perfcore format, see Kernel/API/Perfcore.h.
+    ErrorOr<void> serialize(KBufferBuilder&) const;
 
     ErrorOr<void> add_process(Process const&, ProcessEventType event_type);
 
@@ -137,14 +152,16 @@ public:
 private:
     explicit PerformanceEventBuffer(NonnullOwnPtr<KBuffer>);
 
-    template<typename Serializer>
-    ErrorOr<void> to_json_impl(Serializer&) const;
-
     PerformanceEvent& at(size_t index);
 
+    // Threads of the same process append to its buffer concurrently, and samples are appended from interrupt context.
+    Spinlock m_lock { LockRank::None };
     size_t m_count { 0 };
     NonnullOwnPtr<KBuffer> m_buffer;
 
+    // Registering a string allocates, which we can't do while holding m_lock. Strings are only
+    // registered from syscalls, so they get a Mutex of their own.
+    mutable Mutex m_strings_lock { "PerformanceEventBuffer strings"sv };
     HashMap<NonnullOwnPtr<KString>, size_t> m_strings;
 };
 
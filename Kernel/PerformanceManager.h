@@ -66,6 +66,33 @@ public:
         }
     }
 
+    inline static void add_performance_counter_event(Thread& current_thread, RegisterState const& regs, int type, u64 period)
+    {
+        if (current_thread.is_profiling_suppressed())
+            return;
+        if (auto* event_buffer = current_thread.process().current_perf_events_buffer()) {
+            [[maybe_unused]] auto rc = event_buffer->append_with_ip_and_bp(
+                current_thread.pid(), current_thread.tid(), regs, type, 0, 0, 0, {}, 0, period);
+        }
+    }
+
+    // Lets callers avoid reading the clock when nobody is interested in how long the thread is off-CPU.
+    inline static bool is_recording_off_cpu_time(Thread& thread)
+    {
+        if (!(g_profiling_event_mask & PERF_EVENT_OFF_CPU) || thread.is_profiling_suppressed())
+            return false;
+        return thread.process().current_perf_events_buffer() != nullptr;
+    }
+
+    inline static void add_off_cpu_event(Thread& thread, Time duration, StringView reason)
+    {
+        if (thread.is_profiling_suppressed())
+            return;
+        if (auto* event_buffer = thread.process().current_perf_events_buffer()) {
+            [[maybe_unused]] auto rc = event_buffer->append(PERF_EVENT_OFF_CPU, duration.to_microseconds(), 0, reason, &thread);
+        }
+    }
+
     inline static void add_mmap_perf_event(Process& current_process, Memory::Region const& region)
     {
         if (auto* event_buffer = current_process.current_perf_events_buffer()) {
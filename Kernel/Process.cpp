@@ -10,6 +10,7 @@
 #include <AK/Types.h>
 #include <Kernel/API/Syscall.h>
 #include <Kernel/Arch/InterruptDisabler.h>
+#include <Kernel/Arch/x86/PerformanceCounters.h>
 #include <Kernel/Coredump.h>
 #include <Kernel/Credentials.h>
 #include <Kernel/Debug.h>
@@ -604,15 +605,15 @@ ErrorOr<void> Process::dump_perfcore()
     }
 
     auto builder = TRY(KBufferBuilder::try_create());
-    TRY(m_perf_event_buffer->to_json(builder));
+    TRY(m_perf_event_buffer->serialize(builder));
 
-    auto json = builder.build();
-    if (!json) {
+    auto perfcore = builder.build();
+    if (!perfcore) {
         dbgln("Failed to generate perfcore for pid {}: Could not allocate buffer.", pid().value());
         return ENOMEM;
     }
-    auto json_buffer = UserOrKernelBuffer::for_kernel_buffer(json->data());
-    TRY(description->write(json_buffer, json->size()));
+    auto perfcore_buffer = UserOrKernelBuffer::for_kernel_buffer(perfcore->data());
+    TRY(description->write(perfcore_buffer, perfcore->size()));
 
     dbgln("Wrote perfcore for pid {} to {}", pid().value(), perfcore_filename);
     return {};
@@ -642,6 +643,8 @@ void Process::finalize()
             if (result.is_error())
                 dmesgln("Failed to write perfcore for pid {}: {}", pid(), result.error());
             TimeManagement::the().disable_profile_timer();
+            if (is_profiling())
+                PerformanceCounters::disable();
         }
     }
 
@@ -320,7 +320,7 @@ public:
     ErrorOr<FlatPtr> sys$stat(Userspace<Syscall::SC_stat_params const*>);
     ErrorOr<FlatPtr> sys$lseek(int fd, Userspace<off_t*>, int whence);
     ErrorOr<FlatPtr> sys$ftruncate(int fd, Userspace<off_t const*>);
-    ErrorOr<FlatPtr> sys$posix_fallocate(int fd, Userspace<off_t const*>, Userspace<off_t const*>);
+    ErrorOr<FlatPtr> sys$fallocate(int fd, int mode, Userspace<off_t const*>, Userspace<off_t const*>);
     ErrorOr<FlatPtr> sys$kill(pid_t pid_or_pgid, int sig);
     [[noreturn]] void sys$exit(int status);
     ErrorOr<FlatPtr> sys$sigreturn(RegisterState& registers);
@@ -335,6 +335,9 @@ public:
     ErrorOr<FlatPtr> sys$msync(Userspace<void*>, size_t, int flags);
     ErrorOr<FlatPtr> sys$purge(int mode);
     ErrorOr<FlatPtr> sys$poll(Userspace<Syscall::SC_poll_params const*>);
+    ErrorOr<FlatPtr> sys$epoll_create(int flags);
+    ErrorOr<FlatPtr> sys$epoll_ctl(int epfd, int op, int fd, Userspace<struct epoll_event const*>);
+    ErrorOr<FlatPtr> sys$epoll_wait(int epfd, Userspace<struct epoll_event*>, int max_events, int timeout);
     ErrorOr<FlatPtr> sys$get_dir_entries(int fd, Userspace<void*>, size_t);
     ErrorOr<FlatPtr> sys$getcwd(Userspace<char*>, size_t);
     ErrorOr<FlatPtr> sys$chdir(Userspace<char const*>, size_t);
@@ -427,6 +430,7 @@ public:
     ErrorOr<FlatPtr> sys$get_stack_bounds(Userspace<FlatPtr*> stack_base, Userspace<size_t*> stack_size);
     ErrorOr<FlatPtr> sys$ptrace(Userspace<Syscall::SC_ptrace_params const*>);
     ErrorOr<FlatPtr> sys$sendfd(int sockfd, int fd);
+    ErrorOr<FlatPtr> sys$sendfile(int out_fd, int in_fd, Userspace<off_t*> offset, size_t count);
     ErrorOr<FlatPtr> sys$recvfd(int sockfd, int options);
     ErrorOr<FlatPtr> sys$sysconf(int name);
     ErrorOr<FlatPtr> sys$disown(ProcessID);
@@ -184,6 +184,33 @@ ErrorOr<void> ProcFSSystemBoolean::truncate(u64 size)
     return {};
 }
 
+ErrorOr<void> ProcFSSystemUnsigned::try_generate(KBufferBuilder& builder)
+{
+    return builder.appendff("{}\n", value());
+}
+
+ErrorOr<size_t> ProcFSSystemUnsigned::write_bytes(off_t, size_t count, UserOrKernelBuffer const& buffer, OpenFileDescription*)
+{
+    // Enough for any u32 in decimal, plus a trailing newline.
+    char digits[11];
+    if (count == 0 || count > sizeof(digits))
+        return EINVAL;
+    MutexLocker locker(m_refresh_lock);
+    TRY(buffer.read(digits, count));
+    auto new_value = StringView { digits, count }.trim_whitespace().to_uint<u32>();
+    if (!new_value.has_value())
+        return EINVAL;
+    TRY(set_value(new_value.value()));
+    return count;
+}
+
+ErrorOr<void> ProcFSSystemUnsigned::truncate(u64 size)
+{
+    if (size != 0)
+        return EPERM;
+    return {};
+}
+
 ErrorOr<size_t> ProcFSExposedLink::read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, OpenFileDescription*) const
 {
     VERIFY(offset == 0);
@@ -202,4 +202,25 @@ private:
     virtual ErrorOr<void> truncate(u64) override final;
 };
 
+class ProcFSSystemUnsigned : public ProcFSGlobalInformation {
+public:
+    virtual u32 value() const = 0;
+    virtual ErrorOr<void> set_value(u32 new_value) = 0;
+
+protected:
+    explicit ProcFSSystemUnsigned(StringView name)
+        : ProcFSGlobalInformation(name)
+    {
+    }
+
+private:
+    // ^ProcFSGlobalInformation
+    virtual ErrorOr<void> try_generate(KBufferBuilder&) override final;
+
+    // ^ProcFSExposedComponent
+    virtual ErrorOr<size_t> write_bytes(off_t, size_t, UserOrKernelBuffer const&, OpenFileDescription*) override final;
+    virtual mode_t required_mode() const override final { return 0644; }
+    virtual ErrorOr<void> truncate(u64) override final;
+};
+
 }
@@ -7,7 +7,6 @@
 #include <AK/JsonArraySerializer.h>
 #include <AK/JsonObjectSerializer.h>
 #include <AK/JsonValue.h>
-#include <Kernel/Arch/InterruptDisabler.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/ProcFS.h>
 #include <Kernel/KBufferBuilder.h>
@@ -209,12 +208,11 @@ ErrorOr<void> Process::procfs_get_unveil_stats(KBufferBuilder& builder) const
 
 ErrorOr<void> Process::procfs_get_perf_events(KBufferBuilder& builder) const
 {
-    InterruptDisabler disabler;
     if (!perf_events()) {
         dbgln("ProcFS: No perf events for {}", pid());
         return Error::from_errno(ENOBUFS);
     }
-    return perf_events()->to_json(builder);
+    return perf_events()->serialize(builder);
 }
 
 ErrorOr<void> Process::procfs_get_fds_stats(KBufferBuilder& builder) const
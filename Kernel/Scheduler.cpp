@@ -5,12 +5,14 @@
  */
 
 #include <AK/BuiltinWrappers.h>
+#include <AK/NumericLimits.h>
 #include <AK/ScopeGuard.h>
 #include <AK/Singleton.h>
 #include <AK/Time.h>
 #include <Kernel/Arch/InterruptDisabler.h>
 #include <Kernel/Arch/x86/TrapFrame.h>
 #include <Kernel/Debug.h>
+#include <Kernel/Heap/kmalloc.h>
 #include <Kernel/Panic.h>
 #include <Kernel/PerformanceManager.h>
 #include <Kernel/Process.h>
@@ -47,7 +49,42 @@ struct ThreadReadyQueues {
     Array<ThreadReadyQueue, count> queues;
 };
 
-static Singleton<SpinlockProtected<ThreadReadyQueues>> g_ready_queues;
+// Every processor has its own set of ready queues, so that picking the next thread
+// to run only contends with processors that are stealing work from us.
+// Processor IDs are bounded by the width of the thread affinity mask.
+static constexpr u32 max_ready_queue_processors = sizeof(u32) * 8;
+
+// How many more threads a processor needs to have queued than another one before
+// we move work between them, rather than keeping threads where their caches are warm.
+static constexpr u32 load_balance_threshold = 2;
+
+struct ProcessorReadyQueues {
+    SpinlockProtected<ThreadReadyQueues> ready_queues { LockRank::None };
+    // Number of threads in ready_queues, readable without taking the lock.
+    Atomic<u32> thread_count { 0 };
+    Atomic<u64> steal_count { 0 };
+};
+
+static Singleton<Array<ProcessorReadyQueues, max_ready_queue_processors>> s_processor_ready_queues;
+
+static ProcessorReadyQueues& ready_queues_for(u32 processor)
+{
+    VERIFY(processor < max_ready_queue_processors);
+    return (*s_processor_ready_queues)[processor];
+}
+
+static u32 online_processor_count()
+{
+    return min(Processor::count(), max_ready_queue_processors);
+}
+
+static u32 online_processor_mask()
+{
+    auto count = online_processor_count();
+    if (count == max_ready_queue_processors)
+        return NumericLimits<u32>::max();
+    return (1u << count) - 1;
+}
 
 static SpinlockProtected<TotalTimeScheduled> g_total_time_scheduled { LockRank::None };
 
@@ -60,7 +97,7 @@ static void dump_thread_list(bool = false);
 static inline u32 thread_priority_to_priority_index(u32 thread_priority)
 {
     // Converts the priority in the range of THREAD_PRIORITY_MIN...THREAD_PRIORITY_MAX
-    // to a index into g_ready_queues where 0 is the highest priority bucket
+    // to a index into a processor's ready queues where 0 is the highest priority bucket
     VERIFY(thread_priority >= THREAD_PRIORITY_MIN && thread_priority <= THREAD_PRIORITY_MAX);
     constexpr u32 thread_priority_count = THREAD_PRIORITY_MAX - THREAD_PRIORITY_MIN + 1;
     static_assert(thread_priority_count > 0);
@@ -69,11 +106,10 @@ static inline u32 thread_priority_to_priority_index(u32 thread_priority)
     return priority_bucket;
 }
 
-Thread& Scheduler::pull_next_runnable_thread()
+Thread* Scheduler::pull_next_runnable_thread_from(u32 processor, u32 affinity_mask)
 {
-    auto affinity_mask = 1u << Processor::current_id();
-
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread& {
+    auto& processor_ready_queues = ready_queues_for(processor);
+    return processor_ready_queues.ready_queues.with([&](auto& ready_queues) -> Thread* {
         auto priority_mask = ready_queues.mask;
         while (priority_mask != 0) {
             auto priority = bit_scan_forward(priority_mask);
@@ -81,6 +117,7 @@ Thread& Scheduler::pull_next_runnable_thread()
             auto& ready_queue = ready_queues.queues[--priority];
             for (auto& thread : ready_queue.thread_list) {
                 VERIFY(thread.m_runnable_priority == (int)priority);
+                VERIFY(thread.m_runnable_processor == processor);
                 if (thread.is_active())
                     continue;
                 if (!(thread.affinity() & affinity_mask))
@@ -89,6 +126,7 @@ Thread& Scheduler::pull_next_runnable_thread()
                 ready_queue.thread_list.remove(thread);
                 if (ready_queue.thread_list.is_empty())
                     ready_queues.mask &= ~(1u << priority);
+                processor_ready_queues.thread_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
                 // Mark it as active because we are using this thread. This is similar
                 // to comparing it with Processor::current_thread, but when there are
                 // multiple processors there's no easy way to check whether the thread
@@ -100,19 +138,17 @@ Thread& Scheduler::pull_next_runnable_thread()
                 // switching to it.
                 // FIXME: Figure out a better way maybe?
                 thread.set_active(true);
-                return thread;
+                return &thread;
             }
             priority_mask &= ~(1u << priority);
         }
-        return *Processor::idle_thread();
+        return nullptr;
     });
 }
 
-Thread* Scheduler::peek_next_runnable_thread()
+Thread* Scheduler::peek_next_runnable_thread_from(u32 processor, u32 affinity_mask)
 {
-    auto affinity_mask = 1u << Processor::current_id();
-
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread* {
+    return ready_queues_for(processor).ready_queues.with([&](auto& ready_queues) -> Thread* {
         auto priority_mask = ready_queues.mask;
         while (priority_mask != 0) {
             auto priority = bit_scan_forward(priority_mask);
@@ -128,20 +164,91 @@ Thread* Scheduler::peek_next_runnable_thread()
             }
             priority_mask &= ~(1u << priority);
         }
-
-        // Unlike in pull_next_runnable_thread() we don't want to fall back to
-        // the idle thread. We just want to see if we have any other thread ready
-        // to be scheduled.
         return nullptr;
     });
 }
 
+Optional<u32> Scheduler::find_busiest_processor(u32 minimum_thread_count, u32 exclude_mask)
+{
+    Optional<u32> busiest_processor;
+    u32 busiest_thread_count = minimum_thread_count;
+    auto processor_count = online_processor_count();
+    for (u32 processor = 0; processor < processor_count; processor++) {
+        if (exclude_mask & (1u << processor))
+            continue;
+        auto thread_count = ready_queues_for(processor).thread_count.load(AK::MemoryOrder::memory_order_relaxed);
+        if (thread_count < busiest_thread_count || thread_count == 0)
+            continue;
+        if (busiest_processor.has_value() && thread_count == busiest_thread_count)
+            continue;
+        busiest_processor = processor;
+        busiest_thread_count = thread_count;
+    }
+    return busiest_processor;
+}
+
+Thread* Scheduler::steal_runnable_thread()
+{
+    // Our own ready queues came up empty, so try to take work from the busiest
+    // processor that has a thread we are allowed to run. Victims are tried in
+    // order of decreasing load, each at most once.
+    auto current_id = Processor::current_id();
+    auto affinity_mask = 1u << current_id;
+    u32 tried_mask = affinity_mask;
+    for (;;) {
+        auto victim = find_busiest_processor(1, tried_mask);
+        if (!victim.has_value())
+            return nullptr;
+        tried_mask |= 1u << victim.value();
+        if (auto* thread = pull_next_runnable_thread_from(victim.value(), affinity_mask)) {
+            ready_queues_for(current_id).steal_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+            dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Stole {} from processor {}", current_id, *thread, victim.value());
+            return thread;
+        }
+    }
+}
+
+Thread& Scheduler::pull_next_runnable_thread()
+{
+    auto current_id = Processor::current_id();
+
+    if (auto* thread = pull_next_runnable_thread_from(current_id, 1u << current_id))
+        return *thread;
+    if (auto* thread = steal_runnable_thread())
+        return *thread;
+    return *Processor::idle_thread();
+}
+
+Thread* Scheduler::peek_next_runnable_thread()
+{
+    auto current_id = Processor::current_id();
+    auto affinity_mask = 1u << current_id;
+
+    if (auto* thread = peek_next_runnable_thread_from(current_id, affinity_mask))
+        return thread;
+
+    // Nothing is queued locally, but if another processor has a backlog of
+    // threads waiting we should give up our time slice and help out.
+    // Unlike in pull_next_runnable_thread() we don't want to fall back to
+    // the idle thread. We just want to see if we have any other thread ready
+    // to be scheduled.
+    auto busiest_processor = find_busiest_processor(load_balance_threshold, affinity_mask);
+    if (!busiest_processor.has_value())
+        return nullptr;
+    return peek_next_runnable_thread_from(busiest_processor.value(), affinity_mask);
+}
+
 bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
 {
     if (thread.is_idle_thread())
         return true;
 
-    return g_ready_queues->with([&](auto& ready_queues) {
+    // m_runnable_processor only changes when the thread is queued, which happens with the
+    // scheduler lock held just like here. Another processor may be pulling the thread off
+    // the queue concurrently though, so m_runnable_priority is only checked under the queue lock.
+    VERIFY(g_scheduler_lock.is_locked_by_current_processor());
+    auto& processor_ready_queues = ready_queues_for(thread.m_runnable_processor);
+    return processor_ready_queues.ready_queues.with([&](auto& ready_queues) {
         auto priority = thread.m_runnable_priority;
         if (priority < 0) {
             VERIFY(!thread.m_ready_queue_node.is_in_list());
@@ -157,26 +264,64 @@ bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
         ready_queue.thread_list.remove(thread);
         if (ready_queue.thread_list.is_empty())
             ready_queues.mask &= ~(1u << priority);
+        processor_ready_queues.thread_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
         return true;
     });
 }
 
+u32 Scheduler::select_processor_for(Thread const& thread)
+{
+    auto eligible_mask = thread.affinity() & online_processor_mask();
+    if (eligible_mask == 0) {
+        // The thread is only allowed to run on processors that haven't come online yet.
+        // Park it on the first one, which will pick it up once it starts scheduling.
+        VERIFY(thread.affinity() != 0);
+        return bit_scan_forward(thread.affinity()) - 1;
+    }
+
+    u32 least_loaded_processor = 0;
+    auto least_thread_count = NumericLimits<u32>::max();
+    for (auto mask = eligible_mask; mask != 0;) {
+        u32 processor = bit_scan_forward(mask) - 1;
+        mask &= ~(1u << processor);
+        auto thread_count = ready_queues_for(processor).thread_count.load(AK::MemoryOrder::memory_order_relaxed);
+        if (thread_count < least_thread_count) {
+            least_loaded_processor = processor;
+            least_thread_count = thread_count;
+        }
+    }
+
+    // Prefer the processor this thread last ran on, as its caches are likely
+    // still warm, unless that would leave the queues noticeably imbalanced.
+    auto previous_processor = thread.cpu();
+    if (eligible_mask & (1u << previous_processor)) {
+        auto thread_count = ready_queues_for(previous_processor).thread_count.load(AK::MemoryOrder::memory_order_relaxed);
+        if (thread_count < least_thread_count + load_balance_threshold)
+            return previous_processor;
+    }
+    return least_loaded_processor;
+}
+
 void Scheduler::enqueue_runnable_thread(Thread& thread)
 {
     VERIFY(g_scheduler_lock.is_locked_by_current_processor());
     if (thread.is_idle_thread())
         return;
     auto priority = thread_priority_to_priority_index(thread.priority());
+    auto processor = select_processor_for(thread);
+    auto& processor_ready_queues = ready_queues_for(processor);
 
-    g_ready_queues->with([&](auto& ready_queues) {
+    processor_ready_queues.ready_queues.with([&](auto& ready_queues) {
         VERIFY(thread.m_runnable_priority < 0);
         thread.m_runnable_priority = (int)priority;
+        thread.m_runnable_processor = processor;
         VERIFY(!thread.m_ready_queue_node.is_in_list());
         auto& ready_queue = ready_queues.queues[priority];
         bool was_empty = ready_queue.thread_list.is_empty();
         ready_queue.thread_list.append(thread);
         if (was_empty)
             ready_queues.mask |= (1u << priority);
+        processor_ready_queues.thread_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
     });
 }
 
@@ -219,26 +364,37 @@ void Scheduler::pick_next()
             Processor::set_current_in_scheduler(false);
         });
 
+    // The ready queues have their own locks, so pick the next thread before taking the
+    // scheduler lock. That way we only contend on it for the context switch itself.
+    auto* thread_to_schedule = &pull_next_runnable_thread();
+
     SpinlockLocker lock(g_scheduler_lock);
 
     if constexpr (SCHEDULER_RUNNABLE_DEBUG) {
         dump_thread_list();
     }
 
-    auto& thread_to_schedule = pull_next_runnable_thread();
+    // The thread may have been stopped or killed before we got the scheduler lock.
+    // It is marked active, so nobody else picked it up in the meantime.
+    while (!thread_to_schedule->is_idle_thread() && thread_to_schedule->state() != Thread::State::Runnable) {
+        thread_to_schedule->set_active(false);
+        if (thread_to_schedule->state() == Thread::State::Dying)
+            notify_finalizer();
+        thread_to_schedule = &pull_next_runnable_thread();
+    }
     if constexpr (SCHEDULER_DEBUG) {
         dbgln("Scheduler[{}]: Switch to {} @ {:#04x}:{:p}",
             Processor::current_id(),
-            thread_to_schedule,
-            thread_to_schedule.regs().cs, thread_to_schedule.regs().ip());
+            *thread_to_schedule,
+            thread_to_schedule->regs().cs, thread_to_schedule->regs().ip());
     }
 
     // We need to leave our first critical section before switching context,
     // but since we're still holding the scheduler lock we're still in a critical section
     critical.leave();
 
-    thread_to_schedule.set_ticks_left(time_slice_for(thread_to_schedule));
-    context_switch(&thread_to_schedule);
+    thread_to_schedule->set_ticks_left(time_slice_for(*thread_to_schedule));
+    context_switch(thread_to_schedule);
 }
 
 void Scheduler::yield()
@@ -502,6 +658,9 @@ void Scheduler::idle_loop(void*)
     VERIFY(are_interrupts_enabled());
 
     for (;;) {
+        // Another processor may have run short on memory while we were busy, so give back our cached kmalloc slabs.
+        kmalloc_drain_processor_cache_if_requested();
+
         proc.idle_begin();
         asm("hlt");
 
@@ -513,6 +672,14 @@ void Scheduler::idle_loop(void*)
 
 void Scheduler::dump_scheduler_state(bool with_stack_traces)
 {
+    auto processor_count = online_processor_count();
+    for (u32 processor = 0; processor < processor_count; processor++) {
+        auto& processor_ready_queues = ready_queues_for(processor);
+        dbgln("Scheduler ready queues for processor {}: {} runnable, {} stolen",
+            processor,
+            processor_ready_queues.thread_count.load(AK::MemoryOrder::memory_order_relaxed),
+            processor_ready_queues.steal_count.load(AK::MemoryOrder::memory_order_relaxed));
+    }
     dump_thread_list(with_stack_traces);
 }
 
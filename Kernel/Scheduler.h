@@ -9,6 +9,7 @@
 #include <AK/Assertions.h>
 #include <AK/Function.h>
 #include <AK/IntrusiveList.h>
+#include <AK/Optional.h>
 #include <AK/Types.h>
 #include <Kernel/Forward.h>
 #include <Kernel/Locking/Spinlock.h>
@@ -56,6 +57,13 @@ public:
     static TotalTimeScheduled get_total_time_scheduled();
     static void add_time_scheduled(u64, bool);
     static u64 (*current_time)();
+
+private:
+    static Thread* pull_next_runnable_thread_from(u32 processor, u32 affinity_mask);
+    static Thread* peek_next_runnable_thread_from(u32 processor, u32 affinity_mask);
+    static Thread* steal_runnable_thread();
+    static Optional<u32> find_busiest_processor(u32 minimum_thread_count, u32 exclude_mask);
+    static u32 select_processor_for(Thread const&);
 };
 
 }
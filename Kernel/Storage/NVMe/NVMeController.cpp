@@ -37,8 +37,6 @@ UNMAP_AFTER_INIT NVMeController::NVMeController(const PCI::DeviceIdentifier& dev
 
 UNMAP_AFTER_INIT ErrorOr<void> NVMeController::initialize(bool is_queue_polled)
 {
-    // Nr of queues = one queue per core
-    auto nr_of_queues = Processor::count();
     auto irq = is_queue_polled ? Optional<u8> {} : m_pci_device_id.interrupt_line().value();
 
     PCI::enable_memory_space(m_pci_device_id.address());
@@ -61,7 +59,10 @@ UNMAP_AFTER_INIT ErrorOr<void> NVMeController::initialize(bool is_queue_polled)
     VERIFY(IO_QUEUE_SIZE < MQES(caps));
     dbgln_if(NVME_DEBUG, "NVMe: IO queue depth is: {}", IO_QUEUE_SIZE);
 
-    // Create an IO queue per core
+    // Ask for an IO queue per core, so processors don't contend on the queue locks.
+    auto nr_of_queues = request_io_queue_count(Processor::count());
+    dmesgln("NVMe: Using {} IO queue(s) for {} processor(s)", nr_of_queues, Processor::count());
+
     for (u32 cpuid = 0; cpuid < nr_of_queues; ++cpuid) {
         // qid is zero is used for admin queue
         TRY(create_io_queue(cpuid + 1, irq));
@@ -140,6 +141,25 @@ bool NVMeController::start_controller()
     return true;
 }
 
+UNMAP_AFTER_INIT u32 NVMeController::request_io_queue_count(u32 wanted_queue_count)
+{
+    // The controller may allocate more or fewer queues than we ask for, and tells us how many in the result.
+    NVMeSubmission sub {};
+    u32 result = 0;
+    sub.op = OP_ADMIN_SET_FEATURES;
+    sub.generic.cdw10 = AK::convert_between_host_and_little_endian<u32>(NVMe_FEATURE_NUMBER_OF_QUEUES);
+    // The queue counts are 0 based
+    u32 count = (wanted_queue_count - 1) & 0xFFFF;
+    sub.generic.cdw11 = AK::convert_between_host_and_little_endian(count | (count << 16));
+    if (auto status = submit_admin_command(sub, true, &result); status) {
+        dmesgln("NVMe: Failed to set the number of queues, status {:#x}", status);
+        return 1;
+    }
+    u32 submission_queues = (result & 0xFFFF) + 1;
+    u32 completion_queues = (result >> 16) + 1;
+    return min(wanted_queue_count, min(submission_queues, completion_queues));
+}
+
 UNMAP_AFTER_INIT u32 NVMeController::get_admin_q_dept()
 {
     u32 aqa = m_controller_regs->aqa;
@@ -41,11 +41,11 @@ public:
     bool start_controller();
     u32 get_admin_q_dept();
 
-    u16 submit_admin_command(NVMeSubmission& sub, bool sync = false)
+    u16 submit_admin_command(NVMeSubmission& sub, bool sync = false, u32* command_specific_result = nullptr)
     {
         // First queue is always the admin queue
         if (sync) {
-            return m_admin_queue->submit_sync_sqe(sub);
+            return m_admin_queue->submit_sync_sqe(sub, command_specific_result);
         }
         m_admin_queue->submit_sqe(sub);
         return 0;
@@ -58,6 +58,7 @@ private:
     NVMeController(PCI::DeviceIdentifier const&, u32 hardware_relative_controller_id);
 
     ErrorOr<void> identify_and_init_namespaces();
+    u32 request_io_queue_count(u32 wanted_queue_count);
     Tuple<u64, u8> get_ns_features(IdentifyNamespace& identify_data_struct);
     ErrorOr<void> create_admin_queue(Optional<u8> irq);
     ErrorOr<void> create_io_queue(u8 qid, Optional<u8> irq);
@@ -114,8 +114,12 @@ enum AdminCommandOpCode {
     OP_ADMIN_CREATE_COMPLETION_QUEUE = 0x5,
     OP_ADMIN_CREATE_SUBMISSION_QUEUE = 0x1,
     OP_ADMIN_IDENTIFY = 0x6,
+    OP_ADMIN_SET_FEATURES = 0x9,
 };
 
+// FEATURES
+static constexpr u8 NVMe_FEATURE_NUMBER_OF_QUEUES = 0x7;
+
 // IO opcodes
 enum IOCommandOpcode {
     OP_NVME_WRITE = 0x1,
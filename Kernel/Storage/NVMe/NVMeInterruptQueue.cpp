@@ -11,8 +11,8 @@
 
 namespace Kernel {
 
-UNMAP_AFTER_INIT NVMeInterruptQueue::NVMeInterruptQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalPage const& rw_dma_page, u16 qid, u8 irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs)
-    : NVMeQueue(move(rw_dma_region), rw_dma_page, qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))
+UNMAP_AFTER_INIT NVMeInterruptQueue::NVMeInterruptQueue(OwnPtr<Memory::Region> rw_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages, u16 qid, u8 irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs)
+    : NVMeQueue(move(rw_dma_region), move(rw_dma_pages), qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))
     , IRQHandler(irq)
 {
     enable_irq();
@@ -20,7 +20,7 @@ UNMAP_AFTER_INIT NVMeInterruptQueue::NVMeInterruptQueue(NonnullOwnPtr<Memory::Re
 
 bool NVMeInterruptQueue::handle_irq(RegisterState const&)
 {
-    SpinlockLocker lock(m_request_lock);
+    SpinlockLocker lock(m_cq_lock);
     return process_cq() ? true : false;
 }
 
@@ -29,34 +29,17 @@ void NVMeInterruptQueue::submit_sqe(NVMeSubmission& sub)
     NVMeQueue::submit_sqe(sub);
 }
 
-void NVMeInterruptQueue::complete_current_request(u16 status)
+void NVMeInterruptQueue::complete_request(u16 slot, u16 status)
 {
-    VERIFY(m_request_lock.is_locked());
+    VERIFY(m_cq_lock.is_locked());
 
-    auto work_item_creation_result = g_io_work->try_queue([this, status]() {
-        SpinlockLocker lock(m_request_lock);
-        auto current_request = m_current_request;
-        m_current_request.clear();
-        if (status) {
-            lock.unlock();
-            current_request->complete(AsyncBlockDeviceRequest::Failure);
-            return;
-        }
-        if (current_request->request_type() == AsyncBlockDeviceRequest::RequestType::Read) {
-            if (auto result = current_request->write_to_buffer(current_request->buffer(), m_rw_dma_region->vaddr().as_ptr(), current_request->buffer_size()); result.is_error()) {
-                lock.unlock();
-                current_request->complete(AsyncDeviceRequest::MemoryFault);
-                return;
-            }
-        }
-        lock.unlock();
-        current_request->complete(AsyncDeviceRequest::Success);
-        return;
+    // Copying the data out may fault, so leave that to the I/O work queue.
+    // It also starts whatever requests were waiting for a free slot.
+    auto work_item_creation_result = g_io_work->try_queue([this, slot, status]() {
+        finish_request(slot, status);
+        submit_pending_requests();
     });
-    if (work_item_creation_result.is_error()) {
-        auto current_request = m_current_request;
-        m_current_request.clear();
-        current_request->complete(AsyncDeviceRequest::OutOfMemory);
-    }
+    if (work_item_creation_result.is_error())
+        end_request(slot, AsyncDeviceRequest::Failure);
 }
 }
@@ -6,6 +6,7 @@
 
 #include "NVMeNameSpace.h"
 #include <AK/NonnullOwnPtr.h>
+#include <AK/StringBuilder.h>
 #include <Kernel/Devices/DeviceManagement.h>
 #include <Kernel/Storage/NVMe/NVMeController.h>
 #include <Kernel/Storage/StorageManagement.h>
@@ -27,16 +28,20 @@ UNMAP_AFTER_INIT NVMeNameSpace::NVMeNameSpace(LUNAddress logical_unit_number_add
 
 void NVMeNameSpace::start_request(AsyncBlockDeviceRequest& request)
 {
-    auto index = Processor::current_id();
-    auto& queue = m_queues.at(index);
+    // The controller may give us fewer queues than there are processors, in which case they share.
+    auto& queue = m_queues.at(Processor::current_id() % m_queues.size());
     // TODO: For now we support only IO transfers of size PAGE_SIZE (Going along with the current constraint in the block layer)
     // Eventually remove this constraint by using the PRP2 field in the submission struct and remove block layer constraint for NVMe driver.
     VERIFY(request.block_count() <= (PAGE_SIZE / block_size()));
 
-    if (request.request_type() == AsyncBlockDeviceRequest::Read) {
-        queue.read(request, m_nsid, request.block_index(), request.block_count());
-    } else {
-        queue.write(request, m_nsid, request.block_index(), request.block_count());
-    }
+    queue.submit_request(request, m_nsid);
+}
+
+ErrorOr<NonnullOwnPtr<KString>> NVMeNameSpace::queue_statistics() const
+{
+    StringBuilder builder;
+    for (auto const& queue : m_queues)
+        TRY(builder.try_appendff("{}: {} submitted, at most {} in flight\n", queue.qid(), queue.submitted_request_count(), queue.peak_requests_in_flight()));
+    return KString::try_create(builder.string_view());
 }
 }
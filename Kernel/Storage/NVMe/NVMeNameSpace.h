@@ -29,6 +29,11 @@ public:
     CommandSet command_set() const override { return CommandSet::NVMe; };
     void start_request(AsyncBlockDeviceRequest& request) override;
 
+    // Each processor submits through its own queue, so there is no need to wait for the previous request.
+    virtual bool can_process_requests_concurrently() const override { return true; }
+
+    virtual ErrorOr<NonnullOwnPtr<KString>> queue_statistics() const override;
+
 private:
     NVMeNameSpace(LUNAddress, u32 hardware_relative_controller_id, NonnullLockRefPtrVector<NVMeQueue> queues, size_t storage_size, size_t lba_size, u16 nsid);
 
@@ -10,8 +10,8 @@
 #include "NVMeDefinitions.h"
 
 namespace Kernel {
-UNMAP_AFTER_INIT NVMePollQueue::NVMePollQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalPage const& rw_dma_page, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs)
-    : NVMeQueue(move(rw_dma_region), rw_dma_page, qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))
+UNMAP_AFTER_INIT NVMePollQueue::NVMePollQueue(OwnPtr<Memory::Region> rw_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs)
+    : NVMeQueue(move(rw_dma_region), move(rw_dma_pages), qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))
 {
 }
 
@@ -24,21 +24,33 @@ void NVMePollQueue::submit_sqe(NVMeSubmission& sub)
     }
 }
 
-void NVMePollQueue::complete_current_request(u16 status)
+void NVMePollQueue::submit_request(AsyncBlockDeviceRequest& request, u16 nsid)
 {
-    auto current_request = m_current_request;
-    m_current_request.clear();
-    if (status) {
-        current_request->complete(AsyncBlockDeviceRequest::Failure);
-        return;
-    }
-    if (current_request->request_type() == AsyncBlockDeviceRequest::RequestType::Read) {
-        if (auto result = current_request->write_to_buffer(current_request->buffer(), m_rw_dma_region->vaddr().as_ptr(), current_request->buffer_size()); result.is_error()) {
-            current_request->complete(AsyncDeviceRequest::MemoryFault);
-            return;
-        }
+    // Nothing else reaps completions on a polled queue, so wait here for a free slot and then for our own command.
+    // Other commands that complete in the meantime are finished on the way.
+    Optional<u16> slot;
+    while (!(slot = try_allocate_slot(request, nsid)).has_value())
+        poll_completions();
+
+    start_requests({ &slot.value(), 1 });
+
+    while (slot_has_request(slot.value(), request))
+        poll_completions();
+}
+
+void NVMePollQueue::poll_completions()
+{
+    u32 nr_of_processed_cqes;
+    {
+        SpinlockLocker lock_cq(m_cq_lock);
+        nr_of_processed_cqes = process_cq();
     }
-    current_request->complete(AsyncDeviceRequest::Success);
-    return;
+    if (!nr_of_processed_cqes)
+        IO::delay(1);
+}
+
+void NVMePollQueue::complete_request(u16 slot, u16 status)
+{
+    finish_request(slot, status);
 }
 }
@@ -6,7 +6,8 @@
 
 #include "NVMeQueue.h"
 #include "Kernel/StdLib.h"
-#include "NVMeQueue.h"
+#include <AK/BuiltinWrappers.h>
+#include <AK/NumericLimits.h>
 #include <Kernel/Arch/x86/IO.h>
 #include <Kernel/Storage/NVMe/NVMeController.h>
 #include <Kernel/Storage/NVMe/NVMeInterruptQueue.h>
@@ -15,21 +16,24 @@
 namespace Kernel {
 ErrorOr<NonnullLockRefPtr<NVMeQueue>> NVMeQueue::try_create(u16 qid, Optional<u8> irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs)
 {
-    // Note: Allocate DMA region for RW operation. For now the requests don't exceed more than 4096 bytes (Storage device takes care of it)
-    RefPtr<Memory::PhysicalPage> rw_dma_page;
-    auto rw_dma_region = TRY(MM.allocate_dma_buffer_page("NVMe Queue Read/Write DMA"sv, Memory::Region::Access::ReadWrite, rw_dma_page));
+    // Note: Allocate a DMA page for each command slot. For now the requests don't exceed more than 4096 bytes (Storage device takes care of it)
+    // The admin queue only runs synchronous commands that bring their own buffers.
+    OwnPtr<Memory::Region> rw_dma_region;
+    NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages;
+    if (qid != 0) {
+        VERIFY(q_depth > IO_QUEUE_SLOTS);
+        rw_dma_region = TRY(MM.allocate_dma_buffer_pages(IO_QUEUE_SLOTS * PAGE_SIZE, "NVMe Queue Read/Write DMA"sv, Memory::Region::Access::ReadWrite, rw_dma_pages));
+    }
     if (!irq.has_value()) {
-        auto queue = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) NVMePollQueue(move(rw_dma_region), *rw_dma_page, qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
+        auto queue = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) NVMePollQueue(move(rw_dma_region), move(rw_dma_pages), qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
         return queue;
     }
-    auto queue = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) NVMeInterruptQueue(move(rw_dma_region), *rw_dma_page, qid, irq.value(), q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
+    auto queue = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) NVMeInterruptQueue(move(rw_dma_region), move(rw_dma_pages), qid, irq.value(), q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
     return queue;
 }
 
-UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalPage const& rw_dma_page, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs)
-    : m_current_request(nullptr)
-    , m_rw_dma_region(move(rw_dma_region))
-    , m_qid(qid)
+UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(OwnPtr<Memory::Region> rw_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs)
+    : m_qid(qid)
     , m_admin_queue(qid == 0)
     , m_qdepth(q_depth)
     , m_cq_dma_region(move(cq_dma_region))
@@ -37,11 +41,13 @@ UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_regio
     , m_sq_dma_region(move(sq_dma_region))
     , m_sq_dma_page(sq_dma_page)
     , m_db_regs(move(db_regs))
-    , m_rw_dma_page(rw_dma_page)
-
+    , m_rw_dma_region(move(rw_dma_region))
+    , m_rw_dma_pages(move(rw_dma_pages))
 {
     m_sqe_array = { reinterpret_cast<NVMeSubmission*>(m_sq_dma_region->vaddr().as_ptr()), m_qdepth };
     m_cqe_array = { reinterpret_cast<NVMeCompletion*>(m_cq_dma_region->vaddr().as_ptr()), m_qdepth };
+    if (!m_admin_queue)
+        m_free_slots = IO_QUEUE_SLOTS == 64 ? NumericLimits<u64>::max() : (1ull << IO_QUEUE_SLOTS) - 1;
 }
 
 bool NVMeQueue::cqe_available()
@@ -74,13 +80,11 @@ u32 NVMeQueue::process_cq()
         // TODO: We don't use AsyncBlockDevice requests for admin queue as it is only applicable for a block device (NVMe namespace)
         //  But admin commands precedes namespace creation. Unify requests to avoid special conditions
         if (m_admin_queue == false) {
-            // As the block layer calls are now sync (as we wait on each requests),
-            // everything is operated on a single request similar to BMIDE driver.
-            // TODO: Remove this constraint eventually.
-            VERIFY(cmdid == m_prev_sq_tail);
-            if (m_current_request) {
-                complete_current_request(status);
-            }
+            // The command identifier of an I/O command is the slot it occupies.
+            if (cmdid < IO_QUEUE_SLOTS)
+                complete_request(cmdid, status);
+            else
+                dbgln("NVMe: Completion with unknown command identifier {} on queue {}", cmdid, m_qid);
         }
         update_cqe_head();
     }
@@ -90,12 +94,12 @@ u32 NVMeQueue::process_cq()
     return nr_of_processed_cqes;
 }
 
-void NVMeQueue::submit_sqe(NVMeSubmission& sub)
+void NVMeQueue::enqueue_sqe_locked(NVMeSubmission& sub)
 {
-    SpinlockLocker lock(m_sq_lock);
-    // For now let's use sq tail as a unique command id.
-    sub.cmdid = m_sq_tail;
-    m_prev_sq_tail = m_sq_tail;
+    VERIFY(m_sq_lock.is_locked());
+    // The admin queue runs one command at a time, so the sq tail makes a unique command id.
+    if (m_admin_queue)
+        sub.cmdid = m_sq_tail;
 
     memcpy(&m_sqe_array[m_sq_tail], &sub, sizeof(NVMeSubmission));
     {
@@ -107,19 +111,25 @@ void NVMeQueue::submit_sqe(NVMeSubmission& sub)
     }
 
     dbgln_if(NVME_DEBUG, "NVMe: Submission with command identifier {}. SQ_TAIL: {}", sub.cmdid, m_sq_tail);
+}
+
+void NVMeQueue::submit_sqe(NVMeSubmission& sub)
+{
+    SpinlockLocker lock(m_sq_lock);
+    enqueue_sqe_locked(sub);
     full_memory_barrier();
     update_sq_doorbell();
 }
 
-u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub)
+u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub, u32* command_specific_result)
 {
     // For now let's use sq tail as a unique command id.
     u16 cqe_cid;
     u16 cid = m_sq_tail;
+    int index;
 
     submit_sqe(sub);
     do {
-        int index;
         {
             SpinlockLocker lock(m_cq_lock);
             index = m_cq_head - 1;
@@ -130,46 +140,144 @@ u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub)
         IO::delay(1);
     } while (cid != cqe_cid);
 
-    auto status = CQ_STATUS_FIELD(m_cqe_array[m_cq_head].status);
+    if (command_specific_result)
+        *command_specific_result = m_cqe_array[index].cmd_spec;
+    auto status = CQ_STATUS_FIELD(m_cqe_array[index].status);
     return status;
 }
 
-void NVMeQueue::read(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count)
+u16 NVMeQueue::allocate_slot_locked(AsyncBlockDeviceRequest& request, u16 nsid)
 {
-    NVMeSubmission sub {};
-    SpinlockLocker m_lock(m_request_lock);
-    m_current_request = request;
+    VERIFY(m_request_lock.is_locked());
+    VERIFY(m_free_slots != 0);
+    u16 slot = count_trailing_zeroes(m_free_slots);
+    m_free_slots &= ~(1ull << slot);
+    m_slots[slot] = { request, nsid };
+    m_submitted_request_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    u16 requests_in_flight = IO_QUEUE_SLOTS - popcount(m_free_slots);
+    if (requests_in_flight > m_peak_requests_in_flight.load(AK::MemoryOrder::memory_order_relaxed))
+        m_peak_requests_in_flight.store(requests_in_flight, AK::MemoryOrder::memory_order_relaxed);
+    return slot;
+}
+
+Optional<u16> NVMeQueue::try_allocate_slot(AsyncBlockDeviceRequest& request, u16 nsid)
+{
+    SpinlockLocker lock(m_request_lock);
+    if (m_free_slots == 0)
+        return {};
+    return allocate_slot_locked(request, nsid);
+}
+
+bool NVMeQueue::slot_has_request(u16 slot, AsyncBlockDeviceRequest const& request)
+{
+    SpinlockLocker lock(m_request_lock);
+    return m_slots[slot].request.ptr() == &request;
+}
 
-    sub.op = OP_NVME_READ;
-    sub.rw.nsid = nsid;
-    sub.rw.slba = AK::convert_between_host_and_little_endian(index);
+NonnullLockRefPtr<AsyncBlockDeviceRequest> NVMeQueue::release_slot(u16 slot)
+{
+    SpinlockLocker lock(m_request_lock);
+    VERIFY(!(m_free_slots & (1ull << slot)));
+    auto request = m_slots[slot].request.release_nonnull();
+    m_free_slots |= 1ull << slot;
+    return request;
+}
+
+void NVMeQueue::fill_in_submission(u16 slot, NVMeSubmission& sub)
+{
+    auto& request = *m_slots[slot].request;
+    sub.op = request.request_type() == AsyncBlockDeviceRequest::Read ? OP_NVME_READ : OP_NVME_WRITE;
+    sub.cmdid = slot;
+    sub.rw.nsid = m_slots[slot].nsid;
+    sub.rw.slba = AK::convert_between_host_and_little_endian(request.block_index());
     // No. of lbas is 0 based
-    sub.rw.length = AK::convert_between_host_and_little_endian((count - 1) & 0xFFFF);
-    sub.rw.data_ptr.prp1 = reinterpret_cast<u64>(AK::convert_between_host_and_little_endian(m_rw_dma_page->paddr().as_ptr()));
+    sub.rw.length = AK::convert_between_host_and_little_endian((request.block_count() - 1) & 0xFFFF);
+    sub.rw.data_ptr.prp1 = reinterpret_cast<u64>(AK::convert_between_host_and_little_endian(m_rw_dma_pages[slot].paddr().as_ptr()));
+}
+
+void NVMeQueue::start_requests(Span<u16 const> slots)
+{
+    // The data for writes has to be in place before the controller sees the command.
+    Array<u16, IO_QUEUE_SLOTS> ready_slots;
+    size_t ready_count = 0;
+    for (auto slot : slots) {
+        auto& request = *m_slots[slot].request;
+        if (request.request_type() == AsyncBlockDeviceRequest::Write) {
+            if (auto result = request.read_from_buffer(request.buffer(), slot_buffer(slot), request.buffer_size()); result.is_error()) {
+                end_request(slot, AsyncDeviceRequest::MemoryFault);
+                continue;
+            }
+        }
+        ready_slots[ready_count++] = slot;
+    }
+    if (ready_count == 0)
+        return;
 
+    // Ring the doorbell once for the whole batch.
     full_memory_barrier();
-    submit_sqe(sub);
+    SpinlockLocker lock(m_sq_lock);
+    for (size_t i = 0; i < ready_count; ++i) {
+        NVMeSubmission sub {};
+        fill_in_submission(ready_slots[i], sub);
+        enqueue_sqe_locked(sub);
+    }
+    full_memory_barrier();
+    update_sq_doorbell();
+}
+
+void NVMeQueue::submit_request(AsyncBlockDeviceRequest& request, u16 nsid)
+{
+    u16 slot;
+    {
+        SpinlockLocker lock(m_request_lock);
+        if (m_free_slots == 0) {
+            if (m_pending_requests.try_append({ request, nsid }).is_error()) {
+                lock.unlock();
+                request.complete(AsyncDeviceRequest::Failure);
+            }
+            return;
+        }
+        slot = allocate_slot_locked(request, nsid);
+    }
+    start_requests({ &slot, 1 });
 }
 
-void NVMeQueue::write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count)
+void NVMeQueue::submit_pending_requests()
 {
-    NVMeSubmission sub {};
-    SpinlockLocker m_lock(m_request_lock);
-    m_current_request = request;
+    Array<u16, IO_QUEUE_SLOTS> slots;
+    size_t count = 0;
+    {
+        SpinlockLocker lock(m_request_lock);
+        while (m_free_slots != 0 && !m_pending_requests.is_empty()) {
+            auto pending = m_pending_requests.take_first();
+            slots[count++] = allocate_slot_locked(pending.request, pending.nsid);
+        }
+    }
+    if (count > 0)
+        start_requests(slots.span().trim(count));
+}
 
-    if (auto result = m_current_request->read_from_buffer(m_current_request->buffer(), m_rw_dma_region->vaddr().as_ptr(), m_current_request->buffer_size()); result.is_error()) {
-        complete_current_request(AsyncDeviceRequest::MemoryFault);
+void NVMeQueue::finish_request(u16 slot, u16 status)
+{
+    if (status) {
+        end_request(slot, AsyncBlockDeviceRequest::Failure);
         return;
     }
-    sub.op = OP_NVME_WRITE;
-    sub.rw.nsid = nsid;
-    sub.rw.slba = AK::convert_between_host_and_little_endian(index);
-    // No. of lbas is 0 based
-    sub.rw.length = AK::convert_between_host_and_little_endian((count - 1) & 0xFFFF);
-    sub.rw.data_ptr.prp1 = reinterpret_cast<u64>(AK::convert_between_host_and_little_endian(m_rw_dma_page->paddr().as_ptr()));
+    auto& request = *m_slots[slot].request;
+    if (request.request_type() == AsyncBlockDeviceRequest::Read) {
+        if (auto result = request.write_to_buffer(request.buffer(), slot_buffer(slot), request.buffer_size()); result.is_error()) {
+            end_request(slot, AsyncDeviceRequest::MemoryFault);
+            return;
+        }
+    }
+    end_request(slot, AsyncDeviceRequest::Success);
+}
 
-    full_memory_barrier();
-    submit_sqe(sub);
+void NVMeQueue::end_request(u16 slot, AsyncDeviceRequest::RequestResult result)
+{
+    // Free up the slot before completing, so the woken up thread can use it right away.
+    auto request = release_slot(slot);
+    request->complete(result);
 }
 
 UNMAP_AFTER_INIT NVMeQueue::~NVMeQueue() = default;
@@ -6,11 +6,15 @@
 
 #pragma once
 
+#include <AK/Array.h>
+#include <AK/Atomic.h>
 #include <AK/AtomicRefCounted.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <AK/Types.h>
+#include <AK/Vector.h>
 #include <Kernel/Bus/PCI/Device.h>
+#include <Kernel/Devices/AsyncDeviceRequest.h>
 #include <Kernel/Interrupts/IRQHandler.h>
 #include <Kernel/Library/LockRefPtr.h>
 #include <Kernel/Library/NonnullLockRefPtr.h>
@@ -27,14 +31,23 @@ struct DoorbellRegister {
     u32 cq_head;
 };
 
+// An I/O queue keeps up to this many commands in flight. Each of them owns a page of the queue's DMA buffer.
+// One submission queue entry always stays free, so that a full queue can be told apart from an empty one.
+static constexpr u16 IO_QUEUE_SLOTS = IO_QUEUE_SIZE - 1;
+static_assert(IO_QUEUE_SLOTS <= 64, "The free slot bitmap of NVMeQueue holds at most 64 slots");
+
 class AsyncBlockDeviceRequest;
 class NVMeQueue : public AtomicRefCounted<NVMeQueue> {
 public:
     static ErrorOr<NonnullLockRefPtr<NVMeQueue>> try_create(u16 qid, Optional<u8> irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs);
     bool is_admin_queue() { return m_admin_queue; };
-    u16 submit_sync_sqe(NVMeSubmission&);
-    void read(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
-    void write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
+    u16 qid() const { return m_qid; }
+    // Usage statistics, so it can be told which processors' queues actually see I/O.
+    u64 submitted_request_count() const { return m_submitted_request_count.load(AK::MemoryOrder::memory_order_relaxed); }
+    u16 peak_requests_in_flight() const { return m_peak_requests_in_flight.load(AK::MemoryOrder::memory_order_relaxed); }
+    u16 submit_sync_sqe(NVMeSubmission&, u32* command_specific_result = nullptr);
+    // Starts a read or write of the request's blocks, or queues it up if the queue is full.
+    virtual void submit_request(AsyncBlockDeviceRequest&, u16 nsid);
     virtual void submit_sqe(NVMeSubmission&);
     virtual ~NVMeQueue();
 
@@ -44,12 +57,24 @@ protected:
     {
         m_db_regs->sq_tail = m_sq_tail;
     }
-    NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalPage const& rw_dma_page, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs);
+    NVMeQueue(OwnPtr<Memory::Region> rw_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs);
+
+    Optional<u16> try_allocate_slot(AsyncBlockDeviceRequest&, u16 nsid);
+    bool slot_has_request(u16 slot, AsyncBlockDeviceRequest const&);
+    void start_requests(Span<u16 const> slots);
+    void finish_request(u16 slot, u16 status);
+    void end_request(u16 slot, AsyncDeviceRequest::RequestResult);
+    void submit_pending_requests();
 
 private:
     bool cqe_available();
     void update_cqe_head();
-    virtual void complete_current_request(u16 status) = 0;
+    virtual void complete_request(u16 slot, u16 status) = 0;
+    u16 allocate_slot_locked(AsyncBlockDeviceRequest&, u16 nsid);
+    NonnullLockRefPtr<AsyncBlockDeviceRequest> release_slot(u16 slot);
+    u8* slot_buffer(u16 slot) { return m_rw_dma_region->vaddr().offset(slot * PAGE_SIZE).as_ptr(); }
+    void fill_in_submission(u16 slot, NVMeSubmission&);
+    void enqueue_sqe_locked(NVMeSubmission&);
     void update_cq_doorbell()
     {
         m_db_regs->cq_head = m_cq_head;
@@ -57,15 +82,22 @@ private:
 
 protected:
     Spinlock m_cq_lock { LockRank::Interrupts };
-    LockRefPtr<AsyncBlockDeviceRequest> m_current_request;
-    NonnullOwnPtr<Memory::Region> m_rw_dma_region;
     Spinlock m_request_lock { LockRank::None };
 
 private:
+    struct Slot {
+        LockRefPtr<AsyncBlockDeviceRequest> request;
+        u16 nsid { 0 };
+    };
+
+    struct PendingRequest {
+        NonnullLockRefPtr<AsyncBlockDeviceRequest> request;
+        u16 nsid { 0 };
+    };
+
     u16 m_qid {};
     u8 m_cq_valid_phase { 1 };
     u16 m_sq_tail {};
-    u16 m_prev_sq_tail {};
     u16 m_cq_head {};
     bool m_admin_queue { false };
     u32 m_qdepth {};
@@ -77,6 +109,15 @@ private:
     NonnullRefPtrVector<Memory::PhysicalPage> m_sq_dma_page;
     Span<NVMeCompletion> m_cqe_array;
     Memory::TypedMapping<DoorbellRegister volatile> m_db_regs;
-    NonnullRefPtr<Memory::PhysicalPage> m_rw_dma_page;
+
+    // Commands in flight on an I/O queue, indexed by command identifier.
+    OwnPtr<Memory::Region> m_rw_dma_region;
+    NonnullRefPtrVector<Memory::PhysicalPage> m_rw_dma_pages;
+    Array<Slot, IO_QUEUE_SLOTS> m_slots;
+    u64 m_free_slots { 0 };
+    Atomic<u64> m_submitted_request_count { 0 };
+    Atomic<u16> m_peak_requests_in_flight { 0 };
+    // Requests that arrived while every slot was taken, started as slots free up.
+    Vector<PendingRequest> m_pending_requests;
 };
 }
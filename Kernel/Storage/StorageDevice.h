@@ -75,6 +75,9 @@ public:
 
     StringView command_set_to_string_view() const;
 
+    // One line per hardware queue, for devices that have several of them.
+    virtual ErrorOr<NonnullOwnPtr<KString>> queue_statistics() const { return KString::try_create(""sv); }
+
     // ^File
     virtual ErrorOr<void> ioctl(OpenFileDescription&, unsigned request, Userspace<void*> arg) final;
 
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/EventPoll.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+#include <Kernel/Time/TimeManagement.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+// Upper bound on the number of events returned by a single epoll_wait() call.
+// Userspace is free to ask for more, it will just get them over several calls.
+static constexpr int max_events_per_wait = 1024;
+
+ErrorOr<FlatPtr> Process::sys$epoll_create(int flags)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    auto fd_allocation = TRY(allocate_fd());
+    auto event_poll = TRY(EventPoll::try_create());
+    auto description = TRY(OpenFileDescription::try_create(move(event_poll)));
+    description->set_readable(true);
+
+    return m_fds.with_exclusive([&](auto& fds) -> ErrorOr<FlatPtr> {
+        fds[fd_allocation.fd].set(move(description));
+        if (flags & EPOLL_CLOEXEC)
+            fds[fd_allocation.fd].set_flags(fds[fd_allocation.fd].flags() | FD_CLOEXEC);
+        return fd_allocation.fd;
+    });
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_ctl(int epfd, int op, int fd, Userspace<epoll_event const*> user_event)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    auto epoll_description = TRY(open_file_description(epfd));
+    if (!epoll_description->is_event_poll())
+        return EINVAL;
+    auto& event_poll = *epoll_description->event_poll();
+
+    auto description = TRY(open_file_description(fd));
+    if (description.ptr() == epoll_description.ptr())
+        return EINVAL;
+
+    switch (op) {
+    case EPOLL_CTL_ADD: {
+        auto event = TRY(copy_typed_from_user(user_event));
+        TRY(event_poll.add(*description, fd, event));
+        return 0;
+    }
+    case EPOLL_CTL_MOD: {
+        auto event = TRY(copy_typed_from_user(user_event));
+        TRY(event_poll.modify(fd, event));
+        return 0;
+    }
+    case EPOLL_CTL_DEL:
+        TRY(event_poll.remove(fd));
+        return 0;
+    default:
+        return EINVAL;
+    }
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_wait(int epfd, Userspace<epoll_event*> user_events, int max_events, int timeout)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    if (max_events <= 0)
+        return EINVAL;
+    max_events = min(max_events, max_events_per_wait);
+
+    auto description = TRY(open_file_description(epfd));
+    if (!description->is_event_poll())
+        return EINVAL;
+    auto& event_poll = *description->event_poll();
+
+    Thread::BlockTimeout block_timeout;
+    if (timeout > 0) {
+        auto deadline = TimeManagement::the().current_time(CLOCK_MONOTONIC_COARSE) + Time::from_milliseconds(timeout);
+        block_timeout = Thread::BlockTimeout(true, &deadline, nullptr, CLOCK_MONOTONIC_COARSE);
+    }
+
+    Vector<epoll_event> events;
+    for (;;) {
+        auto count = TRY(event_poll.collect_ready_events(events, max_events));
+        if (count > 0) {
+            TRY(try_copy_n_to_user(user_events, events.data(), count));
+            return count;
+        }
+        if (timeout == 0)
+            return 0;
+
+        auto unblock_flags = BlockFlags::None;
+        auto result = Thread::current()->block<Thread::ReadBlocker>(block_timeout, *description, unblock_flags);
+        if (result.was_interrupted())
+            return EINTR;
+        if (result == Thread::BlockResult::InterruptedByTimeout)
+            return 0;
+    }
+}
+
+}
@@ -12,11 +12,16 @@
 
 namespace Kernel {
 
-ErrorOr<FlatPtr> Process::sys$posix_fallocate(int fd, Userspace<off_t const*> userspace_offset, Userspace<off_t const*> userspace_length)
+ErrorOr<FlatPtr> Process::sys$fallocate(int fd, int mode, Userspace<off_t const*> userspace_offset, Userspace<off_t const*> userspace_length)
 {
     VERIFY_NO_PROCESS_BIG_LOCK(this);
     TRY(require_promise(Pledge::stdio));
 
+    // FIXME: Support FALLOC_FL_KEEP_SIZE. The space has to stay reserved across a crash or a reboot, so the
+    //        blocks past the end of the file must be recorded in the inode's block map, which Ext2FS can't do yet.
+    if (mode != 0)
+        return EOPNOTSUPP;
+
     auto offset = TRY(copy_typed_from_user(userspace_offset));
     if (offset < 0)
         return EINVAL;
@@ -43,15 +48,8 @@ ErrorOr<FlatPtr> Process::sys$posix_fallocate(int fd, Userspace<off_t const*> us
     VERIFY(description->file().is_inode());
 
     auto& file = static_cast<InodeFile&>(description->file());
-    if (file.inode().size() >= checked_size.value())
-        return 0;
-
-    // Note: truncate essentially calls resize in the inodes implementation
-    //       while resize is not a standard member of an inode, so we just call
-    //       truncate instead
-    TRY(file.inode().truncate(checked_size.value()));
+    TRY(file.inode().allocate(offset, length));
 
-    // FIXME: ENOSPC: There is not enough space left on the device containing the file referred to by fd.
     // FIXME: EINTR: A signal was caught during execution.
     return 0;
 }
@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ScopeGuard.h>
 #include <Kernel/Arch/SafeMem.h>
 #include <Kernel/Arch/SmapDisabler.h>
 #include <Kernel/Arch/x86/MSR.h>
@@ -121,7 +122,7 @@ ErrorOr<void> Process::validate_inode_mmap_prot(int prot, bool readable_descript
 
 ErrorOr<FlatPtr> Process::sys$mmap(Userspace<Syscall::SC_mmap_params const*> user_params)
 {
-    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     TRY(require_promise(Pledge::stdio));
     auto params = TRY(copy_typed_from_user(user_params));
 
@@ -264,7 +265,7 @@ ErrorOr<FlatPtr> Process::sys$mmap(Userspace<Syscall::SC_mmap_params const*> use
 
 ErrorOr<FlatPtr> Process::sys$mprotect(Userspace<void*> addr, size_t size, int prot)
 {
-    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     TRY(require_promise(Pledge::stdio));
 
     if (prot & PROT_EXEC) {
@@ -344,6 +345,16 @@ ErrorOr<FlatPtr> Process::sys$mprotect(Userspace<void*> addr, size_t size, int p
             if (full_size_found != range_to_mprotect.size())
                 return ENOMEM;
 
+            // Regions are remapped without flushing the TLB, and a single flush covering all of them is done
+            // at the end. Regions that were split up are kept alive until then.
+            Vector<NonnullOwnPtr<Memory::Region>, 2> unmapped_regions;
+            TRY(unmapped_regions.try_ensure_capacity(regions.size()));
+            auto flush_range_base = regions.first()->vaddr();
+            auto flush_range_end = regions.last()->range().end();
+            ScopeGuard flush_tlb_guard = [&] {
+                Memory::MemoryManager::flush_tlb(&space->page_directory(), flush_range_base, (flush_range_end.get() - flush_range_base.get()) / PAGE_SIZE);
+            };
+
             // Finally, iterate over each region, either updating its access flags if the range covers it wholly,
             // or carving out a new subregion with the appropriate access flags set.
             for (auto* old_region : regions) {
@@ -357,13 +368,14 @@ ErrorOr<FlatPtr> Process::sys$mprotect(Userspace<void*> addr, size_t size, int p
                     old_region->set_writable(prot & PROT_WRITE);
                     old_region->set_executable(prot & PROT_EXEC);
 
-                    old_region->remap();
+                    TRY(old_region->map(space->page_directory(), Memory::ShouldFlushTLB::No));
                     continue;
                 }
                 // Remove the old region from our regions tree, since were going to add another region
                 // with the exact same start address.
                 auto region = space->take_region(*old_region);
-                region->unmap();
+                region->unmap(Memory::ShouldFlushTLB::No);
+                unmapped_regions.unchecked_append(move(region));
 
                 // This vector is the region(s) adjacent to our range.
                 // We need to allocate a new region for the range we wanted to change permission bits on.
@@ -374,7 +386,7 @@ ErrorOr<FlatPtr> Process::sys$mprotect(Userspace<void*> addr, size_t size, int p
                 VERIFY(adjacent_regions.size() == 1);
 
                 size_t new_range_offset_in_vmobject = old_region->offset_in_vmobject() + (intersection_to_mprotect.base().get() - old_region->range().base().get());
-                auto* new_region = TRY(space->try_allocate_split_region(*region, intersection_to_mprotect, new_range_offset_in_vmobject));
+                auto* new_region = TRY(space->try_allocate_split_region(*old_region, intersection_to_mprotect, new_range_offset_in_vmobject));
 
                 new_region->set_readable(prot & PROT_READ);
                 new_region->set_writable(prot & PROT_WRITE);
@@ -382,9 +394,9 @@ ErrorOr<FlatPtr> Process::sys$mprotect(Userspace<void*> addr, size_t size, int p
 
                 // Map the new region using our page directory (they were just allocated and don't have one) if any.
                 if (adjacent_regions.size())
-                    TRY(adjacent_regions[0]->map(space->page_directory()));
+                    TRY(adjacent_regions[0]->map(space->page_directory(), Memory::ShouldFlushTLB::No));
 
-                TRY(new_region->map(space->page_directory()));
+                TRY(new_region->map(space->page_directory(), Memory::ShouldFlushTLB::No));
             }
 
             return 0;
@@ -396,7 +408,7 @@ ErrorOr<FlatPtr> Process::sys$mprotect(Userspace<void*> addr, size_t size, int p
 
 ErrorOr<FlatPtr> Process::sys$madvise(Userspace<void*> address, size_t size, int advice)
 {
-    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     TRY(require_promise(Pledge::stdio));
 
     auto range_to_madvise = TRY(Memory::expand_range_to_page_boundaries(address.ptr(), size));
@@ -429,7 +441,7 @@ ErrorOr<FlatPtr> Process::sys$madvise(Userspace<void*> address, size_t size, int
 
 ErrorOr<FlatPtr> Process::sys$set_mmap_name(Userspace<Syscall::SC_set_mmap_name_params const*> user_params)
 {
-    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     TRY(require_promise(Pledge::stdio));
     auto params = TRY(copy_typed_from_user(user_params));
 
@@ -455,7 +467,7 @@ ErrorOr<FlatPtr> Process::sys$set_mmap_name(Userspace<Syscall::SC_set_mmap_name_
 
 ErrorOr<FlatPtr> Process::sys$munmap(Userspace<void*> addr, size_t size)
 {
-    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     TRY(require_promise(Pledge::stdio));
     TRY(address_space().with([&](auto& space) {
         return space->unmap_mmap_range(addr.vaddr(), size);
@@ -465,7 +477,7 @@ ErrorOr<FlatPtr> Process::sys$munmap(Userspace<void*> addr, size_t size)
 
 ErrorOr<FlatPtr> Process::sys$mremap(Userspace<Syscall::SC_mremap_params const*> user_params)
 {
-    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     TRY(require_promise(Pledge::stdio));
     auto params = TRY(copy_typed_from_user(user_params));
 
@@ -590,6 +602,7 @@ ErrorOr<FlatPtr> Process::sys$msyscall(Userspace<void*> address)
 
 ErrorOr<FlatPtr> Process::sys$msync(Userspace<void*> address, size_t size, int flags)
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     if ((flags & (MS_SYNC | MS_ASYNC | MS_INVALIDATE)) != flags)
         return EINVAL;
 
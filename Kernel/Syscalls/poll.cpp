@@ -16,7 +16,7 @@ using BlockFlags = Thread::FileBlocker::BlockFlags;
 
 ErrorOr<FlatPtr> Process::sys$poll(Userspace<Syscall::SC_poll_params const*> user_params)
 {
-    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     TRY(require_promise(Pledge::stdio));
 
     auto params = TRY(copy_typed_from_user(user_params));
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <Kernel/Arch/x86/PerformanceCounters.h>
 #include <Kernel/Coredump.h>
 #include <Kernel/PerformanceManager.h>
 #include <Kernel/Process.h>
@@ -32,6 +33,10 @@ ErrorOr<FlatPtr> Process::profiling_enable(pid_t pid, u64 event_mask)
 {
     VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
 
+    // Such a profile would never get any samples.
+    if (PerformanceCounters::counts_none_of(event_mask))
+        return ENOTSUP;
+
     if (pid == -1) {
         auto credentials = this->credentials();
         if (!credentials->is_superuser())
@@ -51,6 +56,7 @@ ErrorOr<FlatPtr> Process::profiling_enable(pid_t pid, u64 event_mask)
         SpinlockLocker lock(g_profiling_lock);
         if (!TimeManagement::the().enable_profile_timer())
             return ENOTSUP;
+        PerformanceCounters::enable(event_mask);
         g_profiling_all_threads = true;
         PerformanceManager::add_process_created_event(*Scheduler::colonel());
         Process::for_each([](auto& process) {
@@ -82,6 +88,7 @@ ErrorOr<FlatPtr> Process::profiling_enable(pid_t pid, u64 event_mask)
         process->set_profiling(false);
         return ENOTSUP;
     }
+    PerformanceCounters::enable(event_mask);
     return 0;
 }
 
@@ -97,6 +104,7 @@ ErrorOr<FlatPtr> Process::sys$profiling_disable(pid_t pid)
         ScopedCritical critical;
         if (!TimeManagement::the().disable_profile_timer())
             return ENOTSUP;
+        PerformanceCounters::disable();
         g_profiling_all_threads = false;
         return 0;
     }
@@ -114,6 +122,7 @@ ErrorOr<FlatPtr> Process::sys$profiling_disable(pid_t pid)
     // FIXME: If we enabled the profile timer and it's not supported, how do we disable it now?
     if (!TimeManagement::the().disable_profile_timer())
         return ENOTSUP;
+    PerformanceCounters::disable();
     process->set_profiling(false);
     return 0;
 }
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/FileSystem/Inode.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Net/Socket.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+// Size of the kernel buffer used when the destination can't take file contents directly.
+static constexpr size_t sendfile_bounce_buffer_size = 64 * KiB;
+
+ErrorOr<FlatPtr> Process::sys$sendfile(int out_fd, int in_fd, Userspace<off_t*> user_offset, size_t count)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+    if (count > NumericLimits<ssize_t>::max())
+        return EINVAL;
+
+    auto in_description = TRY(open_file_description(in_fd));
+    auto out_description = TRY(open_file_description(out_fd));
+    if (!in_description->is_readable() || !out_description->is_writable())
+        return EBADF;
+
+    auto* inode = in_description->inode();
+    if (!inode || !in_description->metadata().is_regular_file())
+        return EINVAL;
+
+    off_t offset = in_description->offset();
+    if (user_offset)
+        TRY(copy_from_user(&offset, user_offset));
+    if (offset < 0)
+        return EINVAL;
+
+    auto file_size = inode->size();
+    if (static_cast<u64>(offset) >= file_size || count == 0)
+        return 0;
+    count = min(count, static_cast<size_t>(file_size - offset));
+
+    auto* socket = out_description->socket();
+    OwnPtr<KBuffer> bounce_buffer;
+
+    // Sends the next chunk, preferably straight from the file into the socket.
+    auto send_chunk = [&](off_t chunk_offset, size_t chunk_size) -> ErrorOr<size_t> {
+        if (socket && !bounce_buffer) {
+            auto nsent_or_error = socket->sendfile(*in_description, chunk_offset, chunk_size);
+            if (nsent_or_error.is_error() && nsent_or_error.error().code() == ENOTSUP)
+                socket = nullptr;
+            else
+                return nsent_or_error;
+        }
+
+        if (!bounce_buffer)
+            bounce_buffer = TRY(KBuffer::try_create_with_size("sendfile"sv, sendfile_bounce_buffer_size, Memory::Region::Access::ReadWrite));
+        chunk_size = min(chunk_size, bounce_buffer->size());
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(bounce_buffer->data());
+        auto nread = TRY(in_description->read(buffer, chunk_offset, chunk_size));
+        if (nread == 0)
+            return 0;
+        return TRY(do_write(*out_description, buffer, nread));
+    };
+
+    size_t total_nsent = 0;
+    while (total_nsent < count) {
+        while (!out_description->can_write()) {
+            if (!out_description->is_blocking()) {
+                if (total_nsent > 0)
+                    break;
+                return EAGAIN;
+            }
+            auto unblock_flags = Thread::FileBlocker::BlockFlags::None;
+            if (Thread::current()->block<Thread::WriteBlocker>({}, *out_description, unblock_flags).was_interrupted()) {
+                if (total_nsent == 0)
+                    return EINTR;
+                break;
+            }
+        }
+        if (!out_description->can_write())
+            break;
+
+        auto chunk_offset = offset + static_cast<off_t>(total_nsent);
+        auto nsent_or_error = send_chunk(chunk_offset, count - total_nsent);
+        if (nsent_or_error.is_error()) {
+            // Someone else may have used up the room in the socket since we checked, so go back to waiting for it.
+            if (nsent_or_error.error().code() == EAGAIN && out_description->is_blocking())
+                continue;
+            if (total_nsent > 0)
+                break;
+            return nsent_or_error.release_error();
+        }
+        auto nsent = nsent_or_error.value();
+        if (nsent == 0)
+            break;
+
+        if (socket && !bounce_buffer) {
+            // The socket read the file directly, so account for it as a file read would.
+            Thread::current()->did_file_read(nsent);
+            if (!in_description->is_direct()) {
+                if (auto read_ahead = in_description->did_read_for_read_ahead(chunk_offset, nsent); read_ahead.has_value())
+                    inode->read_ahead(read_ahead->offset, read_ahead->size);
+            }
+        }
+        total_nsent += nsent;
+    }
+
+    auto new_offset = offset + static_cast<off_t>(total_nsent);
+    if (user_offset)
+        TRY(copy_to_user(user_offset, &new_offset));
+    else
+        TRY(in_description->seek(new_offset, SEEK_SET));
+    return total_nsent;
+}
+
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Singleton.h>
+#include <Kernel/FileSystem/FileSystem.h>
+#include <Kernel/Process.h>
+#include <Kernel/Sections.h>
+#include <Kernel/Tasks/WritebackTask.h>
+#include <Kernel/Time/TimeManagement.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+static constexpr StringView writeback_task_name = "Writeback Task"sv;
+
+Atomic<u32> WritebackTask::interval_ms { 500 };
+Atomic<u32> WritebackTask::dirty_expire_ms { 5000 };
+Atomic<u32> WritebackTask::dirty_ratio { 10 };
+
+static Singleton<WaitQueue> s_writeback_wait_queue;
+
+UNMAP_AFTER_INIT void WritebackTask::spawn()
+{
+    LockRefPtr<Thread> writeback_thread;
+    (void)Process::create_kernel_process(writeback_thread, KString::must_create(writeback_task_name), [] {
+        dbgln("WritebackTask is running");
+        for (;;) {
+            FileSystem::writeback();
+            auto interval = Time::from_milliseconds(max(interval_ms.load(AK::MemoryOrder::memory_order_relaxed), 1u));
+            (void)s_writeback_wait_queue->wait_on(Thread::BlockTimeout(false, &interval), writeback_task_name);
+        }
+    });
+}
+
+void WritebackTask::wake()
+{
+    s_writeback_wait_queue->wake_one();
+}
+
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+class WritebackTask {
+public:
+    static void spawn();
+
+    // Wakes the writeback task ahead of its next scheduled run.
+    static void wake();
+
+    // How often the writeback task runs, in milliseconds.
+    static Atomic<u32> interval_ms;
+    // Dirty blocks are written back once they have been dirty for this many milliseconds.
+    static Atomic<u32> dirty_expire_ms;
+    // Once this percentage of the blocks currently in a disk cache is dirty, the writeback task is woken up and writes back all of it.
+    static Atomic<u32> dirty_ratio;
+};
+
+}
@@ -20,7 +20,7 @@
 #include <Kernel/Memory/PageDirectory.h>
 #include <Kernel/Memory/ScopedAddressSpaceSwitcher.h>
 #include <Kernel/Panic.h>
-#include <Kernel/PerformanceEventBuffer.h>
+#include <Kernel/PerformanceManager.h>
 #include <Kernel/Process.h>
 #include <Kernel/ProcessExposed.h>
 #include <Kernel/Scheduler.h>
@@ -207,6 +207,9 @@ Thread::BlockResult Thread::block_impl(BlockTimeout const& timeout, Blocker& blo
     scheduler_lock.unlock();
 
     dbgln_if(THREAD_DEBUG, "Thread {} blocking on {} ({}) -->", *this, &blocker, blocker.state_string());
+    Optional<Time> off_cpu_start;
+    if (PerformanceManager::is_recording_off_cpu_time(*this))
+        off_cpu_start = TimeManagement::the().monotonic_time(TimePrecision::Precise);
     bool did_timeout = false;
     u32 lock_count_to_restore = 0;
     auto previous_locked = unlock_process_if_locked(lock_count_to_restore);
@@ -240,6 +243,9 @@ Thread::BlockResult Thread::block_impl(BlockTimeout const& timeout, Blocker& blo
     // to clean up now while we're still holding m_lock
     auto result = blocker.end_blocking({}, did_timeout); // calls was_unblocked internally
 
+    if (off_cpu_start.has_value())
+        PerformanceManager::add_off_cpu_event(*this, TimeManagement::the().monotonic_time(TimePrecision::Precise) - off_cpu_start.value(), blocker.state_string());
+
     if (timer_was_added && !did_timeout) {
         // Cancel the timer while not holding any locks. This allows
         // the timer function to complete before we remove it
@@ -293,6 +299,10 @@ void Thread::block(Kernel::Mutex& lock, SpinlockLocker<Spinlock>& lock_lock, u32
 
     dbgln_if(THREAD_DEBUG, "Thread {} blocking on Mutex {}", *this, &lock);
 
+    Optional<Time> off_cpu_start;
+    if (PerformanceManager::is_recording_off_cpu_time(*this))
+        off_cpu_start = TimeManagement::the().monotonic_time(TimePrecision::Precise);
+
     for (;;) {
         // Yield to the scheduler, and wait for us to resume unblocked.
         VERIFY(!g_scheduler_lock.is_locked_by_current_processor());
@@ -315,6 +325,9 @@ void Thread::block(Kernel::Mutex& lock, SpinlockLocker<Spinlock>& lock_lock, u32
         break;
     }
 
+    if (off_cpu_start.has_value())
+        PerformanceManager::add_off_cpu_event(*this, TimeManagement::the().monotonic_time(TimePrecision::Precise) - off_cpu_start.value(), lock.name().is_empty() ? "Mutex"sv : lock.name());
+
     lock_lock.lock();
 }
 
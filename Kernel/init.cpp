@@ -7,6 +7,7 @@
 #include <AK/Types.h>
 #include <Kernel/Arch/InterruptManagement.h>
 #include <Kernel/Arch/Processor.h>
+#include <Kernel/Arch/x86/PerformanceCounters.h>
 #include <Kernel/BootInfo.h>
 #include <Kernel/Bus/PCI/Access.h>
 #include <Kernel/Bus/PCI/Initializer.h>
@@ -58,7 +59,7 @@
 #include <Kernel/TTY/PTYMultiplexer.h>
 #include <Kernel/TTY/VirtualConsole.h>
 #include <Kernel/Tasks/FinalizerTask.h>
-#include <Kernel/Tasks/SyncTask.h>
+#include <Kernel/Tasks/WritebackTask.h>
 #include <Kernel/Time/TimeManagement.h>
 #include <Kernel/WorkQueue.h>
 #include <Kernel/kstdio.h>
@@ -235,6 +236,7 @@ extern "C" [[noreturn]] UNMAP_AFTER_INIT void init(BootInfo const& boot_info)
 
     // Initialize TimeManagement before using randomness!
     TimeManagement::initialize(0);
+    PerformanceCounters::initialize();
 
     __stack_chk_guard = get_fast_random<size_t>();
 
@@ -331,7 +333,7 @@ void init_stage2(void*)
     GraphicsManagement::the().initialize();
     ConsoleManagement::the().initialize();
 
-    SyncTask::spawn();
+    WritebackTask::spawn();
     FinalizerTask::spawn();
 
     auto boot_profiling = kernel_command_line().is_boot_profiling_enabled();
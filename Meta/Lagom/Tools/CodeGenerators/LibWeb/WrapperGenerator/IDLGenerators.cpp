@@ -1875,6 +1875,7 @@ public:
     virtual JS::ThrowCompletionOr<bool> internal_delete(JS::PropertyKey const&) override;
     virtual JS::ThrowCompletionOr<bool> internal_prevent_extensions() override;
     virtual JS::ThrowCompletionOr<JS::MarkedVector<JS::Value>> internal_own_property_keys() const override;
+    virtual bool may_have_exotic_property(JS::PropertyKey const&) const override { return true; }
 )~~~");
     }
 
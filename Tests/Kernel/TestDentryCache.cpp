@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Path lookups are cached, including lookups of names that don't exist.
+// Each case looks a name up before and after changing the directory, so it fails if a stale entry survives.
+
+static void expect_missing(char const* path)
+{
+    struct stat st;
+    EXPECT_EQ(stat(path, &st), -1);
+    EXPECT_EQ(errno, ENOENT);
+}
+
+static ino_t expect_present(char const* path)
+{
+    struct stat st;
+    EXPECT_EQ(stat(path, &st), 0);
+    return st.st_ino;
+}
+
+static void create_file(char const* path)
+{
+    int fd = open(path, O_CREAT | O_EXCL | O_WRONLY, 0644);
+    EXPECT(fd >= 0);
+    close(fd);
+}
+
+static char const* make_directory()
+{
+    static char path[32];
+    strcpy(path, "/tmp/dentry-cache.XXXXXX");
+    EXPECT_NE(mkdtemp(path), nullptr);
+    return path;
+}
+
+TEST_CASE(create_after_failed_lookup)
+{
+    auto* directory = make_directory();
+    char path[64];
+    snprintf(path, sizeof(path), "%s/file", directory);
+
+    expect_missing(path);
+    expect_missing(path);
+    create_file(path);
+    expect_present(path);
+
+    EXPECT_EQ(unlink(path), 0);
+    expect_missing(path);
+    EXPECT_EQ(rmdir(directory), 0);
+    expect_missing(directory);
+}
+
+TEST_CASE(rename_over_cached_names)
+{
+    auto* directory = make_directory();
+    char old_path[64];
+    char new_path[64];
+    snprintf(old_path, sizeof(old_path), "%s/old", directory);
+    snprintf(new_path, sizeof(new_path), "%s/new", directory);
+
+    create_file(old_path);
+    auto inode = expect_present(old_path);
+    expect_missing(new_path);
+
+    EXPECT_EQ(rename(old_path, new_path), 0);
+    expect_missing(old_path);
+    EXPECT_EQ(expect_present(new_path), inode);
+
+    // Replacing an existing name has to make lookups find the new inode.
+    create_file(old_path);
+    auto replacement = expect_present(old_path);
+    EXPECT_EQ(rename(old_path, new_path), 0);
+    expect_missing(old_path);
+    EXPECT_EQ(expect_present(new_path), replacement);
+
+    EXPECT_EQ(unlink(new_path), 0);
+    EXPECT_EQ(rmdir(directory), 0);
+}
+
+TEST_CASE(hard_links)
+{
+    auto* directory = make_directory();
+    char path[64];
+    char link_path[64];
+    snprintf(path, sizeof(path), "%s/file", directory);
+    snprintf(link_path, sizeof(link_path), "%s/link", directory);
+
+    create_file(path);
+    expect_missing(link_path);
+    EXPECT_EQ(link(path, link_path), 0);
+    EXPECT_EQ(expect_present(link_path), expect_present(path));
+
+    EXPECT_EQ(unlink(path), 0);
+    expect_missing(path);
+    expect_present(link_path);
+
+    EXPECT_EQ(unlink(link_path), 0);
+    expect_missing(link_path);
+    EXPECT_EQ(rmdir(directory), 0);
+}
+
+TEST_CASE(recreated_directory)
+{
+    auto* directory = make_directory();
+    char subdirectory[64];
+    char path[64];
+    snprintf(subdirectory, sizeof(subdirectory), "%s/subdirectory", directory);
+    snprintf(path, sizeof(path), "%s/subdirectory/file", directory);
+
+    EXPECT_EQ(mkdir(subdirectory, 0755), 0);
+    create_file(path);
+    expect_present(path);
+
+    EXPECT_EQ(unlink(path), 0);
+    EXPECT_EQ(rmdir(subdirectory), 0);
+    expect_missing(path);
+    expect_missing(subdirectory);
+
+    EXPECT_EQ(mkdir(subdirectory, 0755), 0);
+    expect_missing(path);
+    create_file(path);
+    expect_present(path);
+
+    EXPECT_EQ(unlink(path), 0);
+    EXPECT_EQ(rmdir(subdirectory), 0);
+    EXPECT_EQ(rmdir(directory), 0);
+}
+
+TEST_CASE(long_names)
+{
+    auto* directory = make_directory();
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s", directory, "a-name-that-is-too-long-to-be-kept-in-the-cache");
+
+    expect_missing(path);
+    create_file(path);
+    expect_present(path);
+    EXPECT_EQ(unlink(path), 0);
+    expect_missing(path);
+    EXPECT_EQ(rmdir(directory), 0);
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+static void write_byte(int fd)
+{
+    char byte = 'x';
+    EXPECT_EQ(write(fd, &byte, 1), 1);
+}
+
+static void read_byte(int fd)
+{
+    char byte = 0;
+    EXPECT_EQ(read(fd, &byte, 1), 1);
+}
+
+static void add_watch(int epfd, int fd, u32 events, u64 data)
+{
+    epoll_event event {};
+    event.events = events;
+    event.data.u64 = data;
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event), 0);
+}
+
+TEST_CASE(invalid_arguments)
+{
+    EXPECT_EQ(epoll_create(0), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    EXPECT(epfd >= 0);
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, epfd, &event), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_DEL, fds[0], nullptr), -1);
+    EXPECT_EQ(errno, ENOENT);
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, fds[0], &event), 0);
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, fds[0], &event), -1);
+    EXPECT_EQ(errno, EEXIST);
+
+    epoll_event events[1];
+    EXPECT_EQ(epoll_wait(epfd, events, 0, 0), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    close(fds[0]);
+    close(fds[1]);
+    close(epfd);
+}
+
+TEST_CASE(level_triggered)
+{
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    int epfd = epoll_create1(0);
+    EXPECT(epfd >= 0);
+    add_watch(epfd, fds[0], EPOLLIN, 42);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    write_byte(fds[1]);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+    EXPECT_EQ(events[0].data.u64, 42u);
+    EXPECT(events[0].events & EPOLLIN);
+
+    // Level-triggered entries are reported until the data has been consumed.
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+    read_byte(fds[0]);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    close(fds[0]);
+    close(fds[1]);
+    close(epfd);
+}
+
+TEST_CASE(edge_triggered)
+{
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    int epfd = epoll_create1(0);
+    EXPECT(epfd >= 0);
+    add_watch(epfd, fds[0], EPOLLIN | EPOLLET, 1);
+
+    epoll_event events[4];
+    write_byte(fds[1]);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+    // Nothing changed since the last report, so there's nothing new to say.
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    write_byte(fds[1]);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+
+    close(fds[0]);
+    close(fds[1]);
+    close(epfd);
+}
+
+TEST_CASE(oneshot_and_modify)
+{
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    int epfd = epoll_create1(0);
+    EXPECT(epfd >= 0);
+    add_watch(epfd, fds[0], EPOLLIN | EPOLLONESHOT, 1);
+
+    epoll_event events[4];
+    write_byte(fds[1]);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.u64 = 2;
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_MOD, fds[0], &event), 0);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+    EXPECT_EQ(events[0].data.u64, 2u);
+
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_DEL, fds[0], nullptr), 0);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    close(fds[0]);
+    close(fds[1]);
+    close(epfd);
+}
+
+TEST_CASE(many_fds_only_ready_ones_reported)
+{
+    static constexpr int pipe_count = 64;
+    int fds[pipe_count][2];
+    int epfd = epoll_create1(0);
+    EXPECT(epfd >= 0);
+    for (int i = 0; i < pipe_count; ++i) {
+        EXPECT_EQ(pipe(fds[i]), 0);
+        add_watch(epfd, fds[i][0], EPOLLIN, i);
+    }
+
+    write_byte(fds[7][1]);
+    write_byte(fds[42][1]);
+
+    epoll_event events[pipe_count];
+    auto count = epoll_wait(epfd, events, pipe_count, 0);
+    EXPECT_EQ(count, 2);
+    u64 seen = 0;
+    for (int i = 0; i < count; ++i)
+        seen += events[i].data.u64;
+    EXPECT_EQ(seen, 7u + 42u);
+
+    for (int i = 0; i < pipe_count; ++i) {
+        close(fds[i][0]);
+        close(fds[i][1]);
+    }
+    close(epfd);
+}
+
+TEST_CASE(closing_fd_removes_it)
+{
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    int epfd = epoll_create1(0);
+    EXPECT(epfd >= 0);
+    add_watch(epfd, fds[0], EPOLLIN, 1);
+    write_byte(fds[1]);
+
+    close(fds[0]);
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    close(fds[1]);
+    close(epfd);
+}
+
+TEST_CASE(wait_times_out_and_epoll_fd_is_pollable)
+{
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    int epfd = epoll_create1(0);
+    EXPECT(epfd >= 0);
+    add_watch(epfd, fds[0], EPOLLIN, 1);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 10), 0);
+
+    pollfd pfd { epfd, POLLIN, 0 };
+    EXPECT_EQ(poll(&pfd, 1, 0), 0);
+    write_byte(fds[1]);
+    EXPECT_EQ(poll(&pfd, 1, 0), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, -1), 1);
+
+    close(fds[0]);
+    close(fds[1]);
+    close(epfd);
+}
+
+TEST_CASE(hangup_and_error_are_always_reported)
+{
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    int epfd = epoll_create1(0);
+    EXPECT(epfd >= 0);
+    add_watch(epfd, fds[0], EPOLLIN, 1);
+    add_watch(epfd, fds[1], 0, 2);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    close(fds[1]);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+    EXPECT_EQ(events[0].data.u64, 1u);
+    EXPECT(events[0].events & EPOLLHUP);
+
+    int other_fds[2];
+    EXPECT_EQ(pipe(other_fds), 0);
+    add_watch(epfd, other_fds[1], 0, 3);
+    close(other_fds[0]);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 2);
+    bool saw_error = false;
+    for (auto& event : Span<epoll_event> { events, 2 }) {
+        if (event.data.u64 == 3)
+            saw_error = event.events & EPOLLERR;
+    }
+    EXPECT(saw_error);
+
+    close(fds[0]);
+    close(other_fds[1]);
+    close(epfd);
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// These run on the root file system rather than /tmp, so they exercise the Ext2FS block allocator.
+
+static int create_file()
+{
+    char path[] = "/home/anon/fallocate.XXXXXX";
+    auto fd = mkstemp(path);
+    EXPECT(fd >= 0);
+    EXPECT_EQ(unlink(path), 0);
+    return fd;
+}
+
+static size_t file_size(int fd)
+{
+    struct stat st;
+    EXPECT_EQ(fstat(fd, &st), 0);
+    return st.st_size;
+}
+
+TEST_CASE(posix_fallocate_extends_file_with_zeroes)
+{
+    auto fd = create_file();
+    EXPECT_EQ(posix_fallocate(fd, 0, 64 * KiB), 0);
+    EXPECT_EQ(file_size(fd), 64 * KiB);
+
+    char buffer[4096];
+    for (size_t offset = 0; offset < 64 * KiB; offset += sizeof(buffer)) {
+        memset(buffer, 0xff, sizeof(buffer));
+        EXPECT_EQ(pread(fd, buffer, sizeof(buffer), offset), static_cast<ssize_t>(sizeof(buffer)));
+        for (auto byte : buffer)
+            EXPECT_EQ(byte, 0);
+    }
+
+    // A range that's already allocated leaves the file alone.
+    EXPECT_EQ(posix_fallocate(fd, 0, 4096), 0);
+    EXPECT_EQ(file_size(fd), 64 * KiB);
+    close(fd);
+}
+
+TEST_CASE(invalid_arguments)
+{
+    auto fd = create_file();
+    EXPECT_EQ(fallocate(fd, 0x80, 0, 4096), -1);
+    EXPECT_EQ(errno, EOPNOTSUPP);
+    EXPECT_EQ(fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, 4096), -1);
+    EXPECT_EQ(errno, EOPNOTSUPP);
+    EXPECT_EQ(file_size(fd), 0u);
+    EXPECT_EQ(fallocate(fd, 0, -1, 4096), -1);
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_EQ(fallocate(fd, 0, 0, 0), -1);
+    EXPECT_EQ(errno, EINVAL);
+    close(fd);
+}
+
+TEST_CASE(small_appends_stay_contiguous)
+{
+    auto fd = create_file();
+    char buffer[1024];
+    memset(buffer, 'B', sizeof(buffer));
+    for (size_t i = 0; i < 1024; ++i)
+        EXPECT_EQ(write(fd, buffer, sizeof(buffer)), static_cast<ssize_t>(sizeof(buffer)));
+
+    // FIBMAP is only available to the superuser.
+    int block = 0;
+    if (ioctl(fd, FIBMAP, &block) < 0) {
+        EXPECT_EQ(errno, EPERM);
+        close(fd);
+        return;
+    }
+
+    struct stat st;
+    EXPECT_EQ(fstat(fd, &st), 0);
+    int block_count = st.st_size / st.st_blksize;
+    int previous_block = block;
+    int runs = 1;
+    for (int i = 1; i < block_count; ++i) {
+        block = i;
+        EXPECT_EQ(ioctl(fd, FIBMAP, &block), 0);
+        if (block != previous_block + 1)
+            ++runs;
+        previous_block = block;
+    }
+    // Free space may already be fragmented, but the file shouldn't be scattered block by block.
+    EXPECT(runs <= max(block_count / 16, 1));
+    close(fd);
+}
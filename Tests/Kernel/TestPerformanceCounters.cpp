@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Format.h>
+#include <AK/Vector.h>
+#include <Kernel/API/Perfcore.h>
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <serenity.h>
+#include <string.h>
+#include <unistd.h>
+
+static Vector<u8> read_perf_events()
+{
+    Vector<u8> data;
+    auto fd = open("/proc/self/perf_events", O_RDONLY);
+    EXPECT(fd >= 0);
+    u8 buffer[4096];
+    for (;;) {
+        auto nread = read(fd, buffer, sizeof(buffer));
+        EXPECT(nread >= 0);
+        if (nread <= 0)
+            break;
+        data.append(buffer, nread);
+    }
+    close(fd);
+    return data;
+}
+
+TEST_CASE(hardware_events_are_sampled_with_their_own_period)
+{
+    u64 event_mask = PERF_EVENT_CPU_CYCLES | PERF_EVENT_INSTRUCTIONS;
+    if (profiling_enable(getpid(), event_mask) < 0) {
+        // Without a performance monitoring unit, there is nothing to count.
+        EXPECT_EQ(errno, ENOTSUP);
+        warnln("Skipping, the processor can't count hardware events");
+        return;
+    }
+
+    // Two million cycles or instructions make up a sample, so this is good for a few hundred of them.
+    volatile u64 sum = 0;
+    for (u64 i = 0; i < 500'000'000; ++i)
+        sum = sum + i;
+
+    EXPECT_EQ(profiling_disable(getpid()), 0);
+    auto data = read_perf_events();
+    EXPECT_EQ(profiling_free_buffer(getpid()), 0);
+
+    EXPECT(data.size() >= sizeof(Perfcore::FileHeader));
+    Perfcore::FileHeader file_header;
+    memcpy(&file_header, data.data(), sizeof(file_header));
+    EXPECT_EQ(file_header.magic, Perfcore::magic);
+
+    size_t hardware_samples = 0;
+    for (size_t offset = sizeof(file_header); offset + sizeof(Perfcore::RecordHeader) <= data.size();) {
+        Perfcore::RecordHeader record_header;
+        memcpy(&record_header, data.data() + offset, sizeof(record_header));
+        offset += sizeof(record_header);
+        if (offset + record_header.length > data.size())
+            break;
+
+        if (record_header.type == Perfcore::RecordType::Event) {
+            Perfcore::EventRecord event;
+            memcpy(&event, data.data() + offset, sizeof(event));
+            if (event.type & (PERF_EVENT_CPU_CYCLES | PERF_EVENT_INSTRUCTIONS | PERF_EVENT_CACHE_MISSES | PERF_EVENT_BRANCH_MISSES)) {
+                // Only the events that were asked for are counted, and each sample carries the period of its event.
+                EXPECT(event.type & event_mask);
+                EXPECT_EQ(record_header.length, sizeof(event) + sizeof(Perfcore::PerformanceCounterPayload));
+                Perfcore::PerformanceCounterPayload payload;
+                memcpy(&payload, data.data() + offset + sizeof(event), sizeof(payload));
+                EXPECT_EQ(payload.period, 2'000'000u);
+                EXPECT_EQ(event.pid, static_cast<u32>(getpid()));
+                ++hardware_samples;
+            }
+        }
+        offset += record_header.length;
+    }
+    EXPECT(hardware_samples > 0);
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Format.h>
+#include <AK/Types.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/File.h>
+#include <LibCore/ProcessStatisticsReader.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Measures random access throughput over a large anonymous mapping, with and without
+// transparent huge pages, so the difference in TLB misses shows up. Afterwards, parts of
+// the mapping are re-protected and unmapped, which splits huge pages, and the contents
+// are checked to make sure that nothing was lost along the way.
+// Writing to /proc/sys requires root.
+
+static constexpr size_t huge_page_size = 2 * MiB;
+
+static constexpr auto huge_pages_tunable = "/proc/sys/transparent_huge_pages"sv;
+
+static bool huge_pages_enabled()
+{
+    auto file = Core::File::open(huge_pages_tunable, Core::OpenMode::ReadOnly);
+    if (file.is_error()) {
+        warnln("Couldn't open {}: {}", huge_pages_tunable, file.error());
+        exit(1);
+    }
+    auto contents = file.value()->read_all();
+    return !contents.is_empty() && contents[0] != '0';
+}
+
+static void set_huge_pages_enabled(bool enabled)
+{
+    auto file = Core::File::open(huge_pages_tunable, Core::OpenMode::WriteOnly);
+    if (file.is_error() || !file.value()->write(enabled ? "1"sv : "0"sv)) {
+        warnln("Couldn't write to {}", huge_pages_tunable);
+        exit(1);
+    }
+}
+
+static size_t amount_huge()
+{
+    RefPtr<Core::File> proc_all;
+    auto statistics = Core::ProcessStatisticsReader::get_all(proc_all);
+    if (!statistics.has_value())
+        return 0;
+    auto pid = getpid();
+    for (auto& process : statistics->processes) {
+        if (process.pid == pid)
+            return process.amount_huge;
+    }
+    return 0;
+}
+
+static u64 next_random(u64& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static u64 expected_word(size_t index)
+{
+    return index * 0x9E3779B97F4A7C15ULL;
+}
+
+static void verify(u64 const* words, size_t first_index, size_t end_index)
+{
+    for (size_t i = first_index; i < end_index; ++i) {
+        if (words[i] != expected_word(i)) {
+            fprintf(stderr, "Data mismatch at offset %zu\n", i * sizeof(u64));
+            exit(1);
+        }
+    }
+}
+
+static void run(size_t size, size_t access_count, bool huge_pages)
+{
+    set_huge_pages_enabled(huge_pages);
+
+    auto* memory = serenity_mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0, huge_page_size, "stress-huge-pages");
+    if (memory == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+    auto* words = static_cast<u64*>(memory);
+    size_t word_count = size / sizeof(u64);
+
+    Core::ElapsedTimer timer { true };
+    timer.start();
+    for (size_t i = 0; i < word_count; ++i)
+        words[i] = expected_word(i);
+    auto fill_time = timer.elapsed() / 1000.0;
+    auto huge = amount_huge();
+
+    u64 state = 0x2545F4914F6CDD1DULL;
+    u64 sum = 0;
+    timer.start();
+    for (size_t i = 0; i < access_count; ++i)
+        sum += words[next_random(state) % word_count];
+    auto access_time = timer.elapsed() / 1000.0;
+
+    printf("%10s %10.2f %14.2f %10zu %18llx\n", huge_pages ? "on" : "off", size / fill_time / MiB, access_count / access_time / 1'000'000, huge / MiB, static_cast<unsigned long long>(sum));
+
+    // Changing or unmapping a single page has to split the huge page around it.
+    auto* page_in_first_huge_page = static_cast<u8*>(memory) + 5 * PAGE_SIZE;
+    if (mprotect(page_in_first_huge_page, PAGE_SIZE, PROT_READ) < 0 || mprotect(page_in_first_huge_page, PAGE_SIZE, PROT_READ | PROT_WRITE) < 0) {
+        perror("mprotect");
+        exit(1);
+    }
+    verify(words, 0, word_count);
+    words[5 * PAGE_SIZE / sizeof(u64)] = expected_word(5 * PAGE_SIZE / sizeof(u64));
+
+    auto hole_offset = huge_page_size + 7 * PAGE_SIZE;
+    if (munmap(static_cast<u8*>(memory) + hole_offset, PAGE_SIZE) < 0) {
+        perror("munmap");
+        exit(1);
+    }
+    verify(words, 0, hole_offset / sizeof(u64));
+    verify(words, (hole_offset + PAGE_SIZE) / sizeof(u64), word_count);
+    munmap(memory, hole_offset);
+    munmap(static_cast<u8*>(memory) + hole_offset + PAGE_SIZE, size - hole_offset - PAGE_SIZE);
+}
+
+int main(int argc, char** argv)
+{
+    int size_mib = 256;
+    int access_millions = 20;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure random access throughput over anonymous memory with and without huge pages.");
+    args_parser.add_option(size_mib, "Size of the mapping in MiB", "size", 's', "MiB");
+    args_parser.add_option(access_millions, "Number of random accesses in millions", "accesses", 'a', "millions");
+    args_parser.parse(argc, argv);
+
+    if (size_mib < 4) {
+        fprintf(stderr, "The mapping has to be at least 4 MiB\n");
+        return 1;
+    }
+
+    auto were_enabled = huge_pages_enabled();
+    size_t size = static_cast<size_t>(size_mib) * MiB;
+    size_t access_count = static_cast<size_t>(access_millions) * 1'000'000;
+
+    printf("%10s %10s %14s %10s %18s\n", "huge", "fill MiB/s", "M accesses/s", "huge MiB", "checksum");
+    run(size, access_count, false);
+    run(size, access_count, true);
+
+    set_huge_pages_enabled(were_enabled);
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// All threads belong to the same process and do I/O on their own file descriptors.
+// If I/O syscalls are serialized per process, total throughput stays flat as threads are added.
+
+static constexpr size_t chunk_size = 64 * KiB;
+
+struct Worker {
+    pthread_t thread;
+    int zero_fd { -1 };
+    int null_fd { -1 };
+    bool use_mmap { false };
+    u64 bytes { 0 };
+};
+
+static Atomic<bool> s_stop { false };
+
+static void* worker_main(void* arg)
+{
+    auto& worker = *static_cast<Worker*>(arg);
+    auto* buffer = static_cast<u8*>(malloc(chunk_size));
+    if (!buffer) {
+        perror("malloc");
+        exit(1);
+    }
+
+    while (!s_stop.load(AK::MemoryOrder::memory_order_relaxed)) {
+        if (worker.use_mmap) {
+            auto* region = mmap(nullptr, chunk_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+            if (region == MAP_FAILED) {
+                perror("mmap");
+                exit(1);
+            }
+            if (munmap(region, chunk_size) < 0) {
+                perror("munmap");
+                exit(1);
+            }
+        }
+
+        if (read(worker.zero_fd, buffer, chunk_size) != static_cast<ssize_t>(chunk_size)) {
+            perror("read");
+            exit(1);
+        }
+        iovec iov[2] = {
+            { buffer, chunk_size / 2 },
+            { buffer + chunk_size / 2, chunk_size / 2 },
+        };
+        if (writev(worker.null_fd, iov, 2) != static_cast<ssize_t>(chunk_size)) {
+            perror("writev");
+            exit(1);
+        }
+        worker.bytes += chunk_size;
+    }
+
+    free(buffer);
+    return nullptr;
+}
+
+static u64 run_round(int thread_count, int duration_ms, bool use_mmap)
+{
+    Vector<Worker> workers;
+    workers.resize(thread_count);
+    s_stop.store(false);
+
+    for (auto& worker : workers) {
+        worker.zero_fd = open("/dev/zero", O_RDONLY);
+        worker.null_fd = open("/dev/null", O_WRONLY);
+        if (worker.zero_fd < 0 || worker.null_fd < 0) {
+            perror("open");
+            exit(1);
+        }
+        worker.use_mmap = use_mmap;
+    }
+    for (auto& worker : workers) {
+        if (pthread_create(&worker.thread, nullptr, worker_main, &worker) != 0) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+
+    usleep(duration_ms * 1000);
+    s_stop.store(true);
+
+    u64 bytes = 0;
+    for (auto& worker : workers) {
+        pthread_join(worker.thread, nullptr);
+        bytes += worker.bytes;
+        close(worker.zero_fd);
+        close(worker.null_fd);
+    }
+    return bytes;
+}
+
+int main(int argc, char** argv)
+{
+    int max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int duration_ms = 2000;
+    bool use_mmap = false;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure I/O syscall throughput of a single process with a growing number of threads.");
+    args_parser.add_option(max_threads, "Maximum number of threads (default: number of processors)", "threads", 't', "number");
+    args_parser.add_option(duration_ms, "Duration of each round in milliseconds", "duration", 'd', "ms");
+    args_parser.add_option(use_mmap, "Also map and unmap a region for every chunk", "mmap", 'm');
+    args_parser.parse(argc, argv);
+
+    if (max_threads < 1)
+        max_threads = 1;
+
+    printf("%d processor(s) online\n", (int)sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%8s %14s %14s %10s\n", "threads", "MiB/sec", "MiB/sec/thread", "scaling");
+
+    double single_thread_throughput = 0;
+    for (int thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+        Core::ElapsedTimer timer { true };
+        timer.start();
+        auto bytes = run_round(thread_count, duration_ms, use_mmap);
+        auto elapsed = timer.elapsed() / 1000.0;
+
+        auto throughput = bytes / elapsed / MiB;
+        if (thread_count == 1)
+            single_thread_throughput = throughput;
+        printf("%8d %14.1f %14.1f %9.2fx\n", thread_count, throughput, throughput / thread_count, throughput / single_thread_throughput);
+
+        if (thread_count < max_threads && thread_count * 2 > max_threads)
+            thread_count = max_threads / 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Types.h>
+#include <LibCore/ArgsParser.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+// Measures how many packets per second make it from one UDP socket to another over the
+// loopback adapter, for a few datagram sizes. Every packet goes through the adapter's
+// receive queue and the network task, so this is mostly a measure of per-packet overhead.
+// UDP doesn't resend anything, so packets that didn't fit into the receive queues are
+// counted as lost.
+
+static constexpr size_t datagram_sizes[] = { 16, 512, 1400, 8192 };
+
+struct Receiver {
+    int fd;
+    size_t expected_count;
+    size_t received_count;
+    timespec last_receive_time;
+};
+
+static int create_socket()
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        exit(1);
+    }
+    return fd;
+}
+
+static double seconds_between(timespec const& start, timespec const& end)
+{
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+static void* receive_datagrams(void* argument)
+{
+    auto& receiver = *static_cast<Receiver*>(argument);
+    char buffer[65536];
+    while (receiver.received_count < receiver.expected_count) {
+        // Stop once nothing has arrived for a while, since the rest has been dropped.
+        if (recv(receiver.fd, buffer, sizeof(buffer), 0) < 0)
+            break;
+        ++receiver.received_count;
+        clock_gettime(CLOCK_MONOTONIC, &receiver.last_receive_time);
+    }
+    return nullptr;
+}
+
+static void run(size_t datagram_size, size_t count)
+{
+    int receive_fd = create_socket();
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    if (bind(receive_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        perror("bind");
+        exit(1);
+    }
+    socklen_t address_length = sizeof(address);
+    if (getsockname(receive_fd, reinterpret_cast<sockaddr*>(&address), &address_length) < 0) {
+        perror("getsockname");
+        exit(1);
+    }
+    timeval timeout { 1, 0 };
+    if (setsockopt(receive_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) {
+        perror("setsockopt");
+        exit(1);
+    }
+
+    int send_fd = create_socket();
+    if (connect(send_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        perror("connect");
+        exit(1);
+    }
+
+    Receiver receiver { receive_fd, count, 0, {} };
+    pthread_t thread;
+    if (int rc = pthread_create(&thread, nullptr, receive_datagrams, &receiver); rc != 0) {
+        fprintf(stderr, "pthread_create: %s\n", strerror(rc));
+        exit(1);
+    }
+
+    char datagram[65536];
+    memset(datagram, 'x', datagram_size);
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < count; ++i) {
+        if (send(send_fd, datagram, datagram_size, 0) < 0) {
+            perror("send");
+            exit(1);
+        }
+    }
+    timespec send_end;
+    clock_gettime(CLOCK_MONOTONIC, &send_end);
+    pthread_join(thread, nullptr);
+
+    auto send_seconds = seconds_between(start, send_end);
+    auto receive_seconds = receiver.received_count > 0 ? seconds_between(start, receiver.last_receive_time) : 0;
+    printf("%8zu %12.0f %12.0f %10.2f %8.1f\n", datagram_size,
+        count / send_seconds,
+        receive_seconds > 0 ? receiver.received_count / receive_seconds : 0,
+        receive_seconds > 0 ? receiver.received_count * datagram_size / receive_seconds / MiB : 0,
+        100.0 * (count - receiver.received_count) / count);
+
+    close(send_fd);
+    close(receive_fd);
+}
+
+int main(int argc, char** argv)
+{
+    int count = 100'000;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure how many UDP packets per second can be sent over the loopback adapter.");
+    args_parser.add_option(count, "Number of packets for each datagram size", "count", 'c', "count");
+    args_parser.parse(argc, argv);
+
+    if (count < 1) {
+        fprintf(stderr, "Invalid arguments\n");
+        return 1;
+    }
+
+    printf("%8s %12s %12s %10s %8s\n", "size", "sent/s", "received/s", "MiB/s", "lost %");
+    for (auto datagram_size : datagram_sizes)
+        run(datagram_size, count);
+    return 0;
+}
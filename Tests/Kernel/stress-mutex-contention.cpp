@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/JsonValue.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/File.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Measures the throughput of a varying number of threads that all read from the same file,
+// which makes them contend for the kernel's lock of that file's inode. Short critical sections
+// like these are where spinning on a Mutex whose holder is running pays off.
+// Afterwards, the most contended locks are printed from /sys/kernel/lock_statistics,
+// which requires root.
+
+static constexpr char const* lock_statistics_path = "/sys/kernel/lock_statistics";
+
+static int s_fd;
+static int s_reads_per_thread;
+
+static void* read_repeatedly(void*)
+{
+    char buffer[64];
+    for (int i = 0; i < s_reads_per_thread; ++i) {
+        if (pread(s_fd, buffer, sizeof(buffer), 0) < 0) {
+            perror("pread");
+            exit(1);
+        }
+    }
+    return nullptr;
+}
+
+static void run(int thread_count)
+{
+    Core::ElapsedTimer timer { true };
+    timer.start();
+
+    Vector<pthread_t> threads;
+    for (int i = 0; i < thread_count; ++i) {
+        pthread_t thread;
+        if (int rc = pthread_create(&thread, nullptr, read_repeatedly, nullptr); rc != 0) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(rc));
+            exit(1);
+        }
+        threads.append(thread);
+    }
+    for (auto thread : threads)
+        pthread_join(thread, nullptr);
+
+    auto elapsed = timer.elapsed() / 1000.0;
+    printf("%8d %14.0f\n", thread_count, static_cast<double>(thread_count) * s_reads_per_thread / elapsed);
+}
+
+static bool set_lock_statistics_enabled(bool enabled)
+{
+    int fd = open(lock_statistics_path, O_WRONLY);
+    if (fd < 0)
+        return false;
+    bool success = write(fd, enabled ? "1" : "0", 1) == 1;
+    close(fd);
+    return success;
+}
+
+static void print_lock_statistics(size_t max_locks)
+{
+    auto file_or_error = Core::File::open(lock_statistics_path, Core::OpenMode::ReadOnly);
+    if (file_or_error.is_error())
+        return;
+    auto json = JsonValue::from_string(file_or_error.value()->read_all());
+    if (json.is_error() || !json.value().is_object())
+        return;
+    auto const& locks = json.value().as_object().get("locks"sv).as_array();
+
+    printf("\n%-32s %12s %12s %14s %12s\n", "lock", "contended", "by spinning", "total wait us", "max wait us");
+    for (size_t i = 0; i < min(max_locks, locks.size()); ++i) {
+        auto const& lock = locks.at(i).as_object();
+        printf("%-32s %12llu %12llu %14llu %12llu\n", lock.get("name"sv).to_string().characters(),
+            static_cast<unsigned long long>(lock.get("contended"sv).to_u64()),
+            static_cast<unsigned long long>(lock.get("acquired_by_spinning"sv).to_u64()),
+            static_cast<unsigned long long>(lock.get("total_wait_us"sv).to_u64()),
+            static_cast<unsigned long long>(lock.get("max_wait_us"sv).to_u64()));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int max_threads = 8;
+    int reads = 100'000;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure the throughput of threads contending for the same kernel lock.");
+    args_parser.add_option(max_threads, "Largest number of threads", "threads", 't', "count");
+    args_parser.add_option(reads, "Number of reads per thread", "reads", 'r', "count");
+    args_parser.parse(argc, argv);
+
+    if (max_threads < 1 || reads < 1) {
+        fprintf(stderr, "Invalid arguments\n");
+        return 1;
+    }
+    s_reads_per_thread = reads;
+
+    char path[] = "/tmp/stress-mutex-contention.XXXXXX";
+    s_fd = mkstemp(path);
+    if (s_fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    unlink(path);
+    char contents[64] = {};
+    if (write(s_fd, contents, sizeof(contents)) != sizeof(contents)) {
+        perror("write");
+        return 1;
+    }
+
+    bool has_lock_statistics = set_lock_statistics_enabled(true);
+
+    printf("%8s %14s\n", "threads", "reads/s");
+    for (int thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+        run(thread_count);
+
+    if (has_lock_statistics) {
+        set_lock_statistics_enabled(false);
+        print_lock_statistics(10);
+    }
+
+    close(s_fd);
+    return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// Each pair of threads bounces a single byte back and forth over two pipes.
+// Every round trip blocks and wakes both threads once, so the number of
+// round trips per second is a direct measure of context switch throughput,
+// and the time a round trip takes is a measure of wakeup latency.
+
+struct PingPongPair {
+    int ping_fds[2];
+    int pong_fds[2];
+    pthread_t pinger;
+    pthread_t ponger;
+    u64 round_trips { 0 };
+    u64 total_round_trip_ns { 0 };
+    u64 max_round_trip_ns { 0 };
+};
+
+static u64 now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1'000'000'000ull + ts.tv_nsec;
+}
+
+static Atomic<bool> s_stop { false };
+
+static void* pinger_main(void* arg)
+{
+    auto& pair = *static_cast<PingPongPair*>(arg);
+    char byte = 0;
+    while (!s_stop.load(AK::MemoryOrder::memory_order_relaxed)) {
+        auto start_ns = now_ns();
+        if (write(pair.ping_fds[1], &byte, 1) != 1) {
+            perror("write");
+            exit(1);
+        }
+        if (read(pair.pong_fds[0], &byte, 1) != 1) {
+            perror("read");
+            exit(1);
+        }
+        auto round_trip_ns = now_ns() - start_ns;
+        ++pair.round_trips;
+        pair.total_round_trip_ns += round_trip_ns;
+        pair.max_round_trip_ns = max(pair.max_round_trip_ns, round_trip_ns);
+    }
+    // Tell the ponger to shut down.
+    byte = 1;
+    if (write(pair.ping_fds[1], &byte, 1) != 1)
+        perror("write");
+    return nullptr;
+}
+
+static void* ponger_main(void* arg)
+{
+    auto& pair = *static_cast<PingPongPair*>(arg);
+    char byte = 0;
+    for (;;) {
+        if (read(pair.ping_fds[0], &byte, 1) != 1) {
+            perror("read");
+            exit(1);
+        }
+        if (byte != 0)
+            break;
+        if (write(pair.pong_fds[1], &byte, 1) != 1) {
+            perror("write");
+            exit(1);
+        }
+    }
+    return nullptr;
+}
+
+struct RoundResult {
+    u64 round_trips { 0 };
+    u64 total_round_trip_ns { 0 };
+    u64 max_round_trip_ns { 0 };
+};
+
+static RoundResult run_round(int pair_count, int duration_ms)
+{
+    Vector<PingPongPair> pairs;
+    pairs.resize(pair_count);
+    s_stop.store(false);
+
+    for (auto& pair : pairs) {
+        if (pipe(pair.ping_fds) < 0 || pipe(pair.pong_fds) < 0) {
+            perror("pipe");
+            exit(1);
+        }
+    }
+    for (auto& pair : pairs) {
+        if (pthread_create(&pair.ponger, nullptr, ponger_main, &pair) != 0 || pthread_create(&pair.pinger, nullptr, pinger_main, &pair) != 0) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+
+    usleep(duration_ms * 1000);
+    s_stop.store(true);
+
+    RoundResult result;
+    for (auto& pair : pairs) {
+        pthread_join(pair.pinger, nullptr);
+        pthread_join(pair.ponger, nullptr);
+        result.round_trips += pair.round_trips;
+        result.total_round_trip_ns += pair.total_round_trip_ns;
+        result.max_round_trip_ns = max(result.max_round_trip_ns, pair.max_round_trip_ns);
+        close(pair.ping_fds[0]);
+        close(pair.ping_fds[1]);
+        close(pair.pong_fds[0]);
+        close(pair.pong_fds[1]);
+    }
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int max_pairs = sysconf(_SC_NPROCESSORS_ONLN);
+    int duration_ms = 2000;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure context switch throughput and wakeup latency with a growing number of ping-pong thread pairs.");
+    args_parser.add_option(max_pairs, "Maximum number of thread pairs (default: number of processors)", "pairs", 'p', "number");
+    args_parser.add_option(duration_ms, "Duration of each round in milliseconds", "duration", 'd', "ms");
+    args_parser.parse(argc, argv);
+
+    if (max_pairs < 1)
+        max_pairs = 1;
+
+    printf("%d processor(s) online\n", (int)sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%8s %14s %18s %18s %14s %14s\n", "pairs", "round trips", "switches/sec", "switches/sec/pair", "avg trip (us)", "max trip (us)");
+
+    for (int pair_count = 1; pair_count <= max_pairs; pair_count *= 2) {
+        Core::ElapsedTimer timer { true };
+        timer.start();
+        auto result = run_round(pair_count, duration_ms);
+        auto elapsed = timer.elapsed() / 1000.0;
+
+        // Every round trip blocks each of the two threads once.
+        auto switches_per_second = (2 * result.round_trips) / elapsed;
+        auto average_round_trip_us = result.round_trips ? result.total_round_trip_ns / 1000.0 / result.round_trips : 0.0;
+        printf("%8d %14llu %18.0f %18.0f %14.1f %14.1f\n", pair_count, (unsigned long long)result.round_trips, switches_per_second, switches_per_second / pair_count, average_round_trip_us, result.max_round_trip_ns / 1000.0);
+
+        if (pair_count < max_pairs && pair_count * 2 > max_pairs)
+            pair_count = max_pairs / 2;
+    }
+
+    return 0;
+}
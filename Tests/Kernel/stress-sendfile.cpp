@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Types.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Pushes the same file through a loopback TCP connection, once with read()+write() and once with sendfile().
+// The difference is the cost of copying the file contents through a userspace buffer.
+
+static constexpr size_t chunk_size = 64 * KiB;
+
+static void* drain_main(void* arg)
+{
+    int fd = *static_cast<int*>(arg);
+    auto* buffer = static_cast<u8*>(malloc(chunk_size));
+    if (!buffer) {
+        perror("malloc");
+        exit(1);
+    }
+    for (;;) {
+        auto nread = read(fd, buffer, chunk_size);
+        if (nread < 0) {
+            perror("read");
+            exit(1);
+        }
+        if (nread == 0)
+            break;
+    }
+    free(buffer);
+    close(fd);
+    return nullptr;
+}
+
+static void connect_loopback_pair(int& client_fd, int& server_fd)
+{
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        perror("socket");
+        exit(1);
+    }
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t address_size = sizeof(address);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+        || listen(listen_fd, 1) < 0
+        || getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &address_size) < 0) {
+        perror("bind/listen");
+        exit(1);
+    }
+
+    client_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (client_fd < 0 || connect(client_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        perror("connect");
+        exit(1);
+    }
+    server_fd = accept(listen_fd, nullptr, nullptr);
+    if (server_fd < 0) {
+        perror("accept");
+        exit(1);
+    }
+    close(listen_fd);
+}
+
+static void send_with_read_write(int socket_fd, int file_fd, size_t file_size)
+{
+    static u8 buffer[chunk_size];
+    if (lseek(file_fd, 0, SEEK_SET) < 0) {
+        perror("lseek");
+        exit(1);
+    }
+    size_t total = 0;
+    while (total < file_size) {
+        auto nread = read(file_fd, buffer, chunk_size);
+        if (nread <= 0) {
+            perror("read");
+            exit(1);
+        }
+        for (ssize_t nwritten = 0; nwritten < nread;) {
+            auto rc = write(socket_fd, buffer + nwritten, nread - nwritten);
+            if (rc < 0) {
+                perror("write");
+                exit(1);
+            }
+            nwritten += rc;
+        }
+        total += nread;
+    }
+}
+
+static void send_with_sendfile(int socket_fd, int file_fd, size_t file_size)
+{
+    off_t offset = 0;
+    while (static_cast<size_t>(offset) < file_size) {
+        auto nsent = sendfile(socket_fd, file_fd, &offset, file_size - offset);
+        if (nsent <= 0) {
+            perror("sendfile");
+            exit(1);
+        }
+    }
+}
+
+static double run_round(int file_fd, size_t file_size, int iterations, bool use_sendfile)
+{
+    int client_fd = -1;
+    int server_fd = -1;
+    connect_loopback_pair(client_fd, server_fd);
+
+    pthread_t drain_thread;
+    if (pthread_create(&drain_thread, nullptr, drain_main, &server_fd) != 0) {
+        perror("pthread_create");
+        exit(1);
+    }
+
+    Core::ElapsedTimer timer { true };
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        if (use_sendfile)
+            send_with_sendfile(client_fd, file_fd, file_size);
+        else
+            send_with_read_write(client_fd, file_fd, file_size);
+    }
+    close(client_fd);
+    pthread_join(drain_thread, nullptr);
+    auto elapsed = timer.elapsed() / 1000.0;
+
+    return static_cast<double>(file_size) * iterations / elapsed / MiB;
+}
+
+int main(int argc, char** argv)
+{
+    int file_size_mib = 16;
+    int iterations = 8;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Compare loopback TCP throughput of read()+write() and sendfile().");
+    args_parser.add_option(file_size_mib, "Size of the file to send in MiB", "size", 's', "MiB");
+    args_parser.add_option(iterations, "Number of times to send the file in each round", "iterations", 'i', "count");
+    args_parser.parse(argc, argv);
+
+    char path[] = "/tmp/stress-sendfile.XXXXXX";
+    int file_fd = mkstemp(path);
+    if (file_fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    unlink(path);
+
+    size_t file_size = static_cast<size_t>(file_size_mib) * MiB;
+    auto* pattern = static_cast<u8*>(malloc(chunk_size));
+    if (!pattern) {
+        perror("malloc");
+        return 1;
+    }
+    for (size_t i = 0; i < chunk_size; ++i)
+        pattern[i] = static_cast<u8>(i * 31);
+    for (size_t written = 0; written < file_size; written += chunk_size) {
+        if (write(file_fd, pattern, chunk_size) != static_cast<ssize_t>(chunk_size)) {
+            perror("write");
+            return 1;
+        }
+    }
+    free(pattern);
+
+    // Warm up the disk cache, so both rounds read the file from memory.
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd < 0) {
+        perror("open");
+        return 1;
+    }
+    send_with_read_write(null_fd, file_fd, file_size);
+    close(null_fd);
+
+    auto read_write_throughput = run_round(file_fd, file_size, iterations, false);
+    auto sendfile_throughput = run_round(file_fd, file_size, iterations, true);
+
+    printf("%12s %14s\n", "method", "MiB/sec");
+    printf("%12s %14.1f\n", "read+write", read_write_throughput);
+    printf("%12s %14.1f\n", "sendfile", sendfile_throughput);
+    printf("%12s %13.2fx\n", "speedup", sendfile_throughput / read_write_throughput);
+
+    close(file_fd);
+    return 0;
+}
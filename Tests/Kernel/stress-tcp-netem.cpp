@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Types.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Measures loopback TCP throughput while the loopback adapter delays and drops packets,
+// once for each congestion control algorithm. Every received byte is checked, so this also
+// catches mistakes in retransmission and out-of-order reassembly.
+// Writing to /proc/sys requires root.
+
+static constexpr size_t chunk_size = 64 * KiB;
+
+struct LinkConditions {
+    unsigned delay_ms;
+    unsigned loss_per_mille;
+};
+
+static constexpr LinkConditions link_conditions[] = {
+    { 0, 0 },
+    { 0, 10 },
+    { 10, 0 },
+    { 10, 10 },
+    { 50, 0 },
+    { 50, 20 },
+};
+
+static char const* algorithm_names[] = { "newreno", "cubic" };
+
+static unsigned read_tunable(char const* name)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/sys/%s", name);
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        exit(1);
+    }
+    unsigned value = 0;
+    if (fscanf(file, "%u", &value) != 1) {
+        fprintf(stderr, "Couldn't parse %s\n", path);
+        exit(1);
+    }
+    fclose(file);
+    return value;
+}
+
+static void write_tunable(char const* name, unsigned value)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/sys/%s", name);
+    int fd = open(path, O_WRONLY);
+    if (fd < 0) {
+        perror(path);
+        exit(1);
+    }
+    char text[16];
+    int length = snprintf(text, sizeof(text), "%u", value);
+    if (write(fd, text, length) != length) {
+        perror(path);
+        exit(1);
+    }
+    close(fd);
+}
+
+static u8 pattern_byte(size_t offset)
+{
+    return static_cast<u8>((offset * 31) ^ (offset >> 12));
+}
+
+struct Transfer {
+    int fd { -1 };
+    size_t size { 0 };
+};
+
+static void* send_main(void* arg)
+{
+    auto& transfer = *static_cast<Transfer*>(arg);
+    auto* buffer = static_cast<u8*>(malloc(chunk_size));
+    if (!buffer) {
+        perror("malloc");
+        exit(1);
+    }
+    for (size_t offset = 0; offset < transfer.size;) {
+        size_t length = min(chunk_size, transfer.size - offset);
+        for (size_t i = 0; i < length; ++i)
+            buffer[i] = pattern_byte(offset + i);
+        for (size_t nwritten = 0; nwritten < length;) {
+            auto rc = write(transfer.fd, buffer + nwritten, length - nwritten);
+            if (rc < 0) {
+                perror("write");
+                exit(1);
+            }
+            nwritten += rc;
+        }
+        offset += length;
+    }
+    free(buffer);
+    close(transfer.fd);
+    return nullptr;
+}
+
+static void connect_loopback_pair(int& client_fd, int& server_fd)
+{
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        perror("socket");
+        exit(1);
+    }
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t address_size = sizeof(address);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+        || listen(listen_fd, 1) < 0
+        || getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &address_size) < 0) {
+        perror("bind/listen");
+        exit(1);
+    }
+
+    client_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (client_fd < 0 || connect(client_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        perror("connect");
+        exit(1);
+    }
+    server_fd = accept(listen_fd, nullptr, nullptr);
+    if (server_fd < 0) {
+        perror("accept");
+        exit(1);
+    }
+    close(listen_fd);
+}
+
+static double run_transfer(size_t size)
+{
+    Transfer transfer;
+    int server_fd = -1;
+    connect_loopback_pair(transfer.fd, server_fd);
+    transfer.size = size;
+
+    Core::ElapsedTimer timer { true };
+    timer.start();
+
+    pthread_t send_thread;
+    if (pthread_create(&send_thread, nullptr, send_main, &transfer) != 0) {
+        perror("pthread_create");
+        exit(1);
+    }
+
+    auto* buffer = static_cast<u8*>(malloc(chunk_size));
+    if (!buffer) {
+        perror("malloc");
+        exit(1);
+    }
+    size_t total = 0;
+    for (;;) {
+        auto nread = read(server_fd, buffer, chunk_size);
+        if (nread < 0) {
+            perror("read");
+            exit(1);
+        }
+        if (nread == 0)
+            break;
+        for (ssize_t i = 0; i < nread; ++i) {
+            if (buffer[i] != pattern_byte(total + i)) {
+                fprintf(stderr, "Data mismatch at offset %zu\n", total + i);
+                exit(1);
+            }
+        }
+        total += nread;
+    }
+    auto elapsed = timer.elapsed() / 1000.0;
+    free(buffer);
+    close(server_fd);
+    pthread_join(send_thread, nullptr);
+
+    if (total != size) {
+        fprintf(stderr, "Received %zu bytes, expected %zu\n", total, size);
+        exit(1);
+    }
+    return static_cast<double>(size) / elapsed / MiB;
+}
+
+int main(int argc, char** argv)
+{
+    int transfer_size_mib = 4;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure loopback TCP throughput under emulated delay and packet loss.");
+    args_parser.add_option(transfer_size_mib, "Amount of data to send in each transfer in MiB", "size", 's', "MiB");
+    args_parser.parse(argc, argv);
+
+    auto original_delay = read_tunable("loopback_delay_ms");
+    auto original_loss = read_tunable("loopback_loss_per_mille");
+    auto original_algorithm = read_tunable("tcp_congestion_control");
+
+    size_t transfer_size = static_cast<size_t>(transfer_size_mib) * MiB;
+
+    printf("%10s %10s %10s %10s\n", "delay(ms)", "loss/1000", "algorithm", "MiB/sec");
+    for (auto& conditions : link_conditions) {
+        for (unsigned algorithm = 0; algorithm < sizeof(algorithm_names) / sizeof(algorithm_names[0]); ++algorithm) {
+            // The conditions apply to the handshake as well, which has to survive loss too.
+            write_tunable("tcp_congestion_control", algorithm);
+            write_tunable("loopback_delay_ms", conditions.delay_ms);
+            write_tunable("loopback_loss_per_mille", conditions.loss_per_mille);
+            auto throughput = run_transfer(transfer_size);
+            write_tunable("loopback_delay_ms", 0);
+            write_tunable("loopback_loss_per_mille", 0);
+            printf("%10u %10u %10s %10.2f\n", conditions.delay_ms, conditions.loss_per_mille, algorithm_names[algorithm], throughput);
+        }
+    }
+
+    write_tunable("loopback_delay_ms", original_delay);
+    write_tunable("loopback_loss_per_mille", original_loss);
+    write_tunable("tcp_congestion_control", original_algorithm);
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <limits.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Measures the latency of operations that have to shoot down TLB entries on other processors:
+// unmapping and re-protecting memory that spans several regions, fork() and posix_spawn().
+// Each one is timed with a varying number of threads spinning in the same address space,
+// since those threads are what keeps the other processors using our page directory.
+
+static Atomic<bool> s_stop_spinning;
+
+static void* spin(void*)
+{
+    while (!s_stop_spinning.load(AK::MemoryOrder::memory_order_relaxed))
+        ;
+    return nullptr;
+}
+
+static u64 nanoseconds_since(timespec const& start)
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1'000'000'000ull + now.tv_nsec - start.tv_nsec;
+}
+
+// Maps and touches memory, then splits it into three regions so that unmapping it as a whole has to deal with several.
+static u8* map_touched_regions(size_t size)
+{
+    auto* memory = static_cast<u8*>(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0));
+    if (memory == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+    memset(memory, 1, size);
+    if (mprotect(memory + size / 2, PAGE_SIZE, PROT_READ) < 0) {
+        perror("mprotect");
+        exit(1);
+    }
+    return memory;
+}
+
+static u64 time_munmap(size_t size)
+{
+    auto* memory = map_touched_regions(size);
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (munmap(memory, size) < 0) {
+        perror("munmap");
+        exit(1);
+    }
+    return nanoseconds_since(start);
+}
+
+static u64 time_mprotect(size_t size)
+{
+    auto* memory = map_touched_regions(size);
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (mprotect(memory, size, PROT_READ) < 0) {
+        perror("mprotect");
+        exit(1);
+    }
+    auto elapsed = nanoseconds_since(start);
+    munmap(memory, size);
+    return elapsed;
+}
+
+static u64 time_fork()
+{
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0)
+        _exit(0);
+    if (waitpid(pid, nullptr, 0) < 0) {
+        perror("waitpid");
+        exit(1);
+    }
+    return nanoseconds_since(start);
+}
+
+static u64 time_spawn()
+{
+    char const* argv[] = { "/bin/true", nullptr };
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid_t pid;
+    if (int rc = posix_spawn(&pid, argv[0], nullptr, nullptr, const_cast<char**>(argv), environ); rc != 0) {
+        fprintf(stderr, "posix_spawn: %s\n", strerror(rc));
+        exit(1);
+    }
+    if (waitpid(pid, nullptr, 0) < 0) {
+        perror("waitpid");
+        exit(1);
+    }
+    return nanoseconds_since(start);
+}
+
+static void run(int thread_count, int iterations, size_t size)
+{
+    s_stop_spinning = false;
+    Vector<pthread_t> threads;
+    for (int i = 0; i < thread_count; ++i) {
+        pthread_t thread;
+        if (int rc = pthread_create(&thread, nullptr, spin, nullptr); rc != 0) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(rc));
+            exit(1);
+        }
+        threads.append(thread);
+    }
+
+    u64 munmap_total = 0;
+    u64 mprotect_total = 0;
+    u64 fork_total = 0;
+    u64 spawn_total = 0;
+    for (int i = 0; i < iterations; ++i) {
+        munmap_total += time_munmap(size);
+        mprotect_total += time_mprotect(size);
+        fork_total += time_fork();
+        spawn_total += time_spawn();
+    }
+
+    s_stop_spinning = true;
+    for (auto thread : threads)
+        pthread_join(thread, nullptr);
+
+    printf("%8d %12llu %12llu %12llu %12llu\n", thread_count,
+        static_cast<unsigned long long>(munmap_total / iterations / 1000),
+        static_cast<unsigned long long>(mprotect_total / iterations / 1000),
+        static_cast<unsigned long long>(fork_total / iterations / 1000),
+        static_cast<unsigned long long>(spawn_total / iterations / 1000));
+}
+
+int main(int argc, char** argv)
+{
+    int max_threads = 4;
+    int iterations = 100;
+    int size_kib = 1024;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure the latency of munmap, mprotect, fork and posix_spawn while other threads are running.");
+    args_parser.add_option(max_threads, "Largest number of spinning threads", "threads", 't', "count");
+    args_parser.add_option(iterations, "Number of iterations for each measurement", "iterations", 'i', "count");
+    args_parser.add_option(size_kib, "Size of the mappings in KiB", "size", 's', "KiB");
+    args_parser.parse(argc, argv);
+
+    if (iterations < 1 || max_threads < 0 || size_kib < 16) {
+        fprintf(stderr, "Invalid arguments\n");
+        return 1;
+    }
+
+    size_t size = static_cast<size_t>(size_kib) * KiB;
+    printf("%8s %12s %12s %12s %12s\n", "threads", "munmap us", "mprotect us", "fork us", "spawn us");
+    for (int thread_count = 0; thread_count <= max_threads; thread_count = thread_count ? thread_count * 2 : 1)
+        run(thread_count, iterations, size);
+    return 0;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Format.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/Timer.h>
+#include <LibTest/TestCase.h>
+#include <unistd.h>
+
+TEST_CASE(read_notifier_fires_when_writer_closes)
+{
+    Core::EventLoop event_loop;
+    auto reaper = Core::Timer::create_single_shot(1000, [] {
+        warnln("The read notifier never saw the pipe's writer go away!");
+        VERIFY_NOT_REACHED();
+    });
+    reaper->start();
+
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+
+    auto notifier = Core::Notifier::construct(fds[0], Core::Notifier::Event::Read);
+    bool saw_eof = false;
+    notifier->on_ready_to_read = [&] {
+        char byte = 0;
+        EXPECT_EQ(read(fds[0], &byte, 1), 0);
+        saw_eof = true;
+        notifier->set_enabled(false);
+        event_loop.quit(0);
+    };
+
+    close(fds[1]);
+    event_loop.exec();
+
+    EXPECT(saw_eof);
+    close(fds[0]);
+}
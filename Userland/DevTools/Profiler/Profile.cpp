@@ -15,10 +15,12 @@
 #include <AK/QuickSort.h>
 #include <AK/RefPtr.h>
 #include <AK/Try.h>
-#include <LibCore/File.h>
+#include <Kernel/API/Perfcore.h>
 #include <LibCore/MappedFile.h>
+#include <LibCore/Stream.h>
 #include <LibELF/Image.h>
 #include <LibSymbolication/Symbolication.h>
+#include <serenity.h>
 #include <sys/stat.h>
 
 namespace Profiler {
@@ -41,6 +43,10 @@ Profile::Profile(Vector<Process> processes, Vector<Event> events)
     for (size_t i = 0; i < m_events.size(); ++i) {
         if (m_events[i].data.has<Event::SignpostData>())
             m_signpost_indices.append(i);
+        else if (m_events[i].data.has<Event::PerformanceCounterData>())
+            m_has_performance_counter_events = true;
+        else if (m_events[i].data.has<Event::OffCpuData>())
+            m_has_off_cpu_events = true;
     }
 
     m_first_timestamp = m_events.first().timestamp;
@@ -102,6 +108,7 @@ void Profile::rebuild_tree()
     });
 
     m_filtered_event_indices.clear();
+    m_filtered_event_weight = 0;
     m_filtered_signpost_indices.clear();
     m_file_event_nodes->children().clear();
 
@@ -122,7 +129,40 @@ void Profile::rebuild_tree()
             continue;
         }
 
-        m_filtered_event_indices.append(event_index);
+        if (event.data.has<Event::ReadData>()) {
+            auto const& read_event = event.data.get<Event::ReadData>();
+            auto& event_node = m_file_event_nodes->find_or_create_node(read_event.path);
+
+            event_node.for_each_parent_node([&](FileEventNode& node) {
+                node.increment_count();
+
+                // Fixme: Currently events record 'timestamp' and 'start_timestamp' in ms resolution,
+                //        which results in most durations equal to zero. Increasing the resolution should
+                //        make the information more accurate.
+                auto const duration = event.timestamp - read_event.start_timestamp;
+                node.add_to_duration(duration);
+            });
+        }
+
+        // Off-CPU events make up the whole tree in off-CPU mode, and are left out otherwise.
+        auto const* off_cpu_data = event.data.get_pointer<Event::OffCpuData>();
+        if (m_show_off_cpu_time != (off_cpu_data != nullptr))
+            continue;
+        u64 weight = off_cpu_data ? off_cpu_data->duration_us : 1;
+
+        // Hardware counter samples don't count as samples, they only add to the counter totals of the nodes they land in.
+        auto const* counter_data = event.data.get_pointer<Event::PerformanceCounterData>();
+        if (!counter_data) {
+            m_filtered_event_indices.append(event_index);
+            m_filtered_event_weight += weight;
+        }
+
+        auto add_event_to_node = [&](ProfileNode& node) {
+            if (counter_data)
+                node.add_performance_counter_sample(counter_data->counter, counter_data->period);
+            else
+                node.increment_event_count(weight);
+        };
 
         if (auto* malloc_data = event.data.get_pointer<Event::MallocData>(); malloc_data && !live_allocations.contains(malloc_data->ptr))
             continue;
@@ -147,7 +187,7 @@ void Profile::rebuild_tree()
         if (!m_show_top_functions) {
             ProfileNode* node = nullptr;
             auto& process_node = find_or_create_process_node(event.pid, event.serial);
-            process_node.increment_event_count();
+            add_event_to_node(process_node);
             for_each_frame([&](Frame const& frame, bool is_innermost_frame) {
                 auto const& object_name = frame.object_name;
                 auto const& symbol = frame.symbol;
@@ -162,16 +202,16 @@ void Profile::rebuild_tree()
                     node = &process_node;
                 node = &node->find_or_create_child(object_name, symbol, address, offset, event.timestamp, event.pid);
 
-                node->increment_event_count();
-                if (is_innermost_frame) {
-                    node->add_event_address(address);
-                    node->increment_self_count();
+                add_event_to_node(*node);
+                if (is_innermost_frame && !counter_data) {
+                    node->add_event_address(address, weight);
+                    node->increment_self_count(weight);
                 }
                 return IterationDecision::Continue;
             });
         } else {
             auto& process_node = find_or_create_process_node(event.pid, event.serial);
-            process_node.increment_event_count();
+            add_event_to_node(process_node);
             for (size_t i = 0; i < event.frames.size(); ++i) {
                 ProfileNode* node = nullptr;
                 ProfileNode* root = nullptr;
@@ -196,33 +236,18 @@ void Profile::rebuild_tree()
 
                     if (!root->has_seen_event(event_index)) {
                         root->did_see_event(event_index);
-                        root->increment_event_count();
+                        add_event_to_node(*root);
                     } else if (node != root) {
-                        node->increment_event_count();
+                        add_event_to_node(*node);
                     }
 
-                    if (j == event.frames.size() - 1) {
-                        node->add_event_address(address);
-                        node->increment_self_count();
+                    if (j == event.frames.size() - 1 && !counter_data) {
+                        node->add_event_address(address, weight);
+                        node->increment_self_count(weight);
                     }
                 }
             }
         }
-
-        if (event.data.has<Event::ReadData>()) {
-            auto const& read_event = event.data.get<Event::ReadData>();
-            auto& event_node = m_file_event_nodes->find_or_create_node(read_event.path);
-
-            event_node.for_each_parent_node([&](FileEventNode& node) {
-                node.increment_count();
-
-                // Fixme: Currently events record 'timestamp' and 'start_timestamp' in ms resolution,
-                //        which results in most durations equal to zero. Increasing the resolution should
-                //        make the information more accurate.
-                auto const duration = event.timestamp - read_event.start_timestamp;
-                node.add_to_duration(duration);
-            });
-        }
     }
 
     sort_profile_nodes(roots);
@@ -234,25 +259,42 @@ void Profile::rebuild_tree()
 Optional<MappedObject> g_kernel_debuginfo_object;
 OwnPtr<Debug::DebugInfo> g_kernel_debug_info;
 
-ErrorOr<NonnullOwnPtr<Profile>> Profile::load_from_perfcore_file(StringView path)
-{
-    auto file = TRY(Core::File::open(path, Core::OpenMode::ReadOnly));
+// Turns perf events into profile events, regardless of the format they were stored in.
+class PerfcoreLoader {
+public:
+    ErrorOr<void> load_json(ReadonlyBytes);
+    ErrorOr<void> load_binary(Core::Stream::Stream&);
+
+    ErrorOr<NonnullOwnPtr<Profile>> create_profile();
+
+private:
+    ErrorOr<void> handle_record(Perfcore::RecordType, ReadonlyBytes);
+    ErrorOr<void> handle_event_record(ReadonlyBytes);
+    void handle_event(int type, Profile::Event, Span<FlatPtr const> stack, Optional<u32> stack_id = {});
+    Vector<Profile::Frame> symbolicate(pid_t, Span<FlatPtr const> stack);
+
+    NonnullOwnPtrVector<Process> m_all_processes;
+    HashMap<pid_t, Process*> m_current_processes;
+    Vector<Profile::Event> m_events;
+    EventSerialNumber m_next_serial;
 
-    auto json = JsonValue::from_string(file->read_all());
+    // Only used by the binary format, where strings and stacks are sent once and then referred to by id.
+    HashMap<u32, String> m_strings;
+    HashMap<u32, Vector<FlatPtr>> m_stacks;
+
+    // Symbolicated stacks by stack id and pid. Mapping new code may change the result, so this
+    // is cleared whenever that happens.
+    HashMap<u64, Vector<Profile::Frame>> m_symbolicated_stacks;
+};
+
+ErrorOr<void> PerfcoreLoader::load_json(ReadonlyBytes bytes)
+{
+    auto json = JsonValue::from_string(StringView { bytes });
     if (json.is_error() || !json.value().is_object())
         return Error::from_string_literal("Invalid perfcore format (not a JSON object)");
 
     auto const& object = json.value().as_object();
 
-    if (!g_kernel_debuginfo_object.has_value()) {
-        auto debuginfo_file_or_error = Core::MappedFile::map("/boot/Kernel.debug"sv);
-        if (!debuginfo_file_or_error.is_error()) {
-            auto debuginfo_file = debuginfo_file_or_error.release_value();
-            auto debuginfo_image = ELF::Image(debuginfo_file->bytes());
-            g_kernel_debuginfo_object = { { debuginfo_file, move(debuginfo_image) } };
-        }
-    }
-
     auto const* strings_value = object.get_ptr("strings"sv);
     if (!strings_value || !strings_value->is_array())
         return Error::from_string_literal("Malformed profile (strings is not an array)");
@@ -269,127 +311,76 @@ ErrorOr<NonnullOwnPtr<Profile>> Profile::load_from_perfcore_file(StringView path
 
     auto const& perf_events = events_value->as_array();
 
-    NonnullOwnPtrVector<Process> all_processes;
-    HashMap<pid_t, Process*> current_processes;
-    Vector<Event> events;
-    EventSerialNumber next_serial;
-
     for (auto const& perf_event_value : perf_events.values()) {
         auto const& perf_event = perf_event_value.as_object();
 
-        Event event;
-
-        event.serial = next_serial;
-        next_serial.increment();
+        Profile::Event event;
         event.timestamp = perf_event.get("timestamp"sv).to_number<u64>();
         event.lost_samples = perf_event.get("lost_samples"sv).to_number<u32>();
         event.pid = perf_event.get("pid"sv).to_i32();
         event.tid = perf_event.get("tid"sv).to_i32();
 
         auto type_string = perf_event.get("type"sv).to_string();
+        int type = 0;
 
         if (type_string == "sample"sv) {
-            event.data = Event::SampleData {};
+            type = PERF_EVENT_SAMPLE;
+            event.data = Profile::Event::SampleData {};
         } else if (type_string == "malloc"sv) {
-            event.data = Event::MallocData {
+            type = PERF_EVENT_MALLOC;
+            event.data = Profile::Event::MallocData {
                 .ptr = perf_event.get("ptr"sv).to_number<FlatPtr>(),
                 .size = perf_event.get("size"sv).to_number<size_t>(),
             };
         } else if (type_string == "free"sv) {
-            event.data = Event::FreeData {
+            type = PERF_EVENT_FREE;
+            event.data = Profile::Event::FreeData {
                 .ptr = perf_event.get("ptr"sv).to_number<FlatPtr>(),
             };
         } else if (type_string == "signpost"sv) {
+            type = PERF_EVENT_SIGNPOST;
             auto string_id = perf_event.get("arg1"sv).to_number<FlatPtr>();
-            event.data = Event::SignpostData {
+            event.data = Profile::Event::SignpostData {
                 .string = profile_strings.get(string_id).value_or(String::formatted("Signpost #{}", string_id)),
                 .arg = perf_event.get("arg2"sv).to_number<FlatPtr>(),
             };
         } else if (type_string == "mmap"sv) {
-            auto ptr = perf_event.get("ptr"sv).to_number<FlatPtr>();
-            auto size = perf_event.get("size"sv).to_number<size_t>();
-            auto name = perf_event.get("name"sv).to_string();
-
-            event.data = Event::MmapData {
-                .ptr = ptr,
-                .size = size,
-                .name = name,
+            type = PERF_EVENT_MMAP;
+            event.data = Profile::Event::MmapData {
+                .ptr = perf_event.get("ptr"sv).to_number<FlatPtr>(),
+                .size = perf_event.get("size"sv).to_number<size_t>(),
+                .name = perf_event.get("name"sv).to_string(),
             };
-
-            auto it = current_processes.find(event.pid);
-            if (it != current_processes.end())
-                it->value->library_metadata.handle_mmap(ptr, size, name);
-            continue;
         } else if (type_string == "munmap"sv) {
-            event.data = Event::MunmapData {
+            type = PERF_EVENT_MUNMAP;
+            event.data = Profile::Event::MunmapData {
                 .ptr = perf_event.get("ptr"sv).to_number<FlatPtr>(),
                 .size = perf_event.get("size"sv).to_number<size_t>(),
             };
-            continue;
         } else if (type_string == "process_create"sv) {
-            auto parent_pid = perf_event.get("parent_pid"sv).to_number<pid_t>();
-            auto executable = perf_event.get("executable"sv).to_string();
-            event.data = Event::ProcessCreateData {
-                .parent_pid = parent_pid,
-                .executable = executable,
+            type = PERF_EVENT_PROCESS_CREATE;
+            event.data = Profile::Event::ProcessCreateData {
+                .parent_pid = perf_event.get("parent_pid"sv).to_number<pid_t>(),
+                .executable = perf_event.get("executable"sv).to_string(),
             };
-
-            auto sampled_process = adopt_own(*new Process {
-                .pid = event.pid,
-                .executable = executable,
-                .basename = LexicalPath::basename(executable),
-                .start_valid = event.serial,
-                .end_valid = {},
-            });
-
-            current_processes.set(sampled_process->pid, sampled_process);
-            all_processes.append(move(sampled_process));
-            continue;
         } else if (type_string == "process_exec"sv) {
-            auto executable = perf_event.get("executable"sv).to_string();
-            event.data = Event::ProcessExecData {
-                .executable = executable,
+            type = PERF_EVENT_PROCESS_EXEC;
+            event.data = Profile::Event::ProcessExecData {
+                .executable = perf_event.get("executable"sv).to_string(),
             };
-
-            auto* old_process = current_processes.get(event.pid).value();
-            old_process->end_valid = event.serial;
-
-            current_processes.remove(event.pid);
-
-            auto sampled_process = adopt_own(*new Process {
-                .pid = event.pid,
-                .executable = executable,
-                .basename = LexicalPath::basename(executable),
-                .start_valid = event.serial,
-                .end_valid = {},
-            });
-
-            current_processes.set(sampled_process->pid, sampled_process);
-            all_processes.append(move(sampled_process));
-            continue;
         } else if (type_string == "process_exit"sv) {
-            auto* old_process = current_processes.get(event.pid).value();
-            old_process->end_valid = event.serial;
-
-            current_processes.remove(event.pid);
-            continue;
+            type = PERF_EVENT_PROCESS_EXIT;
         } else if (type_string == "thread_create"sv) {
-            auto parent_tid = perf_event.get("parent_tid"sv).to_number<pid_t>();
-            event.data = Event::ThreadCreateData {
-                .parent_tid = parent_tid,
+            type = PERF_EVENT_THREAD_CREATE;
+            event.data = Profile::Event::ThreadCreateData {
+                .parent_tid = perf_event.get("parent_tid"sv).to_number<pid_t>(),
             };
-            auto it = current_processes.find(event.pid);
-            if (it != current_processes.end())
-                it->value->handle_thread_create(event.tid, event.serial);
-            continue;
         } else if (type_string == "thread_exit"sv) {
-            auto it = current_processes.find(event.pid);
-            if (it != current_processes.end())
-                it->value->handle_thread_exit(event.tid, event.serial);
-            continue;
+            type = PERF_EVENT_THREAD_EXIT;
         } else if (type_string == "read"sv) {
+            type = PERF_EVENT_READ;
             auto const string_index = perf_event.get("filename_index"sv).to_number<FlatPtr>();
-            event.data = Event::ReadData {
+            event.data = Profile::Event::ReadData {
                 .fd = perf_event.get("fd"sv).to_number<int>(),
                 .size = perf_event.get("size"sv).to_number<size_t>(),
                 .path = profile_strings.get(string_index).value(),
@@ -401,54 +392,346 @@ ErrorOr<NonnullOwnPtr<Profile>> Profile::load_from_perfcore_file(StringView path
             VERIFY_NOT_REACHED();
         }
 
-        auto maybe_kernel_base = Symbolication::kernel_base();
-
-        auto const* stack = perf_event.get_ptr("stack"sv);
-        VERIFY(stack);
-        auto const& stack_array = stack->as_array();
-        for (ssize_t i = stack_array.values().size() - 1; i >= 0; --i) {
-            auto const& frame = stack_array.at(i);
-            auto ptr = frame.to_number<u64>();
-            u32 offset = 0;
-            FlyString object_name;
-            String symbol;
-
-            if (maybe_kernel_base.has_value() && ptr >= maybe_kernel_base.value()) {
-                if (g_kernel_debuginfo_object.has_value()) {
-                    symbol = g_kernel_debuginfo_object->elf.symbolicate(ptr - maybe_kernel_base.value(), &offset);
-                } else {
-                    symbol = String::formatted("?? <{:p}>", ptr);
-                }
-            } else {
-                auto it = current_processes.find(event.pid);
-                // FIXME: This logic is kinda gnarly, find a way to clean it up.
-                LibraryMetadata* library_metadata {};
-                if (it != current_processes.end())
-                    library_metadata = &it->value->library_metadata;
-                if (auto const* library = library_metadata ? library_metadata->library_containing(ptr) : nullptr) {
-                    object_name = library->name;
-                    symbol = library->symbolicate(ptr, &offset);
-                } else {
-                    symbol = String::formatted("?? <{:p}>", ptr);
-                }
-            }
+        Vector<FlatPtr> stack;
+        if (auto const* stack_value = perf_event.get_ptr("stack"sv)) {
+            for (auto const& frame : stack_value->as_array().values())
+                stack.append(frame.to_number<u64>());
+        }
+        handle_event(type, move(event), stack);
+    }
+    return {};
+}
 
-            event.frames.append({ object_name, symbol, (FlatPtr)ptr, offset });
+ErrorOr<void> PerfcoreLoader::load_binary(Core::Stream::Stream& stream)
+{
+    // The file may still be growing while we read it, so records are parsed as they come in,
+    // and a partial record at the end is left alone.
+    auto read_buffer = TRY(ByteBuffer::create_uninitialized(64 * KiB));
+    ByteBuffer pending;
+    while (true) {
+        auto bytes_read = TRY(stream.read(read_buffer));
+        if (bytes_read.is_empty())
+            break;
+        TRY(pending.try_append(bytes_read.data(), bytes_read.size()));
+
+        size_t offset = 0;
+        while (pending.size() - offset >= sizeof(Perfcore::RecordHeader)) {
+            Perfcore::RecordHeader header;
+            memcpy(&header, pending.data() + offset, sizeof(header));
+            if (pending.size() - offset - sizeof(header) < header.length)
+                break;
+            TRY(handle_record(header.type, pending.bytes().slice(offset + sizeof(header), header.length)));
+            offset += sizeof(header) + header.length;
         }
+        if (offset > 0)
+            pending = TRY(pending.slice(offset, pending.size() - offset));
+    }
+    if (!pending.is_empty())
+        dbgln("Ignoring {} bytes of an incomplete perfcore record", pending.size());
+    return {};
+}
 
-        if (event.frames.size() < 2)
-            continue;
+template<typename T>
+static ErrorOr<T> read_struct(ReadonlyBytes bytes, size_t offset = 0)
+{
+    if (offset > bytes.size() || bytes.size() - offset < sizeof(T))
+        return Error::from_string_literal("Malformed profile (record is too short)");
+    T value;
+    memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+ErrorOr<void> PerfcoreLoader::handle_record(Perfcore::RecordType type, ReadonlyBytes bytes)
+{
+    switch (type) {
+    case Perfcore::RecordType::String: {
+        auto record = TRY(read_struct<Perfcore::StringRecord>(bytes));
+        if (bytes.size() - sizeof(record) < record.length)
+            return Error::from_string_literal("Malformed profile (string is too long)");
+        m_strings.set(record.id, String { bytes.slice(sizeof(record), record.length) });
+        return {};
+    }
+    case Perfcore::RecordType::Stack: {
+        auto record = TRY(read_struct<Perfcore::StackRecord>(bytes));
+        if ((bytes.size() - sizeof(record)) / sizeof(u64) < record.frame_count)
+            return Error::from_string_literal("Malformed profile (stack is too long)");
+        Vector<FlatPtr> stack;
+        TRY(stack.try_ensure_capacity(record.frame_count));
+        for (size_t i = 0; i < record.frame_count; ++i)
+            stack.unchecked_append(TRY(read_struct<u64>(bytes, sizeof(record) + i * sizeof(u64))));
+        m_stacks.set(record.id, move(stack));
+        return {};
+    }
+    case Perfcore::RecordType::Event:
+        return handle_event_record(bytes);
+    }
+    // Records from a newer version of the format can be skipped.
+    return {};
+}
+
+static PerformanceCounter performance_counter_for_event_type(u32 type)
+{
+    switch (type) {
+    case PERF_EVENT_CPU_CYCLES:
+        return PerformanceCounter::Cycles;
+    case PERF_EVENT_INSTRUCTIONS:
+        return PerformanceCounter::Instructions;
+    case PERF_EVENT_CACHE_MISSES:
+        return PerformanceCounter::CacheMisses;
+    case PERF_EVENT_BRANCH_MISSES:
+        return PerformanceCounter::BranchMisses;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
 
-        FlatPtr innermost_frame_address = event.frames.at(1).address;
-        event.in_kernel = maybe_kernel_base.has_value() && innermost_frame_address >= maybe_kernel_base.value();
+ErrorOr<void> PerfcoreLoader::handle_event_record(ReadonlyBytes bytes)
+{
+    auto record = TRY(read_struct<Perfcore::EventRecord>(bytes));
+    auto payload = bytes.slice(sizeof(record));
+    auto string = [&](u32 id) {
+        return m_strings.get(id).value_or({});
+    };
 
-        events.append(move(event));
+    Profile::Event event;
+    event.timestamp = record.timestamp;
+    event.lost_samples = record.lost_samples;
+    event.pid = record.pid;
+    event.tid = record.tid;
+
+    switch (record.type) {
+    case PERF_EVENT_SAMPLE:
+        event.data = Profile::Event::SampleData {};
+        break;
+    case PERF_EVENT_MALLOC: {
+        auto data = TRY(read_struct<Perfcore::AllocationPayload>(payload));
+        event.data = Profile::Event::MallocData { .ptr = static_cast<FlatPtr>(data.ptr), .size = static_cast<size_t>(data.size) };
+        break;
+    }
+    case PERF_EVENT_FREE: {
+        auto data = TRY(read_struct<Perfcore::AllocationPayload>(payload));
+        event.data = Profile::Event::FreeData { .ptr = static_cast<FlatPtr>(data.ptr) };
+        break;
+    }
+    case PERF_EVENT_SIGNPOST: {
+        auto data = TRY(read_struct<Perfcore::SignpostPayload>(payload));
+        event.data = Profile::Event::SignpostData {
+            .string = data.string_id != Perfcore::invalid_id ? string(data.string_id) : String::formatted("Signpost #{}", data.arg1),
+            .arg = static_cast<FlatPtr>(data.arg2),
+        };
+        break;
+    }
+    case PERF_EVENT_MMAP: {
+        auto data = TRY(read_struct<Perfcore::MmapPayload>(payload));
+        event.data = Profile::Event::MmapData { .ptr = static_cast<FlatPtr>(data.ptr), .size = static_cast<size_t>(data.size), .name = string(data.name_id) };
+        break;
+    }
+    case PERF_EVENT_MUNMAP: {
+        auto data = TRY(read_struct<Perfcore::AllocationPayload>(payload));
+        event.data = Profile::Event::MunmapData { .ptr = static_cast<FlatPtr>(data.ptr), .size = static_cast<size_t>(data.size) };
+        break;
+    }
+    case PERF_EVENT_PROCESS_CREATE: {
+        auto data = TRY(read_struct<Perfcore::ProcessCreatePayload>(payload));
+        event.data = Profile::Event::ProcessCreateData { .parent_pid = data.parent_pid, .executable = string(data.executable_id) };
+        break;
+    }
+    case PERF_EVENT_PROCESS_EXEC: {
+        auto data = TRY(read_struct<Perfcore::ProcessExecPayload>(payload));
+        event.data = Profile::Event::ProcessExecData { .executable = string(data.executable_id) };
+        break;
+    }
+    case PERF_EVENT_PROCESS_EXIT:
+    case PERF_EVENT_THREAD_EXIT:
+        break;
+    case PERF_EVENT_THREAD_CREATE: {
+        auto data = TRY(read_struct<Perfcore::ThreadCreatePayload>(payload));
+        event.data = Profile::Event::ThreadCreateData { .parent_tid = data.parent_tid };
+        break;
+    }
+    case PERF_EVENT_CPU_CYCLES:
+    case PERF_EVENT_INSTRUCTIONS:
+    case PERF_EVENT_CACHE_MISSES:
+    case PERF_EVENT_BRANCH_MISSES: {
+        auto data = TRY(read_struct<Perfcore::PerformanceCounterPayload>(payload));
+        event.data = Profile::Event::PerformanceCounterData { .counter = performance_counter_for_event_type(record.type), .period = data.period };
+        break;
+    }
+    case PERF_EVENT_OFF_CPU: {
+        auto data = TRY(read_struct<Perfcore::OffCpuPayload>(payload));
+        event.data = Profile::Event::OffCpuData { .reason = string(data.reason_id), .duration_us = data.duration_us };
+        break;
+    }
+    case PERF_EVENT_READ: {
+        auto data = TRY(read_struct<Perfcore::ReadPayload>(payload));
+        event.data = Profile::Event::ReadData {
+            .fd = data.fd,
+            .size = static_cast<size_t>(data.size),
+            .path = string(data.path_id),
+            .start_timestamp = static_cast<size_t>(data.start_timestamp),
+            .success = data.success != 0,
+        };
+        break;
+    }
+    default:
+        // Event types that the profiler doesn't show (context switches, kmalloc, ...) are skipped.
+        return {};
     }
 
-    if (events.is_empty())
+    Optional<u32> stack_id;
+    Span<FlatPtr const> stack;
+    if (record.stack_id != Perfcore::invalid_id) {
+        auto it = m_stacks.find(record.stack_id);
+        if (it == m_stacks.end())
+            return Error::from_string_literal("Malformed profile (event refers to an unknown stack)");
+        stack_id = static_cast<u32>(record.stack_id);
+        stack = it->value.span();
+    }
+    handle_event(record.type, move(event), stack, stack_id);
+    return {};
+}
+
+void PerfcoreLoader::handle_event(int type, Profile::Event event, Span<FlatPtr const> stack, Optional<u32> stack_id)
+{
+    event.serial = m_next_serial;
+    m_next_serial.increment();
+
+    switch (type) {
+    case PERF_EVENT_MMAP: {
+        auto const& data = event.data.get<Profile::Event::MmapData>();
+        auto it = m_current_processes.find(event.pid);
+        if (it != m_current_processes.end())
+            it->value->library_metadata.handle_mmap(data.ptr, data.size, data.name);
+        m_symbolicated_stacks.clear();
+        return;
+    }
+    case PERF_EVENT_MUNMAP:
+        return;
+    case PERF_EVENT_PROCESS_CREATE: {
+        auto const& executable = event.data.get<Profile::Event::ProcessCreateData>().executable;
+        auto sampled_process = adopt_own(*new Process {
+            .pid = event.pid,
+            .executable = executable,
+            .basename = LexicalPath::basename(executable),
+            .start_valid = event.serial,
+            .end_valid = {},
+        });
+
+        m_current_processes.set(sampled_process->pid, sampled_process);
+        m_all_processes.append(move(sampled_process));
+        m_symbolicated_stacks.clear();
+        return;
+    }
+    case PERF_EVENT_PROCESS_EXEC: {
+        auto const& executable = event.data.get<Profile::Event::ProcessExecData>().executable;
+        auto* old_process = m_current_processes.get(event.pid).value();
+        old_process->end_valid = event.serial;
+
+        m_current_processes.remove(event.pid);
+
+        auto sampled_process = adopt_own(*new Process {
+            .pid = event.pid,
+            .executable = executable,
+            .basename = LexicalPath::basename(executable),
+            .start_valid = event.serial,
+            .end_valid = {},
+        });
+
+        m_current_processes.set(sampled_process->pid, sampled_process);
+        m_all_processes.append(move(sampled_process));
+        m_symbolicated_stacks.clear();
+        return;
+    }
+    case PERF_EVENT_PROCESS_EXIT: {
+        auto* old_process = m_current_processes.get(event.pid).value();
+        old_process->end_valid = event.serial;
+
+        m_current_processes.remove(event.pid);
+        return;
+    }
+    case PERF_EVENT_THREAD_CREATE: {
+        auto it = m_current_processes.find(event.pid);
+        if (it != m_current_processes.end())
+            it->value->handle_thread_create(event.tid, event.serial);
+        return;
+    }
+    case PERF_EVENT_THREAD_EXIT: {
+        auto it = m_current_processes.find(event.pid);
+        if (it != m_current_processes.end())
+            it->value->handle_thread_exit(event.tid, event.serial);
+        return;
+    }
+    default:
+        break;
+    }
+
+    if (stack_id.has_value()) {
+        u64 key = (static_cast<u64>(stack_id.value()) << 32) | static_cast<u32>(event.pid);
+        if (auto it = m_symbolicated_stacks.find(key); it != m_symbolicated_stacks.end()) {
+            event.frames = it->value;
+        } else {
+            event.frames = symbolicate(event.pid, stack);
+            m_symbolicated_stacks.set(key, event.frames);
+        }
+    } else {
+        event.frames = symbolicate(event.pid, stack);
+    }
+
+    if (event.frames.size() < 2)
+        return;
+
+    auto maybe_kernel_base = Symbolication::kernel_base();
+    FlatPtr innermost_frame_address = event.frames.at(1).address;
+    event.in_kernel = maybe_kernel_base.has_value() && innermost_frame_address >= maybe_kernel_base.value();
+
+    if (auto const* off_cpu_data = event.data.get_pointer<Profile::Event::OffCpuData>())
+        event.frames.append({ {}, String::formatted("[{}]", off_cpu_data->reason), 0, 0 });
+
+    m_events.append(move(event));
+}
+
+Vector<Profile::Frame> PerfcoreLoader::symbolicate(pid_t pid, Span<FlatPtr const> stack)
+{
+    auto maybe_kernel_base = Symbolication::kernel_base();
+
+    Vector<Profile::Frame> frames;
+    for (ssize_t i = stack.size() - 1; i >= 0; --i) {
+        auto ptr = stack[i];
+        u32 offset = 0;
+        FlyString object_name;
+        String symbol;
+
+        if (maybe_kernel_base.has_value() && ptr >= maybe_kernel_base.value()) {
+            if (g_kernel_debuginfo_object.has_value()) {
+                symbol = g_kernel_debuginfo_object->elf.symbolicate(ptr - maybe_kernel_base.value(), &offset);
+            } else {
+                symbol = String::formatted("?? <{:p}>", ptr);
+            }
+        } else {
+            auto it = m_current_processes.find(pid);
+            // FIXME: This logic is kinda gnarly, find a way to clean it up.
+            LibraryMetadata* library_metadata {};
+            if (it != m_current_processes.end())
+                library_metadata = &it->value->library_metadata;
+            if (auto const* library = library_metadata ? library_metadata->library_containing(ptr) : nullptr) {
+                object_name = library->name;
+                symbol = library->symbolicate(ptr, &offset);
+            } else {
+                symbol = String::formatted("?? <{:p}>", ptr);
+            }
+        }
+
+        frames.append({ object_name, symbol, ptr, offset });
+    }
+    return frames;
+}
+
+ErrorOr<NonnullOwnPtr<Profile>> PerfcoreLoader::create_profile()
+{
+    if (m_events.is_empty())
         return Error::from_string_literal("No events captured (targeted process was never on CPU)");
 
-    quick_sort(all_processes, [](auto& a, auto& b) {
+    quick_sort(m_all_processes, [](auto& a, auto& b) {
         if (a.pid == b.pid)
             return a.start_valid < b.start_valid;
 
@@ -456,12 +739,45 @@ ErrorOr<NonnullOwnPtr<Profile>> Profile::load_from_perfcore_file(StringView path
     });
 
     Vector<Process> processes;
-    for (auto& it : all_processes)
+    for (auto& it : m_all_processes)
         processes.append(move(it));
 
+    return Profile::create(move(processes), move(m_events));
+}
+
+ErrorOr<NonnullOwnPtr<Profile>> Profile::create(Vector<Process> processes, Vector<Event> events)
+{
     return adopt_nonnull_own_or_enomem(new (nothrow) Profile(move(processes), move(events)));
 }
 
+ErrorOr<NonnullOwnPtr<Profile>> Profile::load_from_perfcore_file(StringView path)
+{
+    auto file = TRY(Core::Stream::File::open(path, Core::Stream::OpenMode::Read));
+
+    if (!g_kernel_debuginfo_object.has_value()) {
+        auto debuginfo_file_or_error = Core::MappedFile::map("/boot/Kernel.debug"sv);
+        if (!debuginfo_file_or_error.is_error()) {
+            auto debuginfo_file = debuginfo_file_or_error.release_value();
+            auto debuginfo_image = ELF::Image(debuginfo_file->bytes());
+            g_kernel_debuginfo_object = { { debuginfo_file, move(debuginfo_image) } };
+        }
+    }
+
+    // The kernel writes the binary format, profiles from UserspaceEmulator are still JSON.
+    PerfcoreLoader loader;
+    Perfcore::FileHeader header;
+    if (file->read_or_error({ &header, sizeof(header) }) && header.magic == Perfcore::magic) {
+        if (header.version != Perfcore::version)
+            return Error::from_string_literal("Unsupported perfcore version");
+        TRY(loader.load_binary(*file));
+    } else {
+        TRY(file->seek(0, Core::Stream::SeekMode::SetPosition));
+        auto contents = TRY(file->read_all());
+        TRY(loader.load_json(contents));
+    }
+    return loader.create_profile();
+}
+
 void ProfileNode::sort_children()
 {
     sort_profile_nodes(m_children);
@@ -558,6 +874,14 @@ void Profile::set_show_top_functions(bool show)
     rebuild_tree();
 }
 
+void Profile::set_show_off_cpu_time(bool show)
+{
+    if (m_show_off_cpu_time == show)
+        return;
+    m_show_off_cpu_time = show;
+    rebuild_tree();
+}
+
 void Profile::set_show_percentages(bool show_percentages)
 {
     if (m_show_percentages == show_percentages)
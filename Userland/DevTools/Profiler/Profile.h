@@ -14,6 +14,7 @@
 #include "SamplesModel.h"
 #include "SignpostsModel.h"
 #include "SourceModel.h"
+#include <AK/Array.h>
 #include <AK/Bitmap.h>
 #include <AK/FlyString.h>
 #include <AK/JsonArray.h>
@@ -32,6 +33,14 @@ namespace Profiler {
 extern Optional<MappedObject> g_kernel_debuginfo_object;
 extern OwnPtr<Debug::DebugInfo> g_kernel_debug_info;
 
+enum class PerformanceCounter {
+    Cycles,
+    Instructions,
+    CacheMisses,
+    BranchMisses,
+    __Count
+};
+
 class ProfileNode : public RefCounted<ProfileNode> {
 public:
     static NonnullRefPtr<ProfileNode> create(Process const& process, FlyString const& object_name, String symbol, FlatPtr address, u32 offset, u64 timestamp, pid_t pid)
@@ -59,8 +68,9 @@ public:
     u32 offset() const { return m_offset; }
     u64 timestamp() const { return m_timestamp; }
 
-    u32 event_count() const { return m_event_count; }
-    u32 self_count() const { return m_self_count; }
+    // In off-CPU mode, these are microseconds rather than numbers of events.
+    u64 event_count() const { return m_event_count; }
+    u64 self_count() const { return m_self_count; }
 
     int child_count() const { return m_children.size(); }
     Vector<NonnullRefPtr<ProfileNode>> const& children() const { return m_children; }
@@ -90,19 +100,23 @@ public:
     ProfileNode* parent() { return m_parent; }
     ProfileNode const* parent() const { return m_parent; }
 
-    void increment_event_count() { ++m_event_count; }
-    void increment_self_count() { ++m_self_count; }
+    void increment_event_count(u64 weight = 1) { m_event_count += weight; }
+    void increment_self_count(u64 weight = 1) { m_self_count += weight; }
+
+    // The estimated number of hardware events in this node and the functions it called.
+    u64 performance_counter_total(PerformanceCounter counter) const { return m_performance_counter_totals[to_underlying(counter)]; }
+    void add_performance_counter_sample(PerformanceCounter counter, u64 period) { m_performance_counter_totals[to_underlying(counter)] += period; }
 
     void sort_children();
 
-    HashMap<FlatPtr, size_t> const& events_per_address() const { return m_events_per_address; }
-    void add_event_address(FlatPtr address)
+    HashMap<FlatPtr, u64> const& events_per_address() const { return m_events_per_address; }
+    void add_event_address(FlatPtr address, u64 weight = 1)
     {
         auto it = m_events_per_address.find(address);
         if (it == m_events_per_address.end())
-            m_events_per_address.set(address, 1);
+            m_events_per_address.set(address, weight);
         else
-            m_events_per_address.set(address, it->value + 1);
+            m_events_per_address.set(address, it->value + weight);
     }
 
     pid_t pid() const { return m_pid; }
@@ -122,11 +136,12 @@ private:
     pid_t m_pid { 0 };
     FlatPtr m_address { 0 };
     u32 m_offset { 0 };
-    u32 m_event_count { 0 };
-    u32 m_self_count { 0 };
+    u64 m_event_count { 0 };
+    u64 m_self_count { 0 };
     u64 m_timestamp { 0 };
+    Array<u64, to_underlying(PerformanceCounter::__Count)> m_performance_counter_totals {};
     Vector<NonnullRefPtr<ProfileNode>> m_children;
-    HashMap<FlatPtr, size_t> m_events_per_address;
+    HashMap<FlatPtr, u64> m_events_per_address;
     Bitmap m_seen_events;
 };
 
@@ -231,11 +246,25 @@ public:
             bool success;
         };
 
-        Variant<std::nullptr_t, SampleData, MallocData, FreeData, SignpostData, MmapData, MunmapData, ProcessCreateData, ProcessExecData, ThreadCreateData, ReadData> data { nullptr };
+        // Each of these samples stands for `period` occurrences of the counted event.
+        struct PerformanceCounterData {
+            PerformanceCounter counter;
+            u64 period { 0 };
+        };
+
+        // The frames of these events are where the thread blocked, followed by a pseudo-frame for the reason.
+        struct OffCpuData {
+            String reason;
+            u64 duration_us { 0 };
+        };
+
+        Variant<std::nullptr_t, SampleData, MallocData, FreeData, SignpostData, MmapData, MunmapData, ProcessCreateData, ProcessExecData, ThreadCreateData, ReadData, PerformanceCounterData, OffCpuData> data { nullptr };
     };
 
     Vector<Event> const& events() const { return m_events; }
     Vector<size_t> const& filtered_event_indices() const { return m_filtered_event_indices; }
+    // The total that the event counts of the nodes add up to, for computing percentages.
+    u64 filtered_event_weight() const { return m_filtered_event_weight; }
     Vector<size_t> const& filtered_signpost_indices() const { return m_filtered_signpost_indices; }
     NonnullRefPtr<FileEventNode> const& file_event_nodes() { return m_file_event_nodes; }
 
@@ -261,8 +290,15 @@ public:
     bool show_percentages() const { return m_show_percentages; }
     void set_show_percentages(bool);
 
+    // Builds the tree from the time that threads spent blocked instead of from samples.
+    bool show_off_cpu_time() const { return m_show_off_cpu_time; }
+    void set_show_off_cpu_time(bool);
+    bool has_off_cpu_events() const { return m_has_off_cpu_events; }
+
     Vector<Process> const& processes() const { return m_processes; }
 
+    bool has_performance_counter_events() const { return m_has_performance_counter_events; }
+
     template<typename Callback>
     void for_each_event_in_filter_range(Callback callback)
     {
@@ -287,6 +323,9 @@ public:
     }
 
 private:
+    friend class PerfcoreLoader;
+
+    static ErrorOr<NonnullOwnPtr<Profile>> create(Vector<Process>, Vector<Event>);
     Profile(Vector<Process>, Vector<Event>);
 
     void rebuild_tree();
@@ -303,6 +342,7 @@ private:
 
     Vector<NonnullRefPtr<ProfileNode>> m_roots;
     Vector<size_t> m_filtered_event_indices;
+    u64 m_filtered_event_weight { 0 };
     u64 m_first_timestamp { 0 };
     u64 m_last_timestamp { 0 };
 
@@ -322,6 +362,9 @@ private:
     bool m_inverted { false };
     bool m_show_top_functions { false };
     bool m_show_percentages { false };
+    bool m_show_off_cpu_time { false };
+    bool m_has_performance_counter_events { false };
+    bool m_has_off_cpu_events { false };
 };
 
 }
@@ -76,8 +76,12 @@ String ProfileModel::column_name(int column) const
 {
     switch (column) {
     case Column::SampleCount:
+        if (m_profile.show_off_cpu_time())
+            return m_profile.show_percentages() ? "% Off-CPU" : "Off-CPU (µs)";
         return m_profile.show_percentages() ? "% Samples" : "# Samples";
     case Column::SelfCount:
+        if (m_profile.show_off_cpu_time())
+            return m_profile.show_percentages() ? "% Self" : "Self (µs)";
         return m_profile.show_percentages() ? "% Self" : "# Self";
     case Column::ObjectName:
         return "Object";
@@ -85,6 +89,12 @@ String ProfileModel::column_name(int column) const
         return "Stack Frame";
     case Column::SymbolAddress:
         return "Symbol Address";
+    case Column::InstructionsPerCycle:
+        return "IPC";
+    case Column::CacheMissesPerKiloInstruction:
+        return "Cache Misses/1K Instr.";
+    case Column::BranchMissesPerKiloInstruction:
+        return "Branch Misses/1K Instr.";
     default:
         VERIFY_NOT_REACHED();
         return {};
@@ -97,6 +107,8 @@ GUI::Variant ProfileModel::data(GUI::ModelIndex const& index, GUI::ModelRole rol
     if (role == GUI::ModelRole::TextAlignment) {
         if (index.column() == Column::SampleCount || index.column() == Column::SelfCount)
             return Gfx::TextAlignment::CenterRight;
+        if (index.column() >= Column::InstructionsPerCycle)
+            return Gfx::TextAlignment::CenterRight;
     }
     if (role == GUI::ModelRole::Icon) {
         if (index.column() == Column::StackFrame) {
@@ -115,7 +127,7 @@ GUI::Variant ProfileModel::data(GUI::ModelIndex const& index, GUI::ModelRole rol
             auto percentage_full_precision = round_to<int>(
                 static_cast<float>(value)
                 * 100.f
-                / static_cast<float>(m_profile.filtered_event_indices().size())
+                / static_cast<float>(m_profile.filtered_event_weight())
                 * percent_digits_rounding);
             return String::formatted(
                 "{}.{:02}",
@@ -148,6 +160,19 @@ GUI::Variant ProfileModel::data(GUI::ModelIndex const& index, GUI::ModelRole rol
                 return "";
             return String::formatted("{:p} (offset {:p})", node->address(), node->address() - library->base);
         }
+        // The counters are sampled independently of each other, so these ratios are estimates that get better with more samples.
+        auto ratio = [](u64 numerator, u64 denominator, u64 scale) -> GUI::Variant {
+            if (denominator == 0)
+                return "";
+            return String::formatted("{:.2}", static_cast<double>(numerator) * scale / denominator);
+        };
+        auto instructions = node->performance_counter_total(PerformanceCounter::Instructions);
+        if (index.column() == Column::InstructionsPerCycle)
+            return ratio(instructions, node->performance_counter_total(PerformanceCounter::Cycles), 1);
+        if (index.column() == Column::CacheMissesPerKiloInstruction)
+            return ratio(node->performance_counter_total(PerformanceCounter::CacheMisses), instructions, 1000);
+        if (index.column() == Column::BranchMissesPerKiloInstruction)
+            return ratio(node->performance_counter_total(PerformanceCounter::BranchMisses), instructions, 1000);
         return {};
     }
     return {};
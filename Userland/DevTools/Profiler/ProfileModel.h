@@ -30,6 +30,9 @@ public:
         ObjectName,
         StackFrame,
         SymbolAddress,
+        InstructionsPerCycle,
+        CacheMissesPerKiloInstruction,
+        BranchMissesPerKiloInstruction,
         __Count
     };
 
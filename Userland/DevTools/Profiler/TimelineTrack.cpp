@@ -160,6 +160,9 @@ void TimelineTrack::recompute_histograms_if_needed(HistogramInputs const& inputs
         if (!m_process.valid_at(event.serial))
             continue;
 
+        if (event.data.has<Profile::Event::PerformanceCounterData>() || event.data.has<Profile::Event::OffCpuData>())
+            continue;
+
         auto& histogram = event.in_kernel ? *m_kernel_histogram : *m_user_histogram;
         histogram.insert(clamp_timestamp(event.timestamp), 1 + event.lost_samples);
     }
@@ -140,6 +140,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     tree_view->set_column_headers_visible(true);
     tree_view->set_selection_behavior(GUI::TreeView::SelectionBehavior::SelectRows);
     tree_view->set_model(profile->model());
+    for (auto column : { ProfileModel::Column::InstructionsPerCycle, ProfileModel::Column::CacheMissesPerKiloInstruction, ProfileModel::Column::BranchMissesPerKiloInstruction })
+        tree_view->set_column_visible(column, profile->has_performance_counter_events());
 
     auto disassembly_view = TRY(bottom_splitter->try_add<GUI::TableView>());
     disassembly_view->set_visible(false);
@@ -227,7 +229,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     auto const format_sample_count = [&profile, sample_count_percent_format_string](auto const sample_count) {
         if (profile->show_percentages())
             return String::formatted(sample_count_percent_format_string, sample_count.as_float_or(0.0));
-        return String::formatted("{} Samples", sample_count.to_i32());
+        if (profile->show_off_cpu_time())
+            return String::formatted("{} ms", sample_count.to_i64() / 1000);
+        return String::formatted("{} Samples", sample_count.to_i64());
     };
 
     auto statusbar = TRY(main_widget->try_add<GUI::Statusbar>());
@@ -241,7 +245,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             auto sample_count = profile->model().data(flamegraph_hovered_index.sibling_at_column(ProfileModel::Column::SampleCount));
             auto self_count = profile->model().data(flamegraph_hovered_index.sibling_at_column(ProfileModel::Column::SelfCount));
             builder.appendff("{}, ", stack);
-            builder.appendff("Samples: {}, ", format_sample_count(sample_count));
+            builder.appendff("{}: {}, ", profile->show_off_cpu_time() ? "Off-CPU"sv : "Samples"sv, format_sample_count(sample_count));
             builder.appendff("Self: {}", format_sample_count(self_count));
         } else {
             u64 normalized_start_time = clamp_timestamp(min(view.select_start_time(), view.select_end_time()));
@@ -296,6 +300,14 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     percent_action->set_checked(false);
     TRY(view_menu->try_add_action(percent_action));
 
+    auto off_cpu_action = GUI::Action::create_checkable("Show &Off-CPU Time", { Mod_Ctrl, Key_B }, [&](auto& action) {
+        profile->set_show_off_cpu_time(action.is_checked());
+        tree_view->update();
+    });
+    off_cpu_action->set_checked(false);
+    off_cpu_action->set_enabled(profile->has_off_cpu_events());
+    TRY(view_menu->try_add_action(off_cpu_action));
+
     TRY(view_menu->try_add_action(disassembly_action));
     TRY(view_menu->try_add_action(source_action));
 
@@ -362,7 +374,8 @@ bool generate_profile(pid_t& pid)
     }
 
     static constexpr u64 event_mask = PERF_EVENT_SAMPLE | PERF_EVENT_MMAP | PERF_EVENT_MUNMAP | PERF_EVENT_PROCESS_CREATE
-        | PERF_EVENT_PROCESS_EXEC | PERF_EVENT_PROCESS_EXIT | PERF_EVENT_THREAD_CREATE | PERF_EVENT_THREAD_EXIT;
+        | PERF_EVENT_PROCESS_EXEC | PERF_EVENT_PROCESS_EXIT | PERF_EVENT_THREAD_CREATE | PERF_EVENT_THREAD_EXIT
+        | PERF_EVENT_CPU_CYCLES | PERF_EVENT_INSTRUCTIONS | PERF_EVENT_CACHE_MISSES | PERF_EVENT_BRANCH_MISSES | PERF_EVENT_OFF_CPU;
 
     if (profiling_enable(pid, event_mask) < 0) {
         int saved_errno = errno;
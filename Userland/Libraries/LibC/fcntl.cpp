@@ -117,7 +117,13 @@ int posix_fadvise(int fd, off_t offset, off_t len, int advice)
 int posix_fallocate(int fd, off_t offset, off_t len)
 {
     // posix_fallocate does not set errno.
-    return static_cast<int>(syscall(SC_posix_fallocate, fd, &offset, &len));
+    return static_cast<int>(syscall(SC_fallocate, fd, 0, &offset, &len));
+}
+
+int fallocate(int fd, int mode, off_t offset, off_t len)
+{
+    int rc = syscall(SC_fallocate, fd, mode, &offset, &len);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/utimensat.html
@@ -31,6 +31,7 @@ int inode_watcher_remove_watch(int fd, int wd);
 
 int posix_fadvise(int fd, off_t offset, off_t len, int advice);
 int posix_fallocate(int fd, off_t offset, off_t len);
+int fallocate(int fd, int mode, off_t offset, off_t len);
 
 int utimensat(int dirfd, char const* path, struct timespec const times[2], int flag);
 
@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <bits/pthread_cancel.h>
+#include <errno.h>
+#include <sys/sendfile.h>
+#include <syscall.h>
+
+extern "C" {
+
+ssize_t sendfile(int out_fd, int in_fd, off_t* offset, size_t count)
+{
+    __pthread_maybe_cancel();
+
+    ssize_t rc = syscall(SC_sendfile, out_fd, in_fd, offset, count);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+}
@@ -36,6 +36,11 @@
 #include <time.h>
 #include <unistd.h>
 
+#if defined(__serenity__) || defined(__linux__)
+#    include <sys/epoll.h>
+#    define EVENTLOOP_HAS_EPOLL
+#endif
+
 #ifdef __serenity__
 extern bool s_global_initializers_ran;
 #endif
@@ -72,6 +77,81 @@ static thread_local HashTable<Notifier*>* s_notifiers;
 thread_local int EventLoop::s_wake_pipe_fds[2];
 thread_local bool EventLoop::s_wake_pipe_initialized { false };
 
+#ifdef EVENTLOOP_HAS_EPOLL
+// When the kernel supports it, each thread also keeps an epoll instance with an interest
+// entry per watched fd, so waiting does not have to hand every notifier to the kernel again.
+// If anything goes wrong with it, we permanently fall back to select() for that thread.
+static thread_local int s_epoll_fd { -1 };
+static thread_local bool s_epoll_initialized { false };
+static thread_local HashMap<int, Vector<Notifier*, 1>>* s_notifiers_by_fd;
+
+static void disable_event_poll()
+{
+    dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: Falling back to select()");
+    if (s_epoll_fd >= 0)
+        close(s_epoll_fd);
+    s_epoll_fd = -1;
+}
+
+static bool update_event_poll_interest(int fd)
+{
+    if (s_epoll_fd < 0)
+        return false;
+
+    auto it = s_notifiers_by_fd->find(fd);
+    if (it == s_notifiers_by_fd->end()) {
+        // NOTE: The fd may already have been closed, in which case the kernel dropped it for us.
+        (void)epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        return true;
+    }
+
+    unsigned event_mask = 0;
+    for (auto* notifier : it->value)
+        event_mask |= notifier->event_mask();
+
+    epoll_event event {};
+    if (event_mask & Notifier::Read)
+        event.events |= EPOLLIN;
+    if (event_mask & Notifier::Write)
+        event.events |= EPOLLOUT;
+    event.data.fd = fd;
+
+    if (epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event) == 0)
+        return true;
+    if (errno == ENOENT && epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0)
+        return true;
+
+    // Some fds (e.g. regular files on Linux) can't be watched, but select() handles them fine.
+    dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: epoll_ctl on fd {} failed: {}", fd, strerror(errno));
+    disable_event_poll();
+    return false;
+}
+
+static void initialize_event_poll(int wake_pipe_fd)
+{
+    if (s_epoll_initialized)
+        return;
+    s_epoll_initialized = true;
+
+    s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (s_epoll_fd < 0)
+        return;
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = wake_pipe_fd;
+    if (epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, wake_pipe_fd, &event) < 0) {
+        disable_event_poll();
+        return;
+    }
+
+    for (auto& it : *s_notifiers_by_fd) {
+        if (!update_event_poll_interest(it.key))
+            return;
+    }
+}
+#endif
+
 void EventLoop::initialize_wake_pipes()
 {
     if (!s_wake_pipe_initialized) {
@@ -326,6 +406,9 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
         s_event_loop_stack = new Vector<EventLoop&>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
         s_notifiers = new HashTable<Notifier*>;
+#ifdef EVENTLOOP_HAS_EPOLL
+        s_notifiers_by_fd = new HashMap<int, Vector<Notifier*, 1>>;
+#endif
     }
 
     if (s_event_loop_stack->is_empty()) {
@@ -347,6 +430,9 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
     }
 
     initialize_wake_pipes();
+#ifdef EVENTLOOP_HAS_EPOLL
+    initialize_event_poll(s_wake_pipe_fds[0]);
+#endif
 
     dbgln_if(EVENTLOOP_DEBUG, "{} Core::EventLoop constructed :)", getpid());
 }
@@ -658,6 +744,13 @@ void EventLoop::notify_forked(ForkEvent event)
         s_notifiers->clear();
         s_wake_pipe_initialized = false;
         initialize_wake_pipes();
+#ifdef EVENTLOOP_HAS_EPOLL
+        // The epoll instance is shared with the parent, so we need one of our own.
+        s_notifiers_by_fd->clear();
+        disable_event_poll();
+        s_epoll_initialized = false;
+        initialize_event_poll(s_wake_pipe_fds[0]);
+#endif
         if (auto* info = signals_info<false>()) {
             info->signal_handlers.clear();
             info->next_signal_id = 0;
@@ -670,6 +763,95 @@ void EventLoop::notify_forked(ForkEvent event)
 }
 
 void EventLoop::wait_for_event(WaitMode mode)
+{
+#ifdef EVENTLOOP_HAS_EPOLL
+    if (s_epoll_fd >= 0)
+        return wait_for_event_with_epoll(mode);
+#endif
+    wait_for_event_with_select(mode);
+}
+
+Optional<Time> EventLoop::wait_timeout(WaitMode mode)
+{
+    bool queued_events_is_empty;
+    {
+        Threading::MutexLocker locker(m_private->lock);
+        queued_events_is_empty = m_queued_events.is_empty();
+    }
+
+    if (mode != WaitMode::WaitForEvents || !queued_events_is_empty)
+        return Time::zero();
+
+    auto next_timer_expiration = get_next_timer_expiration();
+    if (!next_timer_expiration.has_value())
+        return {};
+
+    auto computed_timeout = next_timer_expiration.value() - Time::now_monotonic_coarse();
+    if (computed_timeout.is_negative())
+        computed_timeout = Time::zero();
+    return computed_timeout;
+}
+
+bool EventLoop::drain_wake_pipe()
+{
+    int wake_events[8];
+    ssize_t nread;
+    // We might receive another signal while read()ing here. The signal will go to the handle_signal properly,
+    // but we get interrupted. Therefore, just retry while we were interrupted.
+    do {
+        errno = 0;
+        nread = read(s_wake_pipe_fds[0], wake_events, sizeof(wake_events));
+        if (nread == 0)
+            break;
+    } while (nread < 0 && errno == EINTR);
+    if (nread < 0) {
+        perror("Core::EventLoop::wait_for_event: read from wake pipe");
+        VERIFY_NOT_REACHED();
+    }
+    VERIFY(nread > 0);
+    bool wake_requested = false;
+    int event_count = nread / sizeof(wake_events[0]);
+    for (int i = 0; i < event_count; i++) {
+        if (wake_events[i] != 0)
+            dispatch_signal(wake_events[i]);
+        else
+            wake_requested = true;
+    }
+
+    // If we only got signals and filled the whole buffer, there may be more to read.
+    return !wake_requested && nread == sizeof(wake_events);
+}
+
+void EventLoop::dispatch_expired_timers()
+{
+    if (s_timers->is_empty())
+        return;
+
+    auto now = Time::now_monotonic_coarse();
+    for (auto& it : *s_timers) {
+        auto& timer = *it.value;
+        if (!timer.has_expired(now))
+            continue;
+        auto owner = timer.owner.strong_ref();
+        if (timer.fire_when_not_visible == TimerShouldFireWhenNotVisible::No
+            && owner && !owner->is_visible_for_timer_purposes()) {
+            continue;
+        }
+
+        dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: Timer {} has expired, sending Core::TimerEvent to {}", timer.timer_id, *owner);
+
+        if (owner)
+            post_event(*owner, make<TimerEvent>(timer.timer_id));
+        if (timer.should_reload) {
+            timer.reload(now);
+        } else {
+            // FIXME: Support removing expired timers that don't want to reload.
+            VERIFY_NOT_REACHED();
+        }
+    }
+}
+
+void EventLoop::wait_for_event_with_select(WaitMode mode)
 {
     fd_set rfds;
     fd_set wfds;
@@ -697,30 +879,13 @@ retry:
             VERIFY_NOT_REACHED();
     }
 
-    bool queued_events_is_empty;
-    {
-        Threading::MutexLocker locker(m_private->lock);
-        queued_events_is_empty = m_queued_events.is_empty();
-    }
-
-    Time now;
+    auto wait_time = wait_timeout(mode);
     struct timeval timeout = { 0, 0 };
-    bool should_wait_forever = false;
-    if (mode == WaitMode::WaitForEvents && queued_events_is_empty) {
-        auto next_timer_expiration = get_next_timer_expiration();
-        if (next_timer_expiration.has_value()) {
-            now = Time::now_monotonic_coarse();
-            auto computed_timeout = next_timer_expiration.value() - now;
-            if (computed_timeout.is_negative())
-                computed_timeout = Time::zero();
-            timeout = computed_timeout.to_timeval();
-        } else {
-            should_wait_forever = true;
-        }
-    }
+    if (wait_time.has_value())
+        timeout = wait_time->to_timeval();
 
 try_select_again:
-    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, wait_time.has_value() ? &timeout : nullptr);
     if (marked_fd_count < 0) {
         int saved_errno = errno;
         if (saved_errno == EINTR) {
@@ -732,59 +897,11 @@ try_select_again:
         VERIFY_NOT_REACHED();
     }
     if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
-        int wake_events[8];
-        ssize_t nread;
-        // We might receive another signal while read()ing here. The signal will go to the handle_signal properly,
-        // but we get interrupted. Therefore, just retry while we were interrupted.
-        do {
-            errno = 0;
-            nread = read(s_wake_pipe_fds[0], wake_events, sizeof(wake_events));
-            if (nread == 0)
-                break;
-        } while (nread < 0 && errno == EINTR);
-        if (nread < 0) {
-            perror("Core::EventLoop::wait_for_event: read from wake pipe");
-            VERIFY_NOT_REACHED();
-        }
-        VERIFY(nread > 0);
-        bool wake_requested = false;
-        int event_count = nread / sizeof(wake_events[0]);
-        for (int i = 0; i < event_count; i++) {
-            if (wake_events[i] != 0)
-                dispatch_signal(wake_events[i]);
-            else
-                wake_requested = true;
-        }
-
-        if (!wake_requested && nread == sizeof(wake_events))
+        if (drain_wake_pipe())
             goto retry;
     }
 
-    if (!s_timers->is_empty()) {
-        now = Time::now_monotonic_coarse();
-    }
-
-    for (auto& it : *s_timers) {
-        auto& timer = *it.value;
-        if (!timer.has_expired(now))
-            continue;
-        auto owner = timer.owner.strong_ref();
-        if (timer.fire_when_not_visible == TimerShouldFireWhenNotVisible::No
-            && owner && !owner->is_visible_for_timer_purposes()) {
-            continue;
-        }
-
-        dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: Timer {} has expired, sending Core::TimerEvent to {}", timer.timer_id, *owner);
-
-        if (owner)
-            post_event(*owner, make<TimerEvent>(timer.timer_id));
-        if (timer.should_reload) {
-            timer.reload(now);
-        } else {
-            // FIXME: Support removing expired timers that don't want to reload.
-            VERIFY_NOT_REACHED();
-        }
-    }
+    dispatch_expired_timers();
 
     if (!marked_fd_count)
         return;
@@ -801,6 +918,62 @@ try_select_again:
     }
 }
 
+#ifdef EVENTLOOP_HAS_EPOLL
+void EventLoop::wait_for_event_with_epoll(WaitMode mode)
+{
+    epoll_event events[64];
+retry:
+    auto wait_time = wait_timeout(mode);
+    int timeout_ms = -1;
+    if (wait_time.has_value()) {
+        // Round up, so we don't wake up just before the next timer expires and spin.
+        auto timeout_ns = wait_time->to_nanoseconds();
+        timeout_ms = static_cast<int>(min<i64>((timeout_ns + 999'999) / 1'000'000, NumericLimits<int>::max()));
+    }
+
+    int event_count;
+    for (;;) {
+        event_count = epoll_wait(s_epoll_fd, events, array_size(events), timeout_ms);
+        if (event_count >= 0)
+            break;
+        int saved_errno = errno;
+        if (saved_errno != EINTR) {
+            dbgln("Core::EventLoop::wait_for_event: {} ({}: {})", event_count, saved_errno, strerror(saved_errno));
+            VERIFY_NOT_REACHED();
+        }
+        if (m_exit_requested)
+            return;
+    }
+
+    for (int i = 0; i < event_count; ++i) {
+        if (events[i].data.fd != s_wake_pipe_fds[0])
+            continue;
+        if (drain_wake_pipe())
+            goto retry;
+    }
+
+    dispatch_expired_timers();
+
+    for (int i = 0; i < event_count; ++i) {
+        int fd = events[i].data.fd;
+        if (fd == s_wake_pipe_fds[0])
+            continue;
+        auto it = s_notifiers_by_fd->find(fd);
+        if (it == s_notifiers_by_fd->end())
+            continue;
+        // A hangup or error is never masked out by epoll, so it has to be delivered to the notifier;
+        // otherwise the (level-triggered) fd stays ready and we'd spin without the owner ever seeing EOF.
+        bool hangup_or_error = events[i].events & (EPOLLHUP | EPOLLERR);
+        for (auto* notifier : it->value) {
+            if ((events[i].events & EPOLLIN || hangup_or_error) && (notifier->event_mask() & Notifier::Event::Read))
+                post_event(*notifier, make<NotifierReadEvent>(fd));
+            if ((events[i].events & EPOLLOUT || hangup_or_error) && (notifier->event_mask() & Notifier::Event::Write))
+                post_event(*notifier, make<NotifierWriteEvent>(fd));
+        }
+    }
+}
+#endif
+
 bool EventLoopTimer::has_expired(Time const& now) const
 {
     return now > fire_time;
@@ -862,13 +1035,38 @@ bool EventLoop::unregister_timer(int timer_id)
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
     VERIFY_EVENT_LOOP_INITIALIZED();
-    s_notifiers->set(&notifier);
+    if (s_notifiers->set(&notifier) != AK::HashSetResult::InsertedNewEntry)
+        return;
+#ifdef EVENTLOOP_HAS_EPOLL
+    s_notifiers_by_fd->ensure(notifier.fd()).append(&notifier);
+    update_event_poll_interest(notifier.fd());
+#endif
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
     VERIFY_EVENT_LOOP_INITIALIZED();
-    s_notifiers->remove(&notifier);
+    if (!s_notifiers->remove(&notifier))
+        return;
+#ifdef EVENTLOOP_HAS_EPOLL
+    auto it = s_notifiers_by_fd->find(notifier.fd());
+    VERIFY(it != s_notifiers_by_fd->end());
+    it->value.remove_first_matching([&](auto* other) { return other == &notifier; });
+    if (it->value.is_empty())
+        s_notifiers_by_fd->remove(it);
+    update_event_poll_interest(notifier.fd());
+#endif
+}
+
+void EventLoop::notifier_event_mask_changed(Badge<Notifier>, Notifier& notifier)
+{
+    VERIFY_EVENT_LOOP_INITIALIZED();
+#ifdef EVENTLOOP_HAS_EPOLL
+    if (s_notifiers->contains(&notifier))
+        update_event_poll_interest(notifier.fd());
+#else
+    (void)notifier;
+#endif
 }
 
 void EventLoop::wake_current()
@@ -67,6 +67,7 @@ public:
 
     static void register_notifier(Badge<Notifier>, Notifier&);
     static void unregister_notifier(Badge<Notifier>, Notifier&);
+    static void notifier_event_mask_changed(Badge<Notifier>, Notifier&);
 
     void quit(int);
     void unquit();
@@ -99,6 +100,11 @@ public:
 
 private:
     void wait_for_event(WaitMode);
+    void wait_for_event_with_select(WaitMode);
+    void wait_for_event_with_epoll(WaitMode);
+    Optional<Time> wait_timeout(WaitMode);
+    static bool drain_wake_pipe();
+    void dispatch_expired_timers();
     Optional<Time> get_next_timer_expiration();
     static void dispatch_signal(int);
     static void handle_signal(int);
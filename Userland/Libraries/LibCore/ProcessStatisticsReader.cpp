@@ -65,6 +65,7 @@ Optional<AllProcessesStatistics> ProcessStatisticsReader::get_all(RefPtr<Core::F
         process.amount_clean_inode = process_object.get("amount_clean_inode"sv).to_u32();
         process.amount_purgeable_volatile = process_object.get("amount_purgeable_volatile"sv).to_u32();
         process.amount_purgeable_nonvolatile = process_object.get("amount_purgeable_nonvolatile"sv).to_u32();
+        process.amount_huge = process_object.get("amount_huge"sv).to_u32();
 
         auto& thread_array = process_object.get_ptr("threads"sv)->as_array();
         process.threads.ensure_capacity(thread_array.size());
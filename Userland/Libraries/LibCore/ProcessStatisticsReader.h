@@ -57,6 +57,7 @@ struct ProcessStatistics {
     size_t amount_clean_inode;
     size_t amount_purgeable_volatile;
     size_t amount_purgeable_nonvolatile;
+    size_t amount_huge;
 
     Vector<Core::ThreadStatistics> threads;
 
@@ -313,6 +313,8 @@ public:
     ErrorOr<void> set_blocking(bool enabled) override { return m_helper.set_blocking(enabled); }
     ErrorOr<void> set_close_on_exec(bool enabled) override { return m_helper.set_close_on_exec(enabled); }
 
+    int fd() const { return m_helper.fd(); }
+
     virtual ~TCPSocket() override { close(); }
 
 private:
@@ -852,6 +854,9 @@ public:
 
     virtual size_t buffer_size() const override { return m_helper.buffer_size(); }
 
+    // Writes are not buffered, so it's safe to write to the underlying socket directly.
+    T& underlying_stream() { return m_helper.stream(); }
+
     virtual ~BufferedSocket() override = default;
 
 private:
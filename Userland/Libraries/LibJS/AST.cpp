@@ -3700,7 +3700,8 @@ ThrowCompletionOr<Value> TaggedTemplateLiteral::get_template_object(Interpreter&
 
         // d. Let rawValue be the String value rawStrings[index].
         // e. Perform ! DefinePropertyOrThrow(rawObj, prop, PropertyDescriptor { [[Value]]: rawValue, [[Writable]]: false, [[Enumerable]]: true, [[Configurable]]: false }).
-        raw_obj->indexed_properties().append(TRY(raw_strings[i].execute(interpreter)).release_value());
+        auto raw_value = TRY(raw_strings[i].execute(interpreter)).release_value();
+        raw_obj->indexed_properties().append(raw_value);
 
         // f. Set index to index + 1.
     }
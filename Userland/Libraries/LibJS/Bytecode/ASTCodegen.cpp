@@ -610,7 +610,7 @@ Bytecode::CodeGenerationErrorOr<void> AssignmentExpression::generate_bytecode(By
                         generator.emit<Bytecode::Op::PutByValue>(*base_object_register, *computed_property_register);
                     } else if (expression.property().is_identifier()) {
                         auto identifier_table_ref = generator.intern_identifier(verify_cast<Identifier>(expression.property()).string());
-                        generator.emit<Bytecode::Op::PutById>(*base_object_register, identifier_table_ref);
+                        generator.emit<Bytecode::Op::PutById>(*base_object_register, identifier_table_ref, generator.next_property_lookup_cache());
                     } else {
                         return Bytecode::CodeGenerationError {
                             &expression,
@@ -1061,7 +1061,7 @@ Bytecode::CodeGenerationErrorOr<void> ObjectExpression::generate_bytecode(Byteco
             if (property_kind != Bytecode::Op::PropertyKind::Spread)
                 TRY(property.value().generate_bytecode(generator));
 
-            generator.emit<Bytecode::Op::PutById>(object_reg, key_name, property_kind);
+            generator.emit<Bytecode::Op::PutById>(object_reg, key_name, generator.next_property_lookup_cache(), property_kind);
         } else {
             TRY(property.key().generate_bytecode(generator));
             auto property_reg = generator.allocate_register();
@@ -1184,7 +1184,7 @@ static Bytecode::CodeGenerationErrorOr<void> generate_object_binding_pattern_byt
             }
 
             generator.emit<Bytecode::Op::Load>(value_reg);
-            generator.emit<Bytecode::Op::GetById>(generator.intern_identifier(identifier));
+            generator.emit<Bytecode::Op::GetById>(generator.intern_identifier(identifier), generator.next_property_lookup_cache());
         } else {
             auto expression = name.get<NonnullRefPtr<Expression>>();
             TRY(expression->generate_bytecode(generator));
@@ -1480,7 +1480,7 @@ Bytecode::CodeGenerationErrorOr<void> CallExpression::generate_bytecode(Bytecode
             generator.emit<Bytecode::Op::GetByValue>(this_reg);
         } else {
             auto identifier_table_ref = generator.intern_identifier(verify_cast<Identifier>(member_expression.property()).string());
-            generator.emit<Bytecode::Op::GetById>(identifier_table_ref);
+            generator.emit<Bytecode::Op::GetById>(identifier_table_ref, generator.next_property_lookup_cache());
         }
         generator.emit<Bytecode::Op::Store>(callee_reg);
     } else {
@@ -1735,7 +1735,7 @@ Bytecode::CodeGenerationErrorOr<void> TaggedTemplateLiteral::generate_bytecode(B
     generator.emit<Bytecode::Op::Store>(raw_strings_reg);
 
     generator.emit<Bytecode::Op::Load>(strings_reg);
-    generator.emit<Bytecode::Op::PutById>(raw_strings_reg, generator.intern_identifier("raw"));
+    generator.emit<Bytecode::Op::PutById>(raw_strings_reg, generator.intern_identifier("raw"), generator.next_property_lookup_cache());
 
     generator.emit<Bytecode::Op::LoadImmediate>(js_undefined());
     auto this_reg = generator.allocate_register();
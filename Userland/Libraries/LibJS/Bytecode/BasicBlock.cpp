@@ -7,6 +7,7 @@
 #include <AK/String.h>
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/Op.h>
+#include <LibJS/JIT/Compiler.h>
 #include <sys/mman.h>
 
 namespace JS::Bytecode {
@@ -39,6 +40,21 @@ BasicBlock::~BasicBlock()
     munmap(m_buffer, m_buffer_capacity);
 }
 
+void* BasicBlock::replace_instruction(size_t offset, size_t new_size)
+{
+    VERIFY(offset < m_buffer_size);
+    auto& instruction = *reinterpret_cast<Instruction*>(m_buffer + offset);
+    auto old_size = instruction.length();
+    if (new_size > old_size && !can_grow(new_size - old_size))
+        return nullptr;
+
+    Instruction::destroy(instruction);
+    auto following_size = m_buffer_size - offset - old_size;
+    memmove(m_buffer + offset + new_size, m_buffer + offset + old_size, following_size);
+    m_buffer_size = m_buffer_size - old_size + new_size;
+    return m_buffer + offset;
+}
+
 void BasicBlock::seal()
 {
     // FIXME: mprotect the instruction stream as PROT_READ
@@ -64,4 +80,13 @@ void BasicBlock::grow(size_t additional_size)
     VERIFY(m_buffer_size <= m_buffer_capacity);
 }
 
+JIT::NativeBlock const* BasicBlock::native_block() const
+{
+    if (!m_did_try_to_compile) {
+        m_did_try_to_compile = true;
+        m_native_block = JIT::Compiler::compile(*this);
+    }
+    return m_native_block.ptr();
+}
+
 }
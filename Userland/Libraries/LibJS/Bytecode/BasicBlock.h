@@ -8,6 +8,7 @@
 
 #include <AK/Badge.h>
 #include <AK/NonnullOwnPtrVector.h>
+#include <AK/OwnPtr.h>
 #include <AK/String.h>
 #include <LibJS/Forward.h>
 
@@ -36,11 +37,19 @@ public:
     bool can_grow(size_t additional_size) const { return m_buffer_size + additional_size <= m_buffer_capacity; }
     void grow(size_t additional_size);
 
+    // Destroys the instruction at the given offset and resizes its slot to `new_size` bytes, moving the instructions
+    // after it. Returns the slot to construct the replacement in, or null (leaving the block alone) if it can't grow.
+    void* replace_instruction(size_t offset, size_t new_size);
+    void remove_instruction(size_t offset) { (void)replace_instruction(offset, 0); }
+
     void terminate(Badge<Generator>) { m_is_terminated = true; }
     bool is_terminated() const { return m_is_terminated; }
 
     String const& name() const { return m_name; }
 
+    // Compiles the block the first time it's asked for, and returns null if it can't be compiled.
+    JIT::NativeBlock const* native_block() const;
+
 private:
     BasicBlock(String name, size_t size);
 
@@ -49,6 +58,8 @@ private:
     size_t m_buffer_size { 0 };
     bool m_is_terminated { false };
     String m_name;
+    mutable OwnPtr<JIT::NativeBlock> m_native_block;
+    mutable bool m_did_try_to_compile { false };
 };
 
 }
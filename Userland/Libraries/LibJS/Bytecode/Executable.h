@@ -10,6 +10,7 @@
 #include <AK/NonnullOwnPtrVector.h>
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/IdentifierTable.h>
+#include <LibJS/Bytecode/PropertyLookupCache.h>
 #include <LibJS/Bytecode/StringTable.h>
 
 namespace JS::Bytecode {
@@ -19,6 +20,8 @@ struct Executable {
     NonnullOwnPtrVector<BasicBlock> basic_blocks;
     NonnullOwnPtr<StringTable> string_table;
     NonnullOwnPtr<IdentifierTable> identifier_table;
+    // Indexed by the cache index of GetById and PutById instructions.
+    Vector<PropertyLookupCache> mutable property_lookup_caches;
     size_t number_of_registers { 0 };
     bool is_strict_mode { false };
 
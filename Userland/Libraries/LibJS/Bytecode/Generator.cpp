@@ -52,11 +52,15 @@ CodeGenerationErrorOr<NonnullOwnPtr<Executable>> Generator::generate(ASTNode con
     else if (is<FunctionExpression>(node))
         is_strict_mode = static_cast<FunctionExpression const&>(node).is_strict_mode();
 
+    Vector<PropertyLookupCache> property_lookup_caches;
+    property_lookup_caches.resize(generator.m_next_property_lookup_cache);
+
     return adopt_own(*new Executable {
         .name = {},
         .basic_blocks = move(generator.m_root_basic_blocks),
         .string_table = move(generator.m_string_table),
         .identifier_table = move(generator.m_identifier_table),
+        .property_lookup_caches = move(property_lookup_caches),
         .number_of_registers = generator.m_next_register,
         .is_strict_mode = is_strict_mode });
 }
@@ -159,7 +163,7 @@ CodeGenerationErrorOr<void> Generator::emit_load_from_reference(JS::ASTNode cons
             emit<Bytecode::Op::GetByValue>(object_reg);
         } else if (expression.property().is_identifier()) {
             auto identifier_table_ref = intern_identifier(verify_cast<Identifier>(expression.property()).string());
-            emit<Bytecode::Op::GetById>(identifier_table_ref);
+            emit<Bytecode::Op::GetById>(identifier_table_ref, next_property_lookup_cache());
         } else {
             return CodeGenerationError {
                 &expression,
@@ -198,7 +202,7 @@ CodeGenerationErrorOr<void> Generator::emit_store_to_reference(JS::ASTNode const
         } else if (expression.property().is_identifier()) {
             emit<Bytecode::Op::Load>(value_reg);
             auto identifier_table_ref = intern_identifier(verify_cast<Identifier>(expression.property()).string());
-            emit<Bytecode::Op::PutById>(object_reg, identifier_table_ref);
+            emit<Bytecode::Op::PutById>(object_reg, identifier_table_ref, next_property_lookup_cache());
         } else {
             return CodeGenerationError {
                 &expression,
@@ -8,6 +8,7 @@
 
 #include <AK/Forward.h>
 #include <AK/Span.h>
+#include <LibJS/Bytecode/Register.h>
 #include <LibJS/Forward.h>
 
 #define ENUMERATE_BYTECODE_OPS(O)    \
@@ -110,6 +111,17 @@ public:
     void replace_references(BasicBlock const&, BasicBlock const&);
     static void destroy(Instruction&);
 
+    enum class RegisterAccess {
+        Read,
+        Write,
+        ReadWrite,
+    };
+
+    // Calls the visitor with every register operand, which it may rename. The accumulator that most
+    // instructions use implicitly is not an operand, and isn't visited. Every instruction has to define
+    // visit_registers_impl(), so that one with register operands can't be left out by accident.
+    void visit_registers(Function<void(Register&, RegisterAccess)> const&);
+
 protected:
     explicit Instruction(Type type)
         : m_type(type)
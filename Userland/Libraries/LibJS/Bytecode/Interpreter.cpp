@@ -11,6 +11,7 @@
 #include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Bytecode/Op.h>
 #include <LibJS/Interpreter.h>
+#include <LibJS/JIT/NativeBlock.h>
 #include <LibJS/Runtime/GlobalEnvironment.h>
 #include <LibJS/Runtime/GlobalObject.h>
 #include <LibJS/Runtime/Realm.h>
@@ -19,6 +20,8 @@ namespace JS::Bytecode {
 
 static Interpreter* s_current;
 bool g_dump_bytecode = false;
+bool g_enable_jit = false;
+bool g_dump_pass_statistics = false;
 
 Interpreter* Interpreter::current()
 {
@@ -71,9 +74,22 @@ Interpreter::ValueAndFrame Interpreter::run_and_return_frame(Executable const& e
 
     for (;;) {
         Bytecode::InstructionStreamIterator pc(block->instruction_stream());
+        auto const* native_block = g_enable_jit ? block->native_block() : nullptr;
         bool will_jump = false;
         bool will_return = false;
         while (!pc.at_end()) {
+            if (native_block) {
+                auto exit = native_block->run(*this, registers().data(), pc.offset());
+                if (exit.next_block) {
+                    block = exit.next_block;
+                    will_jump = true;
+                    break;
+                }
+                // The native code couldn't run this instruction, so we do and then go back to it.
+                pc.jump(exit.resume_offset);
+                if (pc.at_end())
+                    break;
+            }
             auto& instruction = *pc;
             auto ran_or_error = instruction.execute(*this);
             if (ran_or_error.is_error()) {
@@ -226,6 +242,12 @@ Bytecode::PassManager& Interpreter::optimization_pipeline(Interpreter::Optimizat
         pm->add<Passes::UnifySameBlocks>();
         pm->add<Passes::GenerateCFG>();
         pm->add<Passes::MergeBlocks>();
+        pm->add<Passes::FoldConstants>();
+        pm->add<Passes::ThreadJumps>();
+        pm->add<Passes::GenerateLiveness>();
+        pm->add<Passes::EliminateDeadStores>();
+        pm->add<Passes::GenerateLiveness>();
+        pm->add<Passes::AllocateRegisters>();
         pm->add<Passes::GenerateCFG>();
         pm->add<Passes::PlaceBlocks>();
     } else {
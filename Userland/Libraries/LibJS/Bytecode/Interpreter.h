@@ -100,5 +100,6 @@ private:
 };
 
 extern bool g_dump_bytecode;
+extern bool g_enable_jit;
 
 }
@@ -409,7 +409,14 @@ ThrowCompletionOr<void> GetById::execute_impl(Bytecode::Interpreter& interpreter
 {
     auto& vm = interpreter.vm();
     auto* object = TRY(interpreter.accumulator().to_object(vm));
-    interpreter.accumulator() = TRY(object->get(interpreter.current_executable().get_identifier(m_property)));
+    PropertyKey name = interpreter.current_executable().get_identifier(m_property);
+    auto& cache = interpreter.current_executable().property_lookup_caches[m_cache_index];
+    if (auto value = cache.get(*object, name); value.has_value()) {
+        interpreter.accumulator() = *value;
+        return {};
+    }
+    interpreter.accumulator() = TRY(object->get(name));
+    cache.update_after_get(*object, name);
     return {};
 }
 
@@ -419,7 +426,16 @@ ThrowCompletionOr<void> PutById::execute_impl(Bytecode::Interpreter& interpreter
     auto* object = TRY(interpreter.reg(m_base).to_object(vm));
     PropertyKey name = interpreter.current_executable().get_identifier(m_property);
     auto value = interpreter.accumulator();
-    return put_by_property_key(object, value, name, interpreter, m_kind);
+    if (m_kind != PropertyKind::KeyValue)
+        return put_by_property_key(object, value, name, interpreter, m_kind);
+
+    auto& cache = interpreter.current_executable().property_lookup_caches[m_cache_index];
+
+    if (cache.put(*object, name, value))
+        return {};
+    TRY(put_by_property_key(object, value, name, interpreter, m_kind));
+    cache.update_after_put(*object, name);
+    return {};
 }
 
 ThrowCompletionOr<void> DeleteById::execute_impl(Bytecode::Interpreter& interpreter) const
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <LibCrypto/BigInt/SignedBigInteger.h>
 #include <LibJS/Bytecode/IdentifierTable.h>
 #include <LibJS/Bytecode/Instruction.h>
@@ -33,6 +34,9 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const& visitor) { visitor(m_src, RegisterAccess::Read); }
+
+    Register src() const { return m_src; }
 
 private:
     Register m_src;
@@ -49,6 +53,9 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
+
+    Value value() const { return m_value; }
 
 private:
     Value m_value;
@@ -65,6 +72,9 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const& visitor) { visitor(m_dst, RegisterAccess::Write); }
+
+    Register dst() const { return m_dst; }
 
 private:
     Register m_dst;
@@ -94,21 +104,27 @@ private:
     O(RightShift, right_shift)                \
     O(UnsignedRightShift, unsigned_right_shift)
 
-#define JS_DECLARE_COMMON_BINARY_OP(OpTitleCase, op_snake_case)                \
-    class OpTitleCase final : public Instruction {                             \
-    public:                                                                    \
-        explicit OpTitleCase(Register lhs_reg)                                 \
-            : Instruction(Type::OpTitleCase)                                   \
-            , m_lhs_reg(lhs_reg)                                               \
-        {                                                                      \
-        }                                                                      \
-                                                                               \
-        ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;    \
-        String to_string_impl(Bytecode::Executable const&) const;              \
-        void replace_references_impl(BasicBlock const&, BasicBlock const&) { } \
-                                                                               \
-    private:                                                                   \
-        Register m_lhs_reg;                                                    \
+#define JS_DECLARE_COMMON_BINARY_OP(OpTitleCase, op_snake_case)                             \
+    class OpTitleCase final : public Instruction {                                          \
+    public:                                                                                 \
+        explicit OpTitleCase(Register lhs_reg)                                              \
+            : Instruction(Type::OpTitleCase)                                                \
+            , m_lhs_reg(lhs_reg)                                                            \
+        {                                                                                   \
+        }                                                                                   \
+                                                                                            \
+        ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;                 \
+        String to_string_impl(Bytecode::Executable const&) const;                           \
+        void replace_references_impl(BasicBlock const&, BasicBlock const&) { }              \
+        void visit_registers_impl(Function<void(Register&, RegisterAccess)> const& visitor) \
+        {                                                                                   \
+            visitor(m_lhs_reg, RegisterAccess::Read);                                       \
+        }                                                                                   \
+                                                                                            \
+        Register lhs() const { return m_lhs_reg; }                                          \
+                                                                                            \
+    private:                                                                                \
+        Register m_lhs_reg;                                                                 \
     };
 
 JS_ENUMERATE_COMMON_BINARY_OPS(JS_DECLARE_COMMON_BINARY_OP)
@@ -121,17 +137,18 @@ JS_ENUMERATE_COMMON_BINARY_OPS(JS_DECLARE_COMMON_BINARY_OP)
     O(UnaryMinus, unary_minus)           \
     O(Typeof, typeof_)
 
-#define JS_DECLARE_COMMON_UNARY_OP(OpTitleCase, op_snake_case)                 \
-    class OpTitleCase final : public Instruction {                             \
-    public:                                                                    \
-        OpTitleCase()                                                          \
-            : Instruction(Type::OpTitleCase)                                   \
-        {                                                                      \
-        }                                                                      \
-                                                                               \
-        ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;    \
-        String to_string_impl(Bytecode::Executable const&) const;              \
-        void replace_references_impl(BasicBlock const&, BasicBlock const&) { } \
+#define JS_DECLARE_COMMON_UNARY_OP(OpTitleCase, op_snake_case)                          \
+    class OpTitleCase final : public Instruction {                                      \
+    public:                                                                             \
+        OpTitleCase()                                                                   \
+            : Instruction(Type::OpTitleCase)                                            \
+        {                                                                               \
+        }                                                                               \
+                                                                                        \
+        ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;             \
+        String to_string_impl(Bytecode::Executable const&) const;                       \
+        void replace_references_impl(BasicBlock const&, BasicBlock const&) { }          \
+        void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { } \
     };
 
 JS_ENUMERATE_COMMON_UNARY_OPS(JS_DECLARE_COMMON_UNARY_OP)
@@ -148,6 +165,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     StringTableIndex m_string;
@@ -163,6 +181,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class NewRegExp final : public Instruction {
@@ -177,6 +196,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     StringTableIndex m_source_index;
@@ -198,6 +218,12 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const& visitor)
+    {
+        visitor(m_from_object, RegisterAccess::Read);
+        for (size_t i = 0; i < m_excluded_names_count; i++)
+            visitor(m_excluded_names[i], RegisterAccess::Read);
+    }
 
     size_t length_impl() const { return sizeof(*this) + sizeof(Register) * m_excluded_names_count; }
 
@@ -218,6 +244,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     Crypto::SignedBigInteger m_bigint;
@@ -243,6 +270,19 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    // Only the ends of the range are stored, so renaming its registers has to keep them contiguous.
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const& visitor)
+    {
+        auto first = m_elements[0].index();
+        for (size_t i = 0; i < m_element_count; i++) {
+            Register element { first + static_cast<u32>(i) };
+            visitor(element, RegisterAccess::Read);
+            if (i == 0)
+                m_elements[0] = element;
+            if (i == m_element_count - 1)
+                m_elements[1] = element;
+        }
+    }
 
     size_t length_impl() const
     {
@@ -264,6 +304,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class ConcatString final : public Instruction {
@@ -277,6 +318,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const& visitor) { visitor(m_lhs, RegisterAccess::ReadWrite); }
 
 private:
     Register m_lhs;
@@ -298,6 +340,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     EnvironmentMode m_mode { EnvironmentMode::Lexical };
@@ -313,6 +356,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class CreateVariable final : public Instruction {
@@ -329,6 +373,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     IdentifierTableIndex m_identifier;
@@ -355,6 +400,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     IdentifierTableIndex m_identifier;
@@ -373,6 +419,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     IdentifierTableIndex m_identifier;
@@ -391,6 +438,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     IdentifierTableIndex m_identifier;
@@ -398,18 +446,24 @@ private:
 
 class GetById final : public Instruction {
 public:
-    explicit GetById(IdentifierTableIndex property)
+    GetById(IdentifierTableIndex property, u32 cache_index)
         : Instruction(Type::GetById)
         , m_property(property)
+        , m_cache_index(cache_index)
     {
     }
 
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
+
+    IdentifierTableIndex property() const { return m_property; }
+    u32 cache_index() const { return m_cache_index; }
 
 private:
     IdentifierTableIndex m_property;
+    u32 m_cache_index;
 };
 
 enum class PropertyKind {
@@ -422,22 +476,30 @@ enum class PropertyKind {
 
 class PutById final : public Instruction {
 public:
-    explicit PutById(Register base, IdentifierTableIndex property, PropertyKind kind = PropertyKind::KeyValue)
+    PutById(Register base, IdentifierTableIndex property, u32 cache_index, PropertyKind kind = PropertyKind::KeyValue)
         : Instruction(Type::PutById)
         , m_base(base)
         , m_property(property)
         , m_kind(kind)
+        , m_cache_index(cache_index)
     {
     }
 
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const& visitor) { visitor(m_base, RegisterAccess::Read); }
+
+    Register base() const { return m_base; }
+    IdentifierTableIndex property() const { return m_property; }
+    PropertyKind kind() const { return m_kind; }
+    u32 cache_index() const { return m_cache_index; }
 
 private:
     Register m_base;
     IdentifierTableIndex m_property;
     PropertyKind m_kind;
+    u32 m_cache_index;
 };
 
 class DeleteById final : public Instruction {
@@ -451,6 +513,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     IdentifierTableIndex m_property;
@@ -467,6 +530,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const& visitor) { visitor(m_base, RegisterAccess::Read); }
 
 private:
     Register m_base;
@@ -485,6 +549,11 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const& visitor)
+    {
+        visitor(m_base, RegisterAccess::Read);
+        visitor(m_property, RegisterAccess::Read);
+    }
 
 private:
     Register m_base;
@@ -503,6 +572,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const& visitor) { visitor(m_base, RegisterAccess::Read); }
 
 private:
     Register m_base;
@@ -535,6 +605,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&);
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
     auto& true_target() const { return m_true_target; }
     auto& false_target() const { return m_false_target; }
@@ -599,6 +670,13 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const& visitor)
+    {
+        visitor(m_callee, RegisterAccess::Read);
+        visitor(m_this_value, RegisterAccess::Read);
+        for (size_t i = 0; i < m_argument_count; ++i)
+            visitor(m_arguments[i], RegisterAccess::Read);
+    }
 
     size_t length_impl() const
     {
@@ -628,6 +706,11 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const& visitor)
+    {
+        for (size_t i = 0; i < m_argument_count; ++i)
+            visitor(m_arguments[i], RegisterAccess::Read);
+    }
 
     size_t length_impl() const
     {
@@ -651,6 +734,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     ClassExpression const& m_class_expression;
@@ -667,6 +751,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     FunctionNode const& m_function_node;
@@ -684,6 +769,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class Increment final : public Instruction {
@@ -696,6 +782,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class Decrement final : public Instruction {
@@ -708,6 +795,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class Throw final : public Instruction {
@@ -722,6 +810,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class EnterUnwindContext final : public Instruction {
@@ -739,6 +828,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&);
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
     auto& entry_point() const { return m_entry_point; }
     auto& handler_target() const { return m_handler_target; }
@@ -761,6 +851,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     EnvironmentMode m_mode { EnvironmentMode::Lexical };
@@ -776,6 +867,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class FinishUnwind final : public Instruction {
@@ -789,6 +881,9 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&);
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
+
+    auto& next_target() const { return m_next_target; }
 
 private:
     Label m_next_target;
@@ -807,6 +902,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&);
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
     auto& resume_target() const { return m_resume_target; }
 
@@ -832,6 +928,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&);
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
     auto& continuation() const { return m_continuation_label; }
 
@@ -850,6 +947,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     HashMap<u32, Variable> m_variables;
@@ -865,6 +963,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class GetObjectPropertyIterator final : public Instruction {
@@ -877,6 +976,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class IteratorNext final : public Instruction {
@@ -889,6 +989,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class IteratorResultDone final : public Instruction {
@@ -901,6 +1002,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class IteratorResultValue final : public Instruction {
@@ -913,6 +1015,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class ResolveThisBinding final : public Instruction {
@@ -925,6 +1028,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class GetNewTarget final : public Instruction {
@@ -937,6 +1041,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class TypeofVariable final : public Instruction {
@@ -950,6 +1055,7 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void visit_registers_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     IdentifierTableIndex m_identifier;
@@ -989,6 +1095,21 @@ ALWAYS_INLINE void Instruction::replace_references(BasicBlock const& from, Basic
 #undef __BYTECODE_OP
 }
 
+ALWAYS_INLINE void Instruction::visit_registers(Function<void(Register&, RegisterAccess)> const& visitor)
+{
+#define __BYTECODE_OP(op)       \
+    case Instruction::Type::op: \
+        return static_cast<Bytecode::Op::op&>(*this).visit_registers_impl(visitor);
+
+    switch (type()) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+#undef __BYTECODE_OP
+}
+
 ALWAYS_INLINE size_t Instruction::length() const
 {
     if (type() == Type::Call)
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/QuickSort.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+void AllocateRegisters::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    VERIFY(executable.live_registers_at_exit.has_value());
+    VERIFY(executable.registers_live_everywhere.has_value());
+    auto live_registers_at_exit = executable.live_registers_at_exit.release_value();
+    auto registers_live_everywhere = executable.registers_live_everywhere.release_value();
+
+    HashTable<u32> registers;
+    HashMap<u32, HashTable<u32>> interferences;
+
+    // NewArray reads a range of registers, which has to stay contiguous. Registers that end up in more than one range
+    // (which the generator doesn't do) would tie those ranges together, so they just keep their indices instead.
+    struct Range {
+        u32 first { 0 };
+        u32 count { 0 };
+        bool is_fixed { false };
+    };
+    Vector<Range> ranges;
+    HashMap<u32, size_t> range_of_register;
+
+    // Two registers interfere if one of them is written while the other one is live, and then they can't share an index.
+    for (auto& block : executable.executable.basic_blocks) {
+        Vector<Instruction*> instructions;
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it)
+            instructions.append(const_cast<Instruction*>(&*it));
+
+        auto live = live_registers_at_exit.find(&block)->value;
+        for (size_t i = instructions.size(); i > 0; --i) {
+            auto& instruction = *instructions[i - 1];
+            Optional<size_t> range_index;
+            if (instruction.type() == Instruction::Type::NewArray) {
+                range_index = ranges.size();
+                ranges.append({});
+            }
+            instruction.visit_registers([&](Register& reg, Instruction::RegisterAccess access) {
+                if (reg.index() == Register::accumulator_index)
+                    return;
+                registers.set(reg.index());
+                if (range_index.has_value()) {
+                    auto& range = ranges[*range_index];
+                    if (range.count++ == 0)
+                        range.first = reg.index();
+                    if (auto other_range = range_of_register.get(reg.index()); other_range.has_value()) {
+                        range.is_fixed = true;
+                        ranges[*other_range].is_fixed = true;
+                    }
+                    range_of_register.set(reg.index(), *range_index);
+                }
+                if (access == Instruction::RegisterAccess::Read)
+                    return;
+                for (auto other : live) {
+                    if (other == reg.index())
+                        continue;
+                    interferences.ensure(reg.index()).set(other);
+                    interferences.ensure(other).set(reg.index());
+                }
+            });
+            instruction.visit_registers([&](Register& reg, Instruction::RegisterAccess access) {
+                if (reg.index() == Register::accumulator_index)
+                    return;
+                if (access == Instruction::RegisterAccess::Write)
+                    live.remove(reg.index());
+                else
+                    live.set(reg.index());
+            });
+        }
+    }
+
+    HashMap<u32, u32> new_indices;
+    new_indices.set(Register::accumulator_index, Register::accumulator_index);
+
+    // Every register is allocated on its own, except for the ones in a range which go together.
+    Vector<Vector<u32>> groups;
+    for (auto& range : ranges) {
+        Vector<u32> group;
+        for (u32 i = 0; i < range.count; ++i) {
+            if (range.is_fixed)
+                new_indices.set(range.first + i, range.first + i);
+            else
+                group.append(range.first + i);
+        }
+        if (!group.is_empty())
+            groups.append(move(group));
+    }
+    for (auto reg : registers) {
+        if (!range_of_register.contains(reg))
+            groups.append(Vector<u32> { reg });
+    }
+    quick_sort(groups, [](auto& a, auto& b) { return a.first() < b.first(); });
+
+    auto taken_indices_for = [&](u32 reg) {
+        HashTable<u32> taken_indices;
+        if (registers_live_everywhere.contains(reg)) {
+            for (auto& entry : new_indices)
+                taken_indices.set(entry.value);
+            return taken_indices;
+        }
+        if (auto it = interferences.find(reg); it != interferences.end()) {
+            for (auto other : it->value) {
+                if (auto index = new_indices.get(other); index.has_value())
+                    taken_indices.set(*index);
+            }
+        }
+        for (auto other : registers_live_everywhere) {
+            if (auto index = new_indices.get(other); index.has_value())
+                taken_indices.set(*index);
+        }
+        return taken_indices;
+    };
+
+    // Give every group the lowest indices that none of the registers they interfere with has yet. The generator
+    // never hands out $1, so neither do we.
+    for (auto& group : groups) {
+        Vector<HashTable<u32>> taken_indices;
+        for (auto reg : group)
+            taken_indices.append(taken_indices_for(reg));
+
+        auto fits_at = [&](u32 first_index) {
+            for (size_t i = 0; i < group.size(); ++i) {
+                if (taken_indices[i].contains(first_index + i))
+                    return false;
+            }
+            return true;
+        };
+        u32 first_index = 2;
+        while (!fits_at(first_index))
+            ++first_index;
+        for (size_t i = 0; i < group.size(); ++i)
+            new_indices.set(group[i], first_index + i);
+    }
+
+    size_t number_of_registers = Register::accumulator_index + 1;
+    for (auto& entry : new_indices)
+        number_of_registers = max(number_of_registers, static_cast<size_t>(entry.value) + 1);
+
+    for (auto& block : executable.executable.basic_blocks) {
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            const_cast<Instruction&>(*it).visit_registers([&](Register& reg, Instruction::RegisterAccess) {
+                reg = Register { new_indices.get(reg.index()).value() };
+            });
+        }
+    }
+
+    executable.executable.number_of_registers = number_of_registers;
+
+    finished();
+}
+
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// Anything that can end up running JavaScript may clobber the accumulator, since the return value of a
+// call is put there. So these are the only instructions that are known to leave it alone.
+static bool preserves_accumulator(Instruction const& instruction)
+{
+    switch (instruction.type()) {
+    case Instruction::Type::Store:
+    case Instruction::Type::CreateEnvironment:
+    case Instruction::Type::LeaveEnvironment:
+    case Instruction::Type::LeaveUnwindContext:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Instructions that overwrite the accumulator without reading it, and can't throw before doing so.
+static bool overwrites_accumulator(Instruction const& instruction)
+{
+    switch (instruction.type()) {
+    case Instruction::Type::Load:
+    case Instruction::Type::LoadImmediate:
+    case Instruction::Type::NewString:
+    case Instruction::Type::NewObject:
+    case Instruction::Type::NewBigInt:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Instructions that don't do anything other than setting the accumulator.
+static bool only_writes_accumulator(Instruction const& instruction)
+{
+    switch (instruction.type()) {
+    case Instruction::Type::Load:
+    case Instruction::Type::LoadImmediate:
+    case Instruction::Type::NewString:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static Register written_register(Instruction const& instruction)
+{
+    VERIFY(instruction.type() == Instruction::Type::Store);
+    return static_cast<Op::Store const&>(instruction).dst();
+}
+
+// Forward over the block: drop a Load or Store when the accumulator already holds the register's value.
+static void eliminate_redundant_copies(BasicBlock& block)
+{
+    HashTable<u32> registers_holding_accumulator;
+    size_t offset = 0;
+    while (offset < block.size()) {
+        auto& instruction = *reinterpret_cast<Instruction*>(const_cast<u8*>(block.instruction_stream().data()) + offset);
+        if (instruction.type() == Instruction::Type::Store || instruction.type() == Instruction::Type::Load) {
+            auto reg = instruction.type() == Instruction::Type::Store
+                ? written_register(instruction)
+                : static_cast<Op::Load const&>(instruction).src();
+            if (registers_holding_accumulator.contains(reg.index())) {
+                block.remove_instruction(offset);
+                continue;
+            }
+            if (instruction.type() == Instruction::Type::Load)
+                registers_holding_accumulator.clear();
+            registers_holding_accumulator.set(reg.index());
+        } else {
+            if (!preserves_accumulator(instruction))
+                registers_holding_accumulator.clear();
+            instruction.visit_registers([&](Register& reg, Instruction::RegisterAccess access) {
+                if (access != Instruction::RegisterAccess::Read)
+                    registers_holding_accumulator.remove(reg.index());
+            });
+        }
+        offset += instruction.length();
+    }
+}
+
+// Backward over the block: drop stores to registers that aren't live afterwards, and writes to the
+// accumulator that get overwritten before anything reads them.
+static void eliminate_dead_writes(BasicBlock& block, HashTable<u32> const& live_at_exit, HashTable<u32> const& live_everywhere)
+{
+    Vector<size_t> offsets;
+    for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it)
+        offsets.append(it.offset());
+
+    auto live = live_at_exit;
+    // The accumulator is only tracked inside the block, so assume the successors read it.
+    bool accumulator_is_live = true;
+
+    // Removing an instruction only moves the ones after it, which we're done with.
+    for (size_t i = offsets.size(); i > 0; --i) {
+        auto offset = offsets[i - 1];
+        auto& instruction = *reinterpret_cast<Instruction*>(const_cast<u8*>(block.instruction_stream().data()) + offset);
+
+        if (instruction.type() == Instruction::Type::Store) {
+            auto index = written_register(instruction).index();
+            if (index != Register::accumulator_index && !live.contains(index) && !live_everywhere.contains(index)) {
+                block.remove_instruction(offset);
+                continue;
+            }
+        }
+        if (only_writes_accumulator(instruction) && !accumulator_is_live) {
+            block.remove_instruction(offset);
+            continue;
+        }
+
+        accumulator_is_live = !overwrites_accumulator(instruction);
+        instruction.visit_registers([&](Register& reg, Instruction::RegisterAccess access) {
+            if (access == Instruction::RegisterAccess::Write)
+                live.remove(reg.index());
+            else
+                live.set(reg.index());
+        });
+    }
+}
+
+void EliminateDeadStores::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    VERIFY(executable.live_registers_at_exit.has_value());
+    VERIFY(executable.registers_live_everywhere.has_value());
+    auto live_registers_at_exit = executable.live_registers_at_exit.release_value();
+    auto registers_live_everywhere = executable.registers_live_everywhere.release_value();
+
+    for (auto& block : executable.executable.basic_blocks) {
+        eliminate_redundant_copies(block);
+        // Removing copies only takes reads away, so the liveness from before is still safe to use.
+        eliminate_dead_writes(block, live_registers_at_exit.find(&block)->value, registers_live_everywhere);
+    }
+
+    finished();
+}
+
+}
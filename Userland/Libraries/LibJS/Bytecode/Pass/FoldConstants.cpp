@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Math.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// Only values that aren't cells can be embedded in the instruction stream, as the GC doesn't visit it.
+static bool is_foldable_constant(Value value)
+{
+    return value.is_number() || value.is_boolean() || value.is_nullish();
+}
+
+// Leaves the ToInt32() conversion of numbers that aren't already integers to the runtime.
+static Optional<i32> as_int32(Value value)
+{
+    auto number = value.as_double();
+    if (number < NumericLimits<i32>::min() || number > NumericLimits<i32>::max() || trunc(number) != number)
+        return {};
+    return static_cast<i32>(number);
+}
+
+static Optional<Value> fold_binary_operation(Instruction::Type type, Value lhs, Value rhs)
+{
+    if (type == Instruction::Type::StrictlyEquals)
+        return Value(is_strictly_equal(lhs, rhs));
+    if (type == Instruction::Type::StrictlyInequals)
+        return Value(!is_strictly_equal(lhs, rhs));
+    if (lhs.is_nullish() && rhs.is_nullish()) {
+        if (type == Instruction::Type::LooselyEquals)
+            return Value(true);
+        if (type == Instruction::Type::LooselyInequals)
+            return Value(false);
+    }
+
+    // Everything else converts its operands, which is only free of side effects for numbers.
+    if (!lhs.is_number() || !rhs.is_number())
+        return {};
+
+    auto a = lhs.as_double();
+    auto b = rhs.as_double();
+    switch (type) {
+    case Instruction::Type::Add:
+        return Value(a + b);
+    case Instruction::Type::Sub:
+        return Value(a - b);
+    case Instruction::Type::Mul:
+        return Value(a * b);
+    case Instruction::Type::Div:
+        return Value(a / b);
+    case Instruction::Type::Mod:
+        // fmod() treats NaN, infinities and zeroes just like the % operator does.
+        return Value(fmod(a, b));
+    case Instruction::Type::LessThan:
+        return Value(a < b);
+    case Instruction::Type::LessThanEquals:
+        return Value(a <= b);
+    case Instruction::Type::GreaterThan:
+        return Value(a > b);
+    case Instruction::Type::GreaterThanEquals:
+        return Value(a >= b);
+    case Instruction::Type::LooselyEquals:
+        return Value(a == b);
+    case Instruction::Type::LooselyInequals:
+        return Value(a != b);
+    default:
+        break;
+    }
+
+    auto x_or_empty = as_int32(lhs);
+    auto y_or_empty = as_int32(rhs);
+    if (!x_or_empty.has_value() || !y_or_empty.has_value())
+        return {};
+
+    auto x = *x_or_empty;
+    auto y = *y_or_empty;
+    switch (type) {
+    case Instruction::Type::BitwiseAnd:
+        return Value(x & y);
+    case Instruction::Type::BitwiseOr:
+        return Value(x | y);
+    case Instruction::Type::BitwiseXor:
+        return Value(x ^ y);
+    case Instruction::Type::LeftShift:
+        return Value(static_cast<i32>(static_cast<u32>(x) << (y & 0x1f)));
+    case Instruction::Type::RightShift:
+        return Value(x >> (y & 0x1f));
+    case Instruction::Type::UnsignedRightShift:
+        return Value(static_cast<double>(static_cast<u32>(x) >> (y & 0x1f)));
+    default:
+        return {};
+    }
+}
+
+static Optional<Value> fold_unary_operation(Instruction::Type type, Value value)
+{
+    if (type == Instruction::Type::Not)
+        return Value(!value.to_boolean());
+
+    if (!value.is_number())
+        return {};
+
+    switch (type) {
+    case Instruction::Type::UnaryPlus:
+        return value;
+    case Instruction::Type::UnaryMinus:
+        return Value(-value.as_double());
+    case Instruction::Type::Increment:
+        return Value(value.as_double() + 1);
+    case Instruction::Type::Decrement:
+        return Value(value.as_double() - 1);
+    case Instruction::Type::BitwiseNot:
+        if (auto number = as_int32(value); number.has_value())
+            return Value(~*number);
+        return {};
+    default:
+        return {};
+    }
+}
+
+static bool is_binary_operation(Instruction::Type type)
+{
+    switch (type) {
+#define __BYTECODE_OP(OpTitleCase, op_snake_case) \
+    case Instruction::Type::OpTitleCase:
+        JS_ENUMERATE_COMMON_BINARY_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool is_unary_operation(Instruction::Type type)
+{
+    switch (type) {
+    case Instruction::Type::Not:
+    case Instruction::Type::BitwiseNot:
+    case Instruction::Type::UnaryPlus:
+    case Instruction::Type::UnaryMinus:
+    case Instruction::Type::Increment:
+    case Instruction::Type::Decrement:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static Register binary_operation_lhs(Instruction const& instruction)
+{
+    switch (instruction.type()) {
+#define __BYTECODE_OP(OpTitleCase, op_snake_case) \
+    case Instruction::Type::OpTitleCase:          \
+        return static_cast<Op::OpTitleCase const&>(instruction).lhs();
+        JS_ENUMERATE_COMMON_BINARY_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+static Optional<Label> folded_jump_target(Instruction const& instruction, Value condition)
+{
+    auto& jump = static_cast<Op::Jump const&>(instruction);
+    bool is_taken = false;
+    switch (instruction.type()) {
+    case Instruction::Type::JumpConditional:
+        is_taken = condition.to_boolean();
+        break;
+    case Instruction::Type::JumpNullish:
+        is_taken = condition.is_nullish();
+        break;
+    case Instruction::Type::JumpUndefined:
+        is_taken = condition.is_undefined();
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+    return is_taken ? jump.true_target() : jump.false_target();
+}
+
+static void fold_constants(BasicBlock& block)
+{
+    // What we know about the values of the accumulator and registers at the current instruction.
+    Optional<Value> accumulator;
+    HashMap<u32, Value> registers;
+
+    auto replace_with_load_immediate = [&](size_t offset, Value value) {
+        if (auto* slot = block.replace_instruction(offset, sizeof(Op::LoadImmediate)))
+            new (slot) Op::LoadImmediate(value);
+    };
+
+    size_t offset = 0;
+    while (offset < block.size()) {
+        auto& instruction = *reinterpret_cast<Instruction*>(const_cast<u8*>(block.instruction_stream().data()) + offset);
+        auto type = instruction.type();
+
+        if (type == Instruction::Type::LoadImmediate) {
+            auto value = static_cast<Op::LoadImmediate const&>(instruction).value();
+            accumulator = is_foldable_constant(value) ? value : Optional<Value> {};
+        } else if (type == Instruction::Type::Load) {
+            auto src = static_cast<Op::Load const&>(instruction).src();
+            accumulator = registers.get(src.index());
+            if (accumulator.has_value())
+                replace_with_load_immediate(offset, *accumulator);
+        } else if (type == Instruction::Type::Store) {
+            auto dst = static_cast<Op::Store const&>(instruction).dst();
+            if (accumulator.has_value())
+                registers.set(dst.index(), *accumulator);
+            else
+                registers.remove(dst.index());
+        } else if (is_binary_operation(type)) {
+            auto lhs = registers.get(binary_operation_lhs(instruction).index());
+            Optional<Value> result;
+            if (lhs.has_value() && accumulator.has_value())
+                result = fold_binary_operation(type, *lhs, *accumulator);
+            accumulator = result;
+            if (result.has_value())
+                replace_with_load_immediate(offset, *result);
+        } else if (is_unary_operation(type)) {
+            Optional<Value> result;
+            if (accumulator.has_value())
+                result = fold_unary_operation(type, *accumulator);
+            accumulator = result;
+            if (result.has_value())
+                replace_with_load_immediate(offset, *result);
+        } else if (type == Instruction::Type::JumpConditional || type == Instruction::Type::JumpNullish || type == Instruction::Type::JumpUndefined) {
+            if (accumulator.has_value()) {
+                auto target = folded_jump_target(instruction, *accumulator);
+                // All the jumps have the same size, so this always fits.
+                new (block.replace_instruction(offset, sizeof(Op::Jump))) Op::Jump(move(target));
+            }
+        } else {
+            accumulator = {};
+            instruction.visit_registers([&](Register& reg, Instruction::RegisterAccess access) {
+                if (access != Instruction::RegisterAccess::Read)
+                    registers.remove(reg.index());
+            });
+        }
+
+        // A replacement may have a different length, so look the instruction up again.
+        offset += reinterpret_cast<Instruction const*>(block.instruction_stream().data() + offset)->length();
+    }
+}
+
+void FoldConstants::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    for (auto& block : executable.executable.basic_blocks)
+        fold_constants(block);
+
+    finished();
+}
+
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+void GenerateLiveness::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    struct BlockInfo {
+        // Registers read before they are written in the block, and registers written in it.
+        HashTable<u32> used;
+        HashTable<u32> defined;
+        Vector<BasicBlock const*> successors;
+        HashTable<u32> live_at_entry;
+        HashTable<u32> live_at_exit;
+    };
+
+    HashMap<BasicBlock const*, BlockInfo> infos;
+    HashTable<BasicBlock const*> jump_targets;
+    HashTable<BasicBlock const*> unwind_targets;
+
+    for (auto& block : executable.executable.basic_blocks) {
+        auto& info = infos.ensure(&block);
+        auto add_successor = [&](BasicBlock const& successor) {
+            info.successors.append(&successor);
+            jump_targets.set(&successor);
+        };
+
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            auto& instruction = const_cast<Instruction&>(*it);
+            instruction.visit_registers([&](Register& reg, Instruction::RegisterAccess access) {
+                if (reg.index() == Register::accumulator_index)
+                    return;
+                if (access != Instruction::RegisterAccess::Write && !info.defined.contains(reg.index()))
+                    info.used.set(reg.index());
+                if (access != Instruction::RegisterAccess::Read)
+                    info.defined.set(reg.index());
+            });
+
+            switch (instruction.type()) {
+            case Instruction::Type::Jump:
+            case Instruction::Type::JumpConditional:
+            case Instruction::Type::JumpNullish:
+            case Instruction::Type::JumpUndefined: {
+                auto& jump = static_cast<Op::Jump const&>(instruction);
+                if (jump.true_target().has_value())
+                    add_successor(jump.true_target()->block());
+                if (jump.false_target().has_value())
+                    add_successor(jump.false_target()->block());
+                break;
+            }
+            case Instruction::Type::EnterUnwindContext: {
+                auto& enter = static_cast<Op::EnterUnwindContext const&>(instruction);
+                add_successor(enter.entry_point().block());
+                if (enter.handler_target().has_value()) {
+                    add_successor(enter.handler_target()->block());
+                    unwind_targets.set(&enter.handler_target()->block());
+                }
+                if (enter.finalizer_target().has_value()) {
+                    add_successor(enter.finalizer_target()->block());
+                    unwind_targets.set(&enter.finalizer_target()->block());
+                }
+                break;
+            }
+            case Instruction::Type::FinishUnwind:
+                add_successor(static_cast<Op::FinishUnwind const&>(instruction).next_target().block());
+                break;
+            case Instruction::Type::ContinuePendingUnwind:
+                add_successor(static_cast<Op::ContinuePendingUnwind const&>(instruction).resume_target().block());
+                break;
+            case Instruction::Type::Yield:
+                if (auto& continuation = static_cast<Op::Yield const&>(instruction).continuation(); continuation.has_value())
+                    add_successor(continuation->block());
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    // Iterate backwards until nothing changes, since liveness flows from successors to predecessors.
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = executable.executable.basic_blocks.size(); i > 0; --i) {
+            auto& info = infos.find(&executable.executable.basic_blocks[i - 1])->value;
+            for (auto* successor : info.successors) {
+                for (auto reg : infos.find(successor)->value.live_at_entry) {
+                    if (info.live_at_exit.set(reg) != AK::HashSetResult::InsertedNewEntry)
+                        continue;
+                    if (!info.defined.contains(reg))
+                        info.live_at_entry.set(reg);
+                    changed = true;
+                }
+            }
+            for (auto reg : info.used) {
+                if (info.live_at_entry.set(reg) == AK::HashSetResult::InsertedNewEntry)
+                    changed = true;
+            }
+        }
+    }
+
+    // An exception can get to the handler or finalizer of an unwind context from any instruction inside of it, and
+    // those edges aren't tracked. Registers that could be read before they're written when entering the executable,
+    // or a block that nothing jumps to, have unknown values too. Keep all of these alive everywhere.
+    HashTable<u32> registers_live_everywhere;
+    for (auto& block : executable.executable.basic_blocks) {
+        bool is_entry = &block == &executable.executable.basic_blocks.first();
+        if (!is_entry && jump_targets.contains(&block) && !unwind_targets.contains(&block))
+            continue;
+        for (auto reg : infos.find(&block)->value.live_at_entry)
+            registers_live_everywhere.set(reg);
+    }
+
+    HashMap<BasicBlock const*, HashTable<u32>> live_registers_at_exit;
+    for (auto& entry : infos)
+        live_registers_at_exit.set(entry.key, move(entry.value.live_at_exit));
+
+    executable.live_registers_at_exit = move(live_registers_at_exit);
+    executable.registers_live_everywhere = move(registers_live_everywhere);
+
+    finished();
+}
+
+}
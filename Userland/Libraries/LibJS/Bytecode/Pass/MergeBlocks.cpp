@@ -110,19 +110,25 @@ void MergeBlocks::perform(PassPipelineExecutable& executable)
             blocks_to_merge.remove(it);
         }
 
-        auto blocks_to_merge_copy = blocks_to_merge;
-        for (auto& last : blocks_to_merge) {
-            auto entry = cfg.find(last);
-            if (entry == cfg.end())
-                continue;
-            auto successor = *entry->value.begin();
-            if (auto it = successors.find(successor); !it.is_end()) {
-                successors.insert(it.index(), last);
-                blocks_to_merge_copy.remove(last);
+        // Pull in the blocks that lead into the chain as well. A block that was just pulled in can have predecessors
+        // that we have already looked at, so keep going until nothing changes, as they'd get merged twice otherwise.
+        for (bool changed = true; changed;) {
+            changed = false;
+            auto blocks_to_merge_copy = blocks_to_merge;
+            for (auto& last : blocks_to_merge) {
+                auto entry = cfg.find(last);
+                if (entry == cfg.end())
+                    continue;
+                auto successor = *entry->value.begin();
+                if (auto it = successors.find(successor); !it.is_end()) {
+                    successors.insert(it.index(), last);
+                    blocks_to_merge_copy.remove(last);
+                    changed = true;
+                }
             }
-        }
 
-        blocks_to_merge = move(blocks_to_merge_copy);
+            blocks_to_merge = move(blocks_to_merge_copy);
+        }
 
         size_t size = 0;
         StringBuilder builder;
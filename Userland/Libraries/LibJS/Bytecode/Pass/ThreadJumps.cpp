@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+static bool is_conditional_jump(Instruction::Type type)
+{
+    return type == Instruction::Type::JumpConditional || type == Instruction::Type::JumpNullish || type == Instruction::Type::JumpUndefined;
+}
+
+// The jump that makes up the whole block, if that's all there is to it.
+static Op::Jump const* only_jump_in(BasicBlock const& block)
+{
+    if (block.size() != sizeof(Op::Jump))
+        return nullptr;
+    auto& instruction = *InstructionStreamIterator { block.instruction_stream() };
+    if (instruction.type() != Instruction::Type::Jump && !is_conditional_jump(instruction.type()))
+        return nullptr;
+    return &static_cast<Op::Jump const&>(instruction);
+}
+
+// The value that the accumulator is known to have at the end of the block.
+static Optional<Value> constant_accumulator_at_end_of(BasicBlock const& block)
+{
+    Optional<Value> accumulator;
+    for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+        auto& instruction = *it;
+        if (instruction.type() == Instruction::Type::LoadImmediate) {
+            auto value = static_cast<Op::LoadImmediate const&>(instruction).value();
+            accumulator = value.is_empty() ? Optional<Value> {} : value;
+        } else if (instruction.type() != Instruction::Type::Store && !instruction.is_terminator()) {
+            accumulator = {};
+        }
+    }
+    return accumulator;
+}
+
+static BasicBlock const& thread(BasicBlock const& target, Optional<Value> const& accumulator, size_t max_steps)
+{
+    auto* current = &target;
+    for (size_t step = 0; step < max_steps; ++step) {
+        auto* jump = only_jump_in(*current);
+        if (!jump)
+            break;
+
+        Optional<Label> next;
+        if (jump->type() == Instruction::Type::Jump) {
+            next = jump->true_target();
+        } else if (accumulator.has_value()) {
+            bool is_taken = false;
+            if (jump->type() == Instruction::Type::JumpConditional)
+                is_taken = accumulator->to_boolean();
+            else if (jump->type() == Instruction::Type::JumpNullish)
+                is_taken = accumulator->is_nullish();
+            else
+                is_taken = accumulator->is_undefined();
+            next = is_taken ? jump->true_target() : jump->false_target();
+        }
+
+        if (!next.has_value() || &next->block() == current)
+            break;
+        current = &next->block();
+    }
+    return *current;
+}
+
+void ThreadJumps::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    // Following the jumps can't take more steps than there are blocks, unless they loop forever.
+    auto max_steps = executable.executable.basic_blocks.size();
+
+    for (auto& block : executable.executable.basic_blocks) {
+        Instruction const* terminator = nullptr;
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it)
+            terminator = &*it;
+        if (!terminator || (terminator->type() != Instruction::Type::Jump && !is_conditional_jump(terminator->type())))
+            continue;
+
+        auto& jump = const_cast<Op::Jump&>(static_cast<Op::Jump const&>(*terminator));
+        // Conditional jumps only get here when the accumulator isn't known, as FoldConstants folds them otherwise.
+        Optional<Value> accumulator;
+        if (jump.type() == Instruction::Type::Jump)
+            accumulator = constant_accumulator_at_end_of(block);
+
+        auto thread_target = [&](Optional<Label> const& target) -> Optional<Label> {
+            if (!target.has_value())
+                return {};
+            return Label { thread(target->block(), accumulator, max_steps) };
+        };
+        jump.set_targets(thread_target(jump.true_target()), thread_target(jump.false_target()));
+    }
+
+    finished();
+}
+
+}
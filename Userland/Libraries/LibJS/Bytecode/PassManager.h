@@ -18,14 +18,22 @@ struct PassPipelineExecutable {
     Optional<HashMap<BasicBlock const*, HashTable<BasicBlock const*>>> cfg {};
     Optional<HashMap<BasicBlock const*, HashTable<BasicBlock const*>>> inverted_cfg {};
     Optional<HashTable<BasicBlock const*>> exported_blocks {};
+    // The indices of the registers that are live when leaving each block, not counting the accumulator.
+    Optional<HashMap<BasicBlock const*, HashTable<u32>>> live_registers_at_exit {};
+    // Registers that have to be assumed live at every instruction, like the ones that an exception handler reads.
+    Optional<HashTable<u32>> registers_live_everywhere {};
 };
 
+extern bool g_dump_pass_statistics;
+
 class Pass {
 public:
     Pass() = default;
     virtual ~Pass() = default;
 
     virtual void perform(PassPipelineExecutable&) = 0;
+    virtual StringView name() const = 0;
+
     void started()
     {
         gettimeofday(&m_start_time, nullptr);
@@ -74,12 +82,34 @@ public:
     virtual void perform(PassPipelineExecutable& executable) override
     {
         started();
-        for (auto& pass : m_passes)
+        if (g_dump_pass_statistics)
+            warnln("Optimizing {} ({} instructions, {} registers):", executable.executable.name, instruction_count(executable.executable), executable.executable.number_of_registers);
+        for (auto& pass : m_passes) {
+            auto instructions_before = g_dump_pass_statistics ? instruction_count(executable.executable) : 0;
+            auto registers_before = executable.executable.number_of_registers;
             pass.perform(executable);
+            if (g_dump_pass_statistics) {
+                warnln("    {:20} {:6} -> {:6} instructions, {:4} -> {:4} registers, {}us",
+                    pass.name(), instructions_before, instruction_count(executable.executable),
+                    registers_before, executable.executable.number_of_registers, pass.elapsed());
+            }
+        }
         finished();
     }
 
+    virtual StringView name() const override { return "PassManager"sv; }
+
 private:
+    static size_t instruction_count(Executable const& executable)
+    {
+        size_t count = 0;
+        for (auto& block : executable.basic_blocks) {
+            for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it)
+                ++count;
+        }
+        return count;
+    }
+
     NonnullOwnPtrVector<Pass> m_passes;
 };
 
@@ -90,6 +120,8 @@ public:
     GenerateCFG() = default;
     ~GenerateCFG() override = default;
 
+    virtual StringView name() const override { return "GenerateCFG"sv; }
+
 private:
     virtual void perform(PassPipelineExecutable&) override;
 };
@@ -99,6 +131,8 @@ public:
     MergeBlocks() = default;
     ~MergeBlocks() override = default;
 
+    virtual StringView name() const override { return "MergeBlocks"sv; }
+
 private:
     virtual void perform(PassPipelineExecutable&) override;
 };
@@ -108,6 +142,8 @@ public:
     PlaceBlocks() = default;
     ~PlaceBlocks() override = default;
 
+    virtual StringView name() const override { return "PlaceBlocks"sv; }
+
 private:
     virtual void perform(PassPipelineExecutable&) override;
 };
@@ -117,6 +153,68 @@ public:
     UnifySameBlocks() = default;
     ~UnifySameBlocks() override = default;
 
+    virtual StringView name() const override { return "UnifySameBlocks"sv; }
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Evaluates arithmetic, comparisons and conditional jumps on constants that are known within a block.
+class FoldConstants : public Pass {
+public:
+    FoldConstants() = default;
+    ~FoldConstants() override = default;
+
+    virtual StringView name() const override { return "FoldConstants"sv; }
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Makes jumps skip blocks that do nothing but branch on a constant that is already known at the jump.
+class ThreadJumps : public Pass {
+public:
+    ThreadJumps() = default;
+    ~ThreadJumps() override = default;
+
+    virtual StringView name() const override { return "ThreadJumps"sv; }
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Computes which registers are live at the end of each block, for the passes below.
+class GenerateLiveness : public Pass {
+public:
+    GenerateLiveness() = default;
+    ~GenerateLiveness() override = default;
+
+    virtual StringView name() const override { return "GenerateLiveness"sv; }
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Removes stores to registers that are never read, and loads into the accumulator that are never used.
+class EliminateDeadStores : public Pass {
+public:
+    EliminateDeadStores() = default;
+    ~EliminateDeadStores() override = default;
+
+    virtual StringView name() const override { return "EliminateDeadStores"sv; }
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Renames the registers so that ones that are never live at the same time share an index, which shrinks the register file.
+class AllocateRegisters : public Pass {
+public:
+    AllocateRegisters() = default;
+    ~AllocateRegisters() override = default;
+
+    virtual StringView name() const override { return "AllocateRegisters"sv; }
+
 private:
     virtual void perform(PassPipelineExecutable&) override;
 };
@@ -130,6 +228,8 @@ public:
 
     ~DumpCFG() override = default;
 
+    virtual StringView name() const override { return "DumpCFG"sv; }
+
 private:
     virtual void perform(PassPipelineExecutable&) override;
 
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PropertyLookupCache.h>
+#include <LibJS/Runtime/Object.h>
+
+namespace JS::Bytecode {
+
+PropertyLookupCache::Entry const* PropertyLookupCache::find(Object& object, PropertyKey const& property_key) const
+{
+    auto& shape = object.shape();
+    for (auto const& entry : m_entries) {
+        if (entry.shape.ptr() != &shape)
+            continue;
+        // Objects of different classes can share a shape, so this can't be decided once per entry.
+        if (object.may_have_exotic_property(property_key))
+            return nullptr;
+        // The shape isn't unique, so the prototype is still the object that the entry was created for.
+        if (entry.in_prototype && &shape.prototype()->shape() != entry.prototype_shape.ptr())
+            return nullptr;
+        return &entry;
+    }
+    return nullptr;
+}
+
+void PropertyLookupCache::add(Entry entry)
+{
+    for (auto& existing_entry : m_entries) {
+        if (existing_entry.shape.ptr() == entry.shape.ptr()) {
+            existing_entry = move(entry);
+            return;
+        }
+    }
+    m_entries[m_next_entry_index] = move(entry);
+    m_next_entry_index = (m_next_entry_index + 1) % max_entry_count;
+}
+
+Optional<Value> PropertyLookupCache::get(Object& object, PropertyKey const& property_key) const
+{
+    auto const* entry = find(object, property_key);
+    if (!entry)
+        return {};
+    auto& holder = entry->in_prototype ? *object.shape().prototype() : object;
+    auto value = holder.get_direct(entry->property_offset);
+    // A data property can become an accessor without changing its attributes, and therefore without a new shape.
+    if (value.is_accessor())
+        return {};
+    return value;
+}
+
+bool PropertyLookupCache::put(Object& object, PropertyKey const& property_key, Value value)
+{
+    auto const* entry = find(object, property_key);
+    if (!entry || entry->in_prototype || object.get_direct(entry->property_offset).is_accessor())
+        return false;
+    object.put_direct(entry->property_offset, value);
+    return true;
+}
+
+void PropertyLookupCache::update_after_get(Object& object, PropertyKey const& property_key)
+{
+    auto& shape = object.shape();
+    if (!property_key.is_string() || shape.is_unique() || object.may_have_exotic_property(property_key))
+        return;
+
+    auto key = property_key.to_string_or_symbol();
+    if (auto metadata = shape.lookup(key); metadata.has_value()) {
+        if (!object.get_direct(metadata->offset).is_accessor())
+            add({ shape.make_weak_ptr(), {}, metadata->offset, false });
+        return;
+    }
+
+    auto* prototype = shape.prototype();
+    if (!prototype || prototype->shape().is_unique() || prototype->may_have_exotic_property(property_key))
+        return;
+    auto metadata = prototype->shape().lookup(key);
+    if (!metadata.has_value() || prototype->get_direct(metadata->offset).is_accessor())
+        return;
+    add({ shape.make_weak_ptr(), prototype->shape().make_weak_ptr(), metadata->offset, true });
+}
+
+void PropertyLookupCache::update_after_put(Object& object, PropertyKey const& property_key)
+{
+    auto& shape = object.shape();
+    if (!property_key.is_string() || shape.is_unique() || object.may_have_exotic_property(property_key))
+        return;
+
+    auto metadata = shape.lookup(property_key.to_string_or_symbol());
+    if (!metadata.has_value() || !metadata->attributes.is_writable() || object.get_direct(metadata->offset).is_accessor())
+        return;
+    add({ shape.make_weak_ptr(), {}, metadata->offset, false });
+}
+
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Optional.h>
+#include <AK/WeakPtr.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/Shape.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::Bytecode {
+
+// Remembers where a named property was found for the last few shapes of the objects it was looked up on,
+// so that the next lookup on an object with one of those shapes can skip the property table entirely.
+// A property that was found in the object's prototype is only cached as long as the prototype keeps its shape.
+// Unique shapes are never cached, as their property table can change without the object getting a new shape.
+class PropertyLookupCache {
+public:
+    Optional<Value> get(Object&, PropertyKey const&) const;
+    bool put(Object&, PropertyKey const&, Value);
+
+    void update_after_get(Object&, PropertyKey const&);
+    void update_after_put(Object&, PropertyKey const&);
+
+private:
+    static constexpr size_t max_entry_count = 4;
+
+    struct Entry {
+        WeakPtr<Shape> shape;
+        WeakPtr<Shape> prototype_shape;
+        u32 property_offset { 0 };
+        bool in_prototype { false };
+    };
+
+    Entry const* find(Object&, PropertyKey const&) const;
+    void add(Entry);
+
+    AK::Array<Entry, max_entry_count> m_entries;
+    size_t m_next_entry_index { 0 };
+};
+
+}
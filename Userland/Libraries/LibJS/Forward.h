@@ -287,4 +287,8 @@ class Interpreter;
 class Register;
 }
 
+namespace JIT {
+class NativeBlock;
+}
+
 }
@@ -14,13 +14,64 @@
 
 namespace JS {
 
-#define JS_CELL(class_, base_class)                \
-public:                                            \
-    using Base = base_class;                       \
-    virtual StringView class_name() const override \
-    {                                              \
-        return #class_##sv;                        \
-    }                                              \
+// Cell classes whose every store of a pointer to another cell is followed by Cell::write_barrier().
+// This is deliberately not inherited, since subclasses usually bring pointer members of their own.
+template<typename T>
+inline constexpr bool HasWriteBarriers = false;
+
+template<>
+inline constexpr bool HasWriteBarriers<Array> = true;
+template<>
+inline constexpr bool HasWriteBarriers<BigInt> = true;
+template<>
+inline constexpr bool HasWriteBarriers<DeclarativeEnvironment> = true;
+template<>
+inline constexpr bool HasWriteBarriers<Object> = true;
+template<>
+inline constexpr bool HasWriteBarriers<PrimitiveString> = true;
+template<>
+inline constexpr bool HasWriteBarriers<Shape> = true;
+template<>
+inline constexpr bool HasWriteBarriers<Symbol> = true;
+
+// Cell classes whose destructor has no effect that anyone else could observe, e.g. by clearing a WeakPtr,
+// so that they can be destroyed long after a collection has found them to be unreachable.
+// Like HasWriteBarriers, this is deliberately not inherited.
+template<typename T>
+inline constexpr bool CanBeSweptLazily = false;
+
+template<>
+inline constexpr bool CanBeSweptLazily<Array> = true;
+template<>
+inline constexpr bool CanBeSweptLazily<BigInt> = true;
+template<>
+inline constexpr bool CanBeSweptLazily<DeclarativeEnvironment> = true;
+template<>
+inline constexpr bool CanBeSweptLazily<ECMAScriptFunctionObject> = true;
+template<>
+inline constexpr bool CanBeSweptLazily<FunctionEnvironment> = true;
+template<>
+inline constexpr bool CanBeSweptLazily<Object> = true;
+template<>
+inline constexpr bool CanBeSweptLazily<PrimitiveString> = true;
+template<>
+inline constexpr bool CanBeSweptLazily<Symbol> = true;
+
+#define JS_CELL(class_, base_class)                                      \
+public:                                                                  \
+    using Base = base_class;                                             \
+    virtual StringView class_name() const override                       \
+    {                                                                    \
+        return #class_##sv;                                              \
+    }                                                                    \
+    virtual bool has_write_barriers() const override                     \
+    {                                                                    \
+        return JS::HasWriteBarriers<RemoveCVReference<decltype(*this)>>; \
+    }                                                                    \
+    virtual bool can_be_swept_lazily() const override                    \
+    {                                                                    \
+        return JS::CanBeSweptLazily<RemoveCVReference<decltype(*this)>>; \
+    }                                                                    \
     friend class JS::Heap;
 
 class Cell {
@@ -42,6 +93,26 @@ public:
     State state() const { return m_state; }
     void set_state(State state) { m_state = state; }
 
+    // Cells that survived a garbage collection belong to the old generation. Young collections
+    // only trace old cells that are remembered, i.e. that may point to young cells.
+    bool is_old() const { return m_old; }
+    void set_old(bool b) { m_old = b; }
+
+    bool is_remembered() const { return m_remembered; }
+    void set_remembered(bool b) { m_remembered = b; }
+
+    // Must be called right after storing a pointer to another cell into a cell, with no allocation
+    // in between, unless the cell is still being constructed. Old cells of classes that don't have
+    // write barriers (see HasWriteBarriers) are always remembered instead.
+    ALWAYS_INLINE void write_barrier()
+    {
+        if (m_old && !m_remembered) [[unlikely]]
+            remember();
+    }
+
+    virtual bool has_write_barriers() const { return false; }
+    virtual bool can_be_swept_lazily() const { return false; }
+
     virtual StringView class_name() const = 0;
 
     class Visitor {
@@ -72,8 +143,12 @@ protected:
     Cell() = default;
 
 private:
+    void remember();
+
     bool m_mark : 1 { false };
-    State m_state : 7 { State::Live };
+    bool m_old : 1 { false };
+    bool m_remembered : 1 { false };
+    State m_state : 5 { State::Live };
 };
 
 }
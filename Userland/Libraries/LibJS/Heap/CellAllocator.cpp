@@ -19,6 +19,9 @@ CellAllocator::CellAllocator(size_t cell_size)
 
 Cell* CellAllocator::allocate_cell(Heap& heap)
 {
+    if (m_usable_blocks.is_empty())
+        heap.sweep_lazily({}, *this);
+
     if (m_usable_blocks.is_empty()) {
         auto block = HeapBlock::create_with_cell_size(heap, m_cell_size);
         m_usable_blocks.append(*block.leak_ptr());
@@ -32,6 +35,24 @@ Cell* CellAllocator::allocate_cell(Heap& heap)
     return cell;
 }
 
+void CellAllocator::queue_blocks_for_sweeping(Badge<Heap>, bool only_blocks_with_young_cells, Vector<HeapBlock*, 32>& blocks_to_sweep_now)
+{
+    auto queue_blocks = [&](BlockList& blocks) {
+        for (auto it = blocks.begin(); it != blocks.end();) {
+            auto& block = *it;
+            ++it;
+            if (only_blocks_with_young_cells && !block.has_young_cells())
+                continue;
+            block.set_has_young_cells(false);
+            m_unswept_blocks.append(block);
+            if (block.must_be_swept_eagerly())
+                blocks_to_sweep_now.append(&block);
+        }
+    };
+    queue_blocks(m_full_blocks);
+    queue_blocks(m_usable_blocks);
+}
+
 void CellAllocator::block_did_become_empty(Badge<Heap>, HeapBlock& block)
 {
     auto& heap = block.heap();
@@ -41,10 +62,13 @@ void CellAllocator::block_did_become_empty(Badge<Heap>, HeapBlock& block)
     heap.block_allocator().deallocate_block(&block);
 }
 
-void CellAllocator::block_did_become_usable(Badge<Heap>, HeapBlock& block)
+void CellAllocator::block_was_swept(Badge<Heap>, HeapBlock& block)
 {
-    VERIFY(!block.is_full());
-    m_usable_blocks.append(block);
+    VERIFY(m_unswept_blocks.contains(block));
+    if (block.is_full())
+        m_full_blocks.append(block);
+    else
+        m_usable_blocks.append(block);
 }
 
 }
@@ -8,6 +8,7 @@
 
 #include <AK/IntrusiveList.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/Vector.h>
 #include <LibJS/Forward.h>
 #include <LibJS/Heap/HeapBlock.h>
 
@@ -33,11 +34,19 @@ public:
             if (callback(block) == IterationDecision::Break)
                 return IterationDecision::Break;
         }
+        for (auto& block : m_unswept_blocks) {
+            if (callback(block) == IterationDecision::Break)
+                return IterationDecision::Break;
+        }
         return IterationDecision::Continue;
     }
 
+    bool has_usable_blocks() const { return !m_usable_blocks.is_empty(); }
+    HeapBlock* first_unswept_block() const { return m_unswept_blocks.first(); }
+
+    void queue_blocks_for_sweeping(Badge<Heap>, bool only_blocks_with_young_cells, Vector<HeapBlock*, 32>& blocks_to_sweep_now);
     void block_did_become_empty(Badge<Heap>, HeapBlock&);
-    void block_did_become_usable(Badge<Heap>, HeapBlock&);
+    void block_was_swept(Badge<Heap>, HeapBlock&);
 
 private:
     const size_t m_cell_size;
@@ -45,6 +54,8 @@ private:
     using BlockList = IntrusiveList<&HeapBlock::m_list_node>;
     BlockList m_full_blocks;
     BlockList m_usable_blocks;
+    // Blocks that may contain garbage from the last collection. They are swept once we run out of usable blocks.
+    BlockList m_unswept_blocks;
 };
 
 }
@@ -5,6 +5,7 @@
  */
 
 #include <AK/Badge.h>
+#include <AK/BuiltinWrappers.h>
 #include <AK/Debug.h>
 #include <AK/HashTable.h>
 #include <AK/StackInfo.h>
@@ -16,6 +17,7 @@
 #include <LibJS/Heap/HeapBlock.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/PrimitiveString.h>
 #include <LibJS/Runtime/WeakContainer.h>
 #include <setjmp.h>
 
@@ -70,10 +72,10 @@ ALWAYS_INLINE CellAllocator& Heap::allocator_for_size(size_t cell_size)
 Cell* Heap::allocate_cell(size_t size)
 {
     if (should_collect_on_every_allocation()) {
-        collect_garbage();
+        collect_garbage(CollectionType::CollectYoungGarbage);
     } else if (m_allocations_since_last_gc > m_max_allocations_between_gc) {
         m_allocations_since_last_gc = 0;
-        collect_garbage();
+        collect_garbage(CollectionType::CollectYoungGarbage);
     } else {
         ++m_allocations_since_last_gc;
     }
@@ -82,6 +84,13 @@ Cell* Heap::allocate_cell(size_t size)
     return allocator.allocate_cell(*this);
 }
 
+static size_t pause_time_bucket(i64 pause_us, size_t bucket_count)
+{
+    if (pause_us <= 0)
+        return 0;
+    return min<size_t>(sizeof(u64) * 8 - count_leading_zeroes(static_cast<u64>(pause_us)), bucket_count - 1);
+}
+
 void Heap::collect_garbage(CollectionType collection_type, bool print_report)
 {
     VERIFY(!m_collecting_garbage);
@@ -92,17 +101,85 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
     perf_event(PERF_EVENT_SIGNPOST, gc_perf_string_id, global_gc_counter++);
 #endif
 
-    auto collection_measurement_timer = Core::ElapsedTimer::start_new();
-    if (collection_type == CollectionType::CollectGarbage) {
-        if (m_gc_deferrals) {
-            m_should_gc_when_deferral_ends = true;
-            return;
-        }
+    Core::ElapsedTimer collection_measurement_timer { true };
+    collection_measurement_timer.start();
+
+    // Once the old generation has doubled in size, it's time to find out how much of it is still alive.
+    if (collection_type == CollectionType::CollectYoungGarbage && m_old_cell_count > max(2 * m_old_cell_count_after_last_full_collection, m_max_allocations_between_gc))
+        collection_type = CollectionType::CollectGarbage;
+
+    if (collection_type != CollectionType::CollectEverything && m_gc_deferrals) {
+        // A full collection that was asked for must not turn into a young one once the deferral ends.
+        if (!m_should_gc_when_deferral_ends || collection_type == CollectionType::CollectGarbage)
+            m_collection_type_when_deferral_ends = collection_type;
+        m_should_gc_when_deferral_ends = true;
+        return;
+    }
+
+    // Live cells can only be told apart from the garbage of the previous collection once that has been swept.
+    finish_sweeping();
+    m_last_collection_type = collection_type;
+    m_collected_cell_count = 0;
+    m_collected_cell_bytes = 0;
+    m_freed_block_count = 0;
+
+    size_t surviving_cell_count = 0;
+    if (collection_type != CollectionType::CollectEverything) {
         HashTable<Cell*> roots;
         gather_roots(roots);
-        mark_live_cells(roots);
+        if (collection_type == CollectionType::CollectYoungGarbage)
+            surviving_cell_count = mark_live_young_cells(roots);
+        else
+            surviving_cell_count = mark_live_cells(roots);
+    }
+
+    if (collection_type == CollectionType::CollectYoungGarbage) {
+        // All young cells that remembered cells pointed to are old now.
+        m_remembered_cells.remove_all_matching([](Cell* cell) {
+            if (!cell->has_write_barriers())
+                return false;
+            cell->set_remembered(false);
+            return true;
+        });
+        m_old_cell_count += surviving_cell_count;
+    } else {
+        m_old_cell_count = surviving_cell_count;
+        m_old_cell_count_after_last_full_collection = surviving_cell_count;
     }
-    sweep_dead_cells(print_report, collection_measurement_timer);
+
+    // Weak containers that are garbage themselves haven't been destroyed yet, and a WeakRef among them
+    // may deregister itself while we're iterating.
+    for (auto it = m_weak_containers.begin(); it != m_weak_containers.end();) {
+        auto& weak_container = *it;
+        ++it;
+        weak_container.remove_dead_cells({});
+    }
+
+    vm().string_cache().remove_all_matching([&](auto&, PrimitiveString* string) {
+        return !did_survive_collection(*string);
+    });
+
+    // Most garbage is swept a block at a time whenever a CellAllocator runs out of space, so that the pause
+    // mostly depends on the amount of live cells. Blocks that nothing has been allocated from since the last
+    // collection contain only old cells, which a young collection can't have found to be garbage.
+    if (collection_type == CollectionType::CollectEverything) {
+        destroy_all_cells();
+    } else {
+        Vector<HeapBlock*, 32> blocks_to_sweep_now;
+        for (auto& allocator : m_allocators)
+            allocator->queue_blocks_for_sweeping({}, collection_type == CollectionType::CollectYoungGarbage, blocks_to_sweep_now);
+        for (auto* block : blocks_to_sweep_now)
+            sweep_block(*block);
+    }
+
+    auto time_spent_us = collection_measurement_timer.elapsed_time().to_microseconds();
+    if (collection_type == CollectionType::CollectYoungGarbage)
+        ++m_young_pause_time_histogram[pause_time_bucket(time_spent_us, pause_time_bucket_count)];
+    else if (collection_type == CollectionType::CollectGarbage)
+        ++m_full_pause_time_histogram[pause_time_bucket(time_spent_us, pause_time_bucket_count)];
+
+    if (print_report)
+        print_collection_report(surviving_cell_count, time_spent_us);
 }
 
 void Heap::gather_roots(HashTable<Cell*>& roots)
@@ -188,9 +265,24 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
     }
 }
 
+// Survivors are promoted while marking rather than while sweeping, since stores into cells whose
+// block hasn't been swept yet have to go through the write barriers as well. Old cells whose stores
+// aren't covered by write barriers have to be traced by every young collection.
+static void promote(Cell& cell, Vector<Cell*>& remembered_cells)
+{
+    cell.set_old(true);
+    if (!cell.has_write_barriers() && !cell.is_remembered()) {
+        cell.set_remembered(true);
+        remembered_cells.append(&cell);
+    }
+}
+
 class MarkingVisitor final : public Cell::Visitor {
 public:
-    MarkingVisitor() = default;
+    explicit MarkingVisitor(Vector<Cell*>& remembered_cells)
+        : m_remembered_cells(remembered_cells)
+    {
+    }
 
     virtual void visit_impl(Cell& cell) override
     {
@@ -199,70 +291,238 @@ public:
         dbgln_if(HEAP_DEBUG, "  ! {}", &cell);
 
         cell.set_marked(true);
+        promote(cell, m_remembered_cells);
+        ++m_marked_cell_count;
         cell.visit_edges(*this);
     }
+
+    size_t marked_cell_count() const { return m_marked_cell_count; }
+
+private:
+    Vector<Cell*>& m_remembered_cells;
+    size_t m_marked_cell_count { 0 };
 };
 
-void Heap::mark_live_cells(HashTable<Cell*> const& roots)
+size_t Heap::mark_live_cells(HashTable<Cell*> const& roots)
 {
     dbgln_if(HEAP_DEBUG, "mark_live_cells:");
 
-    MarkingVisitor visitor;
+    // A full collection finds all old cells that are still alive, so it rebuilds the remembered set from scratch.
+    for (auto* cell : m_remembered_cells)
+        cell->set_remembered(false);
+    m_remembered_cells.clear_with_capacity();
+
+    MarkingVisitor visitor(m_remembered_cells);
     for (auto* root : roots)
         visitor.visit(root);
 
-    for (auto& inverse_root : m_uprooted_cells)
+    size_t live_cell_count = visitor.marked_cell_count();
+    for (auto& inverse_root : m_uprooted_cells) {
+        if (!inverse_root->is_marked())
+            continue;
         inverse_root->set_marked(false);
+        forget(*inverse_root);
+        --live_cell_count;
+    }
 
     m_uprooted_cells.clear();
+    return live_cell_count;
 }
 
-void Heap::sweep_dead_cells(bool print_report, Core::ElapsedTimer const& measurement_timer)
+class YoungMarkingVisitor final : public Cell::Visitor {
+public:
+    explicit YoungMarkingVisitor(Vector<Cell*>& remembered_cells)
+        : m_remembered_cells(remembered_cells)
+    {
+    }
+
+    virtual void visit_impl(Cell& cell) override
+    {
+        if (cell.is_old())
+            return;
+        dbgln_if(HEAP_DEBUG, "  ! {}", &cell);
+
+        promote(cell, m_remembered_cells);
+        ++m_promoted_cell_count;
+        cell.visit_edges(*this);
+    }
+
+    size_t promoted_cell_count() const { return m_promoted_cell_count; }
+
+private:
+    Vector<Cell*>& m_remembered_cells;
+    size_t m_promoted_cell_count { 0 };
+};
+
+size_t Heap::mark_live_young_cells(HashTable<Cell*> const& roots)
 {
-    dbgln_if(HEAP_DEBUG, "sweep_dead_cells:");
-    Vector<HeapBlock*, 32> empty_blocks;
-    Vector<HeapBlock*, 32> full_blocks_that_became_usable;
+    dbgln_if(HEAP_DEBUG, "mark_live_young_cells:");
+
+    // Marking promotes uprooted cells like all others, so we have to know which ones were young before.
+    // Old ones can only be collected by the next full collection.
+    Vector<Cell*> young_uprooted_cells;
+    m_uprooted_cells.remove_all_matching([&](Cell* cell) {
+        if (cell->is_old())
+            return false;
+        young_uprooted_cells.append(cell);
+        return true;
+    });
+
+    YoungMarkingVisitor visitor(m_remembered_cells);
+    for (auto* root : roots) {
+        if (!root)
+            continue;
+        // Old roots may be cells that are still being constructed, and constructors don't use write barriers.
+        if (root->is_old())
+            root->visit_edges(visitor);
+        else
+            visitor.visit(root);
+    }
 
-    size_t collected_cells = 0;
-    size_t live_cells = 0;
-    size_t collected_cell_bytes = 0;
-    size_t live_cell_bytes = 0;
+    // Promoting cells may append to the remembered set, but those cells have just been visited anyway.
+    auto remembered_cell_count = m_remembered_cells.size();
+    for (size_t i = 0; i < remembered_cell_count; ++i)
+        m_remembered_cells[i]->visit_edges(visitor);
 
+    size_t promoted_cell_count = visitor.promoted_cell_count();
+    for (auto* inverse_root : young_uprooted_cells) {
+        if (!inverse_root->is_old())
+            continue;
+        inverse_root->set_old(false);
+        forget(*inverse_root);
+        --promoted_cell_count;
+    }
+
+    return promoted_cell_count;
+}
+
+void Heap::forget(Cell& cell)
+{
+    if (!cell.is_remembered())
+        return;
+    cell.set_remembered(false);
+    m_remembered_cells.remove_first_matching([&](Cell* remembered_cell) { return remembered_cell == &cell; });
+}
+
+bool Heap::did_survive_collection(Cell const& cell) const
+{
+    if (cell.state() != Cell::State::Live)
+        return false;
+    if (m_last_collection_type == CollectionType::CollectYoungGarbage)
+        return cell.is_old();
+    return cell.is_marked();
+}
+
+// Returns whether the block was empty afterwards and has been given back to the BlockAllocator.
+bool Heap::sweep_block(HeapBlock& block)
+{
+    dbgln_if(HEAP_DEBUG, "sweep_block: {}", &block);
+    bool block_has_live_cells = false;
+    bool must_be_swept_eagerly = false;
+    block.template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
+        if (!did_survive_collection(*cell)) {
+            dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
+            block.deallocate(cell);
+            ++m_collected_cell_count;
+            m_collected_cell_bytes += block.cell_size();
+            return;
+        }
+        cell->set_marked(false);
+        block_has_live_cells = true;
+        must_be_swept_eagerly |= !cell->can_be_swept_lazily();
+    });
+    block.set_must_be_swept_eagerly(must_be_swept_eagerly);
+
+    auto& allocator = allocator_for_size(block.cell_size());
+    if (!block_has_live_cells) {
+        dbgln_if(HEAP_DEBUG, " - HeapBlock empty @ {}: cell_size={}", &block, block.cell_size());
+        ++m_freed_block_count;
+        allocator.block_did_become_empty({}, block);
+        return true;
+    }
+    allocator.block_was_swept({}, block);
+    return false;
+}
+
+void Heap::sweep_lazily(Badge<CellAllocator>, CellAllocator& allocator)
+{
+    while (!allocator.has_usable_blocks()) {
+        auto* block = allocator.first_unswept_block();
+        if (!block)
+            break;
+        sweep_block(*block);
+    }
+    if (allocator.has_usable_blocks())
+        return;
+
+    // The allocator is about to ask for a new block, so try to give an empty one back to the BlockAllocator first.
+    for (auto& other_allocator : m_allocators) {
+        while (auto* block = other_allocator->first_unswept_block()) {
+            if (sweep_block(*block))
+                return;
+        }
+    }
+}
+
+void Heap::finish_sweeping()
+{
+    for (auto& allocator : m_allocators) {
+        while (auto* block = allocator->first_unswept_block())
+            sweep_block(*block);
+    }
+}
+
+void Heap::destroy_all_cells()
+{
+    Vector<HeapBlock*, 32> blocks;
     for_each_block([&](auto& block) {
-        bool block_has_live_cells = false;
-        bool block_was_full = block.is_full();
-        block.template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
-            if (!cell->is_marked()) {
-                dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
-                block.deallocate(cell);
-                ++collected_cells;
-                collected_cell_bytes += block.cell_size();
-            } else {
-                cell->set_marked(false);
-                block_has_live_cells = true;
-                ++live_cells;
-                live_cell_bytes += block.cell_size();
-            }
-        });
-        if (!block_has_live_cells)
-            empty_blocks.append(&block);
-        else if (block_was_full != block.is_full())
-            full_blocks_that_became_usable.append(&block);
+        blocks.append(&block);
         return IterationDecision::Continue;
     });
 
-    for (auto& weak_container : m_weak_containers)
-        weak_container.remove_dead_cells({});
+    for (auto* block : blocks) {
+        block->template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
+            block->deallocate(cell);
+            ++m_collected_cell_count;
+            m_collected_cell_bytes += block->cell_size();
+        });
+    }
 
-    for (auto* block : empty_blocks) {
-        dbgln_if(HEAP_DEBUG, " - HeapBlock empty @ {}: cell_size={}", block, block->cell_size());
+    // Destructors may still look at cells in other blocks, e.g. to find the Heap of a Handle,
+    // so no block can be given back before all cells have been destroyed.
+    for (auto* block : blocks) {
+        ++m_freed_block_count;
         allocator_for_size(block->cell_size()).block_did_become_empty({}, *block);
     }
+}
 
-    for (auto* block : full_blocks_that_became_usable) {
-        dbgln_if(HEAP_DEBUG, " - HeapBlock usable again @ {}: cell_size={}", block, block->cell_size());
-        allocator_for_size(block->cell_size()).block_did_become_usable({}, *block);
-    }
+void Heap::print_collection_report(size_t surviving_cell_count, i64 time_spent_us)
+{
+    // The numbers are only complete once all the garbage has been swept.
+    finish_sweeping();
+
+    size_t live_block_count = 0;
+    for_each_block([&](auto&) {
+        ++live_block_count;
+        return IterationDecision::Continue;
+    });
+
+    bool is_young_collection = m_last_collection_type == CollectionType::CollectYoungGarbage;
+    dbgln("Garbage collection report");
+    dbgln("=============================================");
+    dbgln("     Collection: {}", is_young_collection ? "Young generation"sv : "Full"sv);
+    dbgln("     Time spent: {} us", time_spent_us);
+    if (is_young_collection)
+        dbgln(" Promoted cells: {}", surviving_cell_count);
+    else
+        dbgln("     Live cells: {}", surviving_cell_count);
+    dbgln("Collected cells: {} ({} bytes)", m_collected_cell_count, m_collected_cell_bytes);
+    dbgln("      Old cells: {} ({} remembered)", m_old_cell_count, m_remembered_cells.size());
+    dbgln("    Live blocks: {} ({} bytes)", live_block_count, live_block_count * HeapBlock::block_size);
+    dbgln("   Freed blocks: {} ({} bytes)", m_freed_block_count, m_freed_block_count * HeapBlock::block_size);
+    dbgln("=============================================");
+    print_pause_time_histograms();
+    dbgln("=============================================");
 
     if constexpr (HEAP_DEBUG) {
         for_each_block([&](auto& block) {
@@ -270,24 +530,18 @@ void Heap::sweep_dead_cells(bool print_report, Core::ElapsedTimer const& measure
             return IterationDecision::Continue;
         });
     }
+}
 
-    int time_spent = measurement_timer.elapsed();
-
-    if (print_report) {
-        size_t live_block_count = 0;
-        for_each_block([&](auto&) {
-            ++live_block_count;
-            return IterationDecision::Continue;
-        });
-
-        dbgln("Garbage collection report");
-        dbgln("=============================================");
-        dbgln("     Time spent: {} ms", time_spent);
-        dbgln("     Live cells: {} ({} bytes)", live_cells, live_cell_bytes);
-        dbgln("Collected cells: {} ({} bytes)", collected_cells, collected_cell_bytes);
-        dbgln("    Live blocks: {} ({} bytes)", live_block_count, live_block_count * HeapBlock::block_size);
-        dbgln("   Freed blocks: {} ({} bytes)", empty_blocks.size(), empty_blocks.size() * HeapBlock::block_size);
-        dbgln("=============================================");
+void Heap::print_pause_time_histograms() const
+{
+    dbgln("    Pause times:      Young       Full");
+    for (size_t i = 0; i < pause_time_bucket_count; ++i) {
+        if (!m_young_pause_time_histogram[i] && !m_full_pause_time_histogram[i])
+            continue;
+        if (i == pause_time_bucket_count - 1)
+            dbgln(" >= {:>8} us: {:>10} {:>10}", 1ull << (i - 1), m_young_pause_time_histogram[i], m_full_pause_time_histogram[i]);
+        else
+            dbgln("  < {:>8} us: {:>10} {:>10}", 1ull << i, m_young_pause_time_histogram[i], m_full_pause_time_histogram[i]);
     }
 }
 
@@ -339,7 +593,7 @@ void Heap::undefer_gc(Badge<DeferGC>)
 
     if (!m_gc_deferrals) {
         if (m_should_gc_when_deferral_ends)
-            collect_garbage();
+            collect_garbage(m_collection_type_when_deferral_ends);
         m_should_gc_when_deferral_ends = false;
     }
 }
@@ -349,4 +603,17 @@ void Heap::uproot_cell(Cell* cell)
     m_uprooted_cells.append(cell);
 }
 
+void Heap::remember(Badge<Cell>, Cell& cell)
+{
+    VERIFY(cell.is_old());
+    VERIFY(!cell.is_remembered());
+    cell.set_remembered(true);
+    m_remembered_cells.append(&cell);
+}
+
+void Cell::remember()
+{
+    heap().remember({}, *this);
+}
+
 }
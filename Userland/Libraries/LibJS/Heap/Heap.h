@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/Badge.h>
 #include <AK/HashTable.h>
 #include <AK/IntrusiveList.h>
@@ -38,7 +39,13 @@ public:
     {
         auto* memory = allocate_cell(sizeof(T));
         new (memory) T(forward<Args>(args)...);
-        return static_cast<T*>(memory);
+        auto* cell = static_cast<T*>(memory);
+        // A collection during construction may have promoted the cell already, after which
+        // its constructor stored pointers into it without a write barrier.
+        cell->write_barrier();
+        if constexpr (!CanBeSweptLazily<T>)
+            HeapBlock::from_cell(cell)->set_must_be_swept_eagerly(true);
+        return cell;
     }
 
     template<typename T, typename... Args>
@@ -48,11 +55,15 @@ public:
         new (memory) T(forward<Args>(args)...);
         auto* cell = static_cast<T*>(memory);
         memory->initialize(realm);
+        cell->write_barrier();
+        if constexpr (!CanBeSweptLazily<T>)
+            HeapBlock::from_cell(cell)->set_must_be_swept_eagerly(true);
         return cell;
     }
 
     enum class CollectionType {
         CollectGarbage,
+        CollectYoungGarbage,
         CollectEverything,
     };
 
@@ -79,13 +90,27 @@ public:
 
     void uproot_cell(Cell* cell);
 
+    void remember(Badge<Cell>, Cell&);
+
+    // Unreachable cells stay in the Live state until their block gets swept, so this is how weak containers
+    // tell whether a cell survived the collection that is running.
+    bool did_survive_collection(Cell const&) const;
+
+    void sweep_lazily(Badge<CellAllocator>, CellAllocator&);
+
 private:
     Cell* allocate_cell(size_t);
 
     void gather_roots(HashTable<Cell*>&);
     void gather_conservative_roots(HashTable<Cell*>&);
-    void mark_live_cells(HashTable<Cell*> const& live_cells);
-    void sweep_dead_cells(bool print_report, Core::ElapsedTimer const&);
+    size_t mark_live_cells(HashTable<Cell*> const& live_cells);
+    size_t mark_live_young_cells(HashTable<Cell*> const& live_cells);
+    void forget(Cell&);
+    bool sweep_block(HeapBlock&);
+    void finish_sweeping();
+    void destroy_all_cells();
+    void print_collection_report(size_t surviving_cell_count, i64 time_spent_us);
+    void print_pause_time_histograms() const;
 
     CellAllocator& allocator_for_size(size_t);
 
@@ -113,10 +138,30 @@ private:
 
     Vector<Cell*> m_uprooted_cells;
 
+    // Old cells that may point to young cells.
+    Vector<Cell*> m_remembered_cells;
+
+    // Decides which of the cells in the blocks that haven't been swept yet are garbage.
+    CollectionType m_last_collection_type { CollectionType::CollectGarbage };
+
+    size_t m_old_cell_count { 0 };
+    size_t m_old_cell_count_after_last_full_collection { 0 };
+
+    // Bucket 0 counts pauses shorter than a microsecond, bucket N pauses of [2^(N-1), 2^N) microseconds.
+    static constexpr size_t pause_time_bucket_count = 24;
+    AK::Array<size_t, pause_time_bucket_count> m_young_pause_time_histogram {};
+    AK::Array<size_t, pause_time_bucket_count> m_full_pause_time_histogram {};
+
+    // What sweeping the garbage of the last collection has freed so far.
+    size_t m_collected_cell_count { 0 };
+    size_t m_collected_cell_bytes { 0 };
+    size_t m_freed_block_count { 0 };
+
     BlockAllocator m_block_allocator;
 
     size_t m_gc_deferrals { 0 };
     bool m_should_gc_when_deferral_ends { false };
+    CollectionType m_collection_type_when_deferral_ends { CollectionType::CollectYoungGarbage };
 
     bool m_collecting_garbage { false };
 };
@@ -43,12 +43,22 @@ public:
 
         if (allocated_cell) {
             ASAN_UNPOISON_MEMORY_REGION(allocated_cell, m_cell_size);
+            m_has_young_cells = true;
         }
         return allocated_cell;
     }
 
     void deallocate(Cell*);
 
+    // Whether cells have been allocated from this block since the last garbage collection.
+    bool has_young_cells() const { return m_has_young_cells; }
+    void set_has_young_cells(bool b) { m_has_young_cells = b; }
+
+    // Whether the block contains cells that have to be destroyed by the collection that finds them
+    // to be unreachable, because they can't be swept lazily (see CanBeSweptLazily).
+    bool must_be_swept_eagerly() const { return m_must_be_swept_eagerly; }
+    void set_must_be_swept_eagerly(bool b) { m_must_be_swept_eagerly = b; }
+
     template<typename Callback>
     void for_each_cell(Callback callback)
     {
@@ -111,6 +121,8 @@ private:
     size_t m_cell_size { 0 };
     size_t m_next_lazy_freelist_index { 0 };
     FreelistEntry* m_freelist { nullptr };
+    bool m_has_young_cells { false };
+    bool m_must_be_swept_eagerly { false };
     alignas(Cell) u8 m_storage[];
 
 public:
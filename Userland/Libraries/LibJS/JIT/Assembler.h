@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace JS::JIT {
+
+// Just enough of an x86-64 assembler for the code that the JIT emits.
+struct Assembler {
+    enum class Reg {
+        RAX = 0,
+        RCX = 1,
+        RDX = 2,
+        RBX = 3,
+        RSP = 4,
+        RBP = 5,
+        RSI = 6,
+        RDI = 7,
+        R8 = 8,
+        R9 = 9,
+        R10 = 10,
+        R11 = 11,
+        R12 = 12,
+        R13 = 13,
+        R14 = 14,
+        R15 = 15,
+    };
+
+    enum class Condition {
+        Overflow = 0x0,
+        Equal = 0x4,
+        NotEqual = 0x5,
+        Sign = 0x8,
+        SignedLessThan = 0xc,
+        SignedGreaterThanOrEqual = 0xd,
+        SignedLessThanOrEqual = 0xe,
+        SignedGreaterThan = 0xf,
+    };
+
+    struct Label {
+        Optional<size_t> offset_of_label_in_instruction_stream;
+        Vector<size_t> jump_slot_offsets_in_instruction_stream;
+
+        void add_jump(Assembler& assembler, size_t offset)
+        {
+            jump_slot_offsets_in_instruction_stream.append(offset);
+            if (offset_of_label_in_instruction_stream.has_value())
+                link_jump(assembler, offset);
+        }
+
+        void link(Assembler& assembler)
+        {
+            VERIFY(!offset_of_label_in_instruction_stream.has_value());
+            offset_of_label_in_instruction_stream = assembler.m_output.size();
+            for (auto offset : jump_slot_offsets_in_instruction_stream)
+                link_jump(assembler, offset);
+        }
+
+    private:
+        void link_jump(Assembler& assembler, size_t offset_in_instruction_stream)
+        {
+            // The rel32 is relative to the end of the jump instruction, which is where the slot ends.
+            auto displacement = static_cast<i32>(*offset_of_label_in_instruction_stream - offset_in_instruction_stream);
+            auto* slot = assembler.m_output.data() + offset_in_instruction_stream - 4;
+            for (size_t i = 0; i < 4; ++i)
+                slot[i] = (displacement >> (i * 8)) & 0xff;
+        }
+    };
+
+    explicit Assembler(Vector<u8>& output)
+        : m_output(output)
+    {
+    }
+
+    Vector<u8>& m_output;
+
+    static constexpr u8 encode_reg(Reg reg) { return to_underlying(reg) & 7; }
+    static constexpr bool is_extended(Reg reg) { return to_underlying(reg) >= 8; }
+
+    void emit8(u8 value) { m_output.append(value); }
+
+    void emit32(u32 value)
+    {
+        for (size_t i = 0; i < 4; ++i)
+            emit8((value >> (i * 8)) & 0xff);
+    }
+
+    void emit64(u64 value)
+    {
+        for (size_t i = 0; i < 8; ++i)
+            emit8((value >> (i * 8)) & 0xff);
+    }
+
+    void emit_rex(bool w, Reg reg, Reg rm)
+    {
+        u8 rex = 0x40 | (w ? 0x08 : 0) | (is_extended(reg) ? 0x04 : 0) | (is_extended(rm) ? 0x01 : 0);
+        if (rex != 0x40)
+            emit8(rex);
+    }
+
+    void emit_modrm_reg(Reg reg, Reg rm)
+    {
+        emit8(0xc0 | (encode_reg(reg) << 3) | encode_reg(rm));
+    }
+
+    void emit_modrm_mem(Reg reg, Reg base, i32 displacement)
+    {
+        // Addressing relative to RSP and R12 would need a SIB byte, which we never do.
+        VERIFY(encode_reg(base) != encode_reg(Reg::RSP));
+        emit8(0x80 | (encode_reg(reg) << 3) | encode_reg(base));
+        emit32(displacement);
+    }
+
+    // mov dst, [base + displacement]
+    void load64(Reg dst, Reg base, i32 displacement)
+    {
+        emit_rex(true, dst, base);
+        emit8(0x8b);
+        emit_modrm_mem(dst, base, displacement);
+    }
+
+    // mov [base + displacement], src
+    void store64(Reg base, i32 displacement, Reg src)
+    {
+        emit_rex(true, src, base);
+        emit8(0x89);
+        emit_modrm_mem(src, base, displacement);
+    }
+
+    void mov64(Reg dst, Reg src)
+    {
+        emit_rex(true, src, dst);
+        emit8(0x89);
+        emit_modrm_reg(src, dst);
+    }
+
+    void mov64(Reg dst, u64 immediate)
+    {
+        emit_rex(true, Reg::RAX, dst);
+        emit8(0xb8 | encode_reg(dst));
+        emit64(immediate);
+    }
+
+    // Zero-extends into the whole register.
+    void mov32(Reg dst, u32 immediate)
+    {
+        emit_rex(false, Reg::RAX, dst);
+        emit8(0xb8 | encode_reg(dst));
+        emit32(immediate);
+    }
+
+    void or64(Reg dst, Reg src)
+    {
+        emit_rex(true, src, dst);
+        emit8(0x09);
+        emit_modrm_reg(src, dst);
+    }
+
+    void xor64(Reg dst, u8 immediate)
+    {
+        emit_rex(true, Reg::RAX, dst);
+        emit8(0x83);
+        emit_modrm_reg(static_cast<Reg>(6), dst);
+        emit8(immediate);
+    }
+
+    void shr64(Reg dst, u8 count)
+    {
+        emit_rex(true, Reg::RAX, dst);
+        emit8(0xc1);
+        emit_modrm_reg(static_cast<Reg>(5), dst);
+        emit8(count);
+    }
+
+    enum class ArithmeticOp : u8 {
+        Add = 0x01,
+        Or = 0x09,
+        And = 0x21,
+        Sub = 0x29,
+        Xor = 0x31,
+        Compare = 0x39,
+    };
+
+    void arithmetic32(ArithmeticOp op, Reg dst, Reg src)
+    {
+        emit_rex(false, src, dst);
+        emit8(to_underlying(op));
+        emit_modrm_reg(src, dst);
+    }
+
+    void arithmetic32(ArithmeticOp op, Reg dst, i32 immediate)
+    {
+        // The /digit of the 0x81 group is the 0x?1 opcode divided by 8.
+        emit_rex(false, Reg::RAX, dst);
+        emit8(0x81);
+        emit_modrm_reg(static_cast<Reg>(to_underlying(op) >> 3), dst);
+        emit32(immediate);
+    }
+
+    void imul32(Reg dst, Reg src)
+    {
+        emit_rex(false, dst, src);
+        emit8(0x0f);
+        emit8(0xaf);
+        emit_modrm_reg(dst, src);
+    }
+
+    void test32(Reg lhs, Reg rhs)
+    {
+        emit_rex(false, rhs, lhs);
+        emit8(0x85);
+        emit_modrm_reg(rhs, lhs);
+    }
+
+    // Only for the registers whose low byte can be addressed without a REX prefix.
+    void test8(Reg lhs, Reg rhs)
+    {
+        VERIFY(to_underlying(lhs) < 4 && to_underlying(rhs) < 4);
+        emit8(0x84);
+        emit_modrm_reg(rhs, lhs);
+    }
+
+    enum class ShiftOp : u8 {
+        Left = 4,
+        LogicalRight = 5,
+        ArithmeticRight = 7,
+    };
+
+    // Shifts by CL, masked to 5 bits just like JavaScript does.
+    void shift32_by_cl(ShiftOp op, Reg dst)
+    {
+        emit_rex(false, Reg::RAX, dst);
+        emit8(0xd3);
+        emit_modrm_reg(static_cast<Reg>(to_underlying(op)), dst);
+    }
+
+    // setcc into the low byte of RAX, then zero-extend it.
+    void set_rax_if(Condition condition)
+    {
+        emit8(0x0f);
+        emit8(0x90 | to_underlying(condition));
+        emit8(0xc0);
+        emit8(0x0f);
+        emit8(0xb6);
+        emit8(0xc0);
+    }
+
+    void jump(Label& label)
+    {
+        emit8(0xe9);
+        emit32(0);
+        label.add_jump(*this, m_output.size());
+    }
+
+    void jump_if(Condition condition, Label& label)
+    {
+        emit8(0x0f);
+        emit8(0x80 | to_underlying(condition));
+        emit32(0);
+        label.add_jump(*this, m_output.size());
+    }
+
+    void jump(Reg target)
+    {
+        emit_rex(false, Reg::RAX, target);
+        emit8(0xff);
+        emit_modrm_reg(static_cast<Reg>(4), target);
+    }
+
+    void call(Reg target)
+    {
+        emit_rex(false, Reg::RAX, target);
+        emit8(0xff);
+        emit_modrm_reg(static_cast<Reg>(2), target);
+    }
+
+    void push(Reg reg)
+    {
+        emit_rex(false, Reg::RAX, reg);
+        emit8(0x50 | encode_reg(reg));
+    }
+
+    void pop(Reg reg)
+    {
+        emit_rex(false, Reg::RAX, reg);
+        emit8(0x58 | encode_reg(reg));
+    }
+
+    void ret()
+    {
+        emit8(0xc3);
+    }
+};
+
+}
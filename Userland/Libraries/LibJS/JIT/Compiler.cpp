@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Platform.h>
+#include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/JIT/Compiler.h>
+
+namespace JS::JIT {
+
+using Reg = Assembler::Reg;
+using Condition = Assembler::Condition;
+using ArithmeticOp = Assembler::ArithmeticOp;
+using ShiftOp = Assembler::ShiftOp;
+
+// While in native code, RBX points to the register file and R12 to the interpreter.
+static constexpr Reg REGISTER_FILE = Reg::RBX;
+static constexpr Reg INTERPRETER = Reg::R12;
+
+static constexpr u64 SHIFTED_BOOLEAN_TAG = BOOLEAN_TAG << TAG_SHIFT;
+
+// The slow paths that native code calls out to. They must not allocate, since the native code
+// doesn't keep any values anywhere the garbage collector would find them.
+static bool get_by_id_from_cache(Bytecode::Interpreter& interpreter, Bytecode::Op::GetById const& instruction)
+{
+    auto base = interpreter.accumulator();
+    if (!base.is_object())
+        return false;
+    auto& executable = interpreter.current_executable();
+    PropertyKey name = executable.get_identifier(instruction.property());
+    auto value = executable.property_lookup_caches[instruction.cache_index()].get(base.as_object(), name);
+    if (!value.has_value())
+        return false;
+    interpreter.accumulator() = *value;
+    return true;
+}
+
+static bool put_by_id_into_cache(Bytecode::Interpreter& interpreter, Bytecode::Op::PutById const& instruction)
+{
+    auto base = interpreter.reg(instruction.base());
+    if (!base.is_object())
+        return false;
+    auto& executable = interpreter.current_executable();
+    PropertyKey name = executable.get_identifier(instruction.property());
+    return executable.property_lookup_caches[instruction.cache_index()].put(base.as_object(), name, interpreter.accumulator());
+}
+
+OwnPtr<NativeBlock> Compiler::compile(Bytecode::BasicBlock const& block)
+{
+#if ARCH(X86_64)
+    Compiler compiler(block);
+    return compiler.compile_block();
+#else
+    (void)block;
+    return {};
+#endif
+}
+
+OwnPtr<NativeBlock> Compiler::compile_block()
+{
+    // Prologue: u64 (Value* registers, Interpreter*, u8 const* entry_point).
+    // Pushing three registers keeps the stack 16-byte aligned for the calls to the slow paths.
+    m_assembler.push(REGISTER_FILE);
+    m_assembler.push(INTERPRETER);
+    m_assembler.push(Reg::R13);
+    m_assembler.mov64(REGISTER_FILE, Reg::RDI);
+    m_assembler.mov64(INTERPRETER, Reg::RSI);
+    m_assembler.jump(Reg::RDX);
+
+    Bytecode::InstructionStreamIterator it(m_block.instruction_stream());
+    while (!it.at_end()) {
+        m_instruction_offset = it.offset();
+        m_entry_points.set(m_instruction_offset, m_output.size());
+        if (!compile_instruction(*it))
+            exit_to_interpreter(m_instruction_offset);
+        ++it;
+    }
+    // Blocks that don't end in a terminator end the executable.
+    exit_to_interpreter(m_block.size());
+
+    for (auto& slow_case : m_slow_cases) {
+        slow_case.label.link(m_assembler);
+        exit_to_interpreter(slow_case.instruction_offset);
+    }
+
+    m_exit.link(m_assembler);
+    m_assembler.pop(Reg::R13);
+    m_assembler.pop(INTERPRETER);
+    m_assembler.pop(REGISTER_FILE);
+    m_assembler.ret();
+
+    return NativeBlock::try_create(m_output.span(), move(m_entry_points));
+}
+
+bool Compiler::compile_instruction(Bytecode::Instruction const& instruction)
+{
+    using Type = Bytecode::Instruction::Type;
+    switch (instruction.type()) {
+    case Type::Load:
+        compile_load(static_cast<Bytecode::Op::Load const&>(instruction));
+        return true;
+    case Type::LoadImmediate:
+        compile_load_immediate(static_cast<Bytecode::Op::LoadImmediate const&>(instruction));
+        return true;
+    case Type::Store:
+        compile_store(static_cast<Bytecode::Op::Store const&>(instruction));
+        return true;
+#define __COMPILE_INT32_ARITHMETIC(OpTitleCase)                                                                       \
+    case Type::OpTitleCase:                                                                                           \
+        compile_int32_arithmetic(static_cast<Bytecode::Op::OpTitleCase const&>(instruction).lhs(), Type::OpTitleCase); \
+        return true;
+        __COMPILE_INT32_ARITHMETIC(Add)
+        __COMPILE_INT32_ARITHMETIC(Sub)
+        __COMPILE_INT32_ARITHMETIC(Mul)
+        __COMPILE_INT32_ARITHMETIC(BitwiseAnd)
+        __COMPILE_INT32_ARITHMETIC(BitwiseOr)
+        __COMPILE_INT32_ARITHMETIC(BitwiseXor)
+        __COMPILE_INT32_ARITHMETIC(LeftShift)
+        __COMPILE_INT32_ARITHMETIC(RightShift)
+        __COMPILE_INT32_ARITHMETIC(UnsignedRightShift)
+#undef __COMPILE_INT32_ARITHMETIC
+#define __COMPILE_INT32_COMPARISON(OpTitleCase, condition)                                                         \
+    case Type::OpTitleCase:                                                                                        \
+        compile_int32_comparison(static_cast<Bytecode::Op::OpTitleCase const&>(instruction).lhs(), condition); \
+        return true;
+        __COMPILE_INT32_COMPARISON(LessThan, Condition::SignedLessThan)
+        __COMPILE_INT32_COMPARISON(LessThanEquals, Condition::SignedLessThanOrEqual)
+        __COMPILE_INT32_COMPARISON(GreaterThan, Condition::SignedGreaterThan)
+        __COMPILE_INT32_COMPARISON(GreaterThanEquals, Condition::SignedGreaterThanOrEqual)
+        __COMPILE_INT32_COMPARISON(StrictlyEquals, Condition::Equal)
+        __COMPILE_INT32_COMPARISON(StrictlyInequals, Condition::NotEqual)
+        __COMPILE_INT32_COMPARISON(LooselyEquals, Condition::Equal)
+        __COMPILE_INT32_COMPARISON(LooselyInequals, Condition::NotEqual)
+#undef __COMPILE_INT32_COMPARISON
+    case Type::Increment:
+        compile_increment_or_decrement(ArithmeticOp::Add);
+        return true;
+    case Type::Decrement:
+        compile_increment_or_decrement(ArithmeticOp::Sub);
+        return true;
+    case Type::Not:
+        compile_not();
+        return true;
+    case Type::Jump:
+        compile_jump(static_cast<Bytecode::Op::Jump const&>(instruction));
+        return true;
+    case Type::JumpConditional:
+        compile_jump_conditional(static_cast<Bytecode::Op::JumpConditional const&>(instruction));
+        return true;
+    case Type::JumpNullish:
+        compile_jump_nullish(static_cast<Bytecode::Op::JumpNullish const&>(instruction));
+        return true;
+    case Type::JumpUndefined:
+        compile_jump_undefined(static_cast<Bytecode::Op::JumpUndefined const&>(instruction));
+        return true;
+    case Type::GetById:
+        compile_cached_property_access(instruction, bit_cast<FlatPtr>(&get_by_id_from_cache));
+        return true;
+    case Type::PutById:
+        // Getters, setters and the like never go through the cache.
+        if (static_cast<Bytecode::Op::PutById const&>(instruction).kind() != Bytecode::Op::PropertyKind::KeyValue)
+            return false;
+        compile_cached_property_access(instruction, bit_cast<FlatPtr>(&put_by_id_into_cache));
+        return true;
+    default:
+        return false;
+    }
+}
+
+i32 Compiler::register_displacement(Bytecode::Register reg)
+{
+    return static_cast<i32>(reg.index() * sizeof(Value));
+}
+
+void Compiler::load_register(Reg dst, Bytecode::Register src)
+{
+    m_assembler.load64(dst, REGISTER_FILE, register_displacement(src));
+}
+
+void Compiler::store_register(Bytecode::Register dst, Reg src)
+{
+    m_assembler.store64(REGISTER_FILE, register_displacement(dst), src);
+}
+
+Assembler::Label& Compiler::slow_case()
+{
+    m_slow_cases.append({ {}, m_instruction_offset });
+    return m_slow_cases.last().label;
+}
+
+void Compiler::jump_to_slow_case_unless_int32(Reg value, Reg scratch)
+{
+    auto& label = m_slow_cases.last().label;
+    m_assembler.mov64(scratch, value);
+    m_assembler.shr64(scratch, TAG_SHIFT);
+    m_assembler.arithmetic32(ArithmeticOp::Compare, scratch, static_cast<i32>(INT32_TAG));
+    m_assembler.jump_if(Condition::NotEqual, label);
+}
+
+// Turns the zero-extended 32-bit payload in `value` into a Value.
+void Compiler::box(Reg value, u64 shifted_tag, Reg scratch)
+{
+    m_assembler.mov64(scratch, shifted_tag);
+    m_assembler.or64(value, scratch);
+}
+
+void Compiler::exit_to_block(Bytecode::BasicBlock const& block)
+{
+    m_assembler.mov64(Reg::RAX, NativeBlock::encode_next_block(block));
+    m_assembler.jump(m_exit);
+}
+
+// Expects the flags to have been set already, which moving an immediate doesn't change.
+void Compiler::exit_to_block_if(Condition condition, Bytecode::BasicBlock const& taken, Bytecode::BasicBlock const& not_taken)
+{
+    m_assembler.mov64(Reg::RAX, NativeBlock::encode_next_block(taken));
+    m_assembler.jump_if(condition, m_exit);
+    exit_to_block(not_taken);
+}
+
+void Compiler::exit_to_interpreter(size_t instruction_offset)
+{
+    m_assembler.mov32(Reg::RAX, static_cast<u32>(NativeBlock::encode_resume_offset(instruction_offset)));
+    m_assembler.jump(m_exit);
+}
+
+void Compiler::compile_load(Bytecode::Op::Load const& instruction)
+{
+    load_register(Reg::RAX, instruction.src());
+    store_register(Bytecode::Register::accumulator(), Reg::RAX);
+}
+
+void Compiler::compile_load_immediate(Bytecode::Op::LoadImmediate const& instruction)
+{
+    m_assembler.mov64(Reg::RAX, instruction.value().encoded());
+    store_register(Bytecode::Register::accumulator(), Reg::RAX);
+}
+
+void Compiler::compile_store(Bytecode::Op::Store const& instruction)
+{
+    load_register(Reg::RAX, Bytecode::Register::accumulator());
+    store_register(instruction.dst(), Reg::RAX);
+}
+
+void Compiler::compile_int32_arithmetic(Bytecode::Register lhs, Bytecode::Instruction::Type type)
+{
+    using Type = Bytecode::Instruction::Type;
+    auto& label = slow_case();
+    load_register(Reg::RAX, lhs);
+    load_register(Reg::RCX, Bytecode::Register::accumulator());
+    jump_to_slow_case_unless_int32(Reg::RAX, Reg::RDX);
+    jump_to_slow_case_unless_int32(Reg::RCX, Reg::RDX);
+
+    switch (type) {
+    case Type::Add:
+        m_assembler.arithmetic32(ArithmeticOp::Add, Reg::RAX, Reg::RCX);
+        m_assembler.jump_if(Condition::Overflow, label);
+        break;
+    case Type::Sub:
+        m_assembler.arithmetic32(ArithmeticOp::Sub, Reg::RAX, Reg::RCX);
+        m_assembler.jump_if(Condition::Overflow, label);
+        break;
+    case Type::Mul:
+        m_assembler.imul32(Reg::RAX, Reg::RCX);
+        m_assembler.jump_if(Condition::Overflow, label);
+        // A zero could have been a negative zero, which isn't an Int32.
+        m_assembler.test32(Reg::RAX, Reg::RAX);
+        m_assembler.jump_if(Condition::Equal, label);
+        break;
+    case Type::BitwiseAnd:
+        m_assembler.arithmetic32(ArithmeticOp::And, Reg::RAX, Reg::RCX);
+        break;
+    case Type::BitwiseOr:
+        m_assembler.arithmetic32(ArithmeticOp::Or, Reg::RAX, Reg::RCX);
+        break;
+    case Type::BitwiseXor:
+        m_assembler.arithmetic32(ArithmeticOp::Xor, Reg::RAX, Reg::RCX);
+        break;
+    case Type::LeftShift:
+        m_assembler.shift32_by_cl(ShiftOp::Left, Reg::RAX);
+        break;
+    case Type::RightShift:
+        m_assembler.shift32_by_cl(ShiftOp::ArithmeticRight, Reg::RAX);
+        break;
+    case Type::UnsignedRightShift:
+        m_assembler.shift32_by_cl(ShiftOp::LogicalRight, Reg::RAX);
+        // Results above 2^31 - 1 are doubles.
+        m_assembler.test32(Reg::RAX, Reg::RAX);
+        m_assembler.jump_if(Condition::Sign, label);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    box(Reg::RAX, SHIFTED_INT32_TAG, Reg::RDX);
+    store_register(Bytecode::Register::accumulator(), Reg::RAX);
+}
+
+void Compiler::compile_int32_comparison(Bytecode::Register lhs, Condition condition)
+{
+    slow_case();
+    load_register(Reg::RAX, lhs);
+    load_register(Reg::RCX, Bytecode::Register::accumulator());
+    jump_to_slow_case_unless_int32(Reg::RAX, Reg::RDX);
+    jump_to_slow_case_unless_int32(Reg::RCX, Reg::RDX);
+    m_assembler.arithmetic32(ArithmeticOp::Compare, Reg::RAX, Reg::RCX);
+    m_assembler.set_rax_if(condition);
+    box(Reg::RAX, SHIFTED_BOOLEAN_TAG, Reg::RDX);
+    store_register(Bytecode::Register::accumulator(), Reg::RAX);
+}
+
+void Compiler::compile_increment_or_decrement(ArithmeticOp op)
+{
+    auto& label = slow_case();
+    load_register(Reg::RAX, Bytecode::Register::accumulator());
+    jump_to_slow_case_unless_int32(Reg::RAX, Reg::RDX);
+    m_assembler.arithmetic32(op, Reg::RAX, 1);
+    m_assembler.jump_if(Condition::Overflow, label);
+    box(Reg::RAX, SHIFTED_INT32_TAG, Reg::RDX);
+    store_register(Bytecode::Register::accumulator(), Reg::RAX);
+}
+
+void Compiler::compile_not()
+{
+    auto& label = slow_case();
+    load_register(Reg::RAX, Bytecode::Register::accumulator());
+    m_assembler.mov64(Reg::RDX, Reg::RAX);
+    m_assembler.shr64(Reg::RDX, TAG_SHIFT);
+    m_assembler.arithmetic32(ArithmeticOp::Compare, Reg::RDX, static_cast<i32>(BOOLEAN_TAG));
+    m_assembler.jump_if(Condition::NotEqual, label);
+    m_assembler.xor64(Reg::RAX, 1);
+    store_register(Bytecode::Register::accumulator(), Reg::RAX);
+}
+
+void Compiler::compile_jump(Bytecode::Op::Jump const& instruction)
+{
+    exit_to_block(instruction.true_target()->block());
+}
+
+void Compiler::compile_jump_conditional(Bytecode::Op::JumpConditional const& instruction)
+{
+    // Booleans and Int32s are truthy exactly if their 32-bit payload isn't zero.
+    auto& label = slow_case();
+    Assembler::Label payload_decides;
+    load_register(Reg::RAX, Bytecode::Register::accumulator());
+    m_assembler.mov64(Reg::RDX, Reg::RAX);
+    m_assembler.shr64(Reg::RDX, TAG_SHIFT);
+    m_assembler.arithmetic32(ArithmeticOp::Compare, Reg::RDX, static_cast<i32>(BOOLEAN_TAG));
+    m_assembler.jump_if(Condition::Equal, payload_decides);
+    m_assembler.arithmetic32(ArithmeticOp::Compare, Reg::RDX, static_cast<i32>(INT32_TAG));
+    m_assembler.jump_if(Condition::NotEqual, label);
+    payload_decides.link(m_assembler);
+    m_assembler.test32(Reg::RAX, Reg::RAX);
+    exit_to_block_if(Condition::NotEqual, instruction.true_target()->block(), instruction.false_target()->block());
+}
+
+void Compiler::compile_jump_nullish(Bytecode::Op::JumpNullish const& instruction)
+{
+    load_register(Reg::RAX, Bytecode::Register::accumulator());
+    m_assembler.shr64(Reg::RAX, TAG_SHIFT);
+    m_assembler.arithmetic32(ArithmeticOp::And, Reg::RAX, static_cast<i32>(IS_NULLISH_EXTRACT_PATTERN));
+    m_assembler.arithmetic32(ArithmeticOp::Compare, Reg::RAX, static_cast<i32>(IS_NULLISH_PATTERN));
+    exit_to_block_if(Condition::Equal, instruction.true_target()->block(), instruction.false_target()->block());
+}
+
+void Compiler::compile_jump_undefined(Bytecode::Op::JumpUndefined const& instruction)
+{
+    load_register(Reg::RAX, Bytecode::Register::accumulator());
+    m_assembler.shr64(Reg::RAX, TAG_SHIFT);
+    m_assembler.arithmetic32(ArithmeticOp::Compare, Reg::RAX, static_cast<i32>(UNDEFINED_TAG));
+    exit_to_block_if(Condition::Equal, instruction.true_target()->block(), instruction.false_target()->block());
+}
+
+// The helper only handles hits in the property lookup cache, and returns false for everything else.
+void Compiler::compile_cached_property_access(Bytecode::Instruction const& instruction, FlatPtr helper)
+{
+    auto& label = slow_case();
+    m_assembler.mov64(Reg::RDI, INTERPRETER);
+    m_assembler.mov64(Reg::RSI, bit_cast<FlatPtr>(&instruction));
+    m_assembler.mov64(Reg::RAX, helper);
+    m_assembler.call(Reg::RAX);
+    m_assembler.test8(Reg::RAX, Reg::RAX);
+    m_assembler.jump_if(Condition::Equal, label);
+}
+
+}
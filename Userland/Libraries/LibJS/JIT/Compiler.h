@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/JIT/Assembler.h>
+#include <LibJS/JIT/NativeBlock.h>
+
+namespace JS::JIT {
+
+// A baseline compiler: every bytecode instruction is translated on its own into a fixed template of
+// machine code that works directly on the register file of the interpreter. Only the common cases,
+// like arithmetic on Int32 values, have templates; everything else and every template whose
+// assumptions don't hold at runtime hands the instruction back to the interpreter.
+class Compiler {
+public:
+    // Returns null on platforms without a JIT, or if the code couldn't be made executable.
+    static OwnPtr<NativeBlock> compile(Bytecode::BasicBlock const&);
+
+private:
+    explicit Compiler(Bytecode::BasicBlock const& block)
+        : m_block(block)
+        , m_assembler(m_output)
+    {
+    }
+
+    OwnPtr<NativeBlock> compile_block();
+
+    bool compile_instruction(Bytecode::Instruction const&);
+    void compile_load(Bytecode::Op::Load const&);
+    void compile_load_immediate(Bytecode::Op::LoadImmediate const&);
+    void compile_store(Bytecode::Op::Store const&);
+    void compile_int32_arithmetic(Bytecode::Register lhs, Bytecode::Instruction::Type);
+    void compile_int32_comparison(Bytecode::Register lhs, Assembler::Condition);
+    void compile_increment_or_decrement(Assembler::ArithmeticOp);
+    void compile_not();
+    void compile_jump(Bytecode::Op::Jump const&);
+    void compile_jump_conditional(Bytecode::Op::JumpConditional const&);
+    void compile_jump_nullish(Bytecode::Op::JumpNullish const&);
+    void compile_jump_undefined(Bytecode::Op::JumpUndefined const&);
+    void compile_cached_property_access(Bytecode::Instruction const&, FlatPtr helper);
+
+    static i32 register_displacement(Bytecode::Register);
+    void load_register(Assembler::Reg, Bytecode::Register);
+    void store_register(Bytecode::Register, Assembler::Reg);
+    void jump_to_slow_case_unless_int32(Assembler::Reg value, Assembler::Reg scratch);
+    void box(Assembler::Reg value, u64 shifted_tag, Assembler::Reg scratch);
+    void exit_to_block(Bytecode::BasicBlock const&);
+    void exit_to_block_if(Assembler::Condition, Bytecode::BasicBlock const& taken, Bytecode::BasicBlock const& not_taken);
+    void exit_to_interpreter(size_t instruction_offset);
+    Assembler::Label& slow_case();
+
+    struct SlowCase {
+        Assembler::Label label;
+        size_t instruction_offset { 0 };
+    };
+
+    Bytecode::BasicBlock const& m_block;
+    Vector<u8> m_output;
+    Assembler m_assembler;
+    Assembler::Label m_exit;
+    HashMap<size_t, size_t> m_entry_points;
+    Vector<SlowCase> m_slow_cases;
+    size_t m_instruction_offset { 0 };
+};
+
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/JIT/NativeBlock.h>
+#include <sys/mman.h>
+
+namespace JS::JIT {
+
+OwnPtr<NativeBlock> NativeBlock::try_create(ReadonlyBytes code, HashMap<size_t, size_t> entry_points)
+{
+    auto size = code.size();
+    auto* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (memory == MAP_FAILED) {
+        dbgln("JIT: Failed to allocate {} bytes for native code: {}", size, strerror(errno));
+        return {};
+    }
+    memcpy(memory, code.data(), size);
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) < 0) {
+        dbgln("JIT: Failed to make native code executable: {}", strerror(errno));
+        munmap(memory, size);
+        return {};
+    }
+    return adopt_own_if_nonnull(new (nothrow) NativeBlock(static_cast<u8*>(memory), size, move(entry_points)));
+}
+
+NativeBlock::NativeBlock(u8* code, size_t size, HashMap<size_t, size_t> entry_points)
+    : m_code(code)
+    , m_size(size)
+    , m_entry_points(move(entry_points))
+{
+}
+
+NativeBlock::~NativeBlock()
+{
+    munmap(m_code, m_size);
+}
+
+NativeBlock::Exit NativeBlock::run(Bytecode::Interpreter& interpreter, Value* registers, size_t instruction_offset) const
+{
+    auto entry_point = m_entry_points.get(instruction_offset);
+    VERIFY(entry_point.has_value());
+
+    using Function = u64 (*)(Value* registers, Bytecode::Interpreter*, u8 const* entry_point);
+    auto* function = reinterpret_cast<Function>(m_code);
+    auto result = function(registers, &interpreter, m_code + *entry_point);
+
+    if (result & 1)
+        return { nullptr, static_cast<size_t>(result >> 1) };
+    return { bit_cast<Bytecode::BasicBlock const*>(static_cast<FlatPtr>(result)), 0 };
+}
+
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/Noncopyable.h>
+#include <AK/OwnPtr.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::JIT {
+
+// The machine code that the JIT has compiled for a BasicBlock. It can be entered at the start of every
+// instruction, and returns to the interpreter when the block jumps to another block, or when it gets to
+// an instruction that it can't run itself. The interpreter runs that one and then enters the native
+// code again right after it, so that falling back doesn't mean giving up on the rest of the block.
+class NativeBlock {
+    AK_MAKE_NONCOPYABLE(NativeBlock);
+    AK_MAKE_NONMOVABLE(NativeBlock);
+
+public:
+    static OwnPtr<NativeBlock> try_create(ReadonlyBytes code, HashMap<size_t, size_t> entry_points);
+    ~NativeBlock();
+
+    // The native code returns one of these, with the low bit telling them apart.
+    static u64 encode_next_block(Bytecode::BasicBlock const& block) { return bit_cast<FlatPtr>(&block); }
+    static constexpr u64 encode_resume_offset(size_t offset) { return (static_cast<u64>(offset) << 1) | 1; }
+
+    struct Exit {
+        // The block that the native code jumped to, or the offset of the instruction that the interpreter should run next.
+        Bytecode::BasicBlock const* next_block { nullptr };
+        size_t resume_offset { 0 };
+    };
+
+    Exit run(Bytecode::Interpreter&, Value* registers, size_t instruction_offset) const;
+
+private:
+    NativeBlock(u8* code, size_t size, HashMap<size_t, size_t> entry_points);
+
+    u8* m_code { nullptr };
+    size_t m_size { 0 };
+    // Maps the offset of each instruction in the bytecode to the offset of its machine code.
+    HashMap<size_t, size_t> m_entry_points;
+};
+
+}
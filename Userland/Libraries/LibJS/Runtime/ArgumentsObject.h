@@ -27,6 +27,8 @@ public:
     virtual ThrowCompletionOr<bool> internal_set(PropertyKey const&, Value value, Value receiver) override;
     virtual ThrowCompletionOr<bool> internal_delete(PropertyKey const&) override;
 
+    virtual bool may_have_exotic_property(PropertyKey const& property_key) const override { return property_key.is_number(); }
+
     // [[ParameterMap]]
     Object& parameter_map() { return *m_parameter_map; }
 
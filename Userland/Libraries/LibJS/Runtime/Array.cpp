@@ -334,4 +334,11 @@ ThrowCompletionOr<MarkedVector<Value>> Array::internal_own_property_keys() const
     return { move(keys) };
 }
 
+// NON-STANDARD: Used to keep the ephemeral length property out of shape-keyed property lookup caches
+bool Array::may_have_exotic_property(PropertyKey const& property_key) const
+{
+    auto& vm = this->vm();
+    return property_key.is_string() && property_key.as_string() == vm.names.length.as_string();
+}
+
 }
@@ -42,6 +42,8 @@ public:
     virtual ThrowCompletionOr<bool> internal_delete(PropertyKey const&) override;
     virtual ThrowCompletionOr<MarkedVector<Value>> internal_own_property_keys() const override;
 
+    virtual bool may_have_exotic_property(PropertyKey const&) const override;
+
     [[nodiscard]] bool length_is_writable() const { return m_length_writable; };
 
 protected:
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibJS/Heap/Heap.h>
 #include <LibJS/Runtime/AbstractOperations.h>
 #include <LibJS/Runtime/FinalizationRegistry.h>
 
@@ -37,9 +38,13 @@ bool FinalizationRegistry::remove_by_token(Cell& unregister_token)
 
 void FinalizationRegistry::remove_dead_cells(Badge<Heap>)
 {
+    // Registries that are garbage themselves only get destroyed once their block is swept, and must not schedule cleanup jobs.
+    if (!heap().did_survive_collection(*this))
+        return;
+
     auto any_cells_were_removed = false;
     for (auto& record : m_records) {
-        if (!record.target || record.target->state() == Cell::State::Live)
+        if (!record.target || heap().did_survive_collection(*record.target))
             continue;
         record.target = nullptr;
         any_cells_were_removed = true;
@@ -31,6 +31,8 @@ public:
     virtual ThrowCompletionOr<MarkedVector<Value>> internal_own_property_keys() const override;
     virtual void initialize(Realm&) override;
 
+    virtual bool may_have_exotic_property(PropertyKey const&) const override { return true; }
+
 private:
     ModuleNamespaceObject(Realm&, Module* module, Vector<FlyString> exports);
 
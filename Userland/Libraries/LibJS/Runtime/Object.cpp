@@ -478,6 +478,7 @@ ThrowCompletionOr<void> Object::private_field_add(PrivateName const& name, Value
 
     // 4. Append PrivateElement { [[Key]]: P, [[Kind]]: field, [[Value]]: value } to O.[[PrivateElements]].
     m_private_elements->empend(name, PrivateElement::Kind::Field, value);
+    write_barrier();
 
     // 5. Return unused.
     return {};
@@ -506,6 +507,7 @@ ThrowCompletionOr<void> Object::private_method_or_accessor_add(PrivateElement el
 
     // 5. Append method to O.[[PrivateElements]].
     m_private_elements->append(move(element));
+    write_barrier();
 
     // 6. Return unused.
     return {};
@@ -545,6 +547,7 @@ ThrowCompletionOr<void> Object::private_set(PrivateName const& name, Value value
 
     if (entry->kind == PrivateElement::Kind::Field) {
         entry->value = value;
+        write_barrier();
         return {};
     } else if (entry->kind == PrivateElement::Kind::Method) {
         return vm.throw_completion<TypeError>(ErrorType::PrivateFieldSetMethod, name.description);
@@ -1009,6 +1012,7 @@ void Object::storage_set(PropertyKey const& property_key, ValueAndAttributes con
     if (property_key.is_number()) {
         auto index = property_key.as_number();
         m_indexed_properties.put(index, value, attributes);
+        write_barrier();
         return;
     }
 
@@ -1028,6 +1032,7 @@ void Object::storage_set(PropertyKey const& property_key, ValueAndAttributes con
             set_shape(*m_shape->create_put_transition(property_key_string_or_symbol, attributes));
 
         m_storage.append(value);
+        write_barrier();
         return;
     }
 
@@ -1039,6 +1044,7 @@ void Object::storage_set(PropertyKey const& property_key, ValueAndAttributes con
     }
 
     m_storage[metadata->offset] = value;
+    write_barrier();
 }
 
 void Object::storage_delete(PropertyKey const& property_key)
@@ -1066,7 +1072,7 @@ void Object::set_prototype(Object* new_prototype)
     if (shape.is_unique())
         shape.set_prototype_without_transition(new_prototype);
     else
-        m_shape = shape.create_prototype_transition(new_prototype);
+        set_shape(*shape.create_prototype_transition(new_prototype));
 }
 
 void Object::define_native_accessor(Realm& realm, PropertyKey const& property_key, Function<ThrowCompletionOr<Value>(VM&)> getter, Function<ThrowCompletionOr<Value>(VM&)> setter, PropertyAttributes attribute)
@@ -1102,7 +1108,7 @@ void Object::ensure_shape_is_unique()
     if (shape().is_unique())
         return;
 
-    m_shape = m_shape->create_unique_clone();
+    set_shape(*m_shape->create_unique_clone());
 }
 
 // Simple side-effect free property lookup, following the prototype chain. Non-standard.
@@ -164,16 +164,35 @@ public:
     // B.3.7 The [[IsHTMLDDA]] Internal Slot, https://tc39.es/ecma262/#sec-IsHTMLDDA-internal-slot
     virtual bool is_htmldda() const { return false; }
 
+    // Whether the property with the given key may be provided or intercepted by this object's exotic internal methods
+    // instead of living in its shape, like an Array's "length". Shape-keyed property lookup caches skip such properties.
+    virtual bool may_have_exotic_property(PropertyKey const&) const { return false; }
+
     bool has_parameter_map() const { return m_has_parameter_map; }
     void set_has_parameter_map() { m_has_parameter_map = true; }
 
     virtual void visit_edges(Cell::Visitor&) override;
 
     Value get_direct(size_t index) const { return m_storage[index]; }
+    void put_direct(size_t index, Value value)
+    {
+        m_storage[index] = value;
+        write_barrier();
+    }
 
     IndexedProperties const& indexed_properties() const { return m_indexed_properties; }
-    IndexedProperties& indexed_properties() { return m_indexed_properties; }
-    void set_indexed_property_elements(Vector<Value>&& values) { m_indexed_properties = IndexedProperties(move(values)); }
+    // NOTE: This assumes that the caller is about to store into the indexed properties, so make sure that
+    //       the values to be stored have been allocated before calling it.
+    IndexedProperties& indexed_properties()
+    {
+        write_barrier();
+        return m_indexed_properties;
+    }
+    void set_indexed_property_elements(Vector<Value>&& values)
+    {
+        m_indexed_properties = IndexedProperties(move(values));
+        write_barrier();
+    }
 
     Shape& shape() { return *m_shape; }
     Shape const& shape() const { return *m_shape; }
@@ -202,7 +221,11 @@ protected:
     bool m_has_parameter_map { false };
 
 private:
-    void set_shape(Shape& shape) { m_shape = &shape; }
+    void set_shape(Shape& shape)
+    {
+        m_shape = &shape;
+        write_barrier();
+    }
 
     Object* prototype() { return shape().prototype(); }
     Object const* prototype() const { return shape().prototype(); }
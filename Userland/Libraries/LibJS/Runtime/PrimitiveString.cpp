@@ -36,7 +36,10 @@ PrimitiveString::PrimitiveString(Utf16String string)
 
 PrimitiveString::~PrimitiveString()
 {
-    vm().string_cache().remove(m_utf8_string);
+    // Strings are swept lazily, by which time the cache may hold a newer string with the same contents.
+    auto& string_cache = vm().string_cache();
+    if (auto it = string_cache.find(m_utf8_string); it != string_cache.end() && it->value == this)
+        string_cache.remove(it);
 }
 
 void PrimitiveString::visit_edges(Cell::Visitor& visitor)
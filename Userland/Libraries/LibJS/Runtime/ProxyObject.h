@@ -52,6 +52,7 @@ private:
 
     virtual bool is_function() const override { return m_target.is_function(); }
     virtual bool is_proxy_object() const final { return true; }
+    virtual bool may_have_exotic_property(PropertyKey const&) const override { return true; }
 
     Object& m_target;
     Object& m_handler;
@@ -193,6 +193,7 @@ void Shape::add_property_to_unique_shape(StringOrSymbol const& property_key, Pro
     VERIFY(m_property_table);
     VERIFY(!m_property_table->contains(property_key));
     m_property_table->set(property_key, { static_cast<u32>(m_property_table->size()), attributes });
+    write_barrier();
 
     VERIFY(m_property_count < NumericLimits<u32>::max());
     ++m_property_count;
@@ -229,6 +230,7 @@ void Shape::add_property_without_transition(StringOrSymbol const& property_key,
         VERIFY(m_property_count < NumericLimits<u32>::max());
         ++m_property_count;
     }
+    write_barrier();
 }
 
 FLATTEN void Shape::add_property_without_transition(PropertyKey const& property_key, PropertyAttributes attributes)
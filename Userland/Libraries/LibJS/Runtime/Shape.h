@@ -75,7 +75,11 @@ public:
 
     Vector<Property> property_table_ordered() const;
 
-    void set_prototype_without_transition(Object* new_prototype) { m_prototype = new_prototype; }
+    void set_prototype_without_transition(Object* new_prototype)
+    {
+        m_prototype = new_prototype;
+        write_barrier();
+    }
 
     void remove_property_from_unique_shape(StringOrSymbol const&, size_t offset);
     void add_property_to_unique_shape(StringOrSymbol const&, PropertyAttributes attributes);
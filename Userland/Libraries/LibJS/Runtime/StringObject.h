@@ -31,6 +31,7 @@ private:
     virtual ThrowCompletionOr<MarkedVector<Value>> internal_own_property_keys() const override;
 
     virtual bool is_string_object() const final { return true; }
+    virtual bool may_have_exotic_property(PropertyKey const& property_key) const override { return property_key.is_number(); }
     virtual void visit_edges(Visitor&) override;
 
     PrimitiveString& m_string;
@@ -455,6 +455,7 @@ protected:
 
 private:
     virtual bool is_typed_array() const final { return true; }
+    virtual bool may_have_exotic_property(PropertyKey const&) const final { return true; }
 };
 
 ThrowCompletionOr<TypedArrayBase*> typed_array_create(VM&, FunctionObject& constructor, MarkedVector<Value> arguments);
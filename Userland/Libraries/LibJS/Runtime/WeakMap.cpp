@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibJS/Heap/Heap.h>
 #include <LibJS/Runtime/WeakMap.h>
 
 namespace JS {
@@ -21,8 +22,8 @@ WeakMap::WeakMap(Object& prototype)
 
 void WeakMap::remove_dead_cells(Badge<Heap>)
 {
-    m_values.remove_all_matching([](Cell* key, Value) {
-        return key->state() != Cell::State::Live;
+    m_values.remove_all_matching([&](Cell* key, Value) {
+        return !heap().did_survive_collection(*key);
     });
 }
 
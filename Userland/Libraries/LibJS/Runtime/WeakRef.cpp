@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibJS/Heap/Heap.h>
 #include <LibJS/Runtime/WeakRef.h>
 
 namespace JS {
@@ -36,7 +37,7 @@ WeakRef::WeakRef(Symbol& value, Object& prototype)
 
 void WeakRef::remove_dead_cells(Badge<Heap>)
 {
-    if (m_value.visit([](Cell* cell) -> bool { return cell->state() == Cell::State::Live; }, [](Empty) -> bool { VERIFY_NOT_REACHED(); }))
+    if (m_value.visit([&](Cell* cell) -> bool { return heap().did_survive_collection(*cell); }, [](Empty) -> bool { VERIFY_NOT_REACHED(); }))
         return;
 
     m_value = Empty {};
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibJS/Heap/Heap.h>
 #include <LibJS/Runtime/WeakSet.h>
 
 namespace JS {
@@ -21,8 +22,8 @@ WeakSet::WeakSet(Object& prototype)
 
 void WeakSet::remove_dead_cells(Badge<Heap>)
 {
-    m_values.remove_all_matching([](Cell* cell) {
-        return cell->state() != Cell::State::Live;
+    m_values.remove_all_matching([&](Cell* cell) {
+        return !heap().did_survive_collection(*cell);
     });
 }
 
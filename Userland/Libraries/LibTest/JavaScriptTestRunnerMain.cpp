@@ -114,6 +114,7 @@ int main(int argc, char** argv)
     args_parser.add_option(g_collect_on_every_allocation, "Collect garbage after every allocation", "collect-often", 'g');
     args_parser.add_option(g_run_bytecode, "Use the bytecode interpreter", "run-bytecode", 'b');
     args_parser.add_option(JS::Bytecode::g_dump_bytecode, "Dump the bytecode", "dump-bytecode", 'd');
+    args_parser.add_option(JS::Bytecode::g_enable_jit, "Compile the bytecode to native code where possible", "jit", 0);
     args_parser.add_option(test_glob, "Only run tests matching the given glob", "filter", 'f', "glob");
     for (auto& entry : g_extra_args)
         args_parser.add_option(*entry.key, entry.value.get<0>().characters(), entry.value.get<1>().characters(), entry.value.get<2>());
@@ -135,6 +136,11 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (JS::Bytecode::g_enable_jit && !g_run_bytecode) {
+        warnln("--jit can only be used when --run-bytecode is specified.");
+        return 1;
+    }
+
     String test_root;
 
     if (specified_test_root) {
@@ -22,7 +22,8 @@ void NavigatorObject::initialize(JS::Realm& realm)
 {
     auto& heap = this->heap();
     auto* languages = MUST(JS::Array::create(realm, 0));
-    languages->indexed_properties().append(js_string(heap, "en-US"));
+    auto* language = js_string(heap, "en-US");
+    languages->indexed_properties().append(language);
 
     // FIXME: All of these should be in Navigator's prototype and be native accessors
     u8 attr = JS::Attribute::Configurable | JS::Attribute::Writable | JS::Attribute::Enumerable;
@@ -31,6 +31,8 @@ public:
     virtual JS::ThrowCompletionOr<bool> internal_delete(JS::PropertyKey const&) override;
     virtual JS::ThrowCompletionOr<JS::MarkedVector<JS::Value>> internal_own_property_keys() const override;
 
+    virtual bool may_have_exotic_property(JS::PropertyKey const&) const override { return true; }
+
     WindowObject& window() { return *m_window; }
     WindowObject const& window() const { return *m_window; }
 
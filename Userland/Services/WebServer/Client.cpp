@@ -18,10 +18,13 @@
 #include <LibCore/FileStream.h>
 #include <LibCore/MappedFile.h>
 #include <LibCore/MimeData.h>
+#include <LibCore/System.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 #include <WebServer/Client.h>
 #include <WebServer/Configuration.h>
+#include <errno.h>
+#include <poll.h>
 #include <stdio.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -163,13 +166,18 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
         return false;
     }
 
+    ContentInfo content_info { .type = Core::guess_mime_type_based_on_filename(real_path), .length = TRY(Core::File::size(real_path)) };
+#ifdef __serenity__
+    TRY(send_file_response(file->fd(), request, content_info));
+#else
+    // Other systems don't have our sendfile(), so the file has to go through our buffers there.
     Core::InputFileStream stream { file };
-
-    TRY(send_response(stream, request, { .type = Core::guess_mime_type_based_on_filename(real_path), .length = TRY(Core::File::size(real_path)) }));
+    TRY(send_response(stream, request, content_info));
+#endif
     return true;
 }
 
-ErrorOr<void> Client::send_response(InputStream& response, HTTP::HttpRequest const& request, ContentInfo content_info)
+ErrorOr<void> Client::send_response_headers(HTTP::HttpRequest const& request, ContentInfo const& content_info)
 {
     StringBuilder builder;
     builder.append("HTTP/1.0 200 OK\r\n"sv);
@@ -187,6 +195,12 @@ ErrorOr<void> Client::send_response(InputStream& response, HTTP::HttpRequest con
     auto builder_contents = builder.to_byte_buffer();
     TRY(m_socket->write(builder_contents));
     log_response(200, request);
+    return {};
+}
+
+ErrorOr<void> Client::send_response(InputStream& response, HTTP::HttpRequest const& request, ContentInfo content_info)
+{
+    TRY(send_response_headers(request, content_info));
 
     char buffer[PAGE_SIZE];
     do {
@@ -206,6 +220,44 @@ ErrorOr<void> Client::send_response(InputStream& response, HTTP::HttpRequest con
         }
     } while (true);
 
+    finish_response(request);
+    return {};
+}
+
+#ifdef __serenity__
+ErrorOr<void> Client::send_file_response(int fd, HTTP::HttpRequest const& request, ContentInfo content_info)
+{
+    TRY(send_response_headers(request, content_info));
+
+    // Let the kernel move the file contents into the socket, so they never have to pass through our buffers.
+    int socket_fd = m_socket->underlying_stream().fd();
+    off_t offset = 0;
+    while (static_cast<size_t>(offset) < content_info.length) {
+        auto nsent_or_error = Core::System::sendfile(socket_fd, fd, &offset, content_info.length - offset);
+        if (nsent_or_error.is_error()) {
+            auto error = nsent_or_error.release_error();
+            if (error.is_errno() && error.code() == EINTR)
+                continue;
+            if (error.is_errno() && error.code() == EAGAIN) {
+                // The client isn't keeping up, so wait until the socket can take more data.
+                pollfd poll_fd { socket_fd, POLLOUT, 0 };
+                if (poll(&poll_fd, 1, -1) < 0 && errno != EINTR)
+                    return Error::from_syscall("poll"sv, -errno);
+                continue;
+            }
+            return error;
+        }
+        if (nsent_or_error.value() == 0)
+            break;
+    }
+
+    finish_response(request);
+    return {};
+}
+#endif
+
+void Client::finish_response(HTTP::HttpRequest const& request)
+{
     auto keep_alive = false;
     if (auto it = request.headers().find_if([](auto& header) { return header.name.equals_ignoring_case("Connection"sv); }); !it.is_end()) {
         if (it->value.trim_whitespace().equals_ignoring_case("keep-alive"sv))
@@ -213,8 +265,6 @@ ErrorOr<void> Client::send_response(InputStream& response, HTTP::HttpRequest con
     }
     if (!keep_alive)
         m_socket->close();
-
-    return {};
 }
 
 ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
@@ -28,7 +28,12 @@ private:
     };
 
     ErrorOr<bool> handle_request(ReadonlyBytes);
+    ErrorOr<void> send_response_headers(HTTP::HttpRequest const&, ContentInfo const&);
     ErrorOr<void> send_response(InputStream&, HTTP::HttpRequest const&, ContentInfo);
+#ifdef __serenity__
+    ErrorOr<void> send_file_response(int fd, HTTP::HttpRequest const&, ContentInfo);
+#endif
+    void finish_response(HTTP::HttpRequest const&);
     ErrorOr<void> send_redirect(StringView redirect, HTTP::HttpRequest const&);
     ErrorOr<void> send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers = {});
     void die();
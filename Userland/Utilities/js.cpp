@@ -1506,7 +1506,7 @@ private:
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
 #ifdef __serenity__
-    TRY(Core::System::pledge("stdio rpath wpath cpath tty sigaction"));
+    TRY(Core::System::pledge("stdio rpath wpath cpath tty sigaction prot_exec"));
 #endif
 
     bool gc_on_every_allocation = false;
@@ -1520,6 +1520,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(JS::Bytecode::g_dump_bytecode, "Dump the bytecode", "dump-bytecode", 'd');
     args_parser.add_option(s_run_bytecode, "Run the bytecode", "run-bytecode", 'b');
     args_parser.add_option(s_opt_bytecode, "Optimize the bytecode", "optimize-bytecode", 'p');
+    args_parser.add_option(JS::Bytecode::g_dump_pass_statistics, "Print instruction counts before and after each optimization pass", "dump-pass-statistics", 0);
+    args_parser.add_option(JS::Bytecode::g_enable_jit, "Compile the bytecode to native code where possible", "jit", 'J');
     args_parser.add_option(s_as_module, "Treat as module", "as-module", 'm');
     args_parser.add_option(s_print_last_result, "Print last result", "print-last-result", 'l');
     args_parser.add_option(s_strip_ansi, "Disable ANSI colors", "disable-ansi-colors", 'i');
@@ -1530,6 +1532,16 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_positional_argument(script_paths, "Path to script files", "scripts", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
+    if (JS::Bytecode::g_enable_jit && !s_run_bytecode) {
+        warnln("--jit can only be used when --run-bytecode is specified.");
+        return 1;
+    }
+
+#ifdef __serenity__
+    if (!JS::Bytecode::g_enable_jit)
+        TRY(Core::System::pledge("stdio rpath wpath cpath tty sigaction"));
+#endif
+
     bool syntax_highlight = !disable_syntax_highlight;
 
     g_vm = JS::VM::create();